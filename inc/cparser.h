@@ -244,7 +244,8 @@
  * submode.
  *
  * Submodes can be nested. The total number of submode plus the top-
- * level is equal to CPARSER_MAX_NESTED_LEVELS.
+ * level is limited by 'max_nested_levels' in cparser_cfg_t 
+ * (CPARSER_MAX_NESTED_LEVELS by default).
  *
  * \section cli_command 5. Command Definitions
  *
@@ -466,6 +467,33 @@
  * }
  * </pre>
  *
+ * With "mk_parser.py -a", all parameters of a command are passed in one
+ * structure instead, cparser_args_<name>_t, declared in cparser_tree.h.
+ * Each parameter is a field of its C type. Strings, file paths and LIST
+ * keywords are copied into char arrays of CPARSER_MAX_TOKEN_SIZE + 1 
+ * bytes. The bit-field 'has' tells which optional parameters are given.
+ * The structure holds no pointers into the parser, so it can be copied,
+ * queued or passed to another thread as it is. A command without 
+ * parameters keeps the prototype above.
+ *
+ * <pre>
+ * typedef struct cparser_args_save_roster_filename_ {
+ *     struct {
+ *         unsigned filename : 1;
+ *     } has;
+ *     char filename[CPARSER_MAX_TOKEN_SIZE + 1];
+ * } cparser_args_save_roster_filename_t;
+ *
+ * cparser_result_t 
+ * cparser_cmd_save_roster_filename(cparser_context_t *context,
+ *     const cparser_args_save_roster_filename_t *args)
+ * {
+ *     const char *fname = (args->has.filename ? args->filename : 
+ *                          "default.dat");
+ *     ...
+ * }
+ * </pre>
+ *
  * \section action_retval 4. RETURNED VALUES
  *
  * Each action function must return a cparser_result_t. If there is no
@@ -476,9 +504,9 @@
  * constraints cannot be checked. For example, if user enters 14 for 
  * a parameter token <UINT:month> which is supposed to be a valid
  * month from 1 to 12, the action function should reject the command
- * and return an error. (Returning an error does not alter CLI Parser
- * processing in anyways currently. In the future, it will increment
- * a counter.)
+ * and return an error. The result is returned by cparser_input() for
+ * the newline that ran the command. It is reported to RPC clients and
+ * recorded in session logs, and it stops cparser_load_cmd().
  *
  * \section action_submode 5. ENTERING AND LEAVING SUBMODE
  *
@@ -519,6 +547,12 @@
  * it automatically exits the submode. This behavior is identical to
  * Cisco CLI.
  *
+ * cparser_check_cmd() (see cparser_check.h) checks such a file without
+ * running it. Every line is parsed and its numbers and addresses are
+ * converted but no action is called. It reports all errors with their lines and
+ * columns instead of stopping at the first one. A large file is split
+ * at lines that are not indented and checked by several threads.
+ *
  * \subsection cli_help 7.2 Display A Help Summary
  *
  * cparser_help_cmd() generates a summary of all available commands in
@@ -550,7 +584,23 @@
  *
  * cparser_quit() causes CLI parser to exit from cparser_run().
  *
- * \subsection cli_user_input 7.5 User Input
+ * \subsection cli_history 7.5 Command History
+ *
+ * By default, a parser only remembers the last 'max_lines' commands
+ * and they are lost when the program exits. To keep a large history
+ * across sessions, open a history file with cparser_history_open() and
+ * set the 'history' field of cparser_cfg_t to it. Each entered command
+ * is appended to the file. A command entered again replaces its older
+ * copy. Several parsers (even in different processes) can share one
+ * history file. \<UP\> and \<DOWN\> walk the history as before.
+ *
+ * Ctrl-R starts a reverse incremental search. Each character typed
+ * is added to the search string and the newest command that contains
+ * it is displayed. Ctrl-R again finds the next older match. Any other
+ * key accepts the match and is then processed normally. An unknown
+ * key cancels the search.
+ *
+ * \subsection cli_user_input 7.6 User Input
  *
  * At times, it is useful if the CLI parser can accept user input.
  * cparser_user_input() is provided to accept user input. Calling
@@ -574,6 +624,88 @@
  * One can use this function to accept a password for entering
  * privileged mode. (In that case, <i>echoed</i> should be set to 0.)
  *
+ * \subsection cli_async 7.7 Asynchronous Commands
+ *
+ * An action function that cannot finish at once, e.g. a dump of a 
+ * large hardware table, does not have to block the session (or, in a
+ * single-threaded event loop, all sessions). It gets a handle of the 
+ * command with cparser_async_handle(), starts the work and returns 
+ * CPARSER_PENDING. The tokens of the command stay valid until it 
+ * completes. The parser does not print the prompt and queues 
+ * all input (up to 'max_queue_size' characters) without echoing it. 
+ * When the work is done, cparser_complete_async() records the result,
+ * prints the prompt and runs the queued input, so the commands of a
+ * session still run in order. If one of them is pending again, the 
+ * rest stays in the queue. cparser_input() returns 
+ * CPARSER_ERR_OUT_OF_RES for a character that does not fit in the 
+ * queue.
+ *
+ * Commands in a file loaded by cparser_load_cmd() cannot be pending.
+ * Loading stops at such a command.
+ *
+ * \subsection cli_coro 7.8 Blocking User Input
+ *
+ * With cparser_user_input(), an action that needs input from the user 
+ * (e.g. a password and then a confirmation) is split into callbacks.
+ * If 'exec' of cparser_cfg_t is cparser_coro_exec() and 'exec_cookie' 
+ * is a cparser_coro_t of the parser (see cparser_coro.h), each action 
+ * runs on the stack of the coroutine and can call cparser_prompt(), 
+ * which returns the input line as if it blocked. Until then, the 
+ * command is pending and cparser_input() returns, so one thread can 
+ * run many sessions that wait for input. On x86-64, a switch between 
+ * the parser and the coroutine only saves and restores a few 
+ * registers.
+ *
+ * \subsection cli_filter 7.9 Output Filters
+ *
+ * With CPARSER_FLAGS_FILTER in 'flags' of cparser_cfg_t, a command can
+ * be followed by a chain of output filters:
+ *
+ * <pre>
+ * show log | include error
+ * show log | exclude debug | count
+ * show running-config | begin interface eth[0-9]
+ * </pre>
+ *
+ * The filters are split off when '|' starts a token, so the command
+ * before them is matched as usual. The command must be complete as
+ * typed; it is not completed automatically. The output of the action
+ * is filtered line by line as it is printed and only the current line
+ * is kept. A pattern with a regular expression special character is
+ * compiled once into a POSIX extended regular expression. Other
+ * patterns are searched as plain strings. "count" must be the last
+ * filter. A filter name can be abbreviated.
+ *
+ * \subsection cli_rpc 7.10 Automation Clients
+ *
+ * A program that drives the CLI does not want echo, prompts or error
+ * pointers. cparser_rpc_init() (see cparser_rpc.h) turns a parser into
+ * a session of such a client. Requests are JSON lines or 
+ * length-prefixed frames with a command line and an id. Each response
+ * carries the id, the result of the command, its output and how long
+ * it took:
+ *
+ * <pre>
+ * {"id": 1, "cmd": "show interface eth0"}
+ * {"id":1,"output":"eth0 up\n","rc":0,"usec":12}
+ * </pre>
+ *
+ * A client can send many requests without waiting for the responses.
+ * They run in order; the ones after a pending command are kept until
+ * cparser_rpc_poll() is called after it completes.
+ *
+ * \subsection cli_record 7.11 Recording And Replaying Sessions
+ *
+ * A session can be recorded into a log file by setting 'record' of 
+ * cparser_cfg_t to cparser_record_hook() and 'record_cookie' to a 
+ * recorder opened by cparser_record_open() (see cparser_record.h).
+ * Each command line is logged with when it ran, its result and the 
+ * sub-mode level after it. cparser_replay() plays many logs at the 
+ * same time, one thread and one parser per log, at the recorded pace,
+ * faster or as fast as possible. It reports the throughput, the 
+ * latency distribution and the commands whose result or sub-mode 
+ * level differs from the log.
+ *
  * \page app Building Your Application
  *
  * \section app_intro 1. INTRODUCTION
@@ -597,17 +729,118 @@
  * .cli files and outputs a cparser_tree.c, a cparser_tree.h.
  *
  * cparser_tree.c contains a set of C structures that form the parse tree.
+ * It also contains the glue functions and cparser_glue_tbl[], a table
+ * of the glue functions indexed by command ID.
+ *
+ * With "-b cparser_tree.bin", mk_parser.py writes the parse tree into
+ * a binary image instead and cparser_tree.c only has the glue functions
+ * and cparser_glue_tbl[]. The image holds no pointers. It is opened 
+ * with cparser_tree_open(), which maps it read-only, so processes 
+ * sharing an image share its pages and the tree needs no relocation 
+ * at startup. The image must be generated on a host with the same 
+ * pointer size and byte order as the target.
+ *
+ * With "-p", cparser_tree.c holds a packed tree, cparser_tree, instead
+ * of one structure per node. The nodes, list nodes and strings needed
+ * for matching are in one block, with 8-bit types and flags and 32-bit
+ * offsets instead of pointers. Strings are stored once and a string that
+ * ends another one shares its bytes. Descriptions are in a separate 
+ * section that is only read for help. The packed tree is usually less 
+ * than half the size of the C structures.
+ *
+ * mk_parser.py checks every set of sibling nodes against all tokens
+ * they can match and prints a warning for:
+ * - A token that matches more than one sibling, e.g. "0x10" with 
+ *   <UINT:a> and <HEX:b>, or "sh" with "show" and <STRING:s>. The 
+ *   warning tells which one is used.
+ * - A node that never gets a token, e.g. "foo" after <STRING:s>, and
+ *   the commands below it.
+ * - A command that is unreachable because another command ends at the
+ *   same node, or an optional part that cannot be left out for the 
+ *   same reason.
+ * .
+ * Nodes that share no token with their siblings are flagged so the 
+ * parser stops at them without trying the other siblings.
+ *
+ * Every command also gets a stable 32-bit ID, CPARSER_ID_<COMMAND> in
+ * cparser_tree.h, which is a hash of its keywords and the types of its
+ * parameters, so it does not change when other commands are added. 
+ * For each command, cparser_enc_<command>() packs the arguments of its
+ * action function into a compact binary record and cparser_dec_<command>()
+ * unpacks one and calls the action. cparser_codec_tbl[] lists the 
+ * decode functions by ID. With 'codecs' and 'num_codecs' of 
+ * cparser_cfg_t set to cparser_codec_tbl and CPARSER_NUM_CODECS, 
+ * cparser_execute_encoded() runs a record without tokenizing or 
+ * matching any text, e.g. to replicate the configuration of one node
+ * to another.
  *
  * \section app_calls 3. ADDING CLI PARSER CALLS
  *
  * You can have multiple CLI parser sessions in your application. Each
  * parser instance is initialized by calling cparser_init(). One needs 
  * to fill out all fields in cparser_cfg_t. The 'root' field should be 
- * <pre>&cparser_root</pre> defined in cparser_tree.c. 'ch_complete', 
+ * <pre>&cparser_root</pre> defined in cparser_tree.c. If a binary image
+ * is used, set 'tree' to the tree opened by cparser_tree_open() with 
+ * cparser_glue_tbl and CPARSER_NUM_GLUE instead. For a packed tree, set
+ * 'tree' to <pre>&cparser_tree</pre>. 'ch_complete', 
  * 'ch_erase', 'ch_del', and 'ch_help' are commonly '\\t', \<BS\> ('\\b'),
  * \<DEL\> (127), and '?' respectively. 'prompt' must be a NULL-terminated 
  * string.
- * 
+ *
+ * The limits of a parser (nested levels, token size, tokens per line, 
+ * number of lines and line size) are also fields of cparser_cfg_t.
+ * Fields left as 0 use the defaults in cparser_options.h. All storage
+ * of a parser is allocated in one block by cparser_init() from the
+ * allocator in 'alloc' (or malloc() if it is NULL) and is freed by
+ * cparser_fini(). A system without heap can use a cparser_arena_t
+ * over a static buffer.
+ *
+ * Commands can also be added and removed at run time, for example by
+ * plugins, with cparser_tree_add() and cparser_tree_remove() on a tree
+ * built by cparser_tree_init(). To change the tree of running parsers,
+ * set 'handle' of all of them to one cparser_tree_handle_t, then change
+ * a clone of the current tree and publish it with
+ * cparser_tree_publish(). Each parser moves to the new tree at its next
+ * line, so no session has to stop, and the old tree is freed after
+ * the last one moved.
+ *
+ * C++ (C++17) programs can use cparser.hpp instead of .cli files. A
+ * command string is bound to a function, a member function or a
+ * captureless lambda with a cparser::command object, and the types of
+ * its arguments are checked against the parameters at compile time.
+ * cparser::add_commands() adds all commands to a run-time tree. The
+ * glue function of each command calls it directly.
+ *
+ * The library has no mutable global state. All state of a parser,
+ * including the terminal settings saved by the UNIX I/O functions, is
+ * in its cparser_t, so parsers can run in different threads at the
+ * same time. Each parser must be used by one thread at a time. A tree
+ * is only read by parsers and can be shared by any number of them.
+ * cparser_tree_add(), cparser_tree_remove(), tree handles and a
+ * history shared by several parsers need a lock of the application
+ * when they are used from several threads. build/unix/bin/bench_threads
+ * runs parsers in 1 to 64 threads over one tree and reports the scaling.
+ *
+ * Actions can also run in a pool of worker threads (cparser_exec.h),
+ * so slow commands of many sessions run in parallel while one thread
+ * handles the input of all of them. Set 'exec' of cparser_cfg_t to 
+ * cparser_exec_submit() and 'exec_cookie' to an executor started by 
+ * cparser_exec_init(). The command is parsed in cparser_input() and its
+ * tokens are queued as a job. The command is pending (see 
+ * cparser_complete_async()) until the job is done, so the commands of 
+ * a session run in order. The output of the job is kept in a buffer.
+ * cparser_exec_poll() prints it and completes the command. The
+ * executor calls a notification function when there is output.
+ *
+ * A server with many sessions can give each session a bounded output
+ * ring (cparser_ring.h) with cparser_ring_config(), so a client that
+ * reads slowly does not block the thread of the server or use
+ * unbounded memory. The event loop calls cparser_ring_drain() when the
+ * (non-blocking) socket is writable. When a ring is full, the output
+ * blocks until it is drained (for a bounded time), is dropped with a 
+ * marker, or disconnects the session. Jobs of an executor print 
+ * directly to the ring.
+ *
  * Run the parser instance when you are ready. There are two interfaces 
  * available - cparser_input() and cparser_run(). cparser_input() is a 
  * low-level interface. You are responsible for getting all characters (from 
@@ -689,7 +922,9 @@ extern "C" {
 /*
  * This is to match Cisco CLI behavior. For example, if there is a
  * command "show crypto interfaces", one can just enter "sh cry int"
- * if no other command has the same prefix form.
+ * if no other command has the same prefix form. mk_parser.py stores
+ * in each keyword node the length after which no sibling can match,
+ * so a token this long is resolved without looking at the others.
  */
 #define SHORTEST_UNIQUE_KEYWORD
 
@@ -704,6 +939,7 @@ typedef enum cparser_result_ {
     CPARSER_ERR_OUT_OF_RES,     /**< Requested resource is exhausted    */
     CPARSER_ERR_PARSE_ERR,      /**< Parse error                        */
     CPARSER_ERR_INCOMP_CMD,     /**< Incomplete command                 */
+    CPARSER_PENDING,            /**< Action completes asynchronously    */
     CPARSER_MAX_RESULTS
 } cparser_result_t;
 
@@ -714,9 +950,14 @@ typedef enum cparser_result_ {
  */
 typedef struct cparser_ cparser_t;
 typedef struct cparser_node_ cparser_node_t;
+typedef struct cparser_tree_ cparser_tree_t;
+typedef struct cparser_tree_ver_ cparser_tree_ver_t;
+typedef struct cparser_tree_handle_ cparser_tree_handle_t;
 
+#include "cparser_alloc.h"
 #include "cparser_line.h"
 #include "cparser_io.h"
+#include "cparser_history.h"
 
 /**
  * \struct   cparser_context_t
@@ -728,10 +969,25 @@ typedef struct {
     /** Pointer to the parser instance */
     cparser_t *parser;
     /** An array of opaque pointers for nested levels */
-    void      *cookie[CPARSER_MAX_NESTED_LEVELS];
+    void      **cookie;
 } cparser_context_t;
 
 #define CPARSER_FLAGS_DEBUG        (1 << 0)
+/** 
+ * The output functions can be called in any thread, e.g. they write to
+ * a cparser_ring_t. Jobs of an executor then print directly.
+ */
+#define CPARSER_FLAGS_MT_OUTPUT    (1 << 1)
+/**
+ * A command can be followed by output filters, e.g. 
+ * "show log | include error". '|' then cannot start a token.
+ */
+#define CPARSER_FLAGS_FILTER       (1 << 2)
+/**
+ * The parser is driven by a program (see cparser_rpc.h). No prompt is
+ * printed.
+ */
+#define CPARSER_FLAGS_BATCH        (1 << 3)
 
 /**
  * Return the number of tokens in the cparser for a particular parsed command.
@@ -745,12 +1001,69 @@ typedef struct {
 typedef cparser_result_t (*cparser_input_cb)(cparser_t *conext,
                                              char *buf, int buf_size);
 
+typedef cparser_result_t (*cparser_glue_fn)(cparser_t *parser);
+
+/**
+ * Executor of glue functions. It is called instead of the glue function
+ * of a command and returns CPARSER_PENDING if the glue function runs 
+ * later (see cparser_complete_async()).
+ */
+typedef cparser_result_t (*cparser_exec_fn)(cparser_t *parser,
+                                            cparser_glue_fn glue);
+
+/**
+ * Recorder of executed commands, e.g. cparser_record_hook(). It is 
+ * called after a command line is run. cparser_last_command() returns 
+ * the line and its result. A pending command is reported with
+ * CPARSER_PENDING and again when it completes.
+ */
+typedef void (*cparser_record_fn)(cparser_t *parser);
+
+/**
+ * Decode function of a command generated by mk_parser.py. It unpacks 
+ * the encoded arguments and calls the action function.
+ */
+typedef cparser_result_t (*cparser_decode_fn)(cparser_t *parser,
+                                              const void *args, 
+                                              size_t len);
+
+/**
+ * \struct   cparser_codec_t
+ * \brief    A command that can be run by cparser_execute_encoded().
+ */
+typedef struct cparser_codec_ {
+    uint32_t          id;     /**< Command ID */
+    /** Number of nodes from the root of the submode to the END node */
+    uint32_t          depth;
+    /** 
+     * Position of each of these nodes among its siblings. Each one is 
+     * in 7-bit groups from the lowest one. Bit 7 is set in all groups
+     * but the last.
+     */
+    const char        *path;
+    cparser_glue_fn   glue;   /**< Glue function of the END node */
+    cparser_decode_fn decode;
+} cparser_codec_t;
+
 /**
  * \struct   cparser_cfg_
  * \brief    Contains all configurable parameters of a parser.
  */
 typedef struct cparser_cfg_ {
     cparser_node_t  *root;
+    /**
+     * Tree image opened by cparser_tree_open(), packed tree generated 
+     * by "mk_parser.py -p" (cparser_tree) or run-time tree. If not NULL,
+     * its root is used and 'root' is ignored. It must stay open until 
+     * cparser_fini() is called.
+     */
+    const cparser_tree_t *tree;
+    /**
+     * Tree handle. If not NULL, the parser uses the newest tree
+     * published in the handle and 'root' and 'tree' are ignored. It
+     * must stay valid until cparser_fini() is called.
+     */
+    cparser_tree_handle_t *handle;
     char            ch_complete;
     char            ch_erase;
     char            ch_del;
@@ -765,6 +1078,57 @@ typedef struct cparser_cfg_ {
     cparser_getch_fn       getch;
     cparser_printc_fn      printc;
     cparser_prints_fn      prints;
+
+    /** 
+     * Persistent command history. NULL to only keep the last 
+     * 'max_lines' commands in the parser. Several parsers can 
+     * share one history.
+     */
+    cparser_history_t      *history;
+
+    /* 
+     * Limits of the parser. Storage is allocated for them in 
+     * cparser_init(). 0 to use the default (CPARSER_MAX_NESTED_LEVELS, 
+     * CPARSER_MAX_TOKEN_SIZE, CPARSER_MAX_NUM_TOKENS, CPARSER_MAX_LINES 
+     * and CPARSER_MAX_LINE_SIZE respectively).
+     */
+    int                    max_nested_levels; /**< Number of sub-mode levels */
+    int                    max_token_size; /**< Characters in one token */
+    int                    max_num_tokens; /**< Tokens per line */
+    int                    max_lines;      /**< Lines kept in the parser */
+    int                    max_line_size;  /**< Characters per line */
+    /** 
+     * Characters queued while a command is pending. 0 to use the 
+     * default (CPARSER_MAX_QUEUE_SIZE).
+     */
+    int                    max_queue_size;
+
+    /**
+     * Executor of the glue functions, e.g. cparser_exec_submit(). NULL
+     * to call them in cparser_input().
+     */
+    cparser_exec_fn        exec;
+    /** Opaque pointer for 'exec', e.g. a cparser_exec_t */
+    void                   *exec_cookie;
+
+    /** Recorder of the executed commands. NULL to not record them. */
+    cparser_record_fn      record;
+    /** Opaque pointer for 'record', e.g. a cparser_record_t */
+    void                   *record_cookie;
+
+    /**
+     * Commands that can be run by cparser_execute_encoded() sorted by 
+     * ID, i.e. cparser_codec_tbl and CPARSER_NUM_CODECS generated by 
+     * mk_parser.py.
+     */
+    const cparser_codec_t  *codecs;
+    uint32_t               num_codecs;
+
+    /** 
+     * Allocator of the parser storage. NULL to use malloc(). It must
+     * stay valid until cparser_fini() is called.
+     */
+    const cparser_alloc_t  *alloc;
 } cparser_cfg_t;
 
 /**
@@ -775,7 +1139,7 @@ typedef struct cparser_token_ {
     /** Index (in the line) of the beginning of the token */
     short          begin_ptr;
     short          token_len;  /**< Number of character in the token */
-    char           buf[CPARSER_MAX_TOKEN_SIZE]; /**< Local copy of the token */
+    char           *buf;      /**< Local copy of the token */
     /** 
      * Pointer to the parent node whose one of its children matches
      * this token.
@@ -790,12 +1154,13 @@ typedef struct cparser_token_ {
 
 /**
  * \brief    Parser FSM states.
- * \details  There are 3 possible states in parser FSM.
+ * \details  There are 4 possible states in parser FSM.
  */
 typedef enum cparser_state_ {
     CPARSER_STATE_WHITESPACE = 0,
     CPARSER_STATE_TOKEN,
     CPARSER_STATE_ERROR,
+    CPARSER_STATE_FILTER, /**< In the output filters after '|' */
     CPARSER_MAX_STATES
 } cparser_state_t;
 
@@ -810,11 +1175,13 @@ struct cparser_ {
     /** Current nested level */
     int               root_level;
     /** Parse tree root node at different nested levels */
-    cparser_node_t    *root[CPARSER_MAX_NESTED_LEVELS];
+    cparser_node_t    **root;
     /** Parser prompt at different nested levels */
-    char              prompt[CPARSER_MAX_NESTED_LEVELS][CPARSER_MAX_PROMPT];
+    char              (*prompt)[CPARSER_MAX_PROMPT];
     /** Current node */
     cparser_node_t    *cur_node;
+    /** Version of the tree of 'cfg.handle' used by the parser */
+    cparser_tree_ver_t *tree_ver;
 
     /********** FSM states **********/
     cparser_state_t   state;       /**< Current state */
@@ -823,17 +1190,46 @@ struct cparser_ {
     /** Last cursor position that is in a non-error state */
     short             last_good;
     /** Token stack */
-    cparser_token_t   tokens[CPARSER_MAX_NUM_TOKENS]; /* parsed tokens */
+    cparser_token_t   *tokens; /* parsed tokens */
     /** Privileged mode (1) or not (0) */
     int               is_privileged_mode;
 
     /********** Line buffering states **********/
     short             max_line;
     short             cur_line;
-    cparser_line_t    lines[CPARSER_MAX_LINES];
+    cparser_line_t    *lines;
+    /** History entry being displayed. CPARSER_HISTORY_NONE for a new line. */
+    uint32_t          hist_id;
+    /** The new line being edited while history entries are displayed */
+    cparser_line_t    hist_saved;
+    /** A line used to redraw the current line after it is replaced */
+    cparser_line_t    scratch;
+
+    /********** Reverse incremental search states **********/
+    /** 1 if a search is in progress; 0 otherwise */
+    int               search_active;
+    short             search_len;  /**< Length of the search string */
+    /** Number of columns of the search display */
+    short             search_cols;
+    /** History entry of the current match. CPARSER_HISTORY_NONE if none. */
+    uint32_t          search_id;
+    /** Search string */
+    char              *search_buf;
+    /** Node stack used by cparser_help_cmd() */
+    cparser_node_t    **help_nodes;
 
     /** Flag indicating if the parser should continue to except input */
     int               done;   
+    /** 
+     * 1 while cparser_load_cmd() runs. Output functions should drop
+     * the output of the parser and of the commands.
+     */
+    int               quiet;
+    /**
+     * 1 while cparser_load_cmd() feeds a command file to the parser FSM.
+     * The line buffers are not used.
+     */
+    int               loading;
     /** Context passed back to action function */ 
     cparser_context_t context;
 
@@ -854,11 +1250,47 @@ struct cparser_ {
     int               last_line_idx;
     /** Result code of the command */
     cparser_result_t  last_rc;
-    /** End node of the command. NULL if the command is invalid. */
+    /** 
+     * End node of the command. NULL if the command is invalid or
+     * the parser has moved to a newer tree since.
+     */
     cparser_node_t    *last_end_node;
+
+    /********** Asynchronous command **********/
+    /** 1 while the action of the last command is pending; 0 otherwise */
+    int               pending;
+    /** Sequence number of the last command, kept in its async handle */
+    uint32_t          async_seq;
+    /** Input characters received while the command is pending */
+    char              *queue_ch;
+    /** Types (cparser_char_t) of the queued characters */
+    uint8_t           *queue_type;
+    int               queue_head;  /**< Index of the oldest character */
+    int               queue_count; /**< Number of queued characters */
+    /** Job of the command in the executor. NULL if there is none. */
+    void              *exec_job;
+
+    /** 
+     * Output filters (cparser_filter.c). NULL without 
+     * CPARSER_FLAGS_FILTER.
+     */
+    void              *filter;
+
+    /** Storage of all the above arrays. See cparser_init(). */
+    void              *mem;
+    size_t            mem_size;  /**< Size of the storage */
+
+    /** 
+     * State of the I/O functions, e.g. the terminal settings saved by
+     * 'io_init' of the parser. NULL if there is none.
+     */
+    void              *io_state;
+    /** Output ring set by cparser_ring_config(). NULL if there is none. */
+    struct cparser_ring_ *ring;
+    /** Batch mode set by cparser_rpc_init(). NULL if there is none. */
+    struct cparser_rpc_  *rpc;
 };
 
-typedef cparser_result_t (*cparser_glue_fn)(cparser_t *parser);
 typedef cparser_result_t (*cparser_token_fn)(char *token, int token_len,
                                              int *is_complete);
 
@@ -881,10 +1313,22 @@ typedef cparser_result_t (*cparser_walker_fn)(cparser_t *parser,
  * \param    cfg Pointer to the parser configuration structure.
  *
  * \retval   parser Pointer to the initialized parser.
- * \return   CPARSER_OK if succeeded; CPARSER_NOT_OK if failed.
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the
+ *           configuration is invalid; CPARSER_ERR_OUT_OF_RES if the 
+ *           storage cannot be allocated.
  */
 cparser_result_t cparser_init(cparser_cfg_t *cfg, cparser_t *parser);
 
+/**
+ * \brief    Free the storage of a parser.
+ *
+ * \param    parser Pointer to the parser structure.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the
+ *           parser is not initialized.
+ */
+cparser_result_t cparser_fini(cparser_t *parser);
+
 /**
  * \brief    Input a character to the parser.
  *
@@ -892,7 +1336,12 @@ cparser_result_t cparser_init(cparser_cfg_t *cfg, cparser_t *parser);
  * \param    ch      Character to be input.
  * \param    ch_type Character type.
  *
- * \return   CPARSER_OK if succeeded; CPARSER_NOT_OK if failed.
+ * \return   CPARSER_OK if succeeded; CPARSER_NOT_OK if failed or the
+ *           result of the action of a completed command;
+ *           CPARSER_PENDING if the command is pending (see 
+ *           cparser_complete_async()); CPARSER_ERR_OUT_OF_RES if the 
+ *           character is dropped because the queue of a pending 
+ *           command is full.
  */
 cparser_result_t cparser_input(cparser_t *parser, char ch, cparser_char_t ch_type);
 
@@ -948,10 +1397,34 @@ cparser_result_t cparser_help_cmd(cparser_t *parser, char *str);
  *
  * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS
  *           if the input parameters are NULL; CPARSER_NOT_OK if the file
- *           cannot be opened.
+ *           cannot be opened or a command in it fails.
  */
 cparser_result_t cparser_load_cmd(cparser_t *parser, char *filename);
 
+/**
+ * \brief    Run a command from its encoded arguments.
+ * \details  The arguments are packed by the encode function of the 
+ *           command generated by mk_parser.py. Nothing is tokenized 
+ *           or matched and nothing but the output of the action is 
+ *           printed. The command must be in the current submode and a 
+ *           hidden command needs the privileged mode. It cannot run 
+ *           while a line is being typed. The action is called in this 
+ *           thread even if 'exec' of cparser_cfg_t is set.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    id     Command ID (CPARSER_ID_<COMMAND>).
+ * \param    args   Encoded arguments.
+ * \param    len    Number of bytes of 'args'.
+ *
+ * \return   The result of the action if it is called; CPARSER_PENDING
+ *           if it completes asynchronously; CPARSER_ERR_INVALID_PARAMS if the
+ *           input parameters or the arguments are invalid or a command 
+ *           is pending; CPARSER_ERR_NOT_EXIST if the command does not 
+ *           exist or cannot be run here.
+ */
+cparser_result_t cparser_execute_encoded(cparser_t *parser, uint32_t id,
+                                         const void *args, size_t len);
+
 /**
  * \brief    Exit a parser session.
  * \details  This call causes the parser to exit and returns from 
@@ -1088,6 +1561,48 @@ int cparser_is_user_input(cparser_t *parser, int *do_echo);
 cparser_result_t cparser_last_command(cparser_t *parser, char **cmd,
                                       cparser_result_t *rc, int *is_priv);
 
+/**
+ * \struct   cparser_async_t
+ * \brief    Handle of a pending command.
+ * \details  It is a value that can be copied. It becomes stale when the
+ *           command completes.
+ */
+typedef struct cparser_async_ {
+    cparser_t *parser; /**< Parser running the command */
+    uint32_t  seq;     /**< Sequence number of the command */
+} cparser_async_t;
+
+/**
+ * \brief    Get the handle of the running command.
+ * \details  It is called by an action function that returns 
+ *           CPARSER_PENDING.
+ *
+ * \param    context Pointer to the context passed to the action function.
+ *
+ * \retval   handle  Handle of the command.
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the 
+ *           input parameters are invalid.
+ */
+cparser_result_t cparser_async_handle(cparser_context_t *context,
+                                      cparser_async_t *handle);
+
+/**
+ * \brief    Complete a pending command.
+ * \details  The prompt is printed and the input queued while the
+ *           command was pending is processed. It must be called in the
+ *           thread that feeds the parser.
+ *
+ * \param    handle Handle of the command.
+ * \param    rc     Result code of the command. It is returned by 
+ *                  cparser_last_command().
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the 
+ *           input parameters are invalid; CPARSER_ERR_NOT_EXIST if the
+ *           command is not pending.
+ */
+cparser_result_t cparser_complete_async(const cparser_async_t *handle,
+                                        cparser_result_t rc);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,533 @@
+/**
+ * \file     cparser.hpp
+ * \brief    C++ front end: commands bound to C++ functions.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPARSER_HPP__
+#define __CPARSER_HPP__
+
+#include <assert.h>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "cparser.h"
+#include "cparser_image.h"
+#include "cparser_token.h"
+
+/**
+ * \namespace cparser
+ * \brief    C++ front end (C++17).
+ * \details  A command is a constexpr string with the syntax of a line of
+ *           a .cli file, bound to an action function:
+ *
+ * <pre>
+ * static constexpr char show_employee[] =
+ *     "show employee <UINT:id> { detail }";
+ *
+ * static cparser_result_t
+ * show_employee_fn (cparser_context_t *context, uint32_t id)
+ * {
+ *     ...
+ * }
+ *
+ * static cparser::command<show_employee, show_employee_fn>
+ *     show_employee_cmd("Show an employee");
+ * </pre>
+ *
+ *           The action takes the context and one argument per parameter
+ *           of the command, in order. A parameter is passed as:
+ *           - const char * for STRING, FILE and LIST,
+ *           - uint32_t for UINT, HEX and IPV4ADDR,
+ *           - uint64_t for UINT64 and HEX64,
+ *           - int32_t for INT, int64_t for INT64, double for FLOAT,
+ *           - cparser_macaddr_t for MACADDR.
+ *           .
+ *           An optional parameter is passed as std::optional of its
+ *           type. The signature is checked against the command at
+ *           compile time and a malformed command or a mismatch fails
+ *           to compile.
+ *
+ *           The action may also be a member function. Its object is
+ *           given to the constructor of cparser::command and kept as a
+ *           typed pointer, cparser::glue<cmd, fn>::object:
+ *
+ * <pre>
+ * static cparser::command<count_ports, &port_table::count>
+ *     count_ports_cmd(&ports, "Count the ports");
+ * </pre>
+ *
+ *           A captureless lambda is bound through a constexpr function
+ *           pointer, e.g. "+lambda".
+ *
+ *           cparser::command objects defined at namespace scope register
+ *           their command during static initialization. add_commands()
+ *           adds all of them to a tree built by cparser_tree_init(). The
+ *           glue function of a command, cparser::glue<cmd, fn>::fn, is
+ *           the function of its END node and calls the action directly.
+ *           It can also be given to cparser_tree_add().
+ */
+namespace cparser {
+
+namespace detail {
+
+/**
+ * \brief    A parameter of a command.
+ */
+struct param_t {
+    /** Node type. CPARSER_MAX_NODES if there is no such parameter. */
+    cparser_node_type_t type;
+    int                 token;    /**< Index of its token */
+    bool                optional; /**< True if it is in { } */
+};
+
+/**
+ * \brief    Result of scan().
+ */
+struct scan_t {
+    /** Number of parameters. -1 if the command is malformed. */
+    int     num_params;
+    param_t param;      /**< The parameter asked for */
+};
+
+/** Names of the parameter types in the same order as cparser_node_type_t */
+constexpr const char *type_names[] = {
+    "STRING", "UINT", "UINT64", "INT", "INT64", "HEX", "HEX64",
+    "FLOAT", "MACADDR", "IPV4ADDR", "FILE", "LIST"
+};
+
+constexpr bool
+is_space (char ch)
+{
+    return ((' ' == ch) || ('\t' == ch) || ('\n' == ch) || ('\r' == ch) ||
+            ('\v' == ch) || ('\f' == ch));
+}
+
+/**
+ * \brief    Get the type of a parameter token "<TYPE:...>".
+ *
+ * \param    str Pointer to the token.
+ * \param    len Length of the token.
+ *
+ * \return   Node type; CPARSER_MAX_NODES if the type is unknown.
+ */
+constexpr cparser_node_type_t
+param_type (const char *str, int len)
+{
+    int n = 0, k = 0;
+
+    if ((3 > len) || ('>' != str[len-1])) {
+        return CPARSER_MAX_NODES;
+    }
+    for (n = 0; n < (int)(sizeof(type_names) / sizeof(type_names[0])); n++) {
+        for (k = 0; type_names[n][k] && (k + 1 < len) &&
+                 (type_names[n][k] == str[k+1]); k++);
+        if (!type_names[n][k] && (':' == str[k+1])) {
+            return (cparser_node_type_t)(CPARSER_NODE_STRING + n);
+        }
+    }
+    return CPARSER_MAX_NODES;
+}
+
+/**
+ * \brief    Scan a command in the same way as cparser_tree_add().
+ * \details  Tokens are counted as in the token stack of a parser. '{'
+ *           and '}' are not tokens.
+ *
+ * \param    cmd  Command string.
+ * \param    want Index of the parameter to return.
+ *
+ * \return   The number of parameters and parameter 'want'.
+ */
+constexpr scan_t
+scan (const char *cmd, int want)
+{
+    scan_t rv = { -1, { CPARSER_MAX_NODES, 0, false } };
+    cparser_node_type_t type = CPARSER_MAX_NODES;
+    int num_tokens = 0, num_params = 0, num_start = 0, num_end = 0, len = 0;
+    bool start = false;
+
+    while (is_space(*cmd)) {
+        cmd++;
+    }
+    if ('+' == *cmd) {
+        cmd++; /* hidden */
+    }
+    for (; *cmd; cmd += len) {
+        if (is_space(*cmd)) {
+            len = 1;
+            continue;
+        }
+        for (len = 0; cmd[len] && !is_space(cmd[len]); len++);
+        if ((1 == len) && ('{' == *cmd)) {
+            start = true;
+            num_start++;
+        } else if ((1 == len) && ('}' == *cmd)) {
+            if (!num_tokens || start || (num_end == num_start)) {
+                return rv;
+            }
+            num_end++;
+        } else {
+            if ('<' == *cmd) {
+                type = param_type(cmd, len);
+                if (CPARSER_MAX_NODES == type) {
+                    return rv;
+                }
+                if (num_params++ == want) {
+                    rv.param.type = type;
+                    rv.param.token = num_tokens;
+                    rv.param.optional = (num_start > num_end);
+                }
+            }
+            num_tokens++;
+            start = false;
+        }
+    }
+    if (num_tokens && (num_start == num_end)) {
+        rv.num_params = num_params;
+    }
+    return rv;
+}
+
+/**
+ * \brief    C++ type of a parameter and its get function.
+ */
+template <cparser_node_type_t T>
+struct arg {
+    typedef void type;
+};
+
+#define CPARSER_HPP_ARG(node_type, val_type, get_fn)                    \
+    template <>                                                         \
+    struct arg<node_type> {                                             \
+        typedef val_type type;                                          \
+        static cparser_result_t                                         \
+        get (const cparser_token_t *token, type *val)                   \
+        {                                                               \
+            return get_fn(token, val);                                  \
+        }                                                               \
+    }
+
+CPARSER_HPP_ARG(CPARSER_NODE_UINT,     uint32_t,          cparser_get_uint);
+CPARSER_HPP_ARG(CPARSER_NODE_UINT64,   uint64_t,          cparser_get_uint64);
+CPARSER_HPP_ARG(CPARSER_NODE_INT,      int32_t,           cparser_get_int);
+CPARSER_HPP_ARG(CPARSER_NODE_INT64,    int64_t,           cparser_get_int64);
+CPARSER_HPP_ARG(CPARSER_NODE_HEX,      uint32_t,          cparser_get_hex);
+CPARSER_HPP_ARG(CPARSER_NODE_HEX64,    uint64_t,          cparser_get_hex64);
+CPARSER_HPP_ARG(CPARSER_NODE_FLOAT,    double,            cparser_get_float);
+CPARSER_HPP_ARG(CPARSER_NODE_MACADDR,  cparser_macaddr_t, cparser_get_macaddr);
+CPARSER_HPP_ARG(CPARSER_NODE_IPV4ADDR, uint32_t,          cparser_get_ipv4addr);
+
+#undef CPARSER_HPP_ARG
+
+#define CPARSER_HPP_ARG_STR(node_type, get_fn)                          \
+    template <>                                                         \
+    struct arg<node_type> {                                             \
+        typedef const char *type;                                       \
+        static cparser_result_t                                         \
+        get (const cparser_token_t *token, type *val)                   \
+        {                                                               \
+            char *str = NULL;                                           \
+            cparser_result_t rc = get_fn(token, &str);                  \
+            *val = str;                                                 \
+            return rc;                                                  \
+        }                                                               \
+    }
+
+CPARSER_HPP_ARG_STR(CPARSER_NODE_STRING, cparser_get_string);
+CPARSER_HPP_ARG_STR(CPARSER_NODE_FILE,   cparser_get_file);
+CPARSER_HPP_ARG_STR(CPARSER_NODE_LIST,   cparser_get_list);
+
+#undef CPARSER_HPP_ARG_STR
+
+/**
+ * \brief    Type of the argument of parameter 'I' of command 'Cmd'.
+ */
+template <const char *Cmd, int I>
+struct arg_of {
+    static constexpr param_t p = scan(Cmd, I).param;
+    typedef typename arg<p.type>::type val_type;
+    typedef std::conditional_t<p.optional, std::optional<val_type>,
+                               val_type> type;
+};
+
+template <const char *Cmd, int I>
+using arg_t = typename arg_of<Cmd, I>::type;
+
+/**
+ * \brief    Get the argument of parameter 'I' of command 'Cmd' from the
+ *           token stack.
+ */
+template <const char *Cmd, int I>
+inline arg_t<Cmd, I>
+get_arg (cparser_t *parser)
+{
+    constexpr param_t p = scan(Cmd, I).param;
+    typename arg<p.type>::type val{};
+    cparser_result_t rc;
+
+    rc = arg<p.type>::get(&parser->tokens[p.token], &val);
+    if constexpr (p.optional) {
+        if (CPARSER_OK != rc) {
+            assert(p.token + 1 > parser->token_tos);
+            return std::nullopt;
+        }
+    } else {
+        assert(CPARSER_OK == rc);
+    }
+    (void)rc;
+    return val;
+}
+
+template <typename... A>
+struct arg_list {
+};
+
+/**
+ * \brief    Signature of an action function.
+ */
+template <typename F>
+struct action {
+    static constexpr bool valid = false;
+    typedef void args;
+};
+
+#define CPARSER_HPP_ACTION(fn_type, obj_type)                           \
+    template <typename... A>                                            \
+    struct action<fn_type> {                                            \
+        static constexpr bool valid = true;                             \
+        typedef obj_type object;                                        \
+        typedef arg_list<A...> args;                                    \
+    }
+
+#define CPARSER_HPP_METHOD(qual)                                        \
+    template <typename C, typename... A>                                \
+    struct action<cparser_result_t (C::*)(cparser_context_t *, A...) qual> { \
+        static constexpr bool valid = true;                             \
+        typedef C object;                                               \
+        typedef arg_list<A...> args;                                    \
+    }
+
+CPARSER_HPP_ACTION(cparser_result_t (*)(cparser_context_t *, A...), void);
+CPARSER_HPP_ACTION(cparser_result_t (*)(cparser_context_t *, A...) noexcept,
+                   void);
+CPARSER_HPP_METHOD();
+CPARSER_HPP_METHOD(const);
+CPARSER_HPP_METHOD(noexcept);
+CPARSER_HPP_METHOD(const noexcept);
+
+#undef CPARSER_HPP_ACTION
+#undef CPARSER_HPP_METHOD
+
+} /* namespace detail */
+
+/**
+ * \brief    Glue function of command 'Cmd' bound to action 'Fn'.
+ */
+template <const char *Cmd, auto Fn,
+          typename Args = typename detail::action<decltype(Fn)>::args>
+struct glue {
+    static_assert(detail::action<decltype(Fn)>::valid,
+                  "an action is cparser_result_t (cparser_context_t *, ...)");
+};
+
+template <const char *Cmd, auto Fn, typename... A>
+struct glue<Cmd, Fn, detail::arg_list<A...> > {
+    /** Class of a member function; void for a function */
+    typedef typename detail::action<decltype(Fn)>::object object_t;
+
+    /** Object of a member function. Set by cparser::command. */
+    static inline object_t *object = NULL;
+
+    static_assert(0 <= detail::scan(Cmd, 0).num_params,
+                  "the command is malformed");
+    static_assert((int)sizeof...(A) == detail::scan(Cmd, 0).num_params,
+                  "the action does not take one argument per parameter");
+
+    /**
+     * \brief    Check the type of every argument.
+     */
+    template <std::size_t... I>
+    static constexpr bool
+    check (std::index_sequence<I...>)
+    {
+        return (std::is_same_v<std::decay_t<A>, detail::arg_t<Cmd, I> > &&
+                ...);
+    }
+    static constexpr bool args_match =
+        ((int)sizeof...(A) == detail::scan(Cmd, 0).num_params) &&
+        check(std::index_sequence_for<A...>());
+    static_assert(!((int)sizeof...(A) == detail::scan(Cmd, 0).num_params) ||
+                  args_match,
+                  "the type of an argument does not match its parameter");
+
+    template <std::size_t... I>
+    static cparser_result_t
+    call (cparser_t *parser, std::index_sequence<I...>)
+    {
+        if constexpr (std::is_void_v<object_t>) {
+            return Fn(&parser->context, detail::get_arg<Cmd, I>(parser)...);
+        } else {
+            assert(object);
+            return (object->*Fn)(&parser->context,
+                                 detail::get_arg<Cmd, I>(parser)...);
+        }
+    }
+
+    /**
+     * \brief    The glue function.
+     *
+     * \param    parser Pointer to the parser.
+     *
+     * \return   The result of the action.
+     */
+    static cparser_result_t
+    fn (cparser_t *parser)
+    {
+        cparser_result_t rc = CPARSER_OK;
+
+        if constexpr (args_match) {
+            rc = call(parser, std::index_sequence_for<A...>());
+        }
+        return rc;
+    }
+};
+
+/**
+ * \brief    A command registered during static initialization.
+ * \details  Commands are kept in the order of registration. The objects
+ *           must stay valid until add_commands() is called.
+ */
+class command_base {
+public:
+    /**
+     * \brief    Register a command.
+     *
+     * \param    cmd  Command string.
+     * \param    fn   Glue function.
+     * \param    desc Description shown by cparser_help_cmd(). May be NULL.
+     */
+    command_base (const char *cmd, cparser_glue_fn fn, const char *desc)
+        : cmd_(cmd), fn_(fn), desc_(desc), next_(NULL)
+    {
+        *tail_ = this;
+        tail_ = &next_;
+    }
+
+    command_base (const command_base &) = delete;
+    command_base &operator= (const command_base &) = delete;
+
+    /**
+     * \brief    Add all registered commands to a tree.
+     *
+     * \param    tree Pointer to a tree built by cparser_tree_init().
+     *
+     * \return   CPARSER_OK if succeeded; the result of the first
+     *           cparser_tree_add() that failed otherwise.
+     */
+    static cparser_result_t
+    add_all (cparser_tree_t *tree)
+    {
+        const command_base *cmd;
+        cparser_result_t rc;
+
+        for (cmd = head_; cmd; cmd = cmd->next_) {
+            rc = cparser_tree_add(tree, cmd->cmd_, cmd->fn_, cmd->desc_);
+            if (CPARSER_OK != rc) {
+                return rc;
+            }
+        }
+        return CPARSER_OK;
+    }
+
+private:
+    const char     *cmd_;
+    cparser_glue_fn fn_;
+    const char     *desc_;
+    command_base   *next_;
+
+    /* Constant-initialized, so commands can register in any order */
+    static inline command_base  *head_ = NULL;
+    static inline command_base **tail_ = &head_;
+};
+
+/**
+ * \brief    Command 'Cmd' bound to action 'Fn'.
+ */
+template <const char *Cmd, auto Fn>
+class command : public command_base {
+public:
+    typedef typename glue<Cmd, Fn>::object_t object_t;
+
+    /**
+     * \brief    Register a command bound to a function.
+     *
+     * \param    desc Description shown by cparser_help_cmd(). May be NULL.
+     */
+    template <typename O = object_t,
+              std::enable_if_t<std::is_void_v<O>, int> = 0>
+    explicit command (const char *desc = NULL)
+        : command_base(Cmd, &glue<Cmd, Fn>::fn, desc)
+    {
+    }
+
+    /**
+     * \brief    Register a command bound to a member function.
+     *
+     * \param    obj  Object the member function is called on.
+     * \param    desc Description shown by cparser_help_cmd(). May be NULL.
+     */
+    template <typename O = object_t,
+              std::enable_if_t<!std::is_void_v<O>, int> = 0>
+    explicit command (O *obj, const char *desc = NULL)
+        : command_base(Cmd, &glue<Cmd, Fn>::fn, desc)
+    {
+        assert(obj);
+        glue<Cmd, Fn>::object = obj;
+    }
+};
+
+/**
+ * \brief    Add all commands registered by cparser::command objects to a
+ *           tree.
+ *
+ * \param    tree Pointer to a tree built by cparser_tree_init().
+ *
+ * \return   CPARSER_OK if succeeded; see cparser_tree_add() otherwise.
+ */
+inline cparser_result_t
+add_commands (cparser_tree_t *tree)
+{
+    return command_base::add_all(tree);
+}
+
+} /* namespace cparser */
+
+#endif /* __CPARSER_HPP__ */
@@ -0,0 +1,115 @@
+/**
+ * \file     cparser_alloc.h
+ * \brief    Memory allocator interface used by parsers and histories.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPARSER_ALLOC_H__
+#define __CPARSER_ALLOC_H__
+
+#include <stddef.h>
+
+/**
+ * \typedef  cparser_alloc_fn
+ * \brief    Allocate a block of memory.
+ *
+ * \param    cookie Opaque pointer of the allocator.
+ * \param    size   Number of bytes to be allocated.
+ *
+ * \return   Pointer to the block; NULL if there is no memory.
+ */
+typedef void *(*cparser_alloc_fn)(void *cookie, size_t size);
+
+/**
+ * \typedef  cparser_free_fn
+ * \brief    Free a block of memory.
+ *
+ * \param    cookie Opaque pointer of the allocator.
+ * \param    ptr    Pointer to the block.
+ * \param    size   Number of bytes requested when the block is allocated.
+ */
+typedef void (*cparser_free_fn)(void *cookie, void *ptr, size_t size);
+
+/**
+ * \struct   cparser_alloc_t
+ * \brief    A memory allocator.
+ * \details  All memory of a parser is allocated by cparser_init() and 
+ *           freed by cparser_fini(). A history allocates memory as
+ *           commands are added. Where an allocator is optional, NULL 
+ *           means malloc() and free().
+ */
+typedef struct cparser_alloc_ {
+    cparser_alloc_fn  alloc;
+    cparser_free_fn   free;
+    void              *cookie; /**< Passed back to 'alloc' and 'free' */
+} cparser_alloc_t;
+
+/**
+ * \struct   cparser_arena_t
+ * \brief    An allocator that carves blocks out of a caller-provided buffer.
+ * \details  Blocks are never returned to the arena. It suits systems 
+ *           without heap where a static buffer is sized for a fixed 
+ *           number of parsers.
+ */
+typedef struct cparser_arena_ {
+    cparser_alloc_t  alloc;  /**< Allocator to be given to a parser */
+    char             *buf;   /**< Memory of the arena */
+    size_t           size;   /**< Size of the memory */
+    size_t           used;   /**< Number of bytes allocated */
+} cparser_arena_t;
+
+/**
+ * Initialize an arena.
+ *
+ * \param    arena Pointer to the arena.
+ * \param    buf   Pointer to the memory of the arena.
+ * \param    size  Size of the memory in bytes.
+ */
+void cparser_arena_init(cparser_arena_t *arena, void *buf, size_t size);
+
+/**
+ * Allocate a zeroed block of memory from an allocator.
+ *
+ * \param    alloc Pointer to the allocator. NULL to use malloc().
+ * \param    size  Number of bytes to be allocated.
+ *
+ * \return   Pointer to the block; NULL if there is no memory.
+ */
+void *cparser_mem_alloc(const cparser_alloc_t *alloc, size_t size);
+
+/**
+ * Free a block of memory to an allocator.
+ *
+ * \param    alloc Pointer to the allocator. NULL to use free().
+ * \param    ptr   Pointer to the block. Nothing is done if it is NULL.
+ * \param    size  Number of bytes requested when the block is allocated.
+ */
+void cparser_mem_free(const cparser_alloc_t *alloc, void *ptr, size_t size);
+
+#endif /* __CPARSER_ALLOC_H__ */
@@ -0,0 +1,116 @@
+/**
+ * \file     cparser_check.h
+ * \brief    Validation of command files without running them.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPARSER_CHECK_H__
+#define __CPARSER_CHECK_H__
+
+#include "cparser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * \struct   cparser_check_error_t
+ * \brief    An error found by cparser_check_cmd().
+ */
+typedef struct cparser_check_error_ {
+    uint32_t          line;   /**< Line number, from 1 */
+    uint32_t          column; /**< Column of the error, from 1 */
+    /**
+     * CPARSER_ERR_PARSE_ERR, CPARSER_ERR_INCOMP_CMD, 
+     * CPARSER_ERR_OUT_OF_RES if the line is too long or CPARSER_NOT_OK
+     * if a number or an address is out of range.
+     */
+    cparser_result_t  rc;
+} cparser_check_error_t;
+
+/**
+ * \brief    Check a command file without running it.
+ * \details  Each line is parsed as cparser_load_cmd() would, including
+ *           the sub-modes given by the indentation, and its numbers
+ *           and addresses are converted. Strings are accepted up to 
+ *           max_token_size of the configuration and files need not 
+ *           exist. No glue or action function is called. A command whose END node has a sub-mode enters it.
+ *           Unlike cparser_load_cmd(), the check goes on after an 
+ *           error, and a last line without a newline is checked too.
+ *
+ *           Commands that leave a sub-mode in their action, e.g. 
+ *           "exit", are not run, so a sub-mode is only left when the
+ *           indentation decreases.
+ *
+ *           The file is split at lines that are not indented into one
+ *           part per thread. Each thread checks its part from the top
+ *           level with its own parser that has the configuration and 
+ *           the privileged mode of 'parser'. If the indentation at the
+ *           end of a part is not enough to leave its sub-modes, the 
+ *           next part is checked again from there after all threads 
+ *           finish.
+ *
+ * \param    parser      Pointer to the parser. It is not changed.
+ * \param    filename    Path of the file.
+ * \param    num_threads Number of threads.
+ * \param    errors      Array that gets the first 'max_errors' errors
+ *                       in the order of their lines. It can be NULL if
+ *                       'max_errors' is 0.
+ * \param    max_errors  Number of entries in 'errors'.
+ *
+ * \retval   num_errors  Number of errors in the file.
+ * \return   CPARSER_OK if there is no error; CPARSER_NOT_OK if there 
+ *           is any error; CPARSER_ERR_NOT_EXIST if the file cannot be 
+ *           read; CPARSER_ERR_OUT_OF_RES if a thread or a parser cannot
+ *           be created; CPARSER_ERR_INVALID_PARAMS if the input 
+ *           parameters are invalid.
+ */
+cparser_result_t cparser_check_cmd(cparser_t *parser, const char *filename,
+                                   int num_threads, 
+                                   cparser_check_error_t *errors,
+                                   uint32_t max_errors, 
+                                   uint32_t *num_errors);
+
+/**
+ * \brief    Print errors found by cparser_check_cmd(), one per line, 
+ *           with the output function of a parser.
+ *
+ * \param    parser     Pointer to the parser.
+ * \param    errors     The errors.
+ * \param    num_errors Number of errors.
+ */
+void cparser_check_print(cparser_t *parser, 
+                         const cparser_check_error_t *errors,
+                         uint32_t num_errors);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __CPARSER_CHECK_H__ */
@@ -0,0 +1,148 @@
+/**
+ * \file     cparser_coro.h
+ * \brief    Actions that run as coroutines and block on user input.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPARSER_CORO_H__
+#define __CPARSER_CORO_H__
+
+#include "cparser.h"
+
+/*
+ * On x86-64 ELF platforms with a GNU compiler, coroutines are switched 
+ * by a few instructions that save the callee-saved registers. Other 
+ * platforms use ucontext, whose switch also saves the signal mask.
+ */
+#if defined(__x86_64__) && defined(__ELF__) && defined(__GNUC__)
+#define CPARSER_CORO_ASM
+#else
+#include <ucontext.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * \struct   cparser_coro_t
+ * \brief    Coroutine of a parser.
+ * \details  A parser with 'exec' set to cparser_coro_exec() and 
+ *           'exec_cookie' set to a coroutine runs the glue function 
+ *           (and the action function) of each command on the stack of 
+ *           the coroutine. An action can then call cparser_prompt(), 
+ *           which returns when a line is input, as if it blocks. 
+ *           Meanwhile, the command is pending and cparser_input() 
+ *           returns, so one thread can serve many sessions.
+ */
+typedef struct cparser_coro_ {
+    const cparser_alloc_t *alloc;   /**< Allocator of the stack */
+    char                  *stack;   /**< Stack of the coroutine */
+    size_t                stack_size;
+#ifdef CPARSER_CORO_ASM
+    void                  *sp;      /**< Stack pointer of the coroutine */
+    void                  *caller_sp; /**< Stack pointer of its caller */
+#else
+    ucontext_t            ctx;      /**< Context of the coroutine */
+    ucontext_t            caller;   /**< Context of its caller */
+#endif
+    cparser_t             *parser;  /**< Parser of the running command */
+    cparser_glue_fn       glue;     /**< Glue function of the command */
+    cparser_async_t       async;    /**< Handle of the pending command */
+    int                   active;   /**< 1 if a command is running */
+    cparser_result_t      rc;       /**< Result of the glue function */
+} cparser_coro_t;
+
+/**
+ * \brief    Allocate a coroutine.
+ *
+ * \param    coro       Pointer to the coroutine.
+ * \param    stack_size Size of the stack in bytes. 0 to use the default
+ *                      (CPARSER_CORO_STACK_SIZE).
+ * \param    alloc      Allocator of the stack. NULL to map it with 
+ *                      mmap() with a guard page below it; the size is 
+ *                      rounded up to pages.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the 
+ *           input parameters are invalid; CPARSER_ERR_OUT_OF_RES if the
+ *           stack cannot be allocated.
+ */
+cparser_result_t cparser_coro_init(cparser_coro_t *coro, size_t stack_size,
+                                   const cparser_alloc_t *alloc);
+
+/**
+ * \brief    Free a coroutine.
+ *
+ * \param    coro Pointer to the coroutine.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the 
+ *           input parameters are invalid; CPARSER_NOT_OK if a command 
+ *           is running on it.
+ */
+cparser_result_t cparser_coro_fini(cparser_coro_t *coro);
+
+/**
+ * \brief    Run a command on the coroutine of a parser.
+ * \details  It is set as 'exec' of cparser_cfg_t and is called by the 
+ *           parser.
+ *
+ * \param    parser Pointer to the parser.
+ * \param    glue   Glue function of the command.
+ *
+ * \return   Result of the glue function if it returns; CPARSER_PENDING
+ *           if it waits in cparser_prompt().
+ */
+cparser_result_t cparser_coro_exec(cparser_t *parser, cparser_glue_fn glue);
+
+/**
+ * \brief    Ask for a line of input in an action function.
+ * \details  It must be called by an action that runs on a coroutine. 
+ *           The coroutine is suspended until \<ENTER\> is input. The 
+ *           line is not parsed as a command.
+ *
+ * \param    parser   Pointer to the parser.
+ * \param    prompt   Prompt to print. NULL if none.
+ * \param    do_echo  1 to echo the input; 0 otherwise (e.g. passwords).
+ * \param    buf      Buffer of the input.
+ * \param    buf_size Size of the buffer. The input is NULL-terminated.
+ *
+ * \return   CPARSER_OK if succeeded (the input is empty if it is 
+ *           aborted by cparser_abort_user_input()); 
+ *           CPARSER_ERR_INVALID_PARAMS if the parameters are invalid or
+ *           the action does not run on a coroutine; CPARSER_NOT_OK if 
+ *           the parser already waits for user input.
+ */
+cparser_result_t cparser_prompt(cparser_t *parser, const char *prompt,
+                                int do_echo, char *buf, int buf_size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __CPARSER_CORO_H__ */
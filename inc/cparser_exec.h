@@ -0,0 +1,175 @@
+/**
+ * \file     cparser_exec.h
+ * \brief    Executor that runs actions in a pool of worker threads.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPARSER_EXEC_H__
+#define __CPARSER_EXEC_H__
+
+#include <pthread.h>
+#include "cparser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+typedef struct cparser_exec_job_ cparser_exec_job_t;
+typedef struct cparser_exec_ cparser_exec_t;
+
+/**
+ * \brief    Notification that a job has new output or has completed.
+ * \details  It is called in a worker thread. It should only wake up the
+ *           thread that feeds the parser, which then calls 
+ *           cparser_exec_poll().
+ *
+ * \param    parser Pointer to the parser of the job.
+ * \param    cookie The cookie given to cparser_exec_init().
+ */
+typedef void (*cparser_exec_notify_fn)(cparser_t *parser, void *cookie);
+
+/**
+ * \struct   cparser_exec_worker_t
+ * \brief    A worker thread and its queue of jobs.
+ */
+typedef struct cparser_exec_worker_ {
+    pthread_t           thread;
+    cparser_exec_t      *exec;   /**< Executor of the worker */
+    pthread_mutex_t     lock;    /**< Lock of the queue */
+    /** 
+     * Jobs to run. The worker takes the oldest job. Other workers 
+     * steal the newest one.
+     */
+    cparser_exec_job_t  **jobs;
+    int                 head;    /**< Index of the oldest job */
+    int                 count;   /**< Number of jobs in the queue */
+} cparser_exec_worker_t;
+
+/**
+ * \struct   cparser_exec_t
+ * \brief    An executor.
+ * \details  A parser with 'exec' set to cparser_exec_submit() and 
+ *           'exec_cookie' set to an executor parses a command in 
+ *           cparser_input() as usual. The glue function is not called. 
+ *           Instead, the tokens are copied into a job that is put in 
+ *           the queue of a worker, and the command is pending. The 
+ *           parser queues the input after it. A worker without jobs 
+ *           steals jobs from the others. The glue function runs in the
+ *           worker on a copy of the parser whose output goes to a 
+ *           buffer of the job. cparser_exec_poll() prints the buffer 
+ *           and completes the command when the job is done. If the 
+ *           parser has CPARSER_FLAGS_MT_OUTPUT, the job prints directly
+ *           with the output functions of the parser instead.
+ */
+struct cparser_exec_ {
+    const cparser_alloc_t   *alloc;       /**< Allocator of the jobs */
+    int                     num_workers;
+    cparser_exec_worker_t   *workers;
+    int                     max_jobs;     /**< Maximum jobs at a time */
+    cparser_exec_notify_fn  notify;
+    void                    *cookie;      /**< Passed back to 'notify' */
+    pthread_mutex_t         lock;         /**< Lock of the fields below */
+    pthread_cond_t          cond;         /**< Signaled when a job is queued */
+    int                     num_jobs;     /**< Jobs not yet polled */
+    int                     num_queued;   /**< Jobs in the queues */
+    int                     next;         /**< Worker of the next job */
+    int                     stop;         /**< 1 if the workers must exit */
+};
+
+/**
+ * \brief    Start an executor.
+ *
+ * \param    exec        Pointer to the executor.
+ * \param    num_workers Number of worker threads.
+ * \param    max_jobs    Maximum number of jobs (of all parsers) that 
+ *                       are queued, running or not yet polled.
+ * \param    notify      Notification of new output. NULL if the parsers 
+ *                       are polled without it.
+ * \param    cookie      Passed back to 'notify'.
+ * \param    alloc       Allocator of the executor and the jobs. NULL to 
+ *                       use malloc().
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the 
+ *           input parameters are invalid; CPARSER_ERR_OUT_OF_RES if the 
+ *           storage or the threads cannot be allocated.
+ */
+cparser_result_t cparser_exec_init(cparser_exec_t *exec, int num_workers,
+                                   int max_jobs, 
+                                   cparser_exec_notify_fn notify, 
+                                   void *cookie, 
+                                   const cparser_alloc_t *alloc);
+
+/**
+ * \brief    Stop an executor.
+ * \details  The workers finish the queued jobs and exit.
+ *
+ * \param    exec Pointer to the executor.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the 
+ *           input parameters are invalid; CPARSER_NOT_OK if some job is
+ *           not yet polled.
+ */
+cparser_result_t cparser_exec_fini(cparser_exec_t *exec);
+
+/**
+ * \brief    Submit a command to the executor of a parser.
+ * \details  It is set as 'exec' of cparser_cfg_t and is called by the 
+ *           parser. The glue function (and the action function) runs 
+ *           on a copy of the parser. It can use the tokens, the cookies 
+ *           of the context and the output functions. It must not change
+ *           the parser, e.g. enter a sub-mode, and must not be pending.
+ *
+ * \param    parser Pointer to the parser.
+ * \param    glue   Glue function of the command.
+ *
+ * \return   CPARSER_PENDING if succeeded; CPARSER_ERR_OUT_OF_RES if 
+ *           there are too many jobs or the job cannot be allocated.
+ */
+cparser_result_t cparser_exec_submit(cparser_t *parser, cparser_glue_fn glue);
+
+/**
+ * \brief    Print the new output of the job of a parser.
+ * \details  If the job is done, the command is completed with 
+ *           cparser_complete_async() and the queued input is processed.
+ *           It must be called in the thread that feeds the parser.
+ *
+ * \param    parser Pointer to the parser.
+ *
+ * \return   CPARSER_OK if the job is done; CPARSER_PENDING if it is 
+ *           still queued or running; CPARSER_ERR_NOT_EXIST if the 
+ *           parser has no job; CPARSER_ERR_INVALID_PARAMS if the input 
+ *           parameters are invalid.
+ */
+cparser_result_t cparser_exec_poll(cparser_t *parser);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __CPARSER_EXEC_H__ */
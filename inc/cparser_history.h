@@ -0,0 +1,217 @@
+/**
+ * \file     cparser_history.h
+ * \brief    Persistent command history API definitions and prototypes.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPARSER_HISTORY_H__
+#define __CPARSER_HISTORY_H__
+
+#include <stddef.h>
+#include "cparser_options.h"
+#include "cparser_alloc.h"
+
+/**
+ * Entry id that refers to no history entry. When it is used as a starting
+ * point of a walk or a search, it refers to the newest end of the history.
+ */
+#define CPARSER_HISTORY_NONE       (0xffffffff)
+
+/**
+ * \struct   cparser_history_entry_t
+ * \brief    Index of one entry in a history file.
+ */
+typedef struct cparser_history_entry_ {
+    /** File offset of the command string. 0 if a newer copy exists. */
+    uint32_t  offset;
+    uint32_t  hash;     /**< Hash of the command string */
+    uint32_t  next;     /**< Next entry id in the same hash bucket */
+} cparser_history_entry_t;
+
+/**
+ * \struct   cparser_history_gram_t
+ * \brief    List of all entries that contains a trigram.
+ */
+typedef struct cparser_history_gram_ {
+    uint32_t  key;      /**< Trigram plus one. 0 if the slot is free */
+    uint32_t  begin;    /**< Index of the first entry not yet evicted */
+    uint32_t  count;    /**< Number of entry ids in 'ids' */
+    uint32_t  size;     /**< Number of entry ids 'ids' can hold */
+    uint32_t  *ids;     /**< Entry ids in ascending order */
+} cparser_history_gram_t;
+
+/**
+ * \struct   cparser_history_t
+ * \brief    A persistent command history.
+ * \details  Commands are appended to a file which is mapped into memory.
+ *           Several parsers (in one or more processes) can share one 
+ *           history file. Each command gets an entry id that increases
+ *           by one for every command. Only the last 'max_entries' 
+ *           entries are kept. When a command is entered again, its
+ *           older entry is dropped so each command appears once.
+ *
+ *           A file with many duplicated or evicted commands is 
+ *           compacted when it is opened. The new file replaces the old 
+ *           one under an exclusive lock. Commands are appended under a 
+ *           shared lock, and a session that finds the file replaced opens
+ *           the new file first. So, no command is lost.
+ *
+ *           Reverse search uses a trigram index. Each trigram has 
+ *           the list of entries that contain it. A search only visits
+ *           entries in the shortest list among trigrams of the search
+ *           string.
+ */
+typedef struct cparser_history_ {
+    int                     fd;          /**< File descriptor of the file */
+    char                    *map;        /**< Mapping of the file */
+    size_t                  map_size;    /**< Size of the mapping */
+    size_t                  file_size;   /**< Number of bytes indexed */
+    uint32_t                num_records; /**< Number of records indexed */
+    uint32_t                max_entries; /**< Capacity of the history */
+    uint32_t                next_id;     /**< Id of the next entry */
+    cparser_history_entry_t *entries;    /**< Entries indexed by id */
+    uint32_t                *buckets;    /**< Hash buckets of entry ids */
+    uint32_t                bucket_mask;
+    cparser_history_gram_t  *grams;      /**< Trigram hash table */
+    uint32_t                gram_mask;
+    uint32_t                num_grams;
+    const cparser_alloc_t   *alloc;      /**< Allocator of the index */
+    /** Path of the file. It is reopened if another session replaces it. */
+    char                    path[CPARSER_HISTORY_PATH_LEN];
+} cparser_history_t;
+
+/**
+ * Open a history file. The file is created if it does not exist.
+ *
+ * \param    hist        Pointer to a history structure.
+ * \param    path        Path of the history file. It is shorter than
+ *                       CPARSER_HISTORY_PATH_LEN.
+ * \param    max_entries Maximum number of entries kept. 0 to use
+ *                       CPARSER_HISTORY_SIZE.
+ * \param    alloc       Allocator of the index. NULL to use malloc().
+ *                       It must stay valid until the history is closed.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if inputs
+ *           are invalid; CPARSER_ERR_OUT_OF_RES if memory cannot be 
+ *           allocated; CPARSER_NOT_OK if the file cannot be opened or
+ *           is not a history file.
+ */
+cparser_result_t cparser_history_open(cparser_history_t *hist, 
+                                      const char *path, uint32_t max_entries,
+                                      const cparser_alloc_t *alloc);
+
+/**
+ * Close a history file and free its index.
+ *
+ * \param    hist Pointer to a history structure.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the 
+ *           history is not open.
+ */
+cparser_result_t cparser_history_close(cparser_history_t *hist);
+
+/**
+ * Index all commands appended to the history file by other sessions.
+ *
+ * \param    hist Pointer to a history structure.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the 
+ *           history is not open; CPARSER_NOT_OK if the file cannot be
+ *           mapped.
+ */
+cparser_result_t cparser_history_sync(cparser_history_t *hist);
+
+/**
+ * Append a command to the history. Trailing spaces are ignored. Empty
+ * commands and a command that is identical to the newest entry are
+ * not added.
+ *
+ * \param    hist Pointer to a history structure.
+ * \param    cmd  Pointer to the command string.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if inputs 
+ *           are invalid; CPARSER_NOT_OK if the file cannot be written.
+ */
+cparser_result_t cparser_history_add(cparser_history_t *hist, const char *cmd);
+
+/**
+ * Return the command string of an entry. The string is in the file
+ * mapping and is only valid until the next call that changes the history.
+ *
+ * \param    hist Pointer to a history structure.
+ * \param    id   Entry id.
+ *
+ * \return   Pointer to the command string; NULL if the entry does not
+ *           exist.
+ */
+const char *cparser_history_get(const cparser_history_t *hist, uint32_t id);
+
+/**
+ * Find the entry right before an entry.
+ *
+ * \param    hist Pointer to a history structure.
+ * \param    id   Entry id. CPARSER_HISTORY_NONE to get the newest entry.
+ *
+ * \retval   prev Id of the previous entry.
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_NOT_EXIST if 'id' is
+ *           the oldest entry.
+ */
+cparser_result_t cparser_history_prev(const cparser_history_t *hist,
+                                      uint32_t id, uint32_t *prev);
+
+/**
+ * Find the entry right after an entry.
+ *
+ * \param    hist Pointer to a history structure.
+ * \param    id   Entry id. CPARSER_HISTORY_NONE to get the oldest entry.
+ *
+ * \retval   next Id of the next entry.
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_NOT_EXIST if 'id' is
+ *           the newest entry.
+ */
+cparser_result_t cparser_history_next(const cparser_history_t *hist,
+                                      uint32_t id, uint32_t *next);
+
+/**
+ * Find the newest entry older than an entry that contains a string.
+ *
+ * \param    hist   Pointer to a history structure.
+ * \param    str    Pointer to the search string.
+ * \param    before Entry id to start the search from (exclusive). 
+ *                  CPARSER_HISTORY_NONE to search the whole history.
+ *
+ * \retval   id     Id of the matching entry.
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if inputs
+ *           are invalid; CPARSER_ERR_NOT_EXIST if there is no match.
+ */
+cparser_result_t cparser_history_search(const cparser_history_t *hist,
+                                        const char *str, uint32_t before,
+                                        uint32_t *id);
+
+#endif /* __CPARSER_HISTORY_H__ */
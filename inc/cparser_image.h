@@ -0,0 +1,319 @@
+/**
+ * \file     cparser_image.h
+ * \brief    Parse tree handle: binary images, run-time commands and 
+ *           versions.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPARSER_IMAGE_H__
+#define __CPARSER_IMAGE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cparser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define CPARSER_TREE_MAGIC       "CPARSERT"
+#define CPARSER_TREE_VERSION     3
+/** Value of 'byte_order' as written by a host of the same byte order */
+#define CPARSER_TREE_BYTE_ORDER  0x0102
+
+/**
+ * \struct   cparser_tree_hdr_t
+ * \brief    Header of a binary parse tree image written by mk_parser.py.
+ * \details  The header is followed by the nodes, the list nodes and a
+ *           pool of NUL-terminated strings. Nodes are laid out like 
+ *           cparser_node_t but every pointer is an offset relative to 
+ *           the node. See CPARSER_NODE_FLAGS_IMAGE in cparser_priv.h.
+ */
+typedef struct cparser_tree_hdr_ {
+    char      magic[8];     /**< CPARSER_TREE_MAGIC */
+    uint32_t  version;      /**< CPARSER_TREE_VERSION */
+    uint16_t  byte_order;   /**< CPARSER_TREE_BYTE_ORDER */
+    uint8_t   ptr_size;     /**< sizeof(void *) */
+    uint8_t   node_size;    /**< sizeof(cparser_node_t) */
+    uint32_t  size;         /**< Size of the image including the header */
+    uint32_t  root;         /**< Offset of the root node */
+    uint32_t  num_cmds;     /**< Number of command IDs */
+    uint32_t  checksum;     /**< FNV-1a hash of all bytes after the header */
+} cparser_tree_hdr_t;
+
+/**
+ * \struct   cparser_tree_t
+ * \brief    A parse tree.
+ * \details  A tree is either an image opened by cparser_tree_open(),
+ *           a packed tree generated by "mk_parser.py -p" as cparser_tree,
+ *           or a tree built at run time by cparser_tree_init(). To use a 
+ *           generated C tree as the base of a run-time tree, set 'root'
+ *           to &cparser_root, 'glue' to cparser_glue_tbl and 'num_cmds'
+ *           to CPARSER_NUM_GLUE.
+ */
+struct cparser_tree_ {
+    cparser_node_t         *root;     /**< Root node of the tree */
+    /** Glue functions indexed by the command ID of END nodes */
+    const cparser_glue_fn  *glue;
+    uint32_t               num_cmds;  /**< Number of entries in 'glue' */
+
+    /********** Packed tree **********/
+    /** 
+     * Offsets of the descriptions in 'descs' indexed by node. The root
+     * is node 0. An offset of 0 means no description.
+     */
+    const uint32_t         *desc_idx;
+    const char             *descs;    /**< Pool of descriptions */
+
+    /********** Binary image **********/
+    void                   *map;      /**< Mapped image */
+    size_t                 map_size;  /**< Size of the mapping */
+
+    /********** Run-time tree **********/
+    const cparser_alloc_t  *alloc;    /**< Allocator of the nodes */
+    /** Hash table of nodes keyed by parent node and token */
+    struct cparser_dnode_  **buckets;
+    uint32_t               num_buckets; /**< A power of 2 */
+    uint32_t               num_nodes;   /**< Number of nodes in the table */
+    /** Changed whenever a command is added or removed */
+    uint32_t               gen;
+};
+
+/**
+ * \brief    Free a tree that no parser uses anymore.
+ * \details  It is called in the thread of the last parser that moves off
+ *           the tree, or in the thread that publishes the next tree.
+ *
+ * \param    tree Pointer to the tree given to cparser_tree_publish().
+ */
+typedef void (*cparser_tree_free_fn)(cparser_tree_t *tree);
+
+/**
+ * \struct   cparser_tree_ver_t
+ * \brief    A version of the tree published in a tree handle.
+ */
+struct cparser_tree_ver_ {
+    cparser_tree_t        *tree;
+    cparser_tree_free_fn  free_fn;  /**< NULL if the tree is not freed */
+    uint32_t              epoch;    /**< Number of the version */
+    uint32_t              readers;  /**< Number of parsers using it */
+    cparser_tree_ver_t    *next;    /**< Next older version in use */
+};
+
+/**
+ * \struct   cparser_tree_handle_t
+ * \brief    Versions of a parse tree shared by parsers.
+ * \details  A published tree is never changed. A parser takes the newest
+ *           version when its FSM is reset at the top level, i.e. after a
+ *           command is entered or when a new line is started. A line 
+ *           in progress, and every line of a submode, finishes with the
+ *           version it started with. A version replaced by a newer one 
+ *           is freed when no parser uses it anymore.
+ *
+ *           Parsers in different threads may share a handle and a tree
+ *           may be published from any thread. Parsers take a version 
+ *           without locking. A replaced version is freed only when it
+ *           has no reader and no parser is in the middle of taking a 
+ *           version.
+ */
+struct cparser_tree_handle_ {
+    cparser_tree_ver_t     *cur;    /**< Newest version */
+    /** Replaced versions that are still in use. Newest first. */
+    cparser_tree_ver_t     *old;
+    const cparser_alloc_t  *alloc;  /**< Allocator of the versions */
+    uint32_t               epoch;   /**< Number of the newest version */
+    /** Number of parsers between reading 'cur' and counting as its reader */
+    uint32_t               entering;
+    char                   lock;    /**< Lock of 'old' and of publishing */
+};
+
+/**
+ * \brief    Open a binary parse tree image.
+ * \details  The image is mapped read-only and used in place. It is 
+ *           checked against its header and checksum before use, and
+ *           its nodes are walked once to check that every offset stays
+ *           in the image and every command ID is below 'num_glue'.
+ *
+ * \param    tree     Pointer to the tree to be opened.
+ * \param    path     Path of the image generated by "mk_parser.py -b".
+ * \param    glue     cparser_glue_tbl generated with the image.
+ * \param    num_glue CPARSER_NUM_GLUE generated with the image.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if any
+ *           parameter is invalid; CPARSER_ERR_NOT_EXIST if the image 
+ *           cannot be opened; CPARSER_ERR_PARSE_ERR if the image is
+ *           corrupted or does not match this host or 'glue'; 
+ *           CPARSER_ERR_OUT_OF_RES if it cannot be mapped or walked.
+ */
+cparser_result_t cparser_tree_open(cparser_tree_t *tree, const char *path,
+                                   const cparser_glue_fn *glue,
+                                   uint32_t num_glue);
+
+/**
+ * \brief    Close a binary parse tree image.
+ * \details  No parser may still use the tree.
+ *
+ * \param    tree Pointer to the tree.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the 
+ *           tree is not open.
+ */
+cparser_result_t cparser_tree_close(cparser_tree_t *tree);
+
+/**
+ * \brief    Initialize a tree for commands added at run time.
+ * \details  The nodes of 'base' are copied with their strings, so 
+ *           'base' can be closed or freed afterward. If 'base' is 
+ *           itself initialized by cparser_tree_init(), the copy is a
+ *           clone and the commands added to 'base' can be removed from
+ *           it. Other commands of 'base' cannot be removed.
+ *
+ * \param    tree  Pointer to the tree to be initialized.
+ * \param    base  A tree whose commands are included. NULL to start with
+ *                 an empty tree.
+ * \param    alloc Allocator of the nodes. NULL to use malloc().
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if any
+ *           parameter is invalid; CPARSER_ERR_OUT_OF_RES if there is not
+ *           enough memory.
+ */
+cparser_result_t cparser_tree_init(cparser_tree_t *tree, 
+                                   const cparser_tree_t *base,
+                                   const cparser_alloc_t *alloc);
+
+/**
+ * \brief    Free all nodes of a tree initialized by cparser_tree_init().
+ *
+ * \param    tree Pointer to the tree.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the
+ *           tree is not initialized by cparser_tree_init().
+ */
+cparser_result_t cparser_tree_fini(cparser_tree_t *tree);
+
+/**
+ * \brief    Add a command to a tree.
+ * \details  The command has the same syntax as a line of a .cli file, 
+ *           including optional parameters and the leading '+' of hidden
+ *           commands. Nodes of a common prefix are shared with other 
+ *           commands. Commands are added to the top level. No parser
+ *           may be in the middle of a line of the tree. To change the 
+ *           tree of running parsers, change a clone and publish it with
+ *           cparser_tree_publish().
+ *
+ *           The glue function gets the parameters from the token stack 
+ *           of the parser with cparser_get_*(). Token 'n' of the command
+ *           is parser->tokens[n].
+ *
+ * \param    tree Pointer to the tree.
+ * \param    cmd  Command, e.g. "show bgp neighbor <IPV4ADDR:peer>".
+ * \param    fn   Glue function called when the command is entered.
+ * \param    desc Description shown by cparser_help_cmd(). May be NULL.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if any
+ *           parameter is invalid; CPARSER_ERR_PARSE_ERR if the command
+ *           is malformed; CPARSER_NOT_OK if the command already exists;
+ *           CPARSER_ERR_OUT_OF_RES if there is not enough memory.
+ */
+cparser_result_t cparser_tree_add(cparser_tree_t *tree, const char *cmd,
+                                  cparser_glue_fn fn, const char *desc);
+
+/**
+ * \brief    Remove a command added by cparser_tree_add().
+ * \details  Nodes that are not used by any other command are freed. No
+ *           parser may be in the middle of a line of the tree. See 
+ *           cparser_tree_add().
+ *
+ * \param    tree Pointer to the tree.
+ * \param    cmd  The command string given to cparser_tree_add().
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if any
+ *           parameter is invalid; CPARSER_ERR_PARSE_ERR if the command
+ *           is malformed; CPARSER_ERR_NOT_EXIST if the command is not 
+ *           added by cparser_tree_add().
+ */
+cparser_result_t cparser_tree_remove(cparser_tree_t *tree, const char *cmd);
+
+/**
+ * \brief    Initialize a tree handle with its first version.
+ *
+ * \param    handle  Pointer to the handle to be initialized.
+ * \param    tree    The first version of the tree.
+ * \param    free_fn Function to free 'tree' when it is no longer used.
+ *                   NULL if it is freed by the caller.
+ * \param    alloc   Allocator of the versions. NULL to use malloc(). It
+ *                   must be thread-safe if parsers in different threads 
+ *                   share the handle.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if any
+ *           parameter is invalid; CPARSER_ERR_OUT_OF_RES if there is not
+ *           enough memory.
+ */
+cparser_result_t cparser_tree_handle_init(cparser_tree_handle_t *handle,
+                                          cparser_tree_t *tree,
+                                          cparser_tree_free_fn free_fn,
+                                          const cparser_alloc_t *alloc);
+
+/**
+ * \brief    Free the tree handle and its current version.
+ *
+ * \param    handle Pointer to the handle.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the 
+ *           handle is not initialized; CPARSER_NOT_OK if a parser still
+ *           uses it.
+ */
+cparser_result_t cparser_tree_handle_fini(cparser_tree_handle_t *handle);
+
+/**
+ * \brief    Publish a new version of the tree.
+ * \details  Parsers take it at their next command. The current version
+ *           is freed now if no parser uses it, or else when the last 
+ *           parser moves off it. A parser that uses the new version 
+ *           rejects the line snapshots saved with older versions.
+ *
+ * \param    handle  Pointer to the handle.
+ * \param    tree    The new version of the tree. It must not be changed
+ *                   afterward.
+ * \param    free_fn Function to free 'tree' when it is no longer used.
+ *                   NULL if it is freed by the caller.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if any
+ *           parameter is invalid; CPARSER_ERR_OUT_OF_RES if there is not
+ *           enough memory.
+ */
+cparser_result_t cparser_tree_publish(cparser_tree_handle_t *handle,
+                                      cparser_tree_t *tree,
+                                      cparser_tree_free_fn free_fn);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __CPARSER_IMAGE_H__ */
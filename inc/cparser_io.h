@@ -49,6 +49,7 @@ typedef enum {
     CPARSER_CHAR_RIGHT_ARROW, /**< Right arrow (next character in the command) */
     CPARSER_CHAR_FIRST,       /**< Go to the first character in the command */
     CPARSER_CHAR_LAST,        /**< Go to the first character in the command */
+    CPARSER_CHAR_SEARCH,      /**< Reverse incremental search of the history */
     CPARSER_MAX_CHAR
 } cparser_char_t;
 
@@ -87,7 +88,8 @@ typedef void (*cparser_getch_fn)(cparser_t *parser, int *ch,
                                  cparser_char_t *type);
 
 /**
- * Print a single character to the output file descriptor.
+ * Print a single character to the output file descriptor. Nothing should
+ * be printed while the 'quiet' field of the parser is set.
  *
  * \param   parser Pointer to the parser structure.
  * \param   ch     Character to be printed.
@@ -95,7 +97,8 @@ typedef void (*cparser_getch_fn)(cparser_t *parser, int *ch,
 typedef void (*cparser_printc_fn)(const cparser_t *parser, const char ch);
 
 /**
- * Print a character string to the output file descriptor.
+ * Print a character string to the output file descriptor. Nothing should
+ * be printed while the 'quiet' field of the parser is set.
  *
  * \param   parser Pointer to the parser structure.
  * \param   s      Pointer to the string to be printed.
@@ -35,16 +35,62 @@
 
 #include "cparser_options.h"
 
+/**
+ * \struct   cparser_line_fsm_t
+ * \brief    A snapshot of the parser FSM at the cursor of a line.
+ * \details  It allows a line to be recalled without entering its characters
+ *           into the parser FSM again. Token strings are not saved because 
+ *           they are in the line. The snapshot is only valid in the mode 
+ *           where it is taken.
+ *
+ *           The state after each token boundary can be derived from the
+ *           snapshot. When the line is edited before the snapshot position,
+ *           token positions are updated. When the parser FSM reaches a 
+ *           token boundary past the edit with the same matched nodes, the 
+ *           rest of the tokens are taken from the snapshot.
+ */
+typedef struct {
+    /** Root node when the snapshot is taken. NULL if there is no snapshot. */
+    cparser_node_t  *root;
+    /** Generation of the tree when the snapshot is taken */
+    uint32_t        tree_gen;
+    /** 
+     * Characters from this position on are the same as when the snapshot
+     * is taken. -1 if the line is not changed.
+     */
+    short           edit_end;
+    short           current_pos;  /**< Cursor position of the parser FSM */
+    short           last_good;    /**< Last position in a non-error state */
+    short           token_tos;    /**< Token stack top pointer */
+    char            state;        /**< Parser FSM state */
+    /** Privileged mode (1) or not (0) */
+    char            is_privileged_mode;
+    /** Index (in the line) of the beginning of each token */
+    short           *begin_ptr;
+    /** Number of characters in each token */
+    short           *token_len;
+    /** Node that matches each token */
+    cparser_node_t  **node;
+} cparser_line_fsm_t;
+
 /**
  * \struct   cparser_line_t
  * \brief    A parser line structure.
  * \details  A parser line represents a line of user input in the parser.
+ *           The buffer is a gap buffer. Characters before the cursor
+ *           are at the beginning of 'buf' and characters after the cursor
+ *           are at the end of it. Inserting or deleting at the cursor
+ *           does not move any other character. After the line is entered,
+ *           the gap is closed and 'buf' holds a NULL-terminated string.
  */
 typedef struct {
-    short  last;      /**< Point to the last character in the line buffer. */
-    short  current;   /**< Point to the current character. */
-    /** Buffer that holds the user input characters. */
-    char   buf[CPARSER_MAX_LINE_SIZE+1];
+    short  size;      /**< Maximum number of characters in the line. */
+    short  last;      /**< Number of characters in the line. */
+    short  current;   /**< Current cursor position (beginning of the gap). */
+    /** Parser FSM state of the line when it was last entered or left. */
+    cparser_line_fsm_t fsm;
+    /** Buffer that holds the user input characters. 'size' + 2 bytes. */
+    char   *buf;
 } cparser_line_t;
 
 /**
@@ -57,6 +103,18 @@ typedef struct {
  */ 
 cparser_result_t cparser_line_reset(cparser_line_t *line);
 
+/**
+ * Close the gap of a line buffer so that the line is stored as a 
+ * NULL-terminated string at the beginning of the buffer. The current 
+ * position is moved to the end of the line.
+ *
+ * \param    line Pointer to a line structure.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the line 
+ *           is NULL.
+ */ 
+cparser_result_t cparser_line_compact(cparser_line_t *line);
+
 /**
  * Insert a character into a line buffer at the current position.
  *
@@ -119,6 +177,81 @@ cparser_result_t cparser_line_next_line(cparser_t *parser);
  */
 cparser_result_t cparser_line_prev_line(cparser_t *parser);
 
+/**
+ * Save the parser FSM state in the current line. Nothing is saved if 
+ * the parser FSM is not fed by the line, e.g. by cparser_load_cmd().
+ *
+ * \param    parser Pointer to the parser structure.
+ *
+ * \return   None. Crash on failure.
+ */
+void cparser_line_save_state(cparser_t *parser);
+
+/**
+ * Restore the parser FSM state saved in the current line.
+ *
+ * \param    parser Pointer to the parser structure.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if inputs
+ *           are invalid; CPARSER_ERR_NOT_EXIST if the line has no saved
+ *           state that is valid in the current mode. In that case, the
+ *           line must be entered into the parser FSM again.
+ */
+cparser_result_t cparser_line_load_state(cparser_t *parser);
+
+/**
+ * Move the cursor forward to the position of the parser FSM state saved
+ * in the current line if the rest of the tokens up to that position can 
+ * be restored from it. This is possible if the parser FSM is at a token
+ * boundary after the last edit and the last token matches the same node
+ * as in the saved state.
+ *
+ * \param    parser Pointer to the parser structure.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if inputs
+ *           are invalid; CPARSER_ERR_NOT_EXIST if the parser FSM cannot 
+ *           resume from the saved state.
+ */
+cparser_result_t cparser_line_fast_forward(cparser_t *parser);
+
+/**
+ * Start a reverse incremental search of the command history.
+ *
+ * \param    parser Pointer to the parser structure.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if inputs
+ *           are invalid; CPARSER_ERR_NOT_EXIST if the parser has no
+ *           command history.
+ */
+cparser_result_t cparser_line_search_start(cparser_t *parser);
+
+/**
+ * Update the search string of a reverse incremental search and display
+ * the newest match.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    ch     Character to be added to the search string. The erase
+ *                  and delete characters remove the last character. NULL
+ *                  looks for an older match of the same string.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if no
+ *           search is in progress; CPARSER_ERR_NOT_EXIST if there is no
+ *           match; CPARSER_ERR_OUT_OF_RES if the search string is full.
+ */
+cparser_result_t cparser_line_search_input(cparser_t *parser, char ch);
+
+/**
+ * End a reverse incremental search.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    accept 1 to load the current match into the current line; 
+ *                  0 to keep the current line.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if no
+ *           search is in progress.
+ */
+cparser_result_t cparser_line_search_stop(cparser_t *parser, int accept);
+
 /**
  * Print the current line including the current line.
  *
@@ -40,33 +40,77 @@
 #define CPARSER_MAX_PROMPT         (16)
 
 /**
- * Maximum number of nested sub-mode levels.
+ * Default maximum number of nested sub-mode levels. See 
+ * 'max_nested_levels' in cparser_cfg_t.
  */
 #define CPARSER_MAX_NESTED_LEVELS  (4)
 
 /**
- * Maximum number of characters in one token.
+ * Default maximum number of characters in one token. See 'max_token_size'
+ * in cparser_cfg_t.
  */
 #define CPARSER_MAX_TOKEN_SIZE     (256)
 
 /**
- * Maximum number of token per line.
+ * Default maximum number of token per line. See 'max_num_tokens' in 
+ * cparser_cfg_t.
  */
 #define CPARSER_MAX_NUM_TOKENS     (32)
 
 /**
- * Maximum number of lines.
+ * Default maximum number of lines. See 'max_lines' in cparser_cfg_t.
  */
 #define CPARSER_MAX_LINES          (10)
 
 /**
- * Maximum number of character per line.
+ * Default maximum number of character per line. See 'max_line_size' in
+ * cparser_cfg_t.
  */
 #define CPARSER_MAX_LINE_SIZE      (383)
 
+/**
+ * Default maximum number of input characters queued while a command
+ * is pending. See 'max_queue_size' in cparser_cfg_t.
+ */
+#define CPARSER_MAX_QUEUE_SIZE     (1024)
+
+/**
+ * Default stack size of a coroutine in bytes. See cparser_coro_init().
+ */
+#define CPARSER_CORO_STACK_SIZE    (64 * 1024)
+
+/**
+ * Maximum number of output filters after a command, e.g. 
+ * "show log | include error | count". See CPARSER_FLAGS_FILTER.
+ */
+#define CPARSER_MAX_FILTERS        (4)
+
+/**
+ * Number of characters of an output line that are kept for output 
+ * filters. A longer line is filtered by its beginning.
+ */
+#define CPARSER_FILTER_LINE_SIZE   (512)
+
+/**
+ * Default maximum number of commands kept in a history file.
+ */
+#define CPARSER_HISTORY_SIZE       (100000)
+
+/**
+ * Size of the buffer of the path of a history file.
+ */
+#define CPARSER_HISTORY_PATH_LEN   (256)
+
 /**
  * If defined, support some of Emacs key binding.
  */
 #define CPARSER_EMACS_BINDING
 
+/**
+ * If defined, the terminal is assumed to understand ANSI (VT100) cursor
+ * sequences. Line editing then redraws only the characters that change.
+ * Otherwise, the rest of the line is reprinted after every edit.
+ */
+#define CPARSER_ANSI_TERMINAL
+
 #endif /* __CPARSER_OPTIONS_H__ */
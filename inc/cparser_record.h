@@ -0,0 +1,253 @@
+/**
+ * \file     cparser_record.h
+ * \brief    Recording and replaying of command sessions.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPARSER_RECORD_H__
+#define __CPARSER_RECORD_H__
+
+#include <pthread.h>
+#include <stdio.h>
+#include "cparser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Default size of the write buffer of a recorder */
+#define CPARSER_RECORD_BUF_SIZE    (4096)
+
+/**
+ * Number of latency buckets. Latencies below 8 usec have one bucket 
+ * each. Every power of two above is split into 8 buckets, so a bucket
+ * is at most 12.5% wide.
+ */
+#define CPARSER_REPLAY_NUM_BUCKETS (8 + (61 * 8))
+
+/**
+ * \struct   cparser_record_t
+ * \brief    A recorder of a session.
+ * \details  The log file starts with a 16-byte header: "CPRL", a 
+ *           version byte, 3 zero bytes and the time the recorder was
+ *           opened in microseconds since the epoch (64-bit, network 
+ *           byte order). Each command is a record of:
+ *
+ *           - microseconds since the previous record (or the header)
+ *             as a varint (7 bits per byte, the lowest bits first),
+ *           - the result of the command (1 byte),
+ *           - the sub-mode level after the command (1 byte),
+ *           - the length of the command line as a varint,
+ *           - the command line without the newline.
+ *
+ *           The time of a command is when its action returned, or 
+ *           went pending. Empty lines are not recorded, nor are 
+ *           lines longer than the buffer. A recorder records one 
+ *           parser.
+ */
+typedef struct cparser_record_ {
+    int                    fd;          /**< File descriptor of the log */
+    char                   *buf;        /**< Records not yet written */
+    size_t                 len;         /**< Number of bytes in 'buf' */
+    size_t                 size;        /**< Size of 'buf' */
+    uint32_t               count;       /**< Number of records in 'buf' */
+    uint64_t               last;        /**< Time of the last record */
+    uint64_t               pending;     /**< Time of the pending command */
+    uint64_t               num_records; /**< Number of records logged */
+    uint64_t               num_dropped; /**< Records that failed to write */
+    const cparser_alloc_t  *alloc;      /**< Allocator of 'buf' */
+} cparser_record_t;
+
+/**
+ * \brief    Open a log file and write its header.
+ * \details  The file is truncated if it exists.
+ *
+ * \param    rec      Pointer to a recorder.
+ * \param    path     Path of the log file.
+ * \param    buf_size Size of the write buffer. 0 to use 
+ *                    CPARSER_RECORD_BUF_SIZE.
+ * \param    alloc    Allocator of the buffer. NULL to use malloc().
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the
+ *           input parameters are invalid; CPARSER_ERR_OUT_OF_RES if 
+ *           the buffer cannot be allocated; CPARSER_NOT_OK if the file 
+ *           cannot be written.
+ */
+cparser_result_t cparser_record_open(cparser_record_t *rec, 
+                                     const char *path, size_t buf_size,
+                                     const cparser_alloc_t *alloc);
+
+/**
+ * \brief    Write the buffered records into the log file.
+ *
+ * \param    rec Pointer to a recorder.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the
+ *           recorder is not open; CPARSER_NOT_OK if the file cannot be
+ *           written. The records are dropped in that case.
+ */
+cparser_result_t cparser_record_flush(cparser_record_t *rec);
+
+/**
+ * \brief    Flush and close a log file.
+ *
+ * \param    rec Pointer to a recorder.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the
+ *           recorder is not open; CPARSER_NOT_OK if the file cannot be
+ *           written.
+ */
+cparser_result_t cparser_record_close(cparser_record_t *rec);
+
+/**
+ * \brief    Recorder function of a parser (cparser_record_fn).
+ * \details  'record_cookie' of the parser must point to an open
+ *           recorder.
+ *
+ * \param    parser Pointer to the parser.
+ */
+void cparser_record_hook(cparser_t *parser);
+
+/**
+ * \brief    Wait for the pending command of a parser.
+ * \details  It is called while a replayed command is pending, e.g. to
+ *           wait for the notification of an executor and call 
+ *           cparser_exec_poll().
+ *
+ * \param    parser Pointer to the parser.
+ * \param    cookie The cookie given to cparser_replay().
+ *
+ * \return   CPARSER_OK to keep waiting; any other value to stop the 
+ *           session.
+ */
+typedef cparser_result_t (*cparser_replay_wait_fn)(cparser_t *parser,
+                                                   void *cookie);
+
+/**
+ * \struct   cparser_replay_stats_t
+ * \brief    Results of a replay.
+ */
+typedef struct cparser_replay_stats_ {
+    uint64_t  num_cmds;      /**< Number of commands replayed */
+    /** Number of commands whose result differs from the log */
+    uint64_t  num_rc_diverged;
+    /** Number of commands whose sub-mode level differs from the log */
+    uint64_t  num_level_diverged;
+    uint64_t  usec;          /**< Time from the start to the last end */
+    uint64_t  total_usec;    /**< Sum of the latencies */
+    uint64_t  max_usec;      /**< Highest latency */
+    /** Number of commands in each latency bucket */
+    uint64_t  buckets[CPARSER_REPLAY_NUM_BUCKETS];
+} cparser_replay_stats_t;
+
+/**
+ * \struct   cparser_replay_session_t
+ * \brief    A log to replay and the parser to replay it on.
+ */
+typedef struct cparser_replay_session_ {
+    cparser_t               *parser; /**< An initialized parser */
+    const char              *path;   /**< Path of the log file */
+    cparser_result_t        rc;      /**< Result of the session */
+    cparser_replay_stats_t  stats;   /**< Results of this session */
+    /* Used by cparser_replay() */
+    pthread_t               thread;
+    cparser_cfg_t           cfg;     /**< Configuration before replay */
+    char                    *log;    /**< The log file */
+    size_t                  log_size;
+    uint64_t                start;   /**< Recording time of the log */
+    uint64_t                base;    /**< Replay time of 'start' */
+    double                  speed;
+    int                     done;    /**< 1 if the command has completed */
+    cparser_result_t        cmd_rc;  /**< Result of the command */
+    cparser_replay_wait_fn  wait;
+    void                    *cookie;
+} cparser_replay_session_t;
+
+/**
+ * \brief    Replay logs.
+ * \details  Each session runs in its own thread. Its command lines are
+ *           fed into its parser with help and completion disabled and
+ *           prompts suppressed. The latency of a command is from the 
+ *           first character until its action returns or its pending 
+ *           action completes. The sessions start together. With a 
+ *           positive 'speed', a command starts when its recording time
+ *           divided by 'speed' has passed since the start of the 
+ *           earliest log; commands run late if the parser falls 
+ *           behind. With 'speed' 0, the commands run back to back.
+ *
+ *           A parser must not be used by anything else during the 
+ *           replay and its configuration is restored afterwards.
+ *
+ * \param    sessions     The sessions. A log can be used by more than 
+ *                        one session.
+ * \param    num_sessions Number of sessions.
+ * \param    speed        Speed relative to the recording. 0 to run as 
+ *                        fast as possible.
+ * \param    wait         Function called while a command is pending. 
+ *                        NULL if no action goes pending.
+ * \param    cookie       Cookie passed to 'wait'.
+ *
+ * \retval   stats        Results of all sessions.
+ * \return   CPARSER_OK if all sessions succeeded; 
+ *           CPARSER_ERR_INVALID_PARAMS if the input parameters are 
+ *           invalid; CPARSER_NOT_OK if a log cannot be read or is not 
+ *           a log, or a session stopped. The 'rc' of the sessions tells
+ *           which.
+ */
+cparser_result_t cparser_replay(cparser_replay_session_t *sessions,
+                                int num_sessions, double speed,
+                                cparser_replay_wait_fn wait, void *cookie,
+                                cparser_replay_stats_t *stats);
+
+/**
+ * \brief    Get a latency percentile of a replay.
+ *
+ * \param    stats   Results of a replay.
+ * \param    percent Percentile between 0 and 100.
+ *
+ * \return   Upper bound of the latency bucket of the percentile in 
+ *           microseconds. 0 if no command was replayed.
+ */
+uint64_t cparser_replay_percentile(const cparser_replay_stats_t *stats,
+                                   double percent);
+
+/**
+ * \brief    Print a summary of a replay: throughput, latency
+ *           percentiles and divergence.
+ *
+ * \param    stats Results of a replay.
+ * \param    fp    Output stream.
+ */
+void cparser_replay_report(const cparser_replay_stats_t *stats, FILE *fp);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __CPARSER_RECORD_H__ */
@@ -0,0 +1,169 @@
+/**
+ * \file     cparser_ring.h
+ * \brief    Bounded output buffers of sessions.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPARSER_RING_H__
+#define __CPARSER_RING_H__
+
+#include <pthread.h>
+#include "cparser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Marker put in the output where output is dropped */
+#define CPARSER_RING_MARKER        "\n... output dropped ...\n"
+
+/** Default of 'block_msec' of cparser_ring_t */
+#define CPARSER_RING_BLOCK_MSEC    (2000)
+
+/**
+ * \brief    What to do with output that does not fit in a ring.
+ */
+typedef enum cparser_ring_policy_ {
+    /**
+     * Wait until the ring is drained. An action in another thread (e.g.
+     * a job of an executor) waits. In the thread that drains the ring, 
+     * the ring is written to the file descriptor until there is room.
+     * A session that has no room for 'block_msec' of cparser_ring_t is
+     * disconnected, so a client that stops reading cannot hold the 
+     * thread.
+     */
+    CPARSER_RING_BLOCK = 0,
+    /** Drop the output. CPARSER_RING_MARKER is put in its place. */
+    CPARSER_RING_DROP,
+    /** Drop all output from now on and disconnect the session */
+    CPARSER_RING_DISCONNECT,
+    CPARSER_RING_MAX_POLICIES
+} cparser_ring_policy_t;
+
+/**
+ * \struct   cparser_ring_t
+ * \brief    A bounded output buffer of a session.
+ * \details  The output functions of a parser configured with 
+ *           cparser_ring_config() append to the ring instead of writing 
+ *           to the file descriptor of the session, so a slow client 
+ *           cannot block the thread. The event loop calls 
+ *           cparser_ring_drain() when the file descriptor (in 
+ *           non-blocking mode) is writable and cparser_ring_pending() 
+ *           is not 0. The ring is drained by the thread that 
+ *           initialized it. Actions in any thread can append to it.
+ */
+typedef struct cparser_ring_ {
+    const cparser_alloc_t  *alloc;     /**< Allocator of the buffer */
+    char                   *buf;       /**< The buffer */
+    size_t                 size;       /**< Size of the buffer */
+    int                    fd;         /**< File descriptor of the session */
+    cparser_ring_policy_t  policy;     /**< Policy when the ring is full */
+    pthread_t              owner;      /**< Thread that drains the ring */
+    /** 
+     * Longest wait for room in milliseconds with CPARSER_RING_BLOCK. 
+     * CPARSER_RING_BLOCK_MSEC after cparser_ring_init().
+     */
+    int                    block_msec;
+    pthread_mutex_t        lock;       /**< Lock of the fields below */
+    pthread_cond_t         cond;       /**< Signaled when there is room */
+    size_t                 head;       /**< Index of the oldest byte */
+    size_t                 len;        /**< Number of bytes in the ring */
+    int                    dropping;   /**< 1 if the marker is in the ring */
+    /** 1 if the session must be disconnected */
+    int                    disconnected;
+    uint64_t               num_dropped; /**< Number of bytes dropped */
+} cparser_ring_t;
+
+/**
+ * \brief    Initialize a ring.
+ *
+ * \param    ring   Pointer to the ring.
+ * \param    fd     File descriptor of the session. It should be in 
+ *                  non-blocking mode.
+ * \param    size   Size of the ring in bytes.
+ * \param    policy What to do when the ring is full.
+ * \param    alloc  Allocator of the buffer. NULL to use malloc().
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the 
+ *           input parameters are invalid; CPARSER_ERR_OUT_OF_RES if the 
+ *           buffer cannot be allocated.
+ */
+cparser_result_t cparser_ring_init(cparser_ring_t *ring, int fd, size_t size,
+                                   cparser_ring_policy_t policy,
+                                   const cparser_alloc_t *alloc);
+
+/**
+ * \brief    Free a ring. The output left in it is discarded.
+ *
+ * \param    ring Pointer to the ring.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the 
+ *           input parameters are invalid.
+ */
+cparser_result_t cparser_ring_fini(cparser_ring_t *ring);
+
+/**
+ * \brief    Send the output of a parser to a ring.
+ * \details  It is called after cparser_init(). It sets the output 
+ *           functions and CPARSER_FLAGS_MT_OUTPUT of the parser.
+ *
+ * \param    parser Pointer to the parser.
+ * \param    ring   Pointer to the ring.
+ */
+void cparser_ring_config(cparser_t *parser, cparser_ring_t *ring);
+
+/**
+ * \brief    Write the output in a ring to its file descriptor.
+ * \details  The output is written with writev() until the ring is 
+ *           empty or the file descriptor would block.
+ *
+ * \param    ring Pointer to the ring.
+ *
+ * \return   CPARSER_OK if the ring is empty; CPARSER_PENDING if some 
+ *           output is left; CPARSER_NOT_OK if the session must be 
+ *           disconnected (a write error or CPARSER_RING_DISCONNECT); 
+ *           CPARSER_ERR_INVALID_PARAMS if the input parameters are 
+ *           invalid.
+ */
+cparser_result_t cparser_ring_drain(cparser_ring_t *ring);
+
+/**
+ * \brief    Get the number of bytes waiting in a ring.
+ *
+ * \param    ring Pointer to the ring.
+ *
+ * \return   Number of bytes.
+ */
+size_t cparser_ring_pending(cparser_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __CPARSER_RING_H__ */
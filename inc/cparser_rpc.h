@@ -0,0 +1,190 @@
+/**
+ * \file     cparser_rpc.h
+ * \brief    Bounded output buffers of sessions.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPARSER_RPC_H__
+#define __CPARSER_RPC_H__
+
+#include "cparser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Maximum number of characters of the id of a JSON request */
+#define CPARSER_RPC_MAX_ID         (64)
+
+/**
+ * \brief    Formats of requests and responses.
+ */
+typedef enum cparser_rpc_format_ {
+    /**
+     * One JSON object per line. A request is 
+     * {"id": <id>, "cmd": "<command line>"}. The id can be a number or
+     * a string and is returned as it is. A response is 
+     * {"id": <id>, "output": "<output>", "rc": <result>, "usec": <time>}.
+     */
+    CPARSER_RPC_JSON = 0,
+    /**
+     * Frames that start with a 32-bit length of the rest of the frame.
+     * A request has a 32-bit id and the command line. A response has 
+     * the id, a 32-bit result, a 32-bit time in microseconds and the 
+     * output. All integers are in network byte order.
+     */
+    CPARSER_RPC_FRAMED,
+    CPARSER_RPC_MAX_FORMATS
+} cparser_rpc_format_t;
+
+/**
+ * \brief    Send a response to the client.
+ *
+ * \param    buf    The response.
+ * \param    len    Number of bytes.
+ * \param    cookie The cookie given to cparser_rpc_init().
+ */
+typedef void (*cparser_rpc_send_fn)(const char *buf, size_t len, 
+                                    void *cookie);
+
+/**
+ * \struct   cparser_rpc_t
+ * \brief    A session of an automation client.
+ * \details  Each request runs a command line on the parser of the 
+ *           session as if it was typed, but nothing is echoed and no
+ *           prompt, error pointer, bell or redraw is printed. Only the 
+ *           output of the action is captured into the response. 
+ *           Requests are pipelined. They run in order as soon as they 
+ *           are received. The requests after a pending command are 
+ *           kept until it completes.
+ */
+typedef struct cparser_rpc_ {
+    cparser_t               *parser;   /**< Parser of the session */
+    cparser_rpc_format_t    format;
+    cparser_rpc_send_fn     send;      /**< Sender of the responses */
+    void                    *cookie;   /**< Cookie of 'send' */
+    const cparser_alloc_t   *alloc;    /**< Allocator of the buffers */
+    /** Configuration of the parser before cparser_rpc_init() */
+    cparser_cfg_t           cfg;
+    char                    *in;       /**< Received bytes not yet run */
+    size_t                  in_size;   /**< Size of 'in' */
+    size_t                  in_len;    /**< Number of bytes in 'in' */
+    char                    *cmd;      /**< Command line of the request */
+    char                    id[CPARSER_RPC_MAX_ID + 1]; /**< JSON id */
+    uint32_t                frame_id;  /**< Id of a framed request */
+    char                    *out;      /**< The response being built */
+    size_t                  out_len;   /**< Number of bytes in 'out' */
+    size_t                  out_size;  /**< Size of 'out' */
+    int                     pending;   /**< 1 if the request is pending */
+    uint64_t                start;     /**< Start of the request in usec */
+    uint64_t                num_requests; /**< Number of requests run */
+} cparser_rpc_t;
+
+/**
+ * \brief    Start a session of an automation client on a parser.
+ * \details  It is called after cparser_init(). The output functions 
+ *           and the executor of the parser are wrapped, 
+ *           CPARSER_FLAGS_BATCH is set and the help and completion 
+ *           characters are disabled.
+ *
+ * \param    rpc     Pointer to the session.
+ * \param    parser  Pointer to the parser. It must not be used by 
+ *                   anything else.
+ * \param    format  Format of the requests and responses.
+ * \param    in_size Size of the buffer of received requests in bytes. 
+ *                   A request must fit in it. 
+ * \param    send    Function that sends the responses.
+ * \param    cookie  Cookie passed to 'send'.
+ * \param    alloc   Allocator of the buffers. NULL to use malloc().
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the 
+ *           input parameters are invalid; CPARSER_ERR_OUT_OF_RES if the 
+ *           buffers cannot be allocated.
+ */
+cparser_result_t cparser_rpc_init(cparser_rpc_t *rpc, cparser_t *parser,
+                                  cparser_rpc_format_t format, 
+                                  size_t in_size, cparser_rpc_send_fn send,
+                                  void *cookie, const cparser_alloc_t *alloc);
+
+/**
+ * \brief    Stop a session of an automation client.
+ * \details  The configuration of the parser is restored. Requests not
+ *           yet run are discarded.
+ *
+ * \param    rpc Pointer to the session.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_INVALID_PARAMS if the 
+ *           input parameters are invalid; CPARSER_NOT_OK if a request 
+ *           is pending.
+ */
+cparser_result_t cparser_rpc_fini(cparser_rpc_t *rpc);
+
+/**
+ * \brief    Feed bytes received from the client.
+ * \details  All complete requests are run and their responses are 
+ *           sent. An invalid JSON request gets a response with 
+ *           CPARSER_ERR_INVALID_PARAMS. A command line that is too long
+ *           gets CPARSER_ERR_OUT_OF_RES.
+ *
+ * \param    rpc  Pointer to the session.
+ * \param    data The received bytes.
+ * \param    len  Number of bytes.
+ *
+ * \retval   used Number of bytes taken. It is less than 'len' only if 
+ *                a request is pending and the buffer is full. The rest
+ *                should be fed again after cparser_rpc_poll().
+ * \return   CPARSER_OK if no request is pending; CPARSER_PENDING if a 
+ *           request is pending; CPARSER_NOT_OK if the stream is broken
+ *           (a request does not fit in the buffer) and the client 
+ *           should be disconnected; CPARSER_ERR_INVALID_PARAMS if the 
+ *           input parameters are invalid.
+ */
+cparser_result_t cparser_rpc_input(cparser_rpc_t *rpc, const char *data,
+                                   size_t len, size_t *used);
+
+/**
+ * \brief    Complete a pending request.
+ * \details  It is called after cparser_complete_async() (or 
+ *           cparser_exec_poll()) completes the command of a session. 
+ *           The response is sent and the requests kept since are run.
+ *
+ * \param    rpc Pointer to the session.
+ *
+ * \return   CPARSER_OK if no request is pending; CPARSER_PENDING if a 
+ *           request is still pending; CPARSER_NOT_OK if the stream is 
+ *           broken; CPARSER_ERR_INVALID_PARAMS if the input parameters 
+ *           are invalid.
+ */
+cparser_result_t cparser_rpc_poll(cparser_rpc_t *rpc);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __CPARSER_RPC_H__ */
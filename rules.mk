@@ -52,8 +52,10 @@ endif
 # Update compilation flags based on DEBUG
 ifeq ("$(DEBUG)", "TRUE")
   CFLAGS += $(ETCFLAGS) -Wall -g -Werror -O0
+  CXXFLAGS += $(ETCFLAGS) -std=c++17 -Wall -g -Werror -O0
 else
   CFLAGS += $(ETCFLAGS) -Wall -Werror -O2
+  CXXFLAGS += $(ETCFLAGS) -std=c++17 -Wall -Werror -O2
 endif
 
 # Add a bunch of default include path
@@ -64,8 +66,8 @@ SRC_INC += -I. -I../inc \
 	   -I$(SRC_BASE)/heap/inc \
 	   -I$(SRC_BASE)/timer/inc \
 	   -I$(SRC_BASE)/fsm/inc
-SRC_OBJ = $(patsubst %.c,$(OBJDIR)/%.o,$(SRC_FILES))
-SRC_DEP = $(patsubst %.c,$(OBJDIR)/%.d,$(SRC_FILES))
+SRC_OBJ = $(patsubst %.cc,$(OBJDIR)/%.o,$(patsubst %.c,$(OBJDIR)/%.o,$(SRC_FILES)))
+SRC_DEP = $(patsubst %.cc,$(OBJDIR)/%.d,$(patsubst %.c,$(OBJDIR)/%.d,$(SRC_FILES)))
 
 # Include the list of dependency files
 -include $(SRC_DEP)
@@ -81,6 +83,13 @@ ifneq ("$(LIBRARY)", "")
 	$(AR) rcs $(LIBDIR)/$(LIBRARY) $@
 endif
 
+# C++ sources (test programs of the C++ front end)
+$(OBJDIR)/%.o:%.cc
+	@echo "  DEP     $<..."
+	$(CXX) $(CXXFLAGS) -MM $(SRC_INC) -MF $(patsubst %.o,%.d,$@) -MT $@ $< 
+	@echo "  COMPILE $<..."
+	$(CXX) -c $(CXXFLAGS) $(SRC_INC) $< -o $@
+
 all: lib bin
 
 dir: $(OBJDIR)
@@ -0,0 +1,82 @@
+#!/usr/bin/env python
+# $Id$
+
+# Benchmark of mk_parser.py with a synthetic CLI definition.
+#
+# Usage: bench_mk_parser.py [-n <commands>] [-t <commands/s>] [-b]
+#
+# The CLI has 100,000 commands by default. They are spread over 100
+# groups and mix keywords, parameters of several types, LISTs, nested
+# optional parameters and hidden commands, each with a comment. With
+# -b, a binary parse tree image is generated instead of C structures.
+#
+# Throughput target: 5,000 commands/s, i.e. 100,000 commands in 20 s,
+# including writing the output files. The script exits with 1 if the
+# generator is slower than the target (-t).
+
+import os, sys, time, shutil, tempfile
+
+TEMPLATES = [ 'show group%d item%d { <UINT:id> { detail } }',
+              'set group%d item%d <STRING:name> <LIST:on,off:state>',
+              'clear group%d item%d { <IPV4ADDR:addr> }',
+              '+debug group%d item%d <HEX:mask>' ]
+
+def write_cli(fname, num_cmds):
+    '''
+    Write a synthetic .cli file.
+
+    @param   fname    Name of the .cli file.
+    @param   num_cmds Number of commands.
+    '''
+    fout = open(fname, 'w')
+    for n in range(num_cmds):
+        fout.write('// Command %d\n' % n)
+        fout.write(TEMPLATES[n % len(TEMPLATES)] % (n % 100, n / 100) + '\n')
+    fout.close()
+
+def main():
+    '''Program entry point.'''
+    num_cmds = 100000
+    target = 5000.0
+    args = ''
+    sys.argv.pop(0)
+    while len(sys.argv) > 0:
+        item = sys.argv.pop(0)
+        if '-n' == item:
+            num_cmds = int(sys.argv.pop(0))
+        elif '-t' == item:
+            target = float(sys.argv.pop(0))
+        elif '-b' == item:
+            args = '-b cparser_tree.bin '
+        else:
+            print 'Unknown option %s.' % item
+            return 2
+
+    mk_parser = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                             'mk_parser.py')
+    out_dir = tempfile.mkdtemp()
+    try:
+        cli = os.path.join(out_dir, 'bench.cli')
+        write_cli(cli, num_cmds)
+        start = time.time()
+        rc = os.system('%s %s -o %s %s%s > /dev/null' %
+                       (sys.executable, mk_parser, out_dir, args, cli))
+        elapsed = time.time() - start
+    finally:
+        shutil.rmtree(out_dir)
+    if rc != 0:
+        print 'FAIL: mk_parser.py exits with %d' % rc
+        return 1
+
+    rate = num_cmds / elapsed
+    print '%d commands in %.2f s (%d commands/s, target %d)' % \
+          (num_cmds, elapsed, rate, target)
+    if rate < target:
+        print 'FAIL: below the target'
+        return 1
+    print 'PASS'
+    return 0
+
+# Entry point of the script
+if __name__ == '__main__':
+    sys.exit(main())
@@ -26,13 +26,26 @@
 # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 # SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-import re, sys, glob
+import re, sys, os, glob, struct, gc, hashlib, cPickle, cStringIO
 
 print_tree = False
 debug = False
+## Pass the parameters of a command to its action in one structure (-a)
+arg_structs = False
 end_node = None
 cli_root_stack = []
 
+## Directives and comments of .cli files. They are compiled once as every
+## line is matched against them.
+RE_ENDIF = re.compile('^#endif')
+RE_DIRECTIVE = re.compile('^#(ifdef|submode|endsubmode|include)')
+RE_COMMENT = re.compile('^\s*\/\/\s*(.*)')
+RE_IFDEF = re.compile('^#ifdef (.+)')
+RE_IFNDEF = re.compile('^#ifndef (.+)')
+RE_INCLUDE = re.compile('^#include "(.+)"')
+RE_SUBMODE = re.compile('^#submode "(.+)"')
+RE_ENDSUBMODE = re.compile('^#endsubmode')
+
 def DBG(hdr, s):
     '''
     Debug printf
@@ -47,7 +60,7 @@ def DBG(hdr, s):
         sys.stdout.write(hdr)
         print(s)
         
-class Node:
+class Node(object):
     '''A class of parse tree node.'''
     ## Supported token types.
     TOKENS = [ 'ROOT', 'END', 'KEYWORD', 'STRING', 'UINT', 'UINT64', 'INT',
@@ -71,6 +84,26 @@ class Node:
               'FILE'       : 'char *',
               'LIST'       : 'char *'
               }
+
+    ## Flags of the nodes of optional parts
+    OPT_FLAGS = ('CPARSER_NODE_FLAGS_OPT_START', 'CPARSER_NODE_FLAGS_OPT_END',
+                 'CPARSER_NODE_FLAGS_OPT_PARTIAL')
+
+    ## Token types and their fields in argument structures (-a) as 
+    ## (C type, array size, alignment)
+    ARG_TYPES = { 'STRING'     : ('char ', '[CPARSER_MAX_TOKEN_SIZE + 1]', 1),
+                  'UINT'       : ('uint32_t ', '', 4),
+                  'UINT64'     : ('uint64_t ', '', 8),
+                  'INT'        : ('int32_t ', '', 4),
+                  'INT64'      : ('int64_t ', '', 8),
+                  'HEX'        : ('uint32_t ', '', 4),
+                  'HEX64'      : ('uint64_t ', '', 8),
+                  'FLOAT'      : ('double ', '', 8),
+                  'MACADDR'    : ('cparser_macaddr_t ', '', 1),
+                  'IPV4ADDR'   : ('uint32_t ', '', 4),
+                  'FILE'       : ('char ', '[CPARSER_MAX_TOKEN_SIZE + 1]', 1),
+                  'LIST'       : ('char ', '[CPARSER_MAX_TOKEN_SIZE + 1]', 1)
+                  }
     
     def __init__(self, node_type, param, desc, flags, list_kw=None):
         '''
@@ -87,10 +120,14 @@ class Node:
             self.desc = '    "%s",\n' % desc
         else:
             self.desc = '    NULL,\n'
+        ## Description as a string (None if there is none)
+        self.desc_str = desc
         ## Flags
         self.flags = flags
         ## List of children nodes
         self.children = []
+        ## Children nodes keyed by (type, param)
+        self.child_index = {}
         if list_kw == None:
             self.list_kw = [] # used only for LIST tokens
         else:
@@ -103,6 +140,16 @@ class Node:
         self.depth = 0
         self.path = ''
         self.next = None
+        ## Name of the shard of the node in incremental mode
+        self.shard = None
+        ## Length of the shortest prefix no sibling matches (keyword only)
+        self.uniq_len = 0
+        ## Command ID (END node only). See assign_cmd_ids().
+        self.id = None
+        ## Path from the root (END node only). See walk_up_to_root().
+        self.up = None
+        ## Parameters on the path (END node only). See params().
+        self.param_nodes = None
         return
 
     def add_child(self, child):
@@ -113,17 +160,17 @@ class Node:
 
         @return  The child node added.
         '''
-        for c in self.children:
-            if (c.type == child.type) and (c.param == child.param):
-                # The node already exists. Re-use the existing node.
-                # But check if the hidden flag should be cleared. If the new
-                # node does not have CPARSER_NODE_HIDDEN.
-                if 'CPARSER_NODE_HIDDEN' not in child.flags:
-                    try:
-                        c.delete('CPARSER_NODE_HIDDEN')
-                    except:
-                        pass
-                return c
+        c = self.child_index.get((child.type, child.param))
+        if c:
+            # The node already exists. Re-use the existing node.
+            # But check if the hidden flag should be cleared. If the new
+            # node does not have CPARSER_NODE_HIDDEN.
+            if 'CPARSER_NODE_HIDDEN' not in child.flags:
+                try:
+                    c.delete('CPARSER_NODE_HIDDEN')
+                except:
+                    pass
+            return c
         # Fill out some information that are tree structure dependent.
         # These information are actually embedded in the tree already
         # However, we compute them and cache them to reduce the
@@ -146,11 +193,44 @@ class Node:
             child.path = self.param.replace('cparser_glue', '') + '_root'
         if len(self.children) > 0:
             self.children[-1].next = child
+        ## Position among its siblings
+        child.pos = len(self.children)
         
         # Insert the node into the children list
         self.children.append(child)
+        self.child_index[(child.type, child.param)] = child
         return child
 
+    def set_uniq_len(self):
+        '''
+        Compute the length of the shortest prefix of each keyword child
+        that no other child matches. It is one more than the longest
+        prefix it shares with another keyword or LIST keyword. It is 0
+        for all if there is a parameter child, which can match anything.
+        '''
+        words = []
+        for c in self.children:
+            if c.is_keyword():
+                words.append(c.param)
+            elif c.is_list():
+                words.extend(c.list_kw)
+            elif c.is_param():
+                return
+        # Sorted, the longest common prefix of a word with any other is
+        # the one with a neighbor
+        words.sort()
+        longest = {}
+        for k in range(len(words) - 1):
+            (a, b) = (words[k], words[k+1])
+            n = 0
+            while (n < len(a)) and (n < len(b)) and (a[n] == b[n]):
+                n += 1
+            longest[a] = max(longest.get(a, 0), n)
+            longest[b] = max(longest.get(b, 0), n)
+        for c in self.children:
+            if c.is_keyword():
+                c.uniq_len = longest.get(c.param, 0) + 1
+
     def is_param(self):
         '''Is this node a parameter node.
 
@@ -182,9 +262,10 @@ class Node:
 
         @return  True if it is optional; False otherwise.
         '''
-        return (0 < (self.flags.count('CPARSER_NODE_FLAGS_OPT_START') +
-                     self.flags.count('CPARSER_NODE_FLAGS_OPT_END') +
-                     self.flags.count('CPARSER_NODE_FLAGS_OPT_PARTIAL')))
+        for f in self.flags:
+            if f in Node.OPT_FLAGS:
+                return True
+        return False
 
     def __repr__(self):
         '''Representation method.
@@ -224,32 +305,31 @@ class Node:
     #
     # \return    Return the number of callback made.
     def walk(self, fn, mode, cookie):
-        last = len(self.children)
         count = 0
         if (mode == 'pre-order') or (mode == 'func'):
             if ((mode == 'pre-order') or
                 ((self.type == 'END') and
-                 (not self.flags.count('CPARSER_NODE_FLAGS_OPT_PARTIAL')))):
+                 ('CPARSER_NODE_FLAGS_OPT_PARTIAL' not in self.flags))):
                 fn(self, cookie)
                 count += 1
-            for n in range(last):
-                count += self.children[n].walk(fn, mode, cookie)
+            for c in self.children:
+                count += c.walk(fn, mode, cookie)
         elif 'post-order' == mode:
-            for n in range(last):
-                count += self.children[last-1-n].walk(fn, mode, cookie)
+            for c in reversed(self.children):
+                count += c.walk(fn, mode, cookie)
             fn(self, cookie)
             count += 1
         else:
             raise ValueError, 'Unknown walk mode: %s' % mode
         return count
     
-    def c_struct(self):
+    def c_struct(self, fout):
         '''
-        Generate the C structure name.
+        Write the C structure of the node.
 
-        @return  Return a string that contains the C structure for the node.
+        @param   fout An output file object.
         '''
-        msg = ''
+        w = fout.write
         if 'LIST' == self.type:
             # For LIST token, build its nodes. First, build the variable name.
             list_kw_len = len(self.list_kw)
@@ -259,44 +339,56 @@ class Node:
                     next = 'NULL' # last keyword in the list
                 else:
                     next = '&cparser_list_node%s_%s' % (self.path, self.list_kw[n+1].replace('-', '_'))
-                msg += 'cparser_list_node_t cparser_list_node%s_%s = {\n' % (self.path, this_kw.replace('-', '_'))
-                msg += '    %s,\n' % next
-                msg += '    "%s"\n' % this_kw
-                msg += ' };\n\n'
+                w('cparser_list_node_t cparser_list_node%s_%s = {\n'
+                  '    %s,\n'
+                  '    "%s"\n'
+                  ' };\n\n' % (self.path, this_kw.replace('-', '_'), next,
+                                this_kw))
             
         if self.parent == None:
-            msg += 'cparser_node_t cparser_root = {\n'
+            w('cparser_node_t cparser_root = {\n')
         else:
-            msg += 'cparser_node_t cparser_node%s = {\n' % self.path
+            w('cparser_node_t cparser_node%s = {\n' % self.path)
         # type
-        msg += '    CPARSER_NODE_%s,\n' % self.type
+        w('    CPARSER_NODE_%s,\n' % self.type)
         # flags
         if len(self.flags) == 0:
-            msg += '    0,\n'
+            w('    0,\n')
         else:
-            msg += '    ' + ' | '.join(self.flags) + ',\n'
+            w('    ' + ' | '.join(self.flags) + ',\n')
+        # uniq_len
+        w('    %d,\n' % self.uniq_len)
         # param
-        if 'ROOT' == self.type:  msg += '    NULL,\n'
-        elif 'END' == self.type: msg += '    %s,\n' % self.param
-        elif 'KEYWORD' == self.type: msg += '    "%s",\n' % self.param
+        if 'ROOT' == self.type:  w('    NULL,\n')
+        elif 'END' == self.type: w('    %s,\n' % self.param)
+        elif 'KEYWORD' == self.type: w('    "%s",\n' % self.param)
         elif 'LIST' == self.type:
-            msg += '    &cparser_list_node%s_%s,\n' % (self.path, self.list_kw[0].replace('-', '_'))
-        else: msg += '    "<%s:%s>",\n' % (self.type, self.param)
+            w('    &cparser_list_node%s_%s,\n' % (self.path, self.list_kw[0].replace('-', '_')))
+        else: w('    "<%s:%s>",\n' % (self.type, self.param))
         # desc
-        msg += self.desc
+        w(self.desc)
         # sibling
         if self.next:
-            msg += '    &cparser_node%s,\n' % self.next.path
+            w('    &cparser_node%s,\n' % self.next.path)
         else:
-            msg += '    NULL,\n'
+            w('    NULL,\n')
         # children
         if len(self.children) > 0:
-            msg += '    &cparser_node%s\n' % self.children[0].path
+            w('    &cparser_node%s\n' % self.children[0].path)
         else:
-            msg += '    NULL\n'
-        msg += '};\n\n'
+            w('    NULL\n')
+        w('};\n\n')
 
-        return msg
+    def param_str(self):
+        '''
+        @return  The string 'param' of the node points to; None if there is 
+                 none.
+        '''
+        if self.type in ('ROOT', 'END', 'LIST'):
+            return None
+        if 'KEYWORD' == self.type:
+            return self.param
+        return '<%s:%s>' % (self.type, self.param)
 
     def walk_up_to_root(self):
         '''
@@ -305,90 +397,1042 @@ class Node:
         @return  A list of Node objects that forms a path from root (first elemnt) to this node (last element).
         '''
         assert self.type == 'END'
+        if self.up is not None:
+            return self.up
         p = []
         cur_node = self
         while cur_node.parent:
-            p.insert(0, cur_node)
+            p.append(cur_node)
             cur_node = cur_node.parent
             if cur_node.type == 'ROOT':
                 break
+        p.reverse()
+        self.up = p
         return p
 
-    def action_fn(self):
+    def params(self):
+        '''
+        @return  A list of the parameter nodes from the root to this node.
         '''
-        Generate the action function prototype.
+        if self.param_nodes is None:
+            self.param_nodes = [n for n in self.walk_up_to_root() 
+                                if n.is_param()]
+        return self.param_nodes
 
-        @return  The C action function prototype for a command.
+    def action_fn(self, fout):
         '''
-        # Build a list of parse nodes that forms the path from the root.
-        # to this end node
-        path = self.walk_up_to_root()
+        Write the action function prototype of a command.
+
+        @param   fout An output file object.
+        '''
+        # The parameters on the path from the root to this end node
+        params = self.params()
 
         # Declare the action function
-        msg = ('cparser_result_t %s(cparser_context_t *context' %
-               self.param.replace('cparser_glue', 'cparser_cmd'))
+        w = fout.write
+        if arg_structs and params:
+            self.args_struct(fout, params)
+            w('cparser_result_t %s(cparser_context_t *context,\n'
+              '    const %s *args);\n' %
+              (self.param.replace('cparser_glue', 'cparser_cmd'),
+               self.args_type()))
+            return
+        w('cparser_result_t %s(cparser_context_t *context' %
+          self.param.replace('cparser_glue', 'cparser_cmd'))
 
         # Declare the variable list
-        for n in path:
-            if not n.is_param(): continue
-            msg += ',\n    %s*%s_ptr' % (Node.TYPES[n.type], n.param)
-        msg += ');\n'
-        return msg
+        for n in params:
+            w(',\n    %s*%s_ptr' % (Node.TYPES[n.type], n.param))
+        w(');\n')
 
-    def glue_fn(self):
+    def args_type(self):
+        '''
+        @return  The name of the argument structure of a command.
         '''
-        Generate the glue funtion.
+        return self.param.replace('cparser_glue', 'cparser_args') + '_t'
+
+    def args_struct(self, fout, params):
+        '''
+        Write the argument structure of a command. Each parameter is a 
+        field and strings are copied into it, so the structure can be 
+        kept after the action function returns. 'has' tells which 
+        optional parameters are given. Fields are ordered by alignment
+        so there is no padding between them.
+
+        @param   fout   An output file object.
+        @param   params Parameter nodes of the command.
+        '''
+        w = fout.write
+        w('\n/** Arguments of %s() */\n' % 
+          self.param.replace('cparser_glue', 'cparser_cmd'))
+        w('typedef struct %s {\n' % self.args_type()[:-1])
+        opts = [n for n in params if n.is_optional()]
+        if opts:
+            w('    struct {\n')
+            for n in opts:
+                w('        unsigned %s : 1;\n' % n.param)
+            w('    } has;\n')
+        for n in sorted(params, key=lambda n: -Node.ARG_TYPES[n.type][2]):
+            (c_type, dim, align) = Node.ARG_TYPES[n.type]
+            w('    %s%s%s;\n' % (c_type, n.param, dim))
+        w('} %s;\n' % self.args_type())
+
+    def glue_fn(self, fout):
+        '''
+        Write the glue funtion of a command.
         
-        @return  The C glue function for a command.
+        @param   fout An output file object.
         '''
         # Build a list of parse nodes that forms the path from the root.
         # to this end node
         path = self.walk_up_to_root()
+        params = [(k, n) for (k, n) in enumerate(path) if n.is_param()]
+        if arg_structs and params:
+            self.args_glue_fn(fout, params)
+            return
 
         # Build the glue function
-        msg =  'cparser_result_t\n'
-        msg += '%s (cparser_t *parser)\n' % self.param
-        msg += '{\n'
+        w = fout.write
+        w('cparser_result_t\n'
+          '%s (cparser_t *parser)\n'
+          '{\n' % self.param)
 
         # Declare the variable list
-        skip = ''
-        for n in path:
-            if not n.is_param(): continue
-            skip = '\n'
+        for (k, n) in params:
             val_type = Node.TYPES[n.type]
-            msg += '    %s%s_val;\n' % (val_type, n.param)
-            msg += '    %s*%s_ptr = NULL;\n' % (val_type, n.param)
-        if skip: msg += '    cparser_result_t rc;\n'
-        msg += skip
+            w('    %s%s_val;\n'
+              '    %s*%s_ptr = NULL;\n' % (val_type, n.param, val_type, n.param))
+        w('    cparser_result_t rc;\n\n')
         
         # Extract the parameters
-        k = -1
-        for n in path:
-            k = k + 1
-            if not n.is_param(): continue
-            msg += ('    rc = cparser_get_%s(&parser->tokens[%d], &%s_val);\n' %
-                    (n.type.lower(), k, n.param))
+        for (k, n) in params:
+            w('    rc = cparser_get_%s(&parser->tokens[%d], &%s_val);\n' %
+              (n.type.lower(), k, n.param))
             if n.is_optional():
-                msg += '    if (CPARSER_OK == rc) {\n'
-                msg += '        %s_ptr = &%s_val;\n' % (n.param, n.param)
-                msg += '    } else {\n'
-                msg += '        assert(%d > parser->token_tos);\n' % (k+1)
-                msg += '    }\n'
+                w('    if (CPARSER_OK == rc) {\n'
+                  '        %s_ptr = &%s_val;\n'
+                  '    } else {\n'
+                  '        assert(%d > parser->token_tos);\n'
+                  '    }\n' % (n.param, n.param, k+1))
             else:
-                msg += '    assert(CPARSER_OK == rc);\n'
-                msg += '    %s_ptr = &%s_val;\n' % (n.param, n.param)
-
-        # Call the user-provided action function
-        msg += ('    %s(&parser->context' %
-                self.param.replace('cparser_glue', 'cparser_cmd'))
-        for n in path:
-            if n.is_param(): msg += ',\n        %s_ptr' % n.param
-        msg += ');\n'
-        msg += '    return CPARSER_OK;\n'
-        msg += '}\n\n'
-        return msg
+                w('    assert(CPARSER_OK == rc);\n'
+                  '    %s_ptr = &%s_val;\n' % (n.param, n.param))
+
+        # Call the user-provided action function. Its result goes back
+        # to the parser.
+        w('    rc = %s(&parser->context' %
+          self.param.replace('cparser_glue', 'cparser_cmd'))
+        for (k, n) in params:
+            w(',\n        %s_ptr' % n.param)
+        w(');\n'
+          '    return rc;\n'
+          '}\n\n')
+
+    def cmd_key(self):
+        '''
+        @return  The glue function name and the types of the parameters 
+                 of a command. The ID of the command is derived from it.
+        '''
+        params = self.params()
+        return self.param + ':' + ','.join([n.type + '?' * n.is_optional()
+                                            for n in params])
+
+    def cmd_id(self):
+        '''
+        @return  The command ID. See assign_cmd_ids().
+        '''
+        assert self.id is not None
+        return self.id
+
+    def sibling_path(self):
+        '''
+        @return  The position of each node from the root of the submode 
+                 to this node among its siblings as a C string. Each 
+                 position is in 7-bit groups from the lowest one and 
+                 bit 7 is set in all groups but the last.
+        '''
+        path = ''
+        for n in self.walk_up_to_root():
+            k = n.pos
+            while k > 0x7f:
+                path += '\\%03o' % (0x80 | (k & 0x7f))
+                k >>= 7
+            path += '\\%03o' % k
+        return '"%s"' % path
+
+    def codec_decl(self, fout):
+        '''
+        Write the ID and the prototype of the encode function of a 
+        command.
+
+        @param   fout An output file object.
+        '''
+        w = fout.write
+        name = self.param.replace('cparser_glue', '')
+        w('#define CPARSER_ID%s (0x%08xU)\n' % (name.upper(), self.cmd_id()))
+        w('int cparser_enc%s(void *buf, size_t size%s);\n' % 
+          (name, self.encode_args()))
+
+    def encode_args(self):
+        '''
+        @return  Parameters of the encode function after the buffer. They
+                 are the ones of the action function.
+        '''
+        params = self.params()
+        if arg_structs and params:
+            return ',\n    const %s *args' % self.args_type()
+        return ''.join([',\n    %s*%s_ptr' % (Node.TYPES[n.type], n.param) 
+                        for n in params])
+
+    def codec_fns(self, fout):
+        '''
+        Write the encode and decode functions of a command. See 
+        cparser_encoder_t for the encoding.
+
+        @param   fout An output file object.
+        '''
+        w = fout.write
+        name = self.param.replace('cparser_glue', '')
+        params = self.params()
+        strs = ('STRING', 'FILE', 'LIST')
+
+        # Encode function
+        w('int\n'
+          'cparser_enc%s (void *buf, size_t size%s)\n'
+          '{\n'
+          '    cparser_encoder_t enc;\n\n'
+          '    cparser_encoder_init(&enc, buf, size);\n' % 
+          (name, self.encode_args()))
+        for n in params:
+            if arg_structs:
+                val = 'args->' + n.param
+                if n.type not in strs:
+                    val = '&' + val
+                if n.is_optional():
+                    val = 'args->has.%s ? %s : NULL' % (n.param, val)
+            elif n.type in strs:
+                val = '%s_ptr ? *%s_ptr : NULL' % (n.param, n.param)
+            else:
+                val = n.param + '_ptr'
+            line = ('    cparser_encode_arg(&enc, CPARSER_NODE_%s, %d, ' %
+                    (n.type, n.is_optional()))
+            if len(line + val) > 76:
+                line = line[:-1] + '\n' + ' ' * 23
+            w('%s%s);\n' % (line, val))
+        w('    return cparser_encoder_done(&enc);\n'
+          '}\n\n')
+
+        # Decode function
+        w('cparser_result_t\n'
+          'cparser_dec%s (cparser_t *parser, const void *data,\n'
+          '    size_t len)\n'
+          '{\n'
+          '    cparser_decoder_t dec;\n' % name)
+        if arg_structs and params:
+            w('    %s args;\n' % self.args_type())
+        else:
+            for n in params:
+                val_type = Node.TYPES[n.type]
+                if n.type in strs:
+                    w('    char %s_buf[CPARSER_MAX_TOKEN_SIZE + 1];\n'
+                      '    char *%s_val = %s_buf;\n' % 
+                      (n.param, n.param, n.param))
+                else:
+                    w('    %s%s_val;\n' % (val_type, n.param))
+                w('    %s*%s_ptr = NULL;\n' % (val_type, n.param))
+        w('    cparser_result_t rc;\n\n')
+        if arg_structs and params:
+            w('    memset(&args, 0, sizeof(args));\n')
+        w('    cparser_decoder_init(&dec, data, len);\n')
+        for n in params:
+            if arg_structs:
+                field = 'args.' + n.param
+            elif n.type in strs:
+                field = n.param + '_buf'
+            else:
+                field = n.param + '_val'
+            if n.is_list():
+                kw = '"%s\\0"' % '\\0'.join(n.list_kw)
+            else:
+                kw = 'NULL'
+            call = ('cparser_decode_arg(&dec, CPARSER_NODE_%s, %d, %s%s,\n'
+                    '                           sizeof(%s), %s)' % 
+                    (n.type, n.is_optional(), 
+                     '' if n.type in strs else '&', field, field, kw))
+            if arg_structs:
+                if n.is_optional():
+                    w('    args.has.%s = %s;\n' % (n.param, call))
+                else:
+                    w('    (void)%s;\n' % call)
+            elif n.is_optional():
+                w('    if (%s) {\n'
+                  '        %s_ptr = &%s_val;\n'
+                  '    }\n' % (call, n.param, n.param))
+            else:
+                w('    (void)%s;\n'
+                  '    %s_ptr = &%s_val;\n' % (call, n.param, n.param))
+        w('    rc = cparser_decoder_done(&dec);\n'
+          '    if (CPARSER_OK != rc) {\n'
+          '        return rc;\n'
+          '    }\n'
+          '    rc = %s(&parser->context' %
+          self.param.replace('cparser_glue', 'cparser_cmd'))
+        if arg_structs and params:
+            w(', &args')
+        else:
+            for n in params:
+                w(',\n        %s_ptr' % n.param)
+        w(');\n'
+          '    return rc;\n'
+          '}\n\n')
+
+    def args_glue_fn(self, fout, params):
+        '''
+        Write the glue function of a command that passes an argument 
+        structure.
+
+        @param   fout   An output file object.
+        @param   params (token index, parameter node) of the command.
+        '''
+        w = fout.write
+        w('cparser_result_t\n'
+          '%s (cparser_t *parser)\n'
+          '{\n'
+          '    %s args;\n'
+          '    cparser_result_t rc;\n\n'
+          '    memset(&args, 0, sizeof(args));\n' % 
+          (self.param, self.args_type()))
+        # A string longer than its field fails. The parser accepts
+        # tokens up to max_token_size of cparser_cfg_t.
+        for (k, n) in params:
+            indent = ''
+            if n.is_optional():
+                w('    if (%d < parser->token_tos) {\n' % k)
+                indent = '    '
+            w('%s    rc = cparser_get_arg(&parser->tokens[%d], '
+              'CPARSER_NODE_%s,\n'
+              '%s                         &args.%s, sizeof(args.%s));\n'
+              '%s    if (CPARSER_OK != rc) {\n'
+              '%s        return rc;\n'
+              '%s    }\n' % (indent, k, n.type, indent, n.param, n.param, 
+                             indent, indent, indent))
+            if n.is_optional():
+                w('        args.has.%s = 1;\n'
+                  '    }\n' % n.param)
+        w('    rc = %s(&parser->context, &args);\n'
+          '    return rc;\n'
+          '}\n\n' % self.param.replace('cparser_glue', 'cparser_cmd'))
+
+class Matcher(object):
+    '''
+    Emulation of the match function of a token type in cparser_token.c.
+    A state stands for the characters of a token seen so far. The 
+    transition table maps a state to a list of (characters, next state)
+    pairs. None matches any character. A state without a transition for
+    a character means that no longer token can match.
+    '''
+    ## Match status of a state, as returned by the match functions
+    NONE = 0
+    PARTIAL = 1
+    COMPLETE = 2
+
+    DIGITS = '0123456789'
+    XDIGITS = DIGITS + 'abcdefABCDEF'
 
-class Token:
+    def __init__(self, table=None, status=None):
+        '''
+        Constructor.
+
+        @param   table  The transition table. 'start' is the first state.
+        @param   status Status of each state keyed by state. It is 
+                        PARTIAL for a state that is not listed.
+        '''
+        self.start = 'start'
+        self.table = table
+        self.status_tbl = status
+
+    def step(self, state, ch):
+        '''
+        @return  The state after 'ch'; None if no longer token matches.
+        '''
+        for (chars, nxt) in self.table.get(state, []):
+            if (chars is None) or (ch in chars):
+                return nxt
+        return None
+
+    def status(self, state):
+        '''
+        @return  The match status of a token that ends in 'state'.
+        '''
+        return self.status_tbl.get(state, Matcher.PARTIAL)
+
+    @classmethod
+    def create(cls, node):
+        '''
+        @return  A Matcher object for a node.
+        '''
+        D = Matcher.DIGITS
+        X = Matcher.XDIGITS
+        C = Matcher.COMPLETE
+        if node.is_keyword():
+            return KeywordMatcher(node.param)
+        if node.is_list():
+            return ListMatcher(node.list_kw)
+        if node.type in ('UINT', 'UINT64'):
+            return Matcher({ 'start' : [('0', 'zero'), (D, 'dec')],
+                             'zero'  : [('x', 'x'), (D, 'dec')],
+                             'dec'   : [(D, 'dec')],
+                             'x'     : [(X, 'hex')],
+                             'hex'   : [(X, 'hex')] },
+                           { 'zero' : C, 'dec' : C, 'hex' : C })
+        if node.type in ('INT', 'INT64'):
+            return Matcher({ 'start' : [('+-', 'sign'), (D, 'num')],
+                             'sign'  : [(D, 'num')],
+                             'num'   : [(D, 'num')] },
+                           { 'num' : C })
+        if node.type in ('HEX', 'HEX64'):
+            return Matcher({ 'start' : [('0', 'zero')],
+                             'zero'  : [('x', 'x')],
+                             'x'     : [(X, 'hex')],
+                             'hex'   : [(X, 'hex')] },
+                           { 'hex' : C })
+        if 'FLOAT' == node.type:
+            # A leading '.' only matches as the 2nd character of a token
+            return Matcher({ 'start' : [('+-', 'sign'), ('.', 'dot'),
+                                        (D, 'int')],
+                             'sign'  : [('.', 'last'), (D, 'int')],
+                             'dot'   : [(None, 'last')],
+                             'int'   : [('.', 'frac'), (D, 'int')],
+                             'frac'  : [(D, 'frac')] },
+                           { 'dot' : Matcher.NONE, 'int' : C, 'frac' : C })
+        if 'MACADDR' == node.type:
+            return MacaddrMatcher()
+        if 'IPV4ADDR' == node.type:
+            return Ipv4addrMatcher()
+        assert node.type in ('STRING', 'FILE')
+        return Matcher({ 'start' : [(None, 'any')], 'any' : [(None, 'any')] },
+                       { 'any' : C })
+
+class KeywordMatcher(Matcher):
+    '''Keyword. The state is the number of characters matched.'''
+    def __init__(self, kw):
+        self.start = 0
+        self.kw = kw
+
+    def step(self, state, ch):
+        if (state < len(self.kw)) and (self.kw[state] == ch):
+            return state + 1
+        return None
+
+    def status(self, state):
+        if state == len(self.kw):
+            return Matcher.COMPLETE
+        return Matcher.PARTIAL
+
+class ListMatcher(Matcher):
+    '''LIST. The state is the token.'''
+    def __init__(self, words):
+        self.start = ''
+        self.words = words
+
+    def step(self, state, ch):
+        for w in self.words:
+            if w.startswith(state + ch):
+                return state + ch
+        return None
+
+    def status(self, state):
+        if 1 == len([w for w in self.words if w.startswith(state)]):
+            return Matcher.COMPLETE
+        return Matcher.PARTIAL
+
+class MacaddrMatcher(Matcher):
+    '''MACADDR. The state is (hex digits in the octet, colons).'''
+    def __init__(self):
+        self.start = (0, 0)
+
+    def step(self, state, ch):
+        (digits, colons) = state
+        if (digits < 2) and (ch in Matcher.XDIGITS):
+            return (digits + 1, colons)
+        if digits and (':' == ch) and (colons < 5):
+            return (0, colons + 1)
+        return None
+
+    def status(self, state):
+        (digits, colons) = state
+        if digits and (5 == colons):
+            return Matcher.COMPLETE
+        return Matcher.PARTIAL
+
+class Ipv4addrMatcher(Matcher):
+    '''IPV4ADDR. The state is (digits of the byte, dots).'''
+    def __init__(self):
+        self.start = ('', 0)
+
+    def step(self, state, ch):
+        (digits, dots) = state
+        if (len(digits) < 3) and (ch in Matcher.DIGITS):
+            if (2 == len(digits)) and (digits + ch > '255'):
+                return None
+            return (digits + ch, dots)
+        if digits and ('.' == ch) and (dots < 3):
+            return ('', dots + 1)
+        return None
+
+    def status(self, state):
+        (digits, dots) = state
+        if digits and (3 == dots):
+            return Matcher.COMPLETE
+        return Matcher.PARTIAL
+
+class Analyzer(object):
+    '''
+    Static analysis of a parse tree. For every set of siblings, it runs
+    the match functions of all of them together on every token that 
+    any of them can match. It reports tokens that match more than one
+    sibling, nodes that never get a token, commands that can never be 
+    executed and optional parts that cannot be left out. It also sets 
+    CPARSER_NODE_FLAGS_NO_OVERLAP on a node if no sibling matches a 
+    token it matches completely, so cparser_match() can stop there, 
+    and sets uniq_len of keywords.
+
+    Matching follows cparser_match() with SHORTEST_UNIQUE_KEYWORD.
+    '''
+    ## Characters all parameter types treat alike. Tokens are explored
+    ## with one character of each class and all characters of keywords.
+    CHAR_CLASSES = [ '0', '1', '2', '34', '5', '6789', 'x', 'abcdefABCDEF',
+                     '.', ':', '+-', 'ghijklmnopqrstuvwyzGHIJKLMNOPQRSTUVWXYZ' +
+                     '!"#$%&\'()*,/;<=>?@[\\]^_`{|}~' ]
+    ## Limit of the states explored for one set of siblings
+    MAX_STATES = 100000
+    FLAG = 'CPARSER_NODE_FLAGS_NO_OVERLAP'
+
+    def __init__(self, root):
+        '''
+        Constructor. Analyze the tree.
+
+        @param   root Root Node object of the parse tree.
+        '''
+        ## Warnings in the order of the tree
+        self.warnings = []
+        ## Nodes that never match keyed by id()
+        self.dead = set()
+        self.visit(root, True)
+
+    @staticmethod
+    def name(node):
+        '''
+        @return  The node as it is written in .cli files.
+        '''
+        if node.is_list():
+            return '<LIST:%s:%s>' % (','.join(node.list_kw), node.param)
+        return node.param_str()
+
+    @staticmethod
+    def path(node):
+        '''
+        @return  The tokens from the root to a node.
+        '''
+        names = []
+        while node and ('ROOT' != node.type):
+            if 'END' != node.type:
+                names.append(Analyzer.name(node))
+            node = node.parent
+        names.reverse()
+        return ' '.join(names)
+
+    @staticmethod
+    def cmd(end):
+        '''
+        @return  The action function of an END node.
+        '''
+        return end.param.replace('cparser_glue', 'cparser_cmd')
+
+    def warn(self, node, msg):
+        '''
+        Add a warning about the children of a node.
+        '''
+        path = Analyzer.path(node)
+        if path:
+            msg = '%s: %s' % (path, msg)
+        self.warnings.append(msg)
+
+    def visit(self, node, reachable):
+        '''
+        Analyze a node and its subtree.
+
+        @param   node      A Node object.
+        @param   reachable False if a node above it never matches.
+        '''
+        if not node.children:
+            return
+        reachable = reachable and (id(node) not in self.dead)
+        if 'END' != node.type:
+            self.analyze(node, reachable)
+        ends = [c for c in node.children if 'END' == c.type]
+        for (k, e) in enumerate(ends):
+            hidden = 'CPARSER_NODE_FLAGS_HIDDEN' in e.flags
+            used = [u for u in ends[:k] 
+                    if hidden or ('CPARSER_NODE_FLAGS_HIDDEN' not in u.flags)]
+            if not reachable:
+                if 'CPARSER_NODE_FLAGS_OPT_PARTIAL' not in e.flags:
+                    self.warn(node, '%s is unreachable.' % Analyzer.cmd(e))
+            elif used and ('CPARSER_NODE_FLAGS_OPT_PARTIAL' in e.flags):
+                self.warn(node, 'the optional part of %s cannot be left out; '
+                          '%s is used.' % (Analyzer.cmd(e), 
+                                           Analyzer.cmd(used[0])))
+            elif used:
+                self.warn(node, '%s is unreachable; %s is used.' %
+                          (Analyzer.cmd(e), Analyzer.cmd(used[0])))
+        for c in node.children:
+            self.visit(c, reachable)
+
+    def alphabet(self, sibs):
+        '''
+        @return  The characters to explore tokens with.
+        '''
+        chars = set()
+        for c in sibs:
+            chars.update(''.join([c.param] + c.list_kw))
+        for cls in Analyzer.CHAR_CLASSES:
+            for ch in cls:
+                if ch not in chars:
+                    chars.add(ch)
+                    break
+        return sorted(chars)
+
+    @staticmethod
+    def winner(sibs, status, privileged):
+        '''
+        @return  Index of the sibling cparser_match() accepts a token 
+                 with; None if it does not accept it.
+        '''
+        (match, complete, num_matches) = (None, False, 0)
+        for k in range(len(sibs)):
+            if not status[k] or (not privileged and
+                                 'CPARSER_NODE_FLAGS_HIDDEN' in sibs[k].flags):
+                continue
+            num_matches += 1
+            if (match is None) or (not complete and 
+                                   (Matcher.COMPLETE == status[k])):
+                (match, complete) = (k, Matcher.COMPLETE == status[k])
+        if (1 == num_matches) and sibs[match].is_keyword():
+            complete = True
+        if complete:
+            return match
+        return None
+
+    def analyze(self, parent, reachable):
+        '''
+        Analyze the children of a node.
+
+        @param   parent    A Node object.
+        @param   reachable True to report problems.
+        '''
+        sibs = [c for c in parent.children if c.type not in ('END', 'ROOT')]
+        if 1 == len(sibs):
+            sibs[0].flags.append(Analyzer.FLAG)
+            if sibs[0].is_keyword():
+                sibs[0].uniq_len = 1
+            return
+        if not sibs:
+            return
+        parent.set_uniq_len()
+        if not [c for c in sibs if not c.is_keyword()]:
+            # Only a keyword that starts another one overlaps. Its whole
+            # length is shared with a sibling.
+            for c in sibs:
+                if c.uniq_len <= len(c.param):
+                    c.flags.append(Analyzer.FLAG)
+            return
+
+        # Explore tokens breadth first, so the first token found for
+        # anything is the shortest one
+        matchers = [Matcher.create(c) for c in sibs]
+        alphabet = self.alphabet(sibs)
+        start = tuple([m.start for m in matchers])
+        seen = set([start])
+        queue = [(start, '')]
+        n = len(sibs)
+        overlap = [False] * n
+        won = [False] * n
+        # First token each sibling completely matches and its winner
+        sample = [None] * n
+        # First token of each ambiguous pair and its winner
+        ambiguous = {}
+        for (states, token) in queue:
+            for ch in alphabet:
+                nxt = tuple([(s is not None and m.step(s, ch)) or None
+                             for (m, s) in zip(matchers, states)])
+                if (nxt in seen) or (nxt.count(None) == n):
+                    continue
+                seen.add(nxt)
+                if len(seen) > Analyzer.MAX_STATES:
+                    DBG('ANALYZE: ', 'too many states under %s' % 
+                        Analyzer.path(parent))
+                    return
+                queue.append((nxt, token + ch))
+                status = [(s is not None and m.status(s)) or Matcher.NONE
+                          for (m, s) in zip(matchers, nxt)]
+                winner = Analyzer.winner(sibs, status, True)
+                for privileged in (True, False):
+                    w = Analyzer.winner(sibs, status, privileged)
+                    if w is not None:
+                        won[w] = True
+                matched = [k for k in range(n) if status[k]]
+                for k in matched:
+                    if Matcher.COMPLETE != status[k]:
+                        continue
+                    if sample[k] is None:
+                        sample[k] = (token + ch, winner)
+                    for j in matched:
+                        if j == k:
+                            continue
+                        overlap[k] = True
+                        if ((Matcher.COMPLETE == status[j]) or 
+                            sibs[j].is_keyword()):
+                            ambiguous.setdefault((min(j, k), max(j, k)),
+                                                 (token + ch, winner))
+
+        for k in range(n):
+            if not overlap[k]:
+                sibs[k].flags.append(Analyzer.FLAG)
+            if not won[k]:
+                self.dead.add(id(sibs[k]))
+        if not reachable:
+            return
+        for k in range(n):
+            if won[k]:
+                continue
+            (token, winner) = sample[k] or (None, None)
+            if token is None:
+                msg = 'it never matches a token completely'
+            elif winner is None:
+                msg = "'%s' is ambiguous" % token
+            else:
+                msg = "'%s' matches %s" % (token, Analyzer.name(sibs[winner]))
+            self.warn(parent, '%s is never matched; %s.' %
+                      (Analyzer.name(sibs[k]), msg))
+        for ((j, k), (token, winner)) in sorted(ambiguous.items()):
+            if (id(sibs[j]) in self.dead) or (id(sibs[k]) in self.dead):
+                continue
+            if winner is None:
+                msg = 'neither is used'
+            else:
+                msg = '%s is used' % Analyzer.name(sibs[winner])
+            self.warn(parent, "'%s' matches both %s and %s; %s." %
+                      (token, Analyzer.name(sibs[j]), Analyzer.name(sibs[k]),
+                       msg))
+
+class Image:
+    '''
+    Binary image of a parse tree. See cparser_image.h for the format.
+    Nodes have the layout of cparser_node_t on this host but every pointer
+    is an offset relative to the node (or the list node) that holds it.
+    '''
+    MAGIC = 'CPARSERT'
+    VERSION = 3
+    BYTE_ORDER = 0x0102
+    HDR_FMT = '=8sIHBBIIII'
+    ## Node flags and their values in cparser_priv.h
+    FLAGS = { 'CPARSER_NODE_FLAGS_OPT_START'   : 1 << 0,
+              'CPARSER_NODE_FLAGS_OPT_END'     : 1 << 1,
+              'CPARSER_NODE_FLAGS_OPT_PARTIAL' : 1 << 2,
+              'CPARSER_NODE_FLAGS_HIDDEN'      : 1 << 3,
+              'CPARSER_NODE_FLAGS_NO_OVERLAP'  : 1 << 6 }
+    FLAGS_IMAGE = 1 << 4
+
+    def __init__(self, root, glue_ids):
+        '''
+        Constructor. Lay out all nodes, list nodes and strings.
+
+        @param   root     Root Node object of the parse tree.
+        @param   glue_ids A dictionary of command IDs keyed by glue function.
+        '''
+        ## Pointer size of this host
+        self.ptr_size = struct.calcsize('P')
+        self.ptr_fmt = { 4 : 'i', 8 : 'q' }[self.ptr_size]
+        # Type, flags and uniq_len padded to the alignment of the pointers
+        self.node_fmt = '=BBH%dx' % (self.ptr_size - 4) + self.ptr_fmt * 4
+        self.node_size = struct.calcsize(self.node_fmt)
+        self.glue_ids = glue_ids
+        ## Image offsets of nodes, list nodes and strings
+        self.offset = {}
+        self.nodes = []
+        root.walk(lambda n,l: l.append(n), 'pre-order', self.nodes)
+        pos = struct.calcsize(Image.HDR_FMT)
+        for n in self.nodes:
+            self.offset[id(n)] = pos
+            pos += self.node_size
+        self.lists = []
+        for n in self.nodes:
+            for kw in n.list_kw:
+                self.offset[(id(n), kw)] = pos
+                self.lists.append((n, kw))
+                pos += 2 * self.ptr_size
+        self.strings = []
+        for n in self.nodes:
+            for st in [n.param_str(), n.desc_str] + n.list_kw:
+                if (st is not None) and (st not in self.offset):
+                    self.offset[st] = pos
+                    self.strings.append(st)
+                    pos += len(st) + 1
+        self.size = pos
+
+    def rel(self, base, key):
+        '''
+        @return  Offset of an object relative to 'base'; 0 if 'key' is None.
+        '''
+        if key is None:
+            return 0
+        return self.offset[key] - base
+
+    def node_bin(self, node):
+        '''
+        @return  The binary record of a node.
+        '''
+        base = self.offset[id(node)]
+        flags = Image.FLAGS_IMAGE
+        for f in node.flags:
+            flags |= Image.FLAGS[f]
+        if 'END' == node.type:
+            param = self.glue_ids[node.param]
+        elif 'LIST' == node.type:
+            param = self.rel(base, (id(node), node.list_kw[0]))
+        else:
+            param = self.rel(base, node.param_str())
+        sibling = None
+        if node.next:
+            sibling = id(node.next)
+        children = None
+        if len(node.children) > 0:
+            children = id(node.children[0])
+        return struct.pack(self.node_fmt,
+                           Node.TOKENS.index(node.type), flags, 
+                           node.uniq_len, param,
+                           self.rel(base, node.desc_str),
+                           self.rel(base, sibling), self.rel(base, children))
+
+    def list_bin(self, node, kw):
+        '''
+        @return  The binary record of the list node of keyword 'kw'.
+        '''
+        base = self.offset[(id(node), kw)]
+        k = node.list_kw.index(kw)
+        next = None
+        if k + 1 < len(node.list_kw):
+            next = (id(node), node.list_kw[k+1])
+        return struct.pack('=' + self.ptr_fmt * 2, self.rel(base, next),
+                           self.rel(base, kw))
+
+    def write(self, fout):
+        '''
+        Write the image.
+
+        @param   fout An output file object opened in binary mode.
+        '''
+        body = ''.join([self.node_bin(n) for n in self.nodes] +
+                       [self.list_bin(n, kw) for (n, kw) in self.lists] +
+                       [st + '\0' for st in self.strings])
+        # FNV-1a hash of the body
+        checksum = 2166136261
+        for c in body:
+            checksum = ((checksum ^ ord(c)) * 16777619) & 0xffffffff
+        fout.write(struct.pack(Image.HDR_FMT, Image.MAGIC, Image.VERSION,
+                               Image.BYTE_ORDER, self.ptr_size,
+                               self.node_size, self.size,
+                               self.offset[id(self.nodes[0])],
+                               len(self.glue_ids), checksum))
+        fout.write(body)
+
+def string_pool(strings, base=0):
+    '''
+    Lay out NUL-terminated strings in a pool. Each string is stored once.
+    A string that ends another one is not stored but points to the end of
+    the other one.
+
+    @param   strings A list of strings.
+    @param   base    Offset of the first string.
+
+    @return  A tuple of the pool and a dictionary of offsets keyed by 
+             string.
+    '''
+    offset = {}
+    pool = []
+    pos = base
+    # Sorted by their reversed text, a string comes right before the
+    # strings that end with it. Go backward so they are placed first.
+    prev = None
+    for r in sorted(set([st[::-1] for st in strings]), reverse=True):
+        st = r[::-1]
+        if prev and prev.endswith(st):
+            offset[st] = offset[prev] + len(prev) - len(st)
+        else:
+            offset[st] = pos
+            pool.append(st + '\0')
+            pos += len(st) + 1
+        prev = st
+    return (''.join(pool), offset)
+
+def c_string(data):
+    '''
+    @return  A C string literal of 'data'.
+    '''
+    out = ['"']
+    for c in data:
+        if c in '"\\':
+            out.append('\\' + c)
+        elif (' ' <= c <= '~') and ('?' != c):
+            out.append(c)
+        else:
+            out.append('\\%03o' % ord(c))
+    out.append('"')
+    return ''.join(out)
+
+class Packed(object):
+    '''
+    Packed parse tree. See cparser_pnode_t in cparser_priv.h. The nodes, 
+    the list nodes and the strings used to match tokens are in one C 
+    structure. Nodes are in pre-order so the root is node 0 and the 
+    nodes of a command are close to each other. The descriptions are in
+    a pool of their own in the cold section.
+    '''
+    NODE_SIZE = 16
+    LIST_SIZE = 8
+    FLAGS_PACKED = 'CPARSER_NODE_FLAGS_PACKED'
+
+    def __init__(self, root, glue_ids):
+        '''
+        Constructor. Lay out all nodes, list nodes and strings.
+
+        @param   root     Root Node object of the parse tree.
+        @param   glue_ids A dictionary of command IDs keyed by glue function.
+        '''
+        self.glue_ids = glue_ids
+        self.nodes = []
+        root.walk(lambda n,l: l.append(n), 'pre-order', self.nodes)
+        ## Index of each node keyed by id()
+        self.index = dict([(id(self.nodes[k]), k) 
+                           for k in range(len(self.nodes))])
+        ## List nodes as (keyword, is the last keyword of its list)
+        self.lists = []
+        ## Index of the list node of the first keyword of each LIST node
+        self.list_index = {}
+        strings = []
+        descs = []
+        for n in self.nodes:
+            if n.list_kw:
+                self.list_index[id(n)] = len(self.lists)
+                self.lists.extend([(kw, False) for kw in n.list_kw[:-1]] +
+                                  [(n.list_kw[-1], True)])
+                strings.extend(n.list_kw)
+            if n.param_str() is not None:
+                strings.append(n.param_str())
+            if n.desc_str:
+                # Descriptions are written as they are in C literals
+                descs.append(n.desc_str.decode('string_escape'))
+        self.list_base = Packed.NODE_SIZE * len(self.nodes)
+        self.str_base = self.list_base + Packed.LIST_SIZE * len(self.lists)
+        (self.strings, self.str_offset) = string_pool(strings, self.str_base)
+        # Offset 0 means no description
+        (self.descs, self.desc_offset) = string_pool(descs, 1)
+        self.descs = '\0' + self.descs
+        ## Size of the data used to match tokens
+        self.size = self.str_base + len(self.strings)
+        ## Size of the descriptions and their index
+        self.cold_size = 4 * len(self.nodes) + len(self.descs)
+
+    def node_c(self, k, node):
+        '''
+        @return  The C initializer of node 'k'.
+        '''
+        base = Packed.NODE_SIZE * k
+        if 'END' == node.type:
+            param = self.glue_ids[node.param]
+        elif 'LIST' == node.type:
+            param = (self.list_base + 
+                     Packed.LIST_SIZE * self.list_index[id(node)] - base)
+        elif node.param_str() is not None:
+            param = self.str_offset[node.param_str()] - base
+        else:
+            param = 0
+        sibling = 0
+        if node.next:
+            sibling = Packed.NODE_SIZE * self.index[id(node.next)] - base
+        children = 0
+        if len(node.children) > 0:
+            children = Packed.NODE_SIZE * self.index[id(node.children[0])] - base
+        return '{ CPARSER_NODE_%s, %s, %d, %d, %d, %d }' % \
+            (node.type, ' | '.join([Packed.FLAGS_PACKED] + node.flags),
+             node.uniq_len, param, sibling, children)
+
+    def write(self, fout):
+        '''
+        Write the packed tree and cparser_tree.
+
+        @param   fout An output file object.
+        '''
+        w = fout.write
+        w('static const struct {\n' +
+          '    cparser_pnode_t nodes[%d];\n' % len(self.nodes))
+        if self.lists:
+            w('    cparser_plist_node_t lists[%d];\n' % len(self.lists))
+        if self.strings:
+            w('    char strings[%d];\n' % len(self.strings))
+        w('} cparser_packed = {\n    {\n')
+        for k in range(len(self.nodes)):
+            w('        %s,\n' % self.node_c(k, self.nodes[k]))
+        w('    },\n')
+        if self.lists:
+            w('    {\n')
+            for j in range(len(self.lists)):
+                base = self.list_base + Packed.LIST_SIZE * j
+                (kw, is_last) = self.lists[j]
+                next = Packed.LIST_SIZE
+                if is_last:
+                    next = 0
+                w('        { %d, %d },\n' % 
+                  (next, self.str_offset[kw] - base))
+            w('    },\n')
+        self.write_pool(fout, self.strings)
+        w('};\n\n')
+
+        w('static const uint32_t cparser_desc_idx[%d] CPARSER_COLD = {\n' %
+          len(self.nodes))
+        for n in self.nodes:
+            if n.desc_str:
+                w('    %d,\n' % 
+                  self.desc_offset[n.desc_str.decode('string_escape')])
+            else:
+                w('    0,\n')
+        w('};\n\n')
+        w('static const char cparser_descs[%d] CPARSER_COLD =\n' % 
+          len(self.descs))
+        self.write_pool(fout, self.descs)
+        w(';\n\n')
+
+        w('cparser_tree_t cparser_tree = {\n' +
+          '    (cparser_node_t *)&cparser_packed.nodes[0],\n' +
+          '    cparser_glue_tbl,\n' +
+          '    CPARSER_NUM_GLUE,\n' +
+          '    cparser_desc_idx,\n' +
+          '    cparser_descs\n' +
+          '};\n')
+
+    def write_pool(self, fout, pool):
+        '''
+        Write a string pool as C string literals, one string per line. The
+        NUL of the last string is the one of the literal.
+        '''
+        if not pool:
+            return
+        strings = pool[:-1].split('\0')
+        for st in strings[:-1]:
+            fout.write('    %s\n' % c_string(st + '\0'))
+        fout.write('    %s\n' % c_string(strings[-1]))
+
+class Token(object):
     '''Token class. This class represents a token in a CLI command.'''
     ## Beginning of a parameter token
     BEGIN = '^\<'
@@ -403,6 +1447,13 @@ class Token:
     PARAM = '([a-zA-Z][a-zA-Z0-9_]*)'
     ## Description of a node
     DESC= '(:(.+))*'
+
+    # Compiled once as every token of every command is matched
+    KW_RE = re.compile('^' + KW + '$')
+    PARAM_RE = re.compile(BEGIN + TYPE + ':(.+)' + END)
+    LIST_RE = re.compile(BEGIN + TYPE + ':' + LIST_KW + ':' + PARAM + DESC + END)
+    TYPED_PARAM_RE = re.compile(BEGIN + TYPE + ':' + PARAM + DESC + END)
+    BAD_PARAM_RE = re.compile(BEGIN + TYPE + ':([^:>]+)' + DESC + END)
     
     @classmethod
     def valid_keyword(cls, s):
@@ -410,7 +1461,7 @@ class Token:
         
         @return  True if the string is a valid keyword; False otherwise.
         '''
-        return bool(re.search('^' + cls.KW + '$', s))
+        return bool(cls.KW_RE.search(s))
         
     def __init__(self, s):
         '''Constructor.
@@ -437,7 +1488,7 @@ class Token:
             return None
         
         # This token must be a parameter of some kind. Parse the type.
-        m = re.search(Token.BEGIN + Token.TYPE + ':(.+)' + Token.END,  s)
+        m = Token.PARAM_RE.search(s)
         if not m:
             raise ValueError, 'Invalid token "%s".' % s
         if m.group(1) not in Node.TYPES:
@@ -446,8 +1497,7 @@ class Token:
         
         # Check if it is a LIST type.
         if self.type == 'LIST':
-            m = re.search(Token.BEGIN + Token.TYPE + ':' + Token.LIST_KW + ':' + 
-                          Token.PARAM + Token.DESC + Token.END, s)
+            m = Token.LIST_RE.search(s)
             if not m:
                 raise ValueError,  'Malformed LIST token "%s".' % s
             (self.type,  list_kw,  self.param, dummy, self.desc) = m.groups()
@@ -459,24 +1509,25 @@ class Token:
             return None
         
         # Handle the rest of the parameters
-        m = re.search(Token.BEGIN + Token.TYPE + ':' + Token.PARAM + Token.DESC + Token.END,  s)
+        m = Token.TYPED_PARAM_RE.search(s)
         if not m:
-            m = re.search(Token.BEGIN + Token.TYPE + ':([^:>]+)' + Token.DESC + Token.END,  s)
+            m = Token.BAD_PARAM_RE.search(s)
             assert m
             raise ValueError, 'Invalid parameter name "%s".' % m.group(2)
         (self.type, self.param, dummy, self.desc) = m.groups()
         self.list_kw = []
 
 ##
-# \brief     Add one line of CLI to the parse tree.
+# \brief     Parse one line of CLI.
 #
-# \param     root     Root node of the parse tree.
 # \param     line     A line of command from a CLI file.
 # \param     comment  The comment that goes with this line of command.
 #
-# \return    Return a new root node.
-def add_cli(root, line, comment):
-    global end_node
+# \return    None for a blank line. Otherwise, a tuple of the nodes as
+#            (type, param, desc, flags, list_kw) tuples, the hidden flag,
+#            the number of optional parts and the comment. It only holds
+#            strings and lists so it can be cached.
+def parse_cli(line, comment):
     nodes = []
     flags = []
     hidden_flag = []
@@ -486,14 +1537,10 @@ def add_cli(root, line, comment):
     # Convert a line into a token list
     line = line.replace('\n','')
     DBG('\n  LINE: ', line)
-    tokens = line.split(' ')
-
     # Delete all token that is ''
-    cnt = tokens.count('')
-    for k in range(0, cnt):
-        tokens.remove('')
+    tokens = [t for t in line.split(' ') if t]
     if len(tokens) == 0:
-        return root # this is a blank line. quit
+        return None # this is a blank line. quit
 
     # If the '+' marker is with the first token, separate them
     if tokens[0] == '+':
@@ -520,10 +1567,10 @@ def add_cli(root, line, comment):
         if '}' == t:
             # See comment in '{' case.
             assert(len(nodes) > 0)
-            nodes[-1].flags.append('CPARSER_NODE_FLAGS_OPT_END')
+            nodes[-1][3].append('CPARSER_NODE_FLAGS_OPT_END')
             num_opt_end = num_opt_end + 1
             if num_opt_end == num_opt_start:
-                nodes[-1].flags.remove('CPARSER_NODE_FLAGS_OPT_PARTIAL')
+                nodes[-1][3].remove('CPARSER_NODE_FLAGS_OPT_PARTIAL')
             continue
 
         if num_opt_start > num_opt_end:
@@ -536,13 +1583,30 @@ def add_cli(root, line, comment):
 
         # Get the token type
         tt = Token(t)
-        nodes.append(Node(tt.type, tt.param, tt.desc, flags[:], tt.list_kw))
+        nodes.append((tt.type, tt.param, tt.desc, flags[:], tt.list_kw))
         start_flag = False
 
     # hack alert - Check that if there are optional parameters, the format is ok
     
     DBG('TOKENS: ', tokens)
+    return (nodes, hidden_flag, num_opt_start, comment)
+
+##
+# \brief     Add one line of CLI to the parse tree.
+#
+# \param     root     Root node of the parse tree.
+# \param     cli      A line of command parsed by parse_cli().
+#
+# \return    Return a new root node.
+def add_cli(root, cli):
+    global end_node
+    (specs, hidden_flag, num_opt_start, comment) = cli
+    # A node is only created the first time it is inserted. Most of them
+    # are already in the tree and are looked up instead.
+    nodes = [None] * len(specs)
+
     if debug:
+        nodes = [Node(t, p, d, f[:], l) for (t, p, d, f, l) in specs]
         sys.stdout.write(' NODES: ')
         for nn in nodes[:-1]:
             nn.display()
@@ -553,9 +1617,8 @@ def add_cli(root, line, comment):
     # We need to create the glue function name. Since the path of the node
     # is set up when the node is inserted, we don't have it here. So,
     # we manually walk all the nodes and generate the glue function name
-    glue_fn = 'cparser_glue' + root.param
-    for n in nodes:
-        glue_fn = glue_fn + '_' + n.param.replace('-','_')
+    glue_fn = 'cparser_glue' + root.param + \
+        ''.join(['_' + spec[1].replace('-','_') for spec in specs])
     
     # Insert them into the parse tree
     for k in range(0, num_opt_start+1):
@@ -566,19 +1629,24 @@ def add_cli(root, line, comment):
             end_node = Node('END', glue_fn, comment, hidden_flag[:])
         else:
             end_node = Node('END', glue_fn, None, ['CPARSER_NODE_FLAGS_OPT_PARTIAL',] + hidden_flag)
-        for n in nodes:
-            if n.flags.count('CPARSER_NODE_FLAGS_OPT_START'):
+        for (j, (t, p, d, f, l)) in enumerate(specs):
+            if 'CPARSER_NODE_FLAGS_OPT_START' in f:
                 if num_braces == k:
                     num_braces += 1
                     break
                 num_braces += 1
+            n = cur_node.child_index.get((t, p))
+            if n is None:
+                if nodes[j] is None:
+                    nodes[j] = Node(t, p, d, f[:], l)
+                n = cur_node.add_child(nodes[j])
             if debug:
                 sys.stdout.write('        ')
                 cur_node.display()
                 sys.stdout.write('-> ')
                 n.display()
                 sys.stdout.write('\n')
-            cur_node = cur_node.add_child(n)
+            cur_node = n
         if debug:
             sys.stdout.write('        ')
             cur_node.display()
@@ -592,28 +1660,25 @@ def add_cli(root, line, comment):
 # \brief     Process one .cli file. This includes handling all
 #            preprocessors directive.
 #
-def process_cli_file(filename, root, mode, labels, last_cli_root=None, last_cli_end=None):
+def process_cli_file(filename, mode, labels):
     '''
     Process one .cli file. This includes handling all preprocessors directive.
 
     @param     filename Name of the .cli file.
-    @param     root     Root Node object of the parse tree.
     @param     mode     "compile", "preprocess" or "mkdep"
     @param     labels   A dictionary containing all defined labels used in
                         preprocessing.
-    @param     last_cli_root The most recent root node created.
-    @param     last_cli_end  The most recent end node visited.
-    @param     submode  A boolean of whether we are in a submode.
 
-    @return    Return the new root node.
+    @return    In "compile" mode, a list of (op, line number, argument) 
+               tuples to be applied to the parse tree by compile_cli_file().
+               'op' is "cli" with a line parsed by parse_cli(), "include"
+               with a file name, "submode" with a submode name or 
+               "endsubmode". None in the other modes.
     '''
-    global end_node
-
-    global cli_root_stack
-
     num_disable = 0
     label_stack = []
     deplist = []
+    ops = []
     comment = None
     line = ''
     try:
@@ -622,9 +1687,6 @@ def process_cli_file(filename, root, mode, labels, last_cli_root=None, last_cli_
         print 'Fail to open %s.' % filename
         sys.exit(-1)
 
-    if last_cli_root is None:
-        last_cli_root = root
-
     line_num = 0
     for line in fin:
         line_num = line_num + 1
@@ -638,10 +1700,10 @@ def process_cli_file(filename, root, mode, labels, last_cli_root=None, last_cli_
         # to terminate it. Then, we omit every other type of line as long
         # as there is at least one disable #ifdef left. Afterward, we
         # check for illegal directives. A normal command line is handled
-        # last. Illegal tokens are checked inside add_cli().
+        # last. Illegal tokens are checked inside parse_cli().
 
         # #endif
-        m = re.search('^#endif', line)
+        m = RE_ENDIF.search(line)
         if m:
             if len(label_stack) == 0:
                 print('%s:%d: Unmatched #ifdef/#ifndef' % (filename, line_num))
@@ -653,15 +1715,12 @@ def process_cli_file(filename, root, mode, labels, last_cli_root=None, last_cli_
         if (num_disable > 0):
             continue
         # Check for illegal preprocessor directives
-        if (re.search('^#', line) and
-            (not re.search('^#ifdef(\S*\/\/.*)*', line) and
-             not re.search('^#submode(\S*\/\/.*)*', line) and
-             not re.search('^#endsubmode(\S*\/\/.*)*', line) and
-             not re.search('^#include(\S*\/\/.*)*', line))):
+        is_directive = line.startswith('#')
+        if is_directive and not RE_DIRECTIVE.search(line):
             print('%s:%d: Unknown preprocessor directive.' % (filename, line_num))
             sys.exit(-1)
         # Comment
-        m = re.search('^\s*\/\/\s*(.*)', line)
+        m = RE_COMMENT.search(line)
         if m:
             if 'compile' == mode:
                 comment = m.group(1)
@@ -669,7 +1728,7 @@ def process_cli_file(filename, root, mode, labels, last_cli_root=None, last_cli_
                 sys.stdout.write(line)
             continue
         # #ifdef
-        m = re.search('^#ifdef (.+)', line)
+        m = is_directive and RE_IFDEF.search(line)
         if m:
             l = m.group(1)
             val = 0
@@ -679,7 +1738,7 @@ def process_cli_file(filename, root, mode, labels, last_cli_root=None, last_cli_
             label_stack.insert(0, [l, val])
             continue
         # #ifndef
-        m = re.search('^#ifndef (.+)', line)
+        m = is_directive and RE_IFNDEF.search(line)
         if m:
             l = m.group(1)
             val = 0
@@ -689,54 +1748,132 @@ def process_cli_file(filename, root, mode, labels, last_cli_root=None, last_cli_
             label_stack.insert(0, [l, val])
             continue
         # #include
-        m = re.search('^#include "(.+)"', line)
+        m = is_directive and RE_INCLUDE.search(line)
         if m:
             if len(glob.glob(m.group(1))) == 0:
                 print('%s:%d: file %s does not exist.' %
                       (filename, line_num, m.group(1)))
                 sys.exit(-1)
             if ('compile' == mode):
-                process_cli_file(m.group(1), root, mode, labels, last_cli_root, last_cli_end)
+                ops.append(('include', line_num, m.group(1)))
             elif ('mkdep' == mode):
                 deplist.append(m.group(1))
             elif ('preprocess' == mode):
-                process_cli_file(m.group(1), root, mode, labels, last_cli_root, last_cli_end)
+                process_cli_file(m.group(1), mode, labels)
             else:
                 print('%s:%d: unknown mode %s' % (filename, line_num, mode))
             continue
         # #submode
-        m = re.search('^#submode "(.+)"', line)
+        m = is_directive and RE_SUBMODE.search(line)
         if m:
-            cli_root_stack.append((last_cli_root, last_cli_end))
-            last_cli_root = Node('ROOT', '_' + m.group(1),
-                                    'Root of submode %s' % m.group(1), [])
-            last_cli_end.add_child(last_cli_root)
+            if ('compile' == mode):
+                ops.append(('submode', line_num, m.group(1)))
             continue
         # #endsubmode
-        m = re.search('^#endsubmode', line)
+        m = is_directive and RE_ENDSUBMODE.search(line)
         if m:
-            if len(cli_root_stack) == 0:
-                print('%s:%d: #endsubmode without a #submode.' %
-                      (filename, line_num))
-                sys.exit(-1)
-            else:
-                (last_cli_root, last_cli_end) = cli_root_stack.pop()
+            if ('compile' == mode):
+                ops.append(('endsubmode', line_num, None))
             continue
         # What survive must be either an empty line or a command
         if ('compile' == mode):
             try:
-                add_cli(last_cli_root, line, comment)
-                last_cli_end = end_node
+                ops.append(('cli', line_num, parse_cli(line, comment)))
             except ValueError, msg:
                 print('%s:%d: %s' % (filename, line_num, msg))
                 sys.exit(-1)
         elif ('preprocess' == mode):
             sys.stdout.write(line)
         comment = None
+    fin.close()
     if 'mkdep' == mode:
         sys.stdout.write('%s:' % filename)
         for d in deplist: sys.stdout.write(' %s' % d)
         sys.stdout.write('\n')
+    if 'compile' == mode:
+        return ops
+    return None
+
+##
+# \brief     Get the operations of one .cli file, from the cache if the file
+#            has not changed.
+#
+def load_cli_file(filename, labels, cache):
+    '''
+    Get the operations of a .cli file. See process_cli_file().
+
+    @param     filename Name of the .cli file.
+    @param     labels   A dictionary containing all defined labels.
+    @param     cache    A Cache object. None if there is no cache.
+
+    @return    A list of operations.
+    '''
+    if cache is None:
+        return process_cli_file(filename, 'compile', labels)
+    try:
+        fin = open(filename, 'rb')
+        data = fin.read()
+        fin.close()
+    except:
+        print 'Fail to open %s.' % filename
+        sys.exit(-1)
+    # The operations depend on the labels. Included files are keys of
+    # their own.
+    key = hashlib.sha1('%s\0%s\0' % (filename, ' '.join(sorted(labels))) +
+                       data).hexdigest()
+    ops = cache.get(key)
+    if ops is None:
+        ops = process_cli_file(filename, 'compile', labels)
+    cache.put(key, ops)
+    return ops
+
+##
+# \brief     Add the commands of one .cli file to the parse tree.
+#
+def compile_cli_file(filename, root, labels, cache, last_cli_root=None,
+                     last_cli_end=None):
+    '''
+    Add the commands of a .cli file and the files it includes to the 
+    parse tree.
+
+    @param     filename Name of the .cli file.
+    @param     root     Root Node object of the parse tree.
+    @param     labels   A dictionary containing all defined labels.
+    @param     cache    A Cache object. None if there is no cache.
+    @param     last_cli_root The most recent root node created.
+    @param     last_cli_end  The most recent end node visited.
+
+    @return    Return the root node.
+    '''
+    global end_node
+    global cli_root_stack
+
+    if last_cli_root is None:
+        last_cli_root = root
+    for (op, line_num, arg) in load_cli_file(filename, labels, cache):
+        if 'cli' == op:
+            if arg:
+                add_cli(last_cli_root, arg)
+            last_cli_end = end_node
+        elif 'include' == op:
+            compile_cli_file(arg, root, labels, cache, last_cli_root,
+                             last_cli_end)
+        elif 'submode' == op:
+            if last_cli_end is None:
+                print('%s:%d: #submode without a command.' %
+                      (filename, line_num))
+                sys.exit(-1)
+            cli_root_stack.append((last_cli_root, last_cli_end))
+            last_cli_root = Node('ROOT', '_' + arg,
+                                 'Root of submode %s' % arg, [])
+            last_cli_end.add_child(last_cli_root)
+        elif 'endsubmode' == op:
+            if len(cli_root_stack) == 0:
+                print('%s:%d: #endsubmode without a #submode.' %
+                      (filename, line_num))
+                sys.exit(-1)
+            else:
+                (last_cli_root, last_cli_end) = cli_root_stack.pop()
     return root
 
 def walker_gen_dbg(node, fout):
@@ -750,14 +1887,374 @@ def walker_gen_dbg(node, fout):
     node.display()
     fout.write('\n')
 
+## Banner of generated files
+GEN_BANNER = ('/*----------------------------------------------------------------------\n'
+              ' * This file is generated by mk_parser.py.\n'
+              ' *----------------------------------------------------------------------*/\n')
+
+## Headers of generated .c files
+GEN_INCLUDES = ('#include <assert.h>\n'
+                '#include <stdint.h>\n'
+                '#include <stdio.h>\n'
+                '#include <string.h>\n'
+                '#include "cparser.h"\n'
+                '#include "cparser_priv.h"\n'
+                '#include "cparser_token.h"\n'
+                '#include "cparser_codec.h"\n')
+
+class Cache(object):
+    '''
+    Cache of the operations of processed .cli files (see 
+    process_cli_file()) and of the shards written in incremental mode.
+    '''
+    def __init__(self, fname):
+        '''
+        Constructor. Load the cache file if it exists and is written by
+        this version of the script.
+
+        @param   fname Name of the cache file.
+        '''
+        fin = open(os.path.abspath(__file__.replace('.pyc', '.py')), 'rb')
+        ## Entries written by another version of the script are ignored
+        self.version = hashlib.sha1(fin.read()).hexdigest()
+        fin.close()
+        self.fname = fname
+        ## Operations of the last run keyed by file
+        self.files = {}
+        ## Operations of this run keyed by file
+        self.used = {}
+        ## Shards written by the last run
+        self.shards = []
+        try:
+            fin = open(fname, 'rb')
+            (version, files, shards) = cPickle.load(fin)
+            fin.close()
+            if version == self.version:
+                (self.files, self.shards) = (files, shards)
+        except:
+            pass
+
+    def get(self, key):
+        '''
+        @return  The operations of a file; None if they are not cached.
+        '''
+        return self.files.get(key)
+
+    def put(self, key, ops):
+        '''
+        Keep the operations of a file used in this run.
+        '''
+        self.used[key] = ops
+
+    def save(self, shards):
+        '''
+        Write the cache file. Files not used in this run are dropped.
+
+        @param   shards Names of the shards written in this run.
+        '''
+        if (set(self.used) == set(self.files)) and (shards == self.shards):
+            return
+        fout = open(self.fname, 'wb')
+        cPickle.dump((self.version, self.used, shards), fout, 2)
+        fout.close()
+
+def open_output(fname, mode='w'):
+    '''
+    Open an output file or exit.
+
+    @param   fname Name of the file.
+    @param   mode  Mode of open().
+
+    @return  A file object.
+    '''
+    try:
+        return open(fname, mode)
+    except:
+        print 'Fail to open %s.' % fname
+        sys.exit(-1)
+
+def write_if_changed(fname, data):
+    '''
+    Write a file unless it already has the same content. Its time stamp
+    is kept so make does not rebuild it.
+
+    @param   fname Name of the file.
+    @param   data  Content of the file.
+
+    @return  True if the file is written; False otherwise.
+    '''
+    try:
+        fin = open(fname, 'r')
+        same = (fin.read() == data)
+        fin.close()
+        if same:
+            return False
+    except IOError:
+        pass
+    fout = open_output(fname)
+    fout.write(data)
+    fout.close()
+    return True
+
+def write_glue_tbl(fout, cmds):
+    '''
+    Write the dispatch table of glue functions indexed by command ID.
+
+    @param   fout An output file object.
+    @param   cmds END nodes of all commands in the order of their IDs.
+    '''
+    fout.write('const cparser_glue_fn cparser_glue_tbl[] = {\n')
+    for n in cmds:
+        fout.write('    %s,\n' % n.param)
+    if len(cmds) == 0:
+        fout.write('    NULL\n')
+    fout.write('};\n\n')
+
+def assign_cmd_ids(cmds):
+    '''
+    Assign the ID of every command. It is the first 32 bits of the SHA-1
+    hash of its key (see Node.cmd_key()), so it does not depend on the 
+    other commands and does not change when they are added or removed.
+    It changes when the encoding of the arguments does. When an ID is 
+    taken by a command whose key sorts first, ":1", ":2", ... is 
+    appended to the key until the ID is free.
+
+    @param   cmds END nodes of all commands.
+    '''
+    sha1 = hashlib.sha1
+    unpack = struct.unpack
+    keys = [n.cmd_key() for n in cmds]
+    ids = set()
+    for (key, n) in zip(keys, cmds):
+        n.id = unpack('>I', sha1(key).digest()[:4])[0]
+        ids.add(n.id)
+    if len(ids) == len(cmds):
+        return
+
+    # Some IDs collide. Take them in the order of the keys.
+    ids = set()
+    for (key, n) in sorted(zip(keys, cmds)):
+        k = 0
+        n.id = unpack('>I', sha1(key).digest()[:4])[0]
+        while n.id in ids:
+            k += 1
+            n.id = unpack('>I', sha1('%s:%d' % (key, k)).digest()[:4])[0]
+        ids.add(n.id)
+
+def write_codec_tbl(fout, cmds):
+    '''
+    Write the table of the decode functions sorted by command ID.
+
+    @param   fout An output file object.
+    @param   cmds END nodes of all commands in the order of their IDs.
+    '''
+    for n in cmds:
+        fout.write('cparser_result_t %s(cparser_t *parser, const void *data,\n'
+                   '    size_t len);\n' % 
+                   n.param.replace('cparser_glue', 'cparser_dec'))
+    fout.write('\nconst cparser_codec_t cparser_codec_tbl[] = {\n')
+    for n in sorted(cmds, key=lambda n: n.cmd_id()):
+        fout.write('    { 0x%08xU, %d, %s,\n'
+                   '      %s, %s },\n' % 
+                   (n.cmd_id(), len(n.walk_up_to_root()), n.sibling_path(),
+                    n.param, n.param.replace('cparser_glue', 'cparser_dec')))
+    if len(cmds) == 0:
+        fout.write('    { 0, 0, NULL, NULL, NULL }\n')
+    fout.write('};\n\n')
+
+def write_h_file(fout, cmds, tree_decl):
+    '''
+    Write the header file of the parse tree.
+
+    @param   fout      An output file object.
+    @param   cmds      END nodes of all commands in the order of their IDs.
+    @param   tree_decl Declaration of the generated tree. None if the tree
+                       is not generated in C.
+    '''
+    fout.write(GEN_BANNER +
+               '#ifndef __CPARSER_TREE_H__\n' +
+               '#define __CPARSER_TREE_H__\n\n' +
+               '#ifdef __cplusplus\n' +
+               'extern "C" {\n' +
+               '#endif /* __cplusplus */\n\n' +
+               '#define CPARSER_NUM_GLUE %d\n' % len(cmds) +
+               '#define CPARSER_NUM_CODECS %d\n\n' % len(cmds) +
+               'extern const cparser_glue_fn cparser_glue_tbl[];\n' +
+               'extern const cparser_codec_t cparser_codec_tbl[];\n')
+    if tree_decl:
+        fout.write(tree_decl)
+    fout.write('\n')
+    for n in cmds:
+        n.action_fn(fout)
+        n.codec_decl(fout)
+    fout.write('\n#ifdef __cplusplus\n' +
+               '}\n' +
+               '#endif /* __cplusplus */\n' +
+               '\n#endif /* __CPARSER_TREE_H__ */\n')
+
+def assign_shards(root):
+    '''
+    Put every node but the root in a shard. The subtree of a top-level 
+    keyword or parameter is a shard. The subtree of a submode root is a
+    shard of its own.
+
+    @param   root Root Node object of the parse tree.
+
+    @return  A dictionary of the nodes of each shard in post-order keyed
+             by shard name.
+    '''
+    shards = {}
+    nodes = []
+    root.walk(lambda n,l: l.append(n), 'post-order', nodes)
+    for n in reversed(nodes):
+        # Parents are visited before their children
+        if n.parent is None:
+            continue
+        if 'ROOT' == n.type:
+            n.shard = 'sm' + n.path
+        elif n.parent.parent is None:
+            n.shard = 'kw' + n.path
+        else:
+            n.shard = n.parent.shard
+    for n in nodes:
+        if n.parent is not None:
+            shards.setdefault(n.shard, []).append(n)
+    return shards
+
+def write_extern(fout, nodes, shard):
+    '''
+    Declare the nodes referenced by some nodes but defined in other shards.
+
+    @param   fout  An output file object.
+    @param   nodes Nodes whose references are declared.
+    @param   shard Name of the shard being written.
+    '''
+    declared = set()
+    for n in nodes:
+        for r in (n.next, n.children and n.children[0]):
+            if r and (r.shard != shard) and (r.path not in declared):
+                fout.write('extern cparser_node_t cparser_node%s;\n' % r.path)
+                declared.add(r.path)
+    if declared:
+        fout.write('\n')
+
+def write_shards(root, cmds, out_dir, c_fname, has_nodes, packed, cache):
+    '''
+    Write the glue functions and the parse tree in shards. Each shard is a
+    .c file. Only shards whose content changed are written. A make file
+    fragment defines <BASE>_SRC (CPARSER_TREE_SRC for cparser_tree.c) as
+    the list of all .c files.
+
+    @param   root      Root Node object of the parse tree.
+    @param   cmds      END nodes of all commands in the order of their IDs.
+    @param   out_dir   Output directory.
+    @param   c_fname   Name of the main .c file.
+    @param   has_nodes True to generate the nodes as C structures.
+    @param   packed    A Packed object written into the main file. None 
+                       if the tree is not packed.
+    @param   cache     A Cache object.
+
+    @return  A tuple of the number of files and the number written.
+    '''
+    base = os.path.splitext(c_fname)[0]
+    shards = assign_shards(root)
+    names = [c_fname]
+    num_written = 0
+    for shard in sorted(shards.keys()):
+        nodes = shards[shard]
+        fout = cStringIO.StringIO()
+        fout.write(GEN_BANNER + GEN_INCLUDES + '\n')
+        # Action functions of the commands of the shard
+        shard_cmds = [n for n in cmds if n.shard == shard]
+        for n in shard_cmds:
+            n.action_fn(fout)
+        if shard_cmds:
+            fout.write('\n')
+        # Glue functions of partial END nodes may be in another shard
+        glue = set([n.param for n in nodes if 'END' == n.type])
+        glue -= set([n.param for n in shard_cmds])
+        for g in sorted(glue):
+            fout.write('cparser_result_t %s(cparser_t *parser);\n' % g)
+        if glue:
+            fout.write('\n')
+        if has_nodes:
+            write_extern(fout, nodes, shard)
+        for n in shard_cmds:
+            n.glue_fn(fout)
+            n.codec_fns(fout)
+        if has_nodes:
+            for n in nodes:
+                n.c_struct(fout)
+        fname = '%s_%s.c' % (base, shard)
+        names.append(fname)
+        if write_if_changed(os.path.join(out_dir, fname), fout.getvalue()):
+            num_written += 1
+
+    # The main file has the dispatch table and the root
+    fout = cStringIO.StringIO()
+    fout.write(GEN_BANNER + GEN_INCLUDES + '#include "cparser_tree.h"\n\n')
+    for n in cmds:
+        fout.write('cparser_result_t %s(cparser_t *parser);\n' % n.param)
+    fout.write('\n')
+    write_glue_tbl(fout, cmds)
+    write_codec_tbl(fout, cmds)
+    if packed:
+        packed.write(fout)
+    elif has_nodes:
+        write_extern(fout, [root], None)
+        root.c_struct(fout)
+    if write_if_changed(os.path.join(out_dir, c_fname), fout.getvalue()):
+        num_written += 1
+
+    # Remove the shards that are gone
+    for fname in cache.shards:
+        if fname not in names:
+            try:
+                os.remove(os.path.join(out_dir, fname))
+            except OSError:
+                pass
+    cache.save(names)
+
+    # The make file fragment is always written as its time stamp tells 
+    # make that the shards are up to date
+    fout = open_output(os.path.join(out_dir, base + '.mk'))
+    fout.write('# This file is generated by mk_parser.py.\n' +
+               base.upper() + '_SRC = ' + ' \\\n\t'.join(names) + '\n')
+    fout.close()
+    return (len(names), num_written)
+
+def c_tree_size(nodes):
+    '''
+    @param   nodes All Node objects of a parse tree.
+
+    @return  Size in bytes of the C structures of the parse tree on this 
+             host, with its list nodes and strings. Identical strings are
+             counted once as the compiler merges them.
+    '''
+    ptr_size = struct.calcsize('P')
+    strings = set()
+    size = 0
+    for n in nodes:
+        # Type, flags and uniq_len padded to a pointer and 4 pointers
+        size += 5 * ptr_size + 2 * ptr_size * len(n.list_kw)
+        strings.update([n.param_str()] + n.list_kw)
+        if n.desc_str:
+            strings.add(n.desc_str.decode('string_escape'))
+    strings.discard(None)
+    return size + sum([len(st) + 1 for st in strings])
+
 def main():
     '''Program entry point.'''
+    global arg_structs
     filelist = []
     labels = {}
     mode = 'compile'
     out_dir = '.'
     c_fname = 'cparser_tree.c'
     h_fname = 'cparser_tree.h'
+    b_fname = None
+    incremental = False
+    packed_mode = False
     # Parse input arguments
     sys.argv.pop(0) # remove mk_parser.py itself
     while (len(sys.argv) > 0):
@@ -775,68 +2272,125 @@ def main():
             c_fname = sys.argv.pop(0)
         elif '-i' == item:
             h_fname = sys.argv.pop(0)
+        elif '-b' == item:
+            b_fname = sys.argv.pop(0)
+        elif '-S' == item:
+            incremental = True
+        elif '-p' == item:
+            packed_mode = True
+        elif '-a' == item:
+            arg_structs = True
         else:
             filelist.append(item)
 
+    if b_fname and packed_mode:
+        print 'Cannot use -b with -p.'
+        sys.exit(-1)
+
+    # -P and -MM only read the .cli files
+    if 'compile' != mode:
+        for f in filelist:
+            if ('mkdep' != mode):
+                print('Processing %s...' % f)
+            process_cli_file(f, mode, labels)
+        return
+
+    # The parse tree lives until the script exits. There is nothing to
+    # collect but the garbage collector would scan it again and again as
+    # it grows.
+    gc.disable()
+
     # Process each file
+    cache = None
+    if incremental:
+        cache = Cache(os.path.join(out_dir, 
+                                   os.path.splitext(c_fname)[0] + '.cache'))
     root = Node('ROOT', '', 'Root node of the parser tree', [])
     for f in filelist:
-        if ('mkdep' != mode):
-            print('Processing %s...' % f)
-        root = process_cli_file(f, root, mode, labels)
+        print('Processing %s...' % f)
+        root = compile_cli_file(f, root, labels, cache)
     if print_tree:
         root.walk(walker_gen_dbg, 'pre-order', sys.stdout)
 
-    # Generate .c file that contains glue functions and parse tree
-    c_fname = out_dir + '/' + c_fname
-    try:
-        fout = open(c_fname, 'w')
-    except:
-        print 'Fail to open %s.' % c_fname
-        sys.exit(-1)
-    fout.write('/*----------------------------------------------------------------------\n' +
-               ' * This file is generated by mk_parser.py.\n' + 
-               ' *----------------------------------------------------------------------*/\n' +
-               '#include <assert.h>\n' +
-               '#include <stdint.h>\n' +
-               '#include <stdio.h>\n' +
-               '#include "cparser.h"\n' +
-               '#include "cparser_priv.h"\n' +
-               '#include "cparser_token.h"\n' +
-               '#include "cparser_tree.h"\n\n')    
-    n_cmds = root.walk(lambda n,f: f.write(n.glue_fn()), 'func', fout)
-    n_nodes = root.walk(lambda n,f: f.write(n.c_struct()), 'post-order', fout)
-    fout.close()
+    analyzer = Analyzer(root)
+    for msg in analyzer.warnings:
+        print 'Warning: %s' % msg
 
-    h_fname = out_dir + '/' + h_fname
-    try:
-        fout = open(h_fname, 'w')
-    except:
-        print 'Fail to open %s.' % h_fname
-        sys.exit(-1)
-    fout.write('/*----------------------------------------------------------------------\n' +
-               ' * This file is generated by mk_parser.py.\n' +
-               ' *----------------------------------------------------------------------*/\n' +
-               '#ifndef __CPARSER_TREE_H__\n' +
-               '#define __CPARSER_TREE_H__\n\n' +
-               '#ifdef __cplusplus\n' +
-               'extern "C" {\n' +
-               '#endif /* __cplusplus */\n\n' +
-               'extern cparser_node_t cparser_root;\n\n')
-    root.walk(lambda n,f: f.write(n.action_fn()), 'func', fout)
-    fout.write('\n#ifdef __cplusplus\n' +
-               '}\n' +
-               '#endif /* __cplusplus */\n' +
-               '\n#endif /* __CPARSER_TREE_H__ */\n')
-    fout.close()
+    # All nodes and the end nodes of all commands in the order of their 
+    # glue function table
+    nodes = []
+    n_nodes = root.walk(lambda n,l: l.append(n), 'pre-order', nodes)
+    cmds = [n for n in nodes if ('END' == n.type) and
+            ('CPARSER_NODE_FLAGS_OPT_PARTIAL' not in n.flags)]
+    n_cmds = len(cmds)
+    glue_ids = dict([(cmds[k].param, k) for k in range(len(cmds))])
+    assign_cmd_ids(cmds)
+
+    packed = None
+    if packed_mode:
+        packed = Packed(root, glue_ids)
+    if b_fname:
+        tree_decl = None
+    elif packed:
+        tree_decl = 'extern cparser_tree_t cparser_tree;\n'
+    else:
+        tree_decl = 'extern cparser_node_t cparser_root;\n'
+
+    if incremental:
+        (n_files, n_written) = write_shards(root, cmds, out_dir, c_fname,
+                                            not b_fname and not packed, 
+                                            packed, cache)
+    else:
+        # Generate .c file that contains glue functions and parse tree
+        fout = open_output(out_dir + '/' + c_fname)
+        fout.write(GEN_BANNER + GEN_INCLUDES + '#include "cparser_tree.h"\n\n')
+        for n in cmds:
+            n.glue_fn(fout)
+            n.codec_fns(fout)
+        write_glue_tbl(fout, cmds)
+        write_codec_tbl(fout, cmds)
+        if packed:
+            packed.write(fout)
+        elif not b_fname:
+            root.walk(lambda n,f: n.c_struct(f), 'post-order', fout)
+        fout.close()
+
+    if b_fname:
+        # The parse tree goes to the binary image
+        image = Image(root, glue_ids)
+        fbin = open_output(out_dir + '/' + b_fname, 'wb')
+        image.write(fbin)
+        fbin.close()
+
+    if incremental:
+        fout = cStringIO.StringIO()
+        write_h_file(fout, cmds, tree_decl)
+        write_if_changed(out_dir + '/' + h_fname, fout.getvalue())
+    else:
+        fout = open_output(out_dir + '/' + h_fname)
+        write_h_file(fout, cmds, tree_decl)
+        fout.close()
 
     # Print out a summary
     print '%d commands.' % n_cmds
-    print '%d parse tree nodes (%d bytes).' % (n_nodes, n_nodes * 24)
+    if b_fname:
+        print '%d parse tree nodes (%d bytes image).' % (n_nodes, image.size)
+    elif packed:
+        print '%d parse tree nodes (%d bytes, %d bytes of descriptions).' % \
+            (n_nodes, packed.size, packed.cold_size)
+    else:
+        print '%d parse tree nodes (%d bytes).' % (n_nodes, c_tree_size(nodes))
+    if incremental:
+        print '%d of %d files written.' % (n_written, n_files)
+    if analyzer.warnings:
+        print '%d warnings.' % len(analyzer.warnings)
 
     return
 
 # Entry point of the script
 if __name__ == '__main__':
     main()
-
+    # Python collects all garbage when it exits. With the parse tree it 
+    # takes seconds and there is nothing to free.
+    sys.stdout.flush()
+    os._exit(0)
@@ -1,21 +1,28 @@
 #!/usr/bin/env python
 
-import os
+import os, shutil, tempfile
 
 tests = [ 'test_unknown_token',
           'test_invalid_param1',
           'test_invalid_param2',
           'test_invalid_param3',
-          'test_invalid_keyword' ]
+          'test_invalid_keyword',
+          'test_overlap' ]
 
+# The files generated from .cli files that compile are not kept and the
+# size of the parse tree depends on the host
+out_dir = tempfile.mkdtemp()
 num_passed = 0
 num_failed = 0
 for t in tests:
-    if os.system('./../../scripts/mk_parser.py %s.cli | diff - %s.out' % (t, t)) == 0:
+    if os.system('./../../scripts/mk_parser.py -o %s %s.cli | '
+                 'grep -v "parse tree nodes" | diff - %s.out' %
+                 (out_dir, t, t)) == 0:
         print 'PASS: %s' % t
         num_passed += 1
     else:
         print 'FAIL: %s' %t
         num_failed += 1
+shutil.rmtree(out_dir)
 print 'Total=%d  Passed=%d  Failed=%d' % (num_passed + num_failed,
                                           num_passed, num_failed)
@@ -0,0 +1,200 @@
+/**
+ * \file     bench_filter.c
+ * \brief    Benchmark of the output filters.
+ * \details  A command prints 1M log lines. Its cost per line is measured
+ *           with the output discarded, written to /dev/null and piped 
+ *           through filters. The cost of the printing and the filters 
+ *           is reported per line, over the cost of the action. "| count"
+ *           must count all lines.
+ *
+ *           Usage: bench_filter [-n <lines>]
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+
+/** Output is discarded if the output file is this */
+#define BENCH_DISCARD  (-2)
+
+/** Output goes to this file. It is discarded if it is BENCH_DISCARD. */
+static int bench_fd = BENCH_DISCARD;
+/** The last count printed by "| count" */
+static char bench_count[64];
+
+/** Levels of the log lines */
+static const char *bench_levels[] = { "error", "info", "debug" };
+
+/**
+ * Glue function of "show log <UINT:n>". It prints n log lines.
+ */
+static cparser_result_t
+bench_log_glue (cparser_t *parser)
+{
+    uint32_t n = 0, k;
+    char buf[64];
+
+    (void)cparser_get_uint(&parser->tokens[2], &n);
+    for (k = 0; k < n; k++) {
+        snprintf(buf, sizeof(buf), "%u %s: event %u\n", k, 
+                 bench_levels[k % 3], k * 7);
+        parser->cfg.prints(parser, buf);
+    }
+    return CPARSER_OK;
+}
+
+static void
+bench_printc (const cparser_t *parser, const char ch)
+{
+    if (0 <= bench_fd) {
+        (void)write(bench_fd, &ch, 1);
+    }
+}
+
+static void
+bench_prints (const cparser_t *parser, const char *s)
+{
+    if (0 <= bench_fd) {
+        (void)write(bench_fd, s, strlen(s));
+    }
+    if (!strncmp(s, "Count: ", 7)) {
+        snprintf(bench_count, sizeof(bench_count), "%s", s);
+    }
+}
+
+static double
+bench_now (void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+/**
+ * Time "show log" with output filters and print the cost of the 
+ * printing or the filters per line, over the cost of the action.
+ *
+ * \return   Elapsed time in seconds.
+ */
+static double
+bench_cmd (cparser_t *parser, int num_lines, const char *what, 
+           const char *filters, double base)
+{
+    char cmd[64];
+    const char *ch;
+    double elapsed;
+
+    snprintf(cmd, sizeof(cmd), "show log %d%s\n", num_lines, filters);
+    elapsed = bench_now();
+    for (ch = cmd; *ch; ch++) {
+        cparser_input(parser, *ch, CPARSER_CHAR_REGULAR);
+    }
+    elapsed = bench_now() - elapsed;
+    printf("%-32s %7.1f ns/line\n", what, 
+           (elapsed - base) * 1e9 / num_lines);
+    return elapsed;
+}
+
+int
+main (int argc, char *argv[])
+{
+    cparser_t parser;
+    cparser_tree_t tree;
+    cparser_cfg_t cfg;
+    char expected[64];
+    double base;
+    int ch, num_lines = 1000000, fd;
+
+    while (-1 != (ch = getopt(argc, argv, "n:"))) {
+        switch (ch) {
+            case 'n':
+                num_lines = atoi(optarg);
+                break;
+            default:
+                printf("Usage: bench_filter [-n <lines>]\n");
+                return 2;
+        }
+    }
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.tree = &tree;
+    cfg.ch_complete = '\t';
+    cfg.ch_erase = '\b';
+    cfg.ch_del = 127;
+    cfg.ch_help = '?';
+    strcpy(cfg.prompt, "bench> ");
+    cfg.fd = -1;
+    cfg.printc = bench_printc;
+    cfg.prints = bench_prints;
+    cfg.flags = CPARSER_FLAGS_FILTER;
+
+    if ((CPARSER_OK != cparser_tree_init(&tree, NULL, NULL)) ||
+        (CPARSER_OK != cparser_tree_add(&tree, "show log <UINT:n>", 
+                                        bench_log_glue, NULL)) ||
+        (CPARSER_OK != cparser_init(&cfg, &parser))) {
+        printf("Fail to create the parser.\n");
+        return 1;
+    }
+    fd = open("/dev/null", O_WRONLY);
+    if (0 > fd) {
+        printf("Fail to open /dev/null.\n");
+        return 1;
+    }
+
+    printf("%d lines of output:\n", num_lines);
+    base = bench_cmd(&parser, num_lines, "Action only", "", 0.0);
+    bench_fd = fd;
+    (void)bench_cmd(&parser, num_lines, "Write to /dev/null", "", base);
+    (void)bench_cmd(&parser, num_lines, "| count", " | count", base);
+    snprintf(expected, sizeof(expected), "Count: %d lines\n", num_lines);
+    ch = strcmp(bench_count, expected);
+    (void)bench_cmd(&parser, num_lines, "| include error", 
+                    " | include error", base);
+    (void)bench_cmd(&parser, num_lines, "| include e(rr|x)or", 
+                    " | include e(rr|x)or", base);
+    close(fd);
+
+    cparser_fini(&parser);
+    cparser_tree_fini(&tree);
+    if (ch) {
+        printf("FAIL: %s\n", bench_count);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
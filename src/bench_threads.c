@@ -0,0 +1,332 @@
+/**
+ * \file     bench_threads.c
+ * \brief    Stress test and throughput benchmark of parsers in threads.
+ * \details  Each thread has its own parser over one shared parse tree and
+ *           feeds it a stream of command lines with abbreviations,
+ *           completion, help and errors. The glue function adds the
+ *           parameters of every command into a checksum of the thread,
+ *           which must be the same in all threads. The benchmark is run
+ *           with 1, 2, 4, ... threads and the throughput and the
+ *           speedup over one thread are reported.
+ *
+ *           Usage: bench_threads [-t <max threads>] [-n <lines/thread>]
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_image.h"
+
+#define BENCH_MAX_THREADS (64)
+
+/**
+ * \brief    State of a benchmark thread.
+ */
+typedef struct bench_thread_ {
+    pthread_t  thread;
+    cparser_t  parser;
+    int        first;    /**< First line of the stream */
+    int        num_lines; /**< Number of lines to feed */
+    uint64_t   sum;      /**< Checksum of the parameters of all commands */
+    uint32_t   num_cmds; /**< Number of commands run */
+    uint64_t   num_out;  /**< Number of characters printed */
+} bench_thread_t;
+
+/** Commands of the shared tree */
+static const char *bench_cmds[] = {
+    "show interface <STRING:name> { counters }",
+    "set interface <STRING:name> mtu <UINT:mtu>",
+    "set route <IPV4ADDR:prefix> <UINT:len> { via <IPV4ADDR:gw> }",
+    "clear counters { <LIST:all,errors,drops:what> }",
+    "debug mask <HEX64:mask>",
+    "set weight <INT:port> <FLOAT:weight>",
+    "show mac <MACADDR:mac>",
+    "+debug trace <UINT64:id> { <HEX:flags> }",
+    NULL
+};
+
+/** Command stream of each thread */
+static const char *bench_lines[] = {
+    "show interface eth0\n",
+    "sh int eth1 co\n",
+    "set interface ge-0/0/1 mtu 9000\n",
+    "set route 10.0.0.0 8\n",
+    "set ro 192.168.1.0 24 via 10.1.1.1\n",
+    "clear counters\n",
+    "clear counters err\t\n",
+    "debug mask 0xdeadbeefcafe\n",
+    "set weight -3 0.125\n",
+    "show mac 00:11:22:33:44:55\n",
+    "sh\tint\teth0 ?\n",
+    "show xyz\n",
+    "set interface eth0 mtu 99999999999\n",
+    "de\t?\n",
+    "set\b\b\bshow interface lo counters\n",
+    NULL
+};
+
+static cparser_tree_t bench_tree;
+static int bench_num_lines;
+static pthread_barrier_t bench_barrier;
+
+static bench_thread_t *
+bench_thread (const cparser_t *parser)
+{
+    return (bench_thread_t *)parser->context.cookie[0];
+}
+
+/**
+ * Glue function of all commands. The parameters are added to the
+ * checksum of the thread.
+ */
+static cparser_result_t
+bench_glue (cparser_t *parser)
+{
+    bench_thread_t *thread = bench_thread(parser);
+    cparser_node_type_t type;
+    const char *str;
+    uint64_t val;
+    int k;
+
+    for (k = 0; k < parser->token_tos; k++) {
+        type = parser->tokens[k].node->type;
+        val = 0;
+        if (!cparser_get_fn_tbl[type]) {
+            continue; /* keyword */
+        }
+        if ((CPARSER_NODE_STRING == type) || (CPARSER_NODE_LIST == type)) {
+            if (CPARSER_OK != cparser_get_fn_tbl[type](&parser->tokens[k],
+                                                       &str)) {
+                return CPARSER_NOT_OK;
+            }
+            for (; *str; str++) {
+                val = (val * 31) + (unsigned char)*str;
+            }
+        } else if (CPARSER_OK != cparser_get_fn_tbl[type](&parser->tokens[k],
+                                                          &val)) {
+            return CPARSER_NOT_OK;
+        }
+        thread->sum += (val ^ (k << 24)) * (type + 1);
+    }
+    thread->num_cmds++;
+    return CPARSER_OK;
+}
+
+static void
+bench_printc (const cparser_t *parser, const char ch)
+{
+    bench_thread(parser)->num_out++;
+}
+
+static void
+bench_prints (const cparser_t *parser, const char *s)
+{
+    bench_thread(parser)->num_out += strlen(s);
+}
+
+/**
+ * Thread entry. Run the stream from line 'first' after all threads
+ * are ready.
+ */
+static void *
+bench_run (void *arg)
+{
+    bench_thread_t *thread = (bench_thread_t *)arg;
+    const char *ch;
+    int n;
+
+    pthread_barrier_wait(&bench_barrier);
+    for (n = 0; n < thread->num_lines; n++) {
+        for (ch = bench_lines[(thread->first + n) % bench_num_lines]; *ch;
+             ch++) {
+            cparser_input(&thread->parser, *ch, CPARSER_CHAR_REGULAR);
+        }
+    }
+    return NULL;
+}
+
+static double
+bench_now (void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+/**
+ * Run the stream in 'num_threads' threads.
+ *
+ * \return   Elapsed time in seconds.
+ */
+static double
+bench_threads (bench_thread_t *threads, int num_threads, int num_lines)
+{
+    cparser_cfg_t cfg;
+    double start;
+    int n;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.tree = &bench_tree;
+    cfg.ch_complete = '\t';
+    cfg.ch_erase = '\b';
+    cfg.ch_del = 127;
+    cfg.ch_help = '?';
+    strcpy(cfg.prompt, "bench> ");
+    cfg.fd = -1;
+    cfg.printc = bench_printc;
+    cfg.prints = bench_prints;
+
+    pthread_barrier_init(&bench_barrier, NULL, num_threads + 1);
+    for (n = 0; n < num_threads; n++) {
+        memset(&threads[n], 0, sizeof(threads[n]));
+        threads[n].first = n;
+        threads[n].num_lines = num_lines;
+        if ((CPARSER_OK != cparser_init(&cfg, &threads[n].parser)) ||
+            (CPARSER_OK != cparser_set_root_context(&threads[n].parser,
+                                                    &threads[n])) ||
+            (CPARSER_OK != cparser_set_privileged_mode(&threads[n].parser,
+                                                       1)) ||
+            pthread_create(&threads[n].thread, NULL, bench_run,
+                           &threads[n])) {
+            printf("Fail to start thread %d.\n", n);
+            exit(1);
+        }
+    }
+    pthread_barrier_wait(&bench_barrier);
+    start = bench_now();
+    for (n = 0; n < num_threads; n++) {
+        pthread_join(threads[n].thread, NULL);
+    }
+    start = bench_now() - start;
+    for (n = 0; n < num_threads; n++) {
+        cparser_fini(&threads[n].parser);
+    }
+    pthread_barrier_destroy(&bench_barrier);
+    return start;
+}
+
+int
+main (int argc, char *argv[])
+{
+    static bench_thread_t threads[BENCH_MAX_THREADS];
+    bench_thread_t ref;
+    double elapsed, base = 0.0, rate;
+    int ch, max_threads = BENCH_MAX_THREADS, num_lines = 20000, n, k;
+    int num_failed = 0;
+
+    while (-1 != (ch = getopt(argc, argv, "t:n:"))) {
+        switch (ch) {
+            case 't':
+                max_threads = atoi(optarg);
+                break;
+            case 'n':
+                num_lines = atoi(optarg);
+                break;
+            default:
+                printf("Usage: bench_threads [-t <max threads>] "
+                       "[-n <lines/thread>]\n");
+                return 2;
+        }
+    }
+    if ((1 > max_threads) || (BENCH_MAX_THREADS < max_threads)) {
+        max_threads = BENCH_MAX_THREADS;
+    }
+
+    /* Every thread runs the whole stream the same number of times */
+    for (bench_num_lines = 0; bench_lines[bench_num_lines];
+         bench_num_lines++);
+    num_lines = ((num_lines + bench_num_lines - 1) / bench_num_lines) *
+        bench_num_lines;
+
+    if (CPARSER_OK != cparser_tree_init(&bench_tree, NULL, NULL)) {
+        printf("Fail to create the tree.\n");
+        return 1;
+    }
+    for (n = 0; bench_cmds[n]; n++) {
+        if (CPARSER_OK != cparser_tree_add(&bench_tree, bench_cmds[n],
+                                           bench_glue, NULL)) {
+            printf("Fail to add %s.\n", bench_cmds[n]);
+            return 1;
+        }
+    }
+
+    /* The reference checksum of one stream */
+    (void)bench_threads(threads, 1, bench_num_lines);
+    ref = threads[0];
+    ref.sum *= (num_lines / bench_num_lines);
+    ref.num_cmds *= (num_lines / bench_num_lines);
+    ref.num_out *= (num_lines / bench_num_lines);
+
+    printf("%d CPUs online, %d lines per thread\n",
+           (int)sysconf(_SC_NPROCESSORS_ONLN), num_lines);
+    printf("threads       lines/s  speedup  efficiency\n");
+    for (n = 1; ; n *= 2) {
+        if (n > max_threads) {
+            n = max_threads;
+        }
+        elapsed = bench_threads(threads, n, num_lines);
+        for (k = 0; k < n; k++) {
+            if ((threads[k].sum != ref.sum) ||
+                (threads[k].num_cmds != ref.num_cmds) ||
+                (threads[k].num_out != ref.num_out)) {
+                printf("FAIL: thread %d of %d: sum=%016llx cmds=%u "
+                       "out=%llu\n", k, n, (unsigned long long)threads[k].sum,
+                       threads[k].num_cmds,
+                       (unsigned long long)threads[k].num_out);
+                num_failed++;
+            }
+        }
+        rate = ((double)n * num_lines) / elapsed;
+        if (1 == n) {
+            base = rate;
+        }
+        printf("%7d  %12.0f  %7.2f  %9.0f%%\n", n, rate, rate / base,
+               100.0 * rate / base / n);
+        if (n == max_threads) {
+            break;
+        }
+    }
+
+    cparser_tree_fini(&bench_tree);
+    if (num_failed) {
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -32,6 +32,7 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <limits.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
@@ -40,11 +41,15 @@
 #include "cparser_token.h"
 #include "cparser_io.h"
 #include "cparser_fsm.h"
+#include "cparser_filter.h"
 
 void
 cparser_print_prompt (const cparser_t *parser)
 {
     assert(parser);
+    if (parser->cfg.flags & CPARSER_FLAGS_BATCH) {
+        return;
+    }
     if (cparser_is_in_privileged_mode(parser)) {
         parser->cfg.printc(parser, '+');
     }
@@ -82,11 +87,11 @@ cparser_help_print_node (cparser_t *parser, cparser_node_t *node,
             break;
         case CPARSER_NODE_LIST:
             parser->cfg.prints(parser, "[ ");
-            cparser_list_node_t *lnode = (cparser_list_node_t *)node->param;
+            cparser_list_node_t *lnode = NODE_PARAM(node);
             assert(lnode);
             while (lnode) {
-                parser->cfg.prints(parser, lnode->keyword);
-                lnode = lnode->next;
+                parser->cfg.prints(parser, LIST_NODE_KEYWORD(node, lnode));
+                lnode = LIST_NODE_NEXT(node, lnode);
                 if (lnode) {
                     parser->cfg.prints(parser, " | ");
                 }
@@ -94,10 +99,10 @@ cparser_help_print_node (cparser_t *parser, cparser_node_t *node,
             parser->cfg.prints(parser, " ]");
             break;
         default:
-            parser->cfg.prints(parser, node->param);
-            if (print_desc && node->desc) {
+            parser->cfg.prints(parser, NODE_PARAM(node));
+            if (print_desc && NODE_DESC(parser->cfg.tree, node)) {
                 parser->cfg.prints(parser, " - ");
-                parser->cfg.prints(parser, node->desc);
+                parser->cfg.prints(parser, NODE_DESC(parser->cfg.tree, node));
             }
             break;
     }
@@ -156,6 +161,36 @@ cparser_is_user_input (cparser_t *parser, int *do_echo)
     return 0;
 }
 
+/**
+ * \brief    Call the callback of a completed user input.
+ * \details  The user input state is reset first so the callback can
+ *           ask for another input.
+ *
+ * \param    parser Pointer to the parser structure.
+ *
+ * \return   Return code of the callback.
+ */
+static cparser_result_t
+cparser_user_input_done (cparser_t *parser)
+{
+    cparser_input_cb cb = parser->user_input_cb;
+    char *buf = parser->user_buf;
+    int count = parser->user_buf_count, was_pending = parser->pending;
+    int do_echo;
+    cparser_result_t rc;
+
+    assert(cb && buf);
+    buf[count] = '\0';
+    cparser_input_reset(parser);
+    rc = cb(parser, buf, count);
+
+    /* A pending command prints the prompt when it completes */
+    if (!was_pending && !cparser_is_user_input(parser, &do_echo)) {
+        cparser_print_prompt(parser);
+    }
+    return rc;
+}
+
 static void
 cparser_record_command (cparser_t *parser, cparser_result_t rc)
 {
@@ -165,17 +200,129 @@ cparser_record_command (cparser_t *parser, cparser_result_t rc)
     parser->last_line_idx = CURRENT_LINE(parser);
     parser->last_rc = rc;
     parser->last_end_node = parser->cur_node;
+    if (parser->cfg.record) {
+        parser->cfg.record(parser);
+    }
 }
 
 /**
- * \brief    If the command is not complete, attempt to complete the command.
- *           If there is a complete comamnd, execute the glue (& action)
- *           function of a command.
+ * \brief    Push a completed token into the token stack by entering a space.
  *
  * \param    parser Pointer to the parser structure.
  *
- * \return   CPARSER_OK if a valid command is executed; CPARSER_NOT_OK
- *           otherwise.
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_OUT_OF_RES if the line
+ *           is too full for the completed token.
+ */
+static cparser_result_t
+cparser_push_completed (cparser_t *parser)
+{
+    short token_tos = parser->token_tos;
+    cparser_result_t rc;
+
+    rc = cparser_input(parser, ' ', CPARSER_CHAR_REGULAR);
+    assert(CPARSER_OK == rc);
+    if (parser->token_tos == token_tos) {
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    return CPARSER_OK;
+}
+
+/**
+ * \brief    Complete the last token of a command and the keywords that
+ *           must follow it.
+ * \details  If we are in TOKEN state, we check if we have an unique
+ *           match and complete it. Then, while there is only one child
+ *           of keyword type, we recurse into it. Nothing is done in 
+ *           ERROR state; cparser_execute_cmd() reports it.
+ *
+ * \param    parser Pointer to the parser structure.
+ *
+ * \return   CPARSER_OK if the command can be executed by 
+ *           cparser_execute_cmd(); CPARSER_ERR_INCOMP_CMD or
+ *           CPARSER_ERR_OUT_OF_RES otherwise. In that case, the error
+ *           is printed and the parser FSM is reset.
+ */
+static cparser_result_t
+cparser_complete_cmd (cparser_t *parser)
+{
+    cparser_node_t *child;
+    cparser_result_t rc = CPARSER_OK;
+
+    assert(VALID_PARSER(parser));
+    if ((CPARSER_STATE_TOKEN != parser->state) &&
+        (CPARSER_STATE_WHITESPACE != parser->state) &&
+        (CPARSER_STATE_FILTER != parser->state)) {
+        return CPARSER_OK;
+    }
+
+    if (CPARSER_STATE_TOKEN == parser->state) {
+        cparser_token_t *token;
+        cparser_node_t *match;
+        int is_complete;
+
+        token = CUR_TOKEN(parser);
+        if ((1 <= cparser_match(parser, token->buf, token->token_len,
+                                parser->cur_node, &match,
+                                &is_complete)) &&
+            (is_complete)) {
+            cparser_complete_fn fn = cparser_complete_fn_tbl[match->type];
+            if (fn) {
+                fn(parser, match, token->buf, token->token_len);
+            }
+            rc = cparser_push_completed(parser);
+        } else {
+            rc = CPARSER_ERR_INCOMP_CMD;
+        }
+        if (CPARSER_OK != rc) {
+            cparser_print_error(parser, 
+                                ((CPARSER_ERR_INCOMP_CMD == rc) ?
+                                 "Incomplete command\n" :
+                                 "Line too long\n"));
+
+            /* Reset the internal buffer, state and cur_node */
+            cparser_record_command(parser, rc);
+            cparser_fsm_reset(parser);
+            cparser_print_prompt(parser);
+            return rc;
+        }
+    }
+
+    /* 
+     * Look for a single keyword node child. Completing it would 
+     * insert it after the filters.
+     */
+    child = NODE_CHILDREN(parser->cur_node);
+    assert(child);
+    while ((CPARSER_STATE_FILTER != parser->state) &&
+           (CPARSER_NODE_KEYWORD == child->type) &&
+           NODE_USABLE(parser, child) && (!NODE_SIBLING(child))) {
+        cparser_token_t *token = CUR_TOKEN(parser);
+        cparser_complete_keyword(parser, child, token->buf, token->token_len);
+        rc = cparser_push_completed(parser);
+        if (CPARSER_OK != rc) {
+            /* Do not execute a shorter command */
+            cparser_print_error(parser, "Line too long\n");
+            cparser_record_command(parser, rc);
+            cparser_fsm_reset(parser);
+            cparser_print_prompt(parser);
+            return rc;
+        }
+
+        child = NODE_CHILDREN(parser->cur_node);
+        assert(child);
+    }
+    return CPARSER_OK;
+}
+
+/**
+ * \brief    Execute the glue (& action) function of a complete command.
+ * \details  The command must be completed by cparser_complete_cmd()
+ *           first.
+ *
+ * \param    parser Pointer to the parser structure.
+ *
+ * \return   CPARSER_OK if a valid command is executed; CPARSER_PENDING
+ *           if its action is pending; CPARSER_NOT_OK otherwise.
  */
 static cparser_result_t
 cparser_execute_cmd (cparser_t *parser)
@@ -185,75 +332,24 @@ cparser_execute_cmd (cparser_t *parser)
     assert(VALID_PARSER(parser));
 
     /*
-     * Enter a command. There are three possibilites:
-     * 1. If we are in WHITESPACE state, we check if there is
-     *    only one child of keyword type. If yes, we recurse
-     *    into it and repeat until either: a) there is more than
-     *    one choice, b) We are at a END node. If there is more
-     *    than one choice, we look for an END node. In either
-     *    case, if an END node is found, we execute the action
-     *    function.
+     * Enter a command. There are two possibilites:
+     * 1. If we are in WHITESPACE, TOKEN or FILTER state, we look for 
+     *    an END node. If one is found, we execute the action function.
      *
-     * 2. If we are in TOKEN state, we check if we have an unique
-     *    match. If yes, re recurse into it and repeat just
-     *    like WHITESPACE state until we find an END node.
+     * 2. If we are in ERROR state, we print out an error.
      *
-     * 3. If we are in ERROR state, we print out an error.
-     *
-     * Afterward, we reset the parser state and move to the
-     * next line buffer.
+     * Afterward, we reset the parser state.
      */
     if ((CPARSER_STATE_TOKEN == parser->state) ||
-        (CPARSER_STATE_WHITESPACE == parser->state)) {
+        (CPARSER_STATE_WHITESPACE == parser->state) ||
+        (CPARSER_STATE_FILTER == parser->state)) {
         cparser_node_t *child;
 
-        if (CPARSER_STATE_TOKEN == parser->state) {
-            cparser_token_t *token;
-            cparser_node_t *match;
-            int is_complete;
-
-            token = CUR_TOKEN(parser);
-            if ((1 <= cparser_match(parser, token->buf, token->token_len,
-                                    parser->cur_node, &match,
-                                    &is_complete)) &&
-                (is_complete)) {
-                cparser_complete_fn fn = cparser_complete_fn_tbl[match->type];
-                if (fn) {
-                    fn(parser, match, token->buf, token->token_len);
-                }
-                rc = cparser_input(parser, ' ', CPARSER_CHAR_REGULAR);
-                assert(CPARSER_OK == rc);
-            } else {
-                cparser_print_error(parser, "Incomplete command\n");
-                rc = CPARSER_ERR_INCOMP_CMD;
-
-                /* Reset the internal buffer, state and cur_node */
-                cparser_record_command(parser, rc);
-                cparser_fsm_reset(parser);
-                cparser_print_prompt(parser);
-                return rc;
-            }
-        }
-
-        /* Look for a single keyword node child */
-        child = parser->cur_node->children;
-        assert(child);
-        while ((CPARSER_NODE_KEYWORD == child->type) &&
-               NODE_USABLE(parser, child) && (!child->sibling)) {
-            cparser_token_t *token = CUR_TOKEN(parser);
-            cparser_complete_keyword(parser, child, token->buf, token->token_len);
-            rc = cparser_input(parser, ' ', CPARSER_CHAR_REGULAR);
-            assert(CPARSER_OK == rc);
-
-            child = parser->cur_node->children;
-            assert(child);
-        }
-
         /* Look for an end node */
-        child = parser->cur_node->children;
+        child = NODE_CHILDREN(parser->cur_node);
         while ((NULL != child) &&
                !((CPARSER_NODE_END == child->type) && NODE_USABLE(parser, child))) {
-            child = child->sibling;
+            child = NODE_SIBLING(child);
         }
         if (child) {
             assert(CPARSER_NODE_END == child->type);
@@ -261,9 +357,35 @@ cparser_execute_cmd (cparser_t *parser)
             /* Execute the glue function */
             parser->cur_node = child;
             parser->cfg.printc(parser, '\n');
-            rc = ((cparser_glue_fn)child->param)(parser);
+            if ((CPARSER_STATE_FILTER == parser->state) &&
+                (CPARSER_OK != cparser_filter_start(parser, 
+                                                    parser->last_good + 1))) {
+                parser->cfg.prints(parser, "Invalid output filter\n");
+                cparser_record_command(parser, CPARSER_ERR_PARSE_ERR);
+                cparser_fsm_reset(parser);
+                cparser_print_prompt(parser);
+                return CPARSER_ERR_PARSE_ERR;
+            }
+            parser->async_seq++;
+            if (parser->cfg.exec) {
+                rc = parser->cfg.exec(parser, NODE_GLUE(parser, child));
+            } else {
+                rc = NODE_GLUE(parser, child)(parser);
+            }
+            if (CPARSER_PENDING == rc) {
+                /* 
+                 * The tokens are kept for the action. 
+                 * cparser_complete_async() resets the FSM and prints 
+                 * the prompt.
+                 */
+                cparser_record_command(parser, rc);
+                parser->pending = 1;
+                return rc;
+            }
+            cparser_filter_stop(parser, 1);
         } else {
-            if (parser->token_tos) {
+            if (parser->token_tos || 
+                (CPARSER_STATE_FILTER == parser->state)) {
                 cparser_print_error(parser, "Incomplete command\n");
                 rc = CPARSER_ERR_INCOMP_CMD;
             }
@@ -292,35 +414,57 @@ cparser_execute_cmd (cparser_t *parser)
     return rc;
 }
 
-static cparser_result_t
-cparser_match_prefix (const cparser_t *parser, const char *token,
-                      const int token_len, const cparser_node_t *parent,
-                      const char ch, const int offset)
+/**
+ * \brief    Find how much of a partial keyword can be completed.
+ *
+ * \param    parser      Pointer to the parser structure.
+ * \param    token       The partial token.
+ * \param    token_len   Length of the token.
+ * \param    parent      Node whose children are matched.
+ * \param    match       The match returned by cparser_match().
+ * \param    num_matches Number of matches returned by cparser_match().
+ *
+ * \return   Length of the prefix common to all keywords that match the 
+ *           token. 'token_len' if a parameter matches as well.
+ */
+static int
+cparser_match_lcp (const cparser_t *parser, const char *token,
+                   const int token_len, const cparser_node_t *parent,
+                   const cparser_node_t *match, const int num_matches)
 {
-    int local_is_complete;
+    int local_is_complete, n, lcp;
     cparser_node_t *child;
-    cparser_result_t rc;
+    const char *kw, *other;
 
-    assert(parent && ch);
-    for (child = parent->children; NULL != child; child = child->sibling) {
-        if (!NODE_USABLE(parser, child)) {
+    assert(parent && match);
+    if (CPARSER_NODE_KEYWORD != match->type) {
+        return token_len;
+    }
+    kw = NODE_PARAM(match);
+    lcp = strlen(kw);
+    if ((1 < num_matches) && match->uniq_len) {
+        /* It shares no more than 'uniq_len' - 1 characters with others */
+        lcp = match->uniq_len - 1;
+    }
+    for (child = NODE_CHILDREN(parent); 
+         (NULL != child) && (lcp > token_len);
+         child = NODE_SIBLING(child)) {
+        if ((child == match) || !NODE_USABLE(parser, child)) {
             continue;
         }
-        rc = cparser_match_fn_tbl[child->type](token, token_len, child,
-                                               &local_is_complete);
-        if (CPARSER_NOT_OK == rc) {
+        if (CPARSER_OK != 
+            cparser_match_fn_tbl[child->type](token, token_len, child,
+                                              &local_is_complete)) {
             continue;
         }
         if (CPARSER_NODE_KEYWORD != child->type) {
-            return CPARSER_NOT_OK;
-        }
-
-        /* There is a match. Make sure that it is part of this node as well */
-        if (*((char *)child->param + offset) != ch) {
-            return CPARSER_NOT_OK;
+            return token_len;
         }
+        other = NODE_PARAM(child);
+        for (n = token_len; (n < lcp) && (kw[n] == other[n]); n++);
+        lcp = n;
     }
-    return CPARSER_OK;
+    return lcp;
 }
 
 /**
@@ -338,26 +482,30 @@ cparser_help (cparser_t *parser)
     assert(VALID_PARSER(parser));
     if (CPARSER_STATE_WHITESPACE == parser->state) {
         /* Just print out every children */
-        for (node = parser->cur_node->children; NULL != node;
-             node = node->sibling) {
+        for (node = NODE_CHILDREN(parser->cur_node); NULL != node;
+             node = NODE_SIBLING(node)) {
             cparser_help_print_node(parser, node, 1, 1);
         }
+    } else if (CPARSER_STATE_FILTER == parser->state) {
+        parser->cfg.prints(parser, "\ninclude <pattern> - Lines that match"
+                           "\nexclude <pattern> - Lines that do not match"
+                           "\nbegin <pattern> - Lines from the first match"
+                           "\ncount - Count the lines");
     } else if (CPARSER_STATE_ERROR == parser->state) {
         /*
          * We have some problem parsing. Just print out the last known
          * good parse point and list the valid options.
          */
         cparser_print_error(parser, "Last known good parse point.");
-        for (node = parser->cur_node->children; NULL != node;
-             node = node->sibling) {
+        for (node = NODE_CHILDREN(parser->cur_node); NULL != node;
+             node = NODE_SIBLING(node)) {
             cparser_help_print_node(parser, node, 1, 1);
         }
     } else {
         /* We have a partial match */
-        node = parser->cur_node->children;
         token = CUR_TOKEN(parser);
-        for (node = parser->cur_node->children; NULL != node;
-             node = node->sibling) {
+        for (node = NODE_CHILDREN(parser->cur_node); NULL != node;
+             node = NODE_SIBLING(node)) {
             if (!NODE_USABLE(parser, node)) {
                 continue;
             }
@@ -390,14 +538,18 @@ cparser_complete_one_level (cparser_t *parser)
 
     switch (parser->state) {
         case CPARSER_STATE_ERROR:
-            /* If we are in ERROR, there cannot be a match. So, just quit */
+        case CPARSER_STATE_FILTER:
+            /* 
+             * If we are in ERROR, there cannot be a match. Filters are
+             * not completed. So, just quit.
+             */
             parser->cfg.printc(parser, '\a');
             break;
         case CPARSER_STATE_WHITESPACE:
-            if (parser->cur_node && parser->cur_node->children &&
-                !parser->cur_node->children->sibling &&
-                (CPARSER_NODE_KEYWORD == parser->cur_node->children->type)) {
-                ch_ptr = parser->cur_node->children->param;
+            match = (parser->cur_node ? NODE_CHILDREN(parser->cur_node) : NULL);
+            if (match && !NODE_SIBLING(match) &&
+                (CPARSER_NODE_KEYWORD == match->type)) {
+                ch_ptr = NODE_PARAM(match);
                 while (*ch_ptr) {
                     rc = cparser_input(parser, *ch_ptr, CPARSER_CHAR_REGULAR);
                     assert(CPARSER_OK == rc);
@@ -435,26 +587,23 @@ cparser_complete_one_level (cparser_t *parser)
 
                 keep_going = 1;
             } else {
-                int offset, orig_offset;
+                int offset, orig_offset, lcp;
                 /*
                  * If we have more than one match, we should try to complete
-                 * as much as possible. To do that, we grab the node in the
-                 * (first) matched node and check that the next character
-                 * from it is common among all matched nodes. If it is common
-                 * to all matched nodes, we continue to feed them into the
-                 * parser. However, this is only useful for keywords. If there
-                 * is a parameter token in the match, we automatically abort.
+                 * as much as possible. To do that, we find the prefix 
+                 * common to all matched nodes and feed the rest of it into
+                 * the parser. However, this is only useful for keywords. If
+                 * there is a parameter token in the match, we automatically
+                 * abort.
                  */
                 offset = orig_offset = token->token_len;
-                ch_ptr = match->param + token->token_len;
-                while (('\0' != *ch_ptr) &&
-                       (CPARSER_OK ==
-                        cparser_match_prefix(parser, token->buf, token->token_len,
-                                             parser->cur_node, *ch_ptr,
-                                             offset))) {
-                    rc = cparser_input(parser, *ch_ptr, CPARSER_CHAR_REGULAR);
+                lcp = cparser_match_lcp(parser, token->buf, token->token_len,
+                                        parser->cur_node, match, num_matches);
+                ch_ptr = (char *)NODE_PARAM(match);
+                while (offset < lcp) {
+                    rc = cparser_input(parser, ch_ptr[offset], 
+                                       CPARSER_CHAR_REGULAR);
                     assert(CPARSER_OK == rc);
-                    ch_ptr++;
                     offset++;
                 }
                 if (orig_offset == offset) {
@@ -470,16 +619,80 @@ cparser_complete_one_level (cparser_t *parser)
     return keep_going;
 }
 
+/**
+ * \brief    Bring the parser FSM in sync with the current line after the 
+ *           line is replaced.
+ * \details  The parser FSM state saved with the line is restored. If there
+ *           is none, the line is entered into the parser FSM again.
+ *
+ * \param    parser Pointer to the parser structure.
+ */
+static void
+cparser_reparse_line (cparser_t *parser)
+{
+    int n;
+    cparser_result_t rc;
+
+    if (CPARSER_OK == cparser_line_load_state(parser)) {
+        return;
+    }
+    cparser_fsm_reset(parser);
+    for (n = 0; n < cparser_line_current(parser); n++) {
+        rc = cparser_fsm_input(parser, cparser_line_char(parser, n));
+        assert(CPARSER_OK == rc);
+    }
+}
+
+/**
+ * \brief    Move the cursor to the end of the line and put the rest of the
+ *           line into the parser FSM.
+ * \details  Characters are entered one by one until the parser FSM can
+ *           resume from the state saved in the line. So, only tokens
+ *           affected by an edit are matched again.
+ *
+ * \param    parser Pointer to the parser structure.
+ */
+static void
+cparser_input_to_end (cparser_t *parser)
+{
+    char ch;
+    cparser_result_t rc;
+
+    do {
+        (void)cparser_line_fast_forward(parser);
+        ch = cparser_line_next_char(parser);
+        if (ch) {
+            rc = cparser_fsm_input(parser, ch);
+            assert(CPARSER_OK == rc);
+        }
+    } while (ch);
+}
+
 cparser_result_t
 cparser_input (cparser_t *parser, char ch, cparser_char_t ch_type)
 {
-    int n, do_echo;
+    int do_echo;
     cparser_result_t rc;
 
     if (!VALID_PARSER(parser)) {
         return CPARSER_ERR_INVALID_PARAMS;
     }
 
+    if (parser->pending && !parser->user_buf) {
+        /* Keep the input until the command completes */
+        int tail;
+
+        if (parser->queue_count >= parser->cfg.max_queue_size) {
+            return CPARSER_ERR_OUT_OF_RES;
+        }
+        tail = (parser->queue_head + parser->queue_count) % 
+            parser->cfg.max_queue_size;
+        parser->queue_ch[tail] = ch;
+        parser->queue_type[tail] = (uint8_t)ch_type;
+        parser->queue_count++;
+        return CPARSER_OK;
+    }
+
     if (cparser_is_user_input(parser, &do_echo)) {
         /* Process user input */
         if (CPARSER_CHAR_REGULAR != ch_type) {
@@ -487,13 +700,7 @@ cparser_input (cparser_t *parser, char ch, cparser_char_t ch_type)
         }
         if ('\n' == ch) {
             /* We have a complete input. Call the callback. */
-            assert(parser->user_input_cb);
-            parser->user_buf[parser->user_buf_count] = '\0';
-            rc = parser->user_input_cb(parser, parser->user_buf,
-                                       parser->user_buf_count);
-            cparser_input_reset(parser);
-            cparser_print_prompt(parser);
-            return rc;
+            return cparser_user_input_done(parser);
         }
 
         if ((parser->cfg.ch_erase == ch) || (parser->cfg.ch_del == ch)) {
@@ -513,6 +720,50 @@ cparser_input (cparser_t *parser, char ch, cparser_char_t ch_type)
         return CPARSER_OK;
     }
 
+    if (parser->search_active) {
+        /* Process reverse incremental search */
+        if (CPARSER_CHAR_SEARCH == ch_type) {
+            (void)cparser_line_search_input(parser, 0);
+            return CPARSER_OK;
+        }
+        if ((CPARSER_CHAR_REGULAR == ch_type) && ('\n' != ch) &&
+            (parser->cfg.ch_complete != ch) && (parser->cfg.ch_help != ch)) {
+            (void)cparser_line_search_input(parser, ch);
+            return CPARSER_OK;
+        }
+
+        /* 
+         * Any other key accepts the match and is then processed as 
+         * usual. An unknown key cancels the search.
+         */
+        if (CPARSER_CHAR_UNKNOWN == ch_type) {
+            rc = cparser_line_search_stop(parser, 0);
+            assert(CPARSER_OK == rc);
+            return CPARSER_OK;
+        }
+        rc = cparser_line_search_stop(parser, 1);
+        assert(CPARSER_OK == rc);
+        cparser_reparse_line(parser);
+    }
+
+    if (parser->loading && (CPARSER_CHAR_REGULAR == ch_type) &&
+        ('\n' != ch) && (parser->cfg.ch_complete != ch) &&
+        (parser->cfg.ch_help != ch)) {
+        /* 
+         * A completion while loading a command file goes to the parser
+         * FSM only, like the rest of the file.
+         */
+        return cparser_fsm_input(parser, ch);
+    }
+
+    if (parser->cfg.handle && !parser->root_level &&
+        (parser->tree_ver != 
+         __atomic_load_n(&parser->cfg.handle->cur, __ATOMIC_SEQ_CST)) &&
+        !cparser_line_last(parser)) {
+        /* A new line starts with the newest tree */
+        cparser_fsm_reset(parser);
+    }
+
     switch (ch_type) {
         case CPARSER_CHAR_REGULAR:
         {
@@ -531,14 +782,16 @@ cparser_input (cparser_t *parser, char ch, cparser_char_t ch_type)
                     return CPARSER_OK;
                 }
             } else if ('\n' == ch) {
-                /* Put the rest of the line into parser FSM */
-                for (n = cparser_line_current(parser);
-                     n < cparser_line_last(parser); n++) {
-                    rc = cparser_fsm_input(parser, cparser_line_char(parser, n));
-                    assert(CPARSER_OK == rc);
-                }
-            } else {
-                (void)cparser_line_insert(parser, ch);
+                /*
+                 * Move to the end of the line and put the rest of the line 
+                 * into parser FSM. Completing the last token may append
+                 * a space and it must go to the end of the line.
+                 */
+                cparser_input_to_end(parser);
+            } else if (CPARSER_OK != cparser_line_insert(parser, ch)) {
+                /* The line is full */
+                parser->cfg.printc(parser, '\a');
+                return CPARSER_OK;
             }
             break;
         }
@@ -547,13 +800,8 @@ cparser_input (cparser_t *parser, char ch, cparser_char_t ch_type)
             rc = cparser_line_prev_line(parser);
             assert(CPARSER_OK == rc);
 
-            /* Reset the token stack and re-enter the command */
-            cparser_fsm_reset(parser);
-            for (n = 0; n < cparser_line_current(parser); n++) {
-                rc = cparser_fsm_input(parser, cparser_line_char(parser, n));
-                assert(CPARSER_OK == rc);
-            }
-
+            /* Restore the token stack of the command */
+            cparser_reparse_line(parser);
             return CPARSER_OK;
         }
         case CPARSER_CHAR_DOWN_ARROW:
@@ -561,13 +809,8 @@ cparser_input (cparser_t *parser, char ch, cparser_char_t ch_type)
             rc = cparser_line_next_line(parser);
             assert(CPARSER_OK == rc);
 
-            /* Reset the token stack and re-enter the command */
-            cparser_fsm_reset(parser);
-            for (n = 0; n < cparser_line_current(parser); n++) {
-                rc = cparser_fsm_input(parser, cparser_line_char(parser, n));
-                assert(CPARSER_OK == rc);
-            }
-
+            /* Restore the token stack of the command */
+            cparser_reparse_line(parser);
             return CPARSER_OK;
         }
         case CPARSER_CHAR_LEFT_ARROW:
@@ -590,22 +833,25 @@ cparser_input (cparser_t *parser, char ch, cparser_char_t ch_type)
         }
         case CPARSER_CHAR_FIRST:
         {
-            do {
-                ch = cparser_line_prev_char(parser);
-                if (ch) {
-                    cparser_fsm_input(parser, ch);
-                }
-            } while (ch);
+            /* 
+             * The parser FSM state is saved in the line before the cursor
+             * moves. At the beginning of the line, the parser FSM is
+             * simply reset.
+             */
+            while (cparser_line_prev_char(parser));
+            cparser_fsm_reset(parser);
             return CPARSER_OK;
         }
         case CPARSER_CHAR_LAST:
         {
-            do {
-                ch = cparser_line_next_char(parser);
-                if (ch) {
-                    cparser_fsm_input(parser, ch);
-                }
-            } while (ch);
+            cparser_input_to_end(parser);
+            return CPARSER_OK;
+        }
+        case CPARSER_CHAR_SEARCH:
+        {
+            if (CPARSER_OK != cparser_line_search_start(parser)) {
+                parser->cfg.printc(parser, '\a');
+            }
             return CPARSER_OK;
         }
         default:
@@ -625,7 +871,15 @@ cparser_input (cparser_t *parser, char ch, cparser_char_t ch_type)
         cparser_help(parser);
         return CPARSER_OK;
     } else if ('\n' == ch) {
-        rc = cparser_execute_cmd(parser);
+        rc = cparser_complete_cmd(parser);
+        if (CPARSER_OK == rc) {
+            /* 
+             * Save the parser FSM state with the line entered into the 
+             * history so that the line can be recalled quickly.
+             */
+            cparser_line_save_state(parser);
+            rc = cparser_execute_cmd(parser);
+        }
         cparser_line_advance(parser);
         return rc;
     }
@@ -655,24 +909,195 @@ cparser_run (cparser_t *parser)
     return CPARSER_OK;
 }
 
+/**
+ * \brief    Take an array out of the parser storage.
+ *
+ * \param    mem  Pointer to the storage. NULL if the storage is being sized.
+ * \param    used Number of bytes of the storage already taken. It is 
+ *                updated.
+ * \param    size Size of the array in bytes.
+ *
+ * \return   Pointer to the array; NULL if 'mem' is NULL.
+ */
+static void *
+cparser_mem_carve (char *mem, size_t *used, size_t size)
+{
+    void *ptr = (mem ? (mem + *used) : NULL);
+
+    /* Keep every array aligned for pointers */
+    *used += (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    return ptr;
+}
+
+/**
+ * \brief    Give a line its storage.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    line   Pointer to the line. NULL if the storage is being sized.
+ * \param    mem    Pointer to the storage. NULL if the storage is being sized.
+ * \param    used   Number of bytes of the storage already taken.
+ */
+static void
+cparser_mem_line (cparser_t *parser, cparser_line_t *line, char *mem,
+                  size_t *used)
+{
+    const cparser_cfg_t *cfg = &parser->cfg;
+    char *buf;
+    short *begin_ptr, *token_len;
+    cparser_node_t **node;
+
+    buf = cparser_mem_carve(mem, used, cfg->max_line_size + 2);
+    begin_ptr = cparser_mem_carve(mem, used, 
+                                  cfg->max_num_tokens * sizeof(short));
+    token_len = cparser_mem_carve(mem, used,
+                                  cfg->max_num_tokens * sizeof(short));
+    node = cparser_mem_carve(mem, used, 
+                             cfg->max_num_tokens * sizeof(cparser_node_t *));
+    if (line) {
+        line->size = cfg->max_line_size;
+        line->buf = buf;
+        line->fsm.begin_ptr = begin_ptr;
+        line->fsm.token_len = token_len;
+        line->fsm.node = node;
+        cparser_line_reset(line);
+    }
+}
+
+/**
+ * \brief    Lay out all arrays of a parser in its storage.
+ * \details  It is called twice. First, without storage to find out its 
+ *           size. Then, with the storage to set up all arrays.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    mem    Pointer to the storage. NULL to size the storage.
+ *
+ * \return   Size of the storage in bytes.
+ */
+static size_t
+cparser_mem_layout (cparser_t *parser, char *mem)
+{
+    const cparser_cfg_t *cfg = &parser->cfg;
+    size_t used = 0;
+    char *buf;
+    int n;
+
+    parser->root = cparser_mem_carve(mem, &used, cfg->max_nested_levels *
+                                     sizeof(*parser->root));
+    parser->prompt = cparser_mem_carve(mem, &used, cfg->max_nested_levels *
+                                       sizeof(*parser->prompt));
+    parser->context.cookie = 
+        cparser_mem_carve(mem, &used, cfg->max_nested_levels * 
+                          sizeof(*parser->context.cookie));
+    parser->help_nodes = 
+        cparser_mem_carve(mem, &used, (cfg->max_num_tokens + 2) *
+                          sizeof(*parser->help_nodes));
+    parser->search_buf = cparser_mem_carve(mem, &used, 
+                                           cfg->max_line_size + 1);
+    parser->queue_ch = cparser_mem_carve(mem, &used, cfg->max_queue_size);
+    parser->queue_type = cparser_mem_carve(mem, &used, cfg->max_queue_size);
+    parser->filter = NULL;
+    if (cfg->flags & CPARSER_FLAGS_FILTER) {
+        parser->filter = cparser_mem_carve(mem, &used, 
+                                           sizeof(cparser_filter_t));
+    }
+
+    /* Token stack. Each token has room for a terminating NULL. */
+    parser->tokens = cparser_mem_carve(mem, &used, cfg->max_num_tokens *
+                                       sizeof(*parser->tokens));
+    for (n = 0; n < cfg->max_num_tokens; n++) {
+        buf = cparser_mem_carve(mem, &used, cfg->max_token_size + 1);
+        if (mem) {
+            parser->tokens[n].buf = buf;
+        }
+    }
+
+    /* Lines */
+    parser->lines = cparser_mem_carve(mem, &used, cfg->max_lines *
+                                      sizeof(*parser->lines));
+    for (n = 0; n < cfg->max_lines; n++) {
+        cparser_mem_line(parser, (mem ? &parser->lines[n] : NULL), mem, 
+                         &used);
+    }
+    cparser_mem_line(parser, (mem ? &parser->hist_saved : NULL), mem, &used);
+    cparser_mem_line(parser, (mem ? &parser->scratch : NULL), mem, &used);
+
+    return used;
+}
+
 cparser_result_t
 cparser_init (cparser_cfg_t *cfg, cparser_t *parser)
 {
     int n;
 
-    if (!parser || !cfg || !cfg->root || !cfg->ch_erase) {
+    if (!parser || !cfg || !(cfg->root || cfg->tree || cfg->handle) || 
+        !cfg->ch_erase) {
 	return CPARSER_ERR_INVALID_PARAMS;
     }
+    if (!cfg->tree && !cfg->handle && NODE_IS_PACKED(cfg->root)) {
+        /* Packed nodes need their tree for descriptions and glue */
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
 
     parser->cfg = *cfg;
+    parser->tree_ver = NULL;
+    parser->quiet = 0;
+    parser->loading = 0;
+    parser->io_state = NULL;
+    parser->ring = NULL;
+    parser->rpc = NULL;
+    if (parser->cfg.handle) {
+        /* cparser_fsm_reset() takes the newest tree */
+        parser->cfg.tree = NULL;
+        parser->cfg.root = NULL;
+    } else if (parser->cfg.tree) {
+        parser->cfg.root = parser->cfg.tree->root;
+    }
     parser->cfg.prompt[CPARSER_MAX_PROMPT-1] = '\0';
 
+    /* Apply the default limits */
+    if (!parser->cfg.max_nested_levels) {
+        parser->cfg.max_nested_levels = CPARSER_MAX_NESTED_LEVELS;
+    }
+    if (!parser->cfg.max_token_size) {
+        parser->cfg.max_token_size = CPARSER_MAX_TOKEN_SIZE;
+    }
+    if (!parser->cfg.max_num_tokens) {
+        parser->cfg.max_num_tokens = CPARSER_MAX_NUM_TOKENS;
+    }
+    if (!parser->cfg.max_lines) {
+        parser->cfg.max_lines = CPARSER_MAX_LINES;
+    }
+    if (!parser->cfg.max_line_size) {
+        parser->cfg.max_line_size = CPARSER_MAX_LINE_SIZE;
+    }
+    if (!parser->cfg.max_queue_size) {
+        parser->cfg.max_queue_size = CPARSER_MAX_QUEUE_SIZE;
+    }
+    /* Line positions are stored in shorts */
+    if ((0 > parser->cfg.max_nested_levels) || 
+        (0 > parser->cfg.max_token_size) ||
+        (2 > parser->cfg.max_num_tokens) || (0 > parser->cfg.max_lines) ||
+        (2 > parser->cfg.max_line_size) || 
+        (0 > parser->cfg.max_queue_size) ||
+        ((SHRT_MAX - 2) < parser->cfg.max_line_size) ||
+        ((SHRT_MAX - 2) < parser->cfg.max_num_tokens)) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+
+    /* Allocate all storage in one block */
+    parser->mem_size = cparser_mem_layout(parser, NULL);
+    parser->mem = cparser_mem_alloc(parser->cfg.alloc, parser->mem_size);
+    if (!parser->mem) {
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    (void)cparser_mem_layout(parser, parser->mem);
+
     /* Initialize sub-mode states */
     parser->root_level = 0;
     parser->root[0] = parser->cfg.root;
     snprintf(parser->prompt[0], sizeof(parser->prompt[0]), "%s",
              parser->cfg.prompt);
-    for (n = 0; n < CPARSER_MAX_NESTED_LEVELS; n++) {
+    for (n = 0; n < parser->cfg.max_nested_levels; n++) {
         parser->context.cookie[n] = NULL;
     }
     parser->context.parser = parser;
@@ -680,8 +1105,17 @@ cparser_init (cparser_cfg_t *cfg, cparser_t *parser)
     /* Initialize line buffering states */
     parser->max_line = 0;
     parser->cur_line = 0;
-    for (n = 0; n < CPARSER_MAX_LINES; n++) {
-        cparser_line_reset(&parser->lines[n]);
+    parser->hist_id = CPARSER_HISTORY_NONE;
+    parser->search_active = 0;
+
+    /* No command is pending */
+    parser->pending = 0;
+    parser->async_seq = 0;
+    parser->queue_head = 0;
+    parser->queue_count = 0;
+    parser->exec_job = NULL;
+    if (parser->filter) {
+        ((cparser_filter_t *)parser->filter)->num_stages = 0;
     }
 
     /* Initialize parser FSM state */
@@ -694,6 +1128,26 @@ cparser_init (cparser_cfg_t *cfg, cparser_t *parser)
     return CPARSER_OK;
 }
 
+cparser_result_t
+cparser_fini (cparser_t *parser)
+{
+    if (!VALID_PARSER(parser) || !parser->mem) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    if (parser->cfg.handle) {
+        cparser_tree_leave(parser);
+    }
+    cparser_filter_stop(parser, 0);
+    cparser_mem_free(parser->cfg.alloc, parser->mem, parser->mem_size);
+    parser->mem = NULL;
+    parser->mem_size = 0;
+    parser->root = NULL;
+    parser->tokens = NULL;
+    parser->lines = NULL;
+    parser->filter = NULL;
+    return CPARSER_OK;
+}
+
 cparser_result_t
 cparser_quit (cparser_t *parser)
 {
@@ -712,11 +1166,11 @@ cparser_submode_enter (cparser_t *parser, void *cookie, char *prompt)
     if (!parser) {
         return CPARSER_ERR_INVALID_PARAMS;
     }
-    if ((CPARSER_MAX_NESTED_LEVELS-1) == parser->root_level) {
+    if ((parser->cfg.max_nested_levels-1) == parser->root_level) {
         return CPARSER_NOT_OK;
     }
     parser->root_level++;
-    new_root = parser->cur_node->children;
+    new_root = NODE_CHILDREN(parser->cur_node);
     assert(new_root);
     assert(CPARSER_NODE_ROOT == new_root->type);
     parser->root[parser->root_level] = new_root;
@@ -746,20 +1200,19 @@ cparser_load_cmd (cparser_t *parser, char *filename)
     FILE *fp;
     char buf[128];
     size_t rsize, n;
-    int fd, indent = 0, last_indent = -1, new_line = 1, m, line_num = 0;
+    int indent = 0, last_indent = -1, new_line = 1, m, line_num = 0;
 
     if (!VALID_PARSER(parser) || !filename) {
         return CPARSER_ERR_INVALID_PARAMS;
     }
 
-    fd = parser->cfg.fd;
-    parser->cfg.fd = -1;
-
     fp = fopen(filename, "r");
     if (!fp) {
         return CPARSER_NOT_OK;
     }
 
+    parser->quiet = 1;
+    parser->loading = 1;
     cparser_fsm_reset(parser);
     while (!feof(fp)) {
         rsize = fread(buf, 1, sizeof(buf), fp);
@@ -772,11 +1225,16 @@ cparser_load_cmd (cparser_t *parser, char *filename)
                 line_num++;
                 indent = 0;
                 new_line = 1;
-                rc = cparser_execute_cmd(parser);
+                rc = cparser_complete_cmd(parser);
+                if (CPARSER_OK == rc) {
+                    rc = cparser_execute_cmd(parser);
+                }
                 if (CPARSER_OK == rc) {
                     continue;
                 }
-                parser->cfg.fd = fd;
+                parser->quiet = 0;
+                parser->loading = 0;
+                fclose(fp);
                 switch (rc) {
                 case CPARSER_ERR_PARSE_ERR:
                     snprintf(buf, sizeof(buf), "Line %d: Parse error.\n", line_num);
@@ -786,8 +1244,14 @@ cparser_load_cmd (cparser_t *parser, char *filename)
                     snprintf(buf, sizeof(buf), "Line %d: Incomplete command.\n", line_num);
                     parser->cfg.prints(parser, buf);
                     break;
+                case CPARSER_PENDING:
+                    snprintf(buf, sizeof(buf), "Line %d: Command is pending.\n", line_num);
+                    parser->cfg.prints(parser, buf);
+                    break;
                 default:
-                    assert(0);
+                    snprintf(buf, sizeof(buf), "Line %d: Command failed.\n", line_num);
+                    parser->cfg.prints(parser, buf);
+                    break;
                 }
                 return CPARSER_NOT_OK;
             } else if (' ' == buf[n]) {
@@ -817,10 +1281,82 @@ cparser_load_cmd (cparser_t *parser, char *filename)
         (void)cparser_submode_exit(parser);
         cparser_fsm_reset(parser);
     }
-    parser->cfg.fd = fd;
+    parser->quiet = 0;
+    parser->loading = 0;
     return CPARSER_OK;
 }
 
+cparser_result_t
+cparser_execute_encoded (cparser_t *parser, uint32_t id, const void *args,
+                         size_t len)
+{
+    const cparser_codec_t *codec = NULL;
+    cparser_node_t *node;
+    const char *path;
+    uint32_t lo, hi, mid, k, n, shift;
+    int do_echo;
+    cparser_result_t rc;
+
+    if (!VALID_PARSER(parser) || (!args && len) || parser->pending ||
+        cparser_is_user_input(parser, &do_echo) || parser->token_tos ||
+        (CPARSER_STATE_WHITESPACE != parser->state)) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+
+    /* The commands are sorted by ID */
+    lo = 0;
+    hi = parser->cfg.num_codecs;
+    while (lo < hi) {
+        mid = lo + ((hi - lo) / 2);
+        if (parser->cfg.codecs[mid].id < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if ((lo >= parser->cfg.num_codecs) || 
+        (parser->cfg.codecs[lo].id != id)) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+    codec = &parser->cfg.codecs[lo];
+
+    /* 
+     * Follow the path of the command from the root of the current 
+     * submode. It ends at its END node only if the command is in this
+     * submode.
+     */
+    node = parser->root[parser->root_level];
+    path = codec->path;
+    for (k = 0; node && (k < codec->depth); k++) {
+        n = 0;
+        shift = 0;
+        do {
+            n |= (uint32_t)(*path & 0x7f) << shift;
+            shift += 7;
+        } while (*path++ & 0x80);
+        for (node = NODE_CHILDREN(node); node && n; n--) {
+            node = NODE_SIBLING(node);
+        }
+    }
+    if (!node || (CPARSER_NODE_END != node->type) ||
+        (NODE_GLUE(parser, node) != codec->glue) || 
+        !NODE_USABLE(parser, node)) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+
+    /* The action may enter the submode under the END node */
+    parser->cur_node = node;
+    parser->async_seq++;
+    rc = codec->decode(parser, args, len);
+    if (CPARSER_PENDING == rc) {
+        /* cparser_complete_async() resets the FSM */
+        parser->pending = 1;
+        return rc;
+    }
+    cparser_fsm_reset(parser);
+    return rc;
+}
+
 static cparser_result_t
 cparser_walk_internal (cparser_t *parser, cparser_node_t *node,
                        cparser_walker_fn pre_fn, cparser_walker_fn post_fn,
@@ -837,10 +1373,10 @@ cparser_walk_internal (cparser_t *parser, cparser_node_t *node,
     }
 
     if (CPARSER_NODE_END != node->type) {
-        cur_node = node->children;
+        cur_node = NODE_CHILDREN(node);
         while (cur_node) {
             cparser_walk_internal(parser, cur_node, pre_fn, post_fn, cookie);
-            cur_node = cur_node->sibling;
+            cur_node = NODE_SIBLING(cur_node);
         }
     }
 
@@ -869,7 +1405,7 @@ cparser_walk (cparser_t *parser, cparser_walker_fn pre_fn,
 typedef struct help_stack_ {
     char *filter;
     int  tos;
-    cparser_node_t *nodes[CPARSER_MAX_NUM_TOKENS+2];
+    cparser_node_t **nodes;  /* Room for max_num_tokens + 2 nodes */
 } help_stack_t;
 
 /**
@@ -889,6 +1425,7 @@ cparser_help_pre_walker (cparser_t *parser, cparser_node_t *node, void *cookie)
     help_stack_t *hs = (help_stack_t *)cookie;
 
     assert(parser && node && hs);
+    assert(hs->tos < (parser->cfg.max_num_tokens + 2));
     hs->nodes[hs->tos] = node;
     hs->tos++;
 
@@ -921,15 +1458,15 @@ cparser_help_post_walker (cparser_t *parser, cparser_node_t *node, void *cookie)
             for (n = 0; n < hs->tos; n++) {
                 if (CPARSER_NODE_LIST == hs->nodes[n]->type) {
                     /* LIST node requires an extra walk of all keywords in the list */
-                    cparser_list_node_t *lnode =
-                        (cparser_list_node_t *)hs->nodes[n]->param;
+                    cparser_list_node_t *lnode = NODE_PARAM(hs->nodes[n]);
                     assert(lnode);
                     while (lnode) {
-                        if (strstr(lnode->keyword, hs->filter)) {
+                        if (strstr(LIST_NODE_KEYWORD(hs->nodes[n], lnode),
+                                   hs->filter)) {
                             do_print = 1;
                             break;
                         }
-                        lnode = lnode->next;
+                        lnode = LIST_NODE_NEXT(hs->nodes[n], lnode);
                     }
                     if (do_print) {
                         break;
@@ -938,7 +1475,7 @@ cparser_help_post_walker (cparser_t *parser, cparser_node_t *node, void *cookie)
                 if (CPARSER_NODE_KEYWORD != hs->nodes[n]->type) {
                     continue;
                 }
-                if (strstr(hs->nodes[n]->param, hs->filter)) {
+                if (strstr(NODE_PARAM(hs->nodes[n]), hs->filter)) {
                     do_print = 1; /* Yes, print it */
                     break;
                 }
@@ -953,8 +1490,8 @@ cparser_help_post_walker (cparser_t *parser, cparser_node_t *node, void *cookie)
             cparser_node_t *cur_node;
             int m, num_braces = 0;
 
-            if (node->desc) {
-                parser->cfg.prints(parser, node->desc);
+            if (NODE_DESC(parser->cfg.tree, node)) {
+                parser->cfg.prints(parser, NODE_DESC(parser->cfg.tree, node));
                 parser->cfg.prints(parser, "\r\n  ");
             } else {
                 parser->cfg.prints(parser, "\r  ");
@@ -994,6 +1531,7 @@ cparser_help_cmd (cparser_t *parser, char *str)
     assert(parser);
     memset(&help_stack, 0, sizeof(help_stack));
     help_stack.filter = str;
+    help_stack.nodes = parser->help_nodes;
     return cparser_walk(parser, cparser_help_pre_walker,
                         cparser_help_post_walker, &help_stack);
 }
@@ -1079,11 +1617,8 @@ cparser_abort_user_input (cparser_t *parser)
     }
 
     /* Force a callback immediately with an empty input */
-    parser->user_buf[0] = '\0';
-    parser->user_input_cb(parser, parser->user_buf, 0);
-
-    cparser_input_reset(parser);
-    cparser_print_prompt(parser);
+    parser->user_buf_count = 0;
+    (void)cparser_user_input_done(parser);
 
     return CPARSER_OK;
 }
@@ -1122,3 +1657,53 @@ cparser_last_command (cparser_t *parser, char **cmd,
     }
     return CPARSER_OK;
 }
+
+cparser_result_t
+cparser_async_handle (cparser_context_t *context, cparser_async_t *handle)
+{
+    if (!context || !VALID_PARSER(context->parser) || !handle) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    handle->parser = context->parser;
+    handle->seq = context->parser->async_seq;
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_complete_async (const cparser_async_t *handle, cparser_result_t rc)
+{
+    cparser_t *parser;
+    int do_echo;
+    char ch;
+    cparser_char_t ch_type;
+
+    if (!handle || !VALID_PARSER(handle->parser) || (CPARSER_PENDING == rc)) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    parser = handle->parser;
+    if (!parser->pending || (handle->seq != parser->async_seq)) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+
+    parser->pending = 0;
+    parser->last_rc = rc;
+    if (parser->cfg.record) {
+        parser->cfg.record(parser);
+    }
+    cparser_filter_stop(parser, 1);
+    cparser_fsm_reset(parser);
+    if (!cparser_is_user_input(parser, &do_echo)) {
+        cparser_print_prompt(parser);
+    }
+
+    /* Run the input queued in the meantime until a command is pending */
+    while (!parser->pending && parser->queue_count) {
+        ch = parser->queue_ch[parser->queue_head];
+        ch_type = (cparser_char_t)parser->queue_type[parser->queue_head];
+        parser->queue_head = (parser->queue_head + 1) % 
+            parser->cfg.max_queue_size;
+        parser->queue_count--;
+        (void)cparser_input(parser, ch, ch_type);
+    }
+    return CPARSER_OK;
+}
@@ -0,0 +1,118 @@
+/**
+ * \file     cparser_alloc.c
+ * \brief    Memory allocator implementation.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cparser_alloc.h"
+
+/** Alignment of blocks allocated from an arena */
+#define ARENA_ALIGN         (2 * sizeof(void *))
+#define ARENA_ROUND_UP(n)   (((n) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+/**
+ * \brief    Allocate a block from an arena.
+ *
+ * \param    cookie Pointer to the arena.
+ * \param    size   Number of bytes to be allocated.
+ *
+ * \return   Pointer to the block; NULL if the arena is exhausted.
+ */
+static void *
+cparser_arena_alloc (void *cookie, size_t size)
+{
+    cparser_arena_t *arena = (cparser_arena_t *)cookie;
+    size_t offset;
+
+    assert(arena);
+    offset = ARENA_ROUND_UP((uintptr_t)arena->buf + arena->used) - 
+        (uintptr_t)arena->buf;
+    if ((offset > arena->size) || (size > (arena->size - offset))) {
+        return NULL;
+    }
+    arena->used = offset + size;
+    return arena->buf + offset;
+}
+
+/**
+ * \brief    Free a block to an arena. Blocks are never reused.
+ *
+ * \param    cookie Pointer to the arena.
+ * \param    ptr    Pointer to the block.
+ * \param    size   Size of the block.
+ */
+static void
+cparser_arena_free (void *cookie, void *ptr, size_t size)
+{
+    assert(cookie);
+}
+
+void
+cparser_arena_init (cparser_arena_t *arena, void *buf, size_t size)
+{
+    assert(arena && (buf || !size));
+    arena->alloc.alloc = cparser_arena_alloc;
+    arena->alloc.free = cparser_arena_free;
+    arena->alloc.cookie = arena;
+    arena->buf = (char *)buf;
+    arena->size = size;
+    arena->used = 0;
+}
+
+void *
+cparser_mem_alloc (const cparser_alloc_t *alloc, size_t size)
+{
+    void *ptr;
+
+    if (!alloc) {
+        return calloc(1, size);
+    }
+    ptr = alloc->alloc(alloc->cookie, size);
+    if (ptr) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+void
+cparser_mem_free (const cparser_alloc_t *alloc, void *ptr, size_t size)
+{
+    if (!ptr) {
+        return;
+    }
+    if (!alloc) {
+        free(ptr);
+        return;
+    }
+    alloc->free(alloc->cookie, ptr, size);
+}
@@ -0,0 +1,424 @@
+/**
+ * \file     cparser_check.c
+ * \brief    Validation of command files without running them.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_fsm.h"
+#include "cparser_check.h"
+
+/**
+ * \brief    A part of the file checked by one thread.
+ */
+typedef struct cparser_check_part_ {
+    pthread_t              thread;
+    cparser_t              parser;
+    const char             *begin;      /**< First character */
+    const char             *end;        /**< After the last character */
+    uint32_t               num_lines;   /**< Number of lines */
+    uint32_t               num_errors;  /**< Number of errors */
+    cparser_check_error_t  *errors;     /**< The first errors */
+    uint32_t               max_errors;  /**< Size of 'errors' */
+    uint32_t               column;      /**< Column of a bad parameter */
+    /** Indentation of the last line before and after the part */
+    int                    last_indent;
+} cparser_check_part_t;
+
+static void
+cparser_check_printc (const cparser_t *parser, const char ch)
+{
+}
+
+static void
+cparser_check_prints (const cparser_t *parser, const char *s)
+{
+}
+
+/**
+ * \brief    Executor of the parsers of the check. It converts the 
+ *           parameters instead of calling the glue function.
+ */
+static cparser_result_t
+cparser_check_exec (cparser_t *parser, cparser_glue_fn glue)
+{
+    cparser_check_part_t *part = 
+        (cparser_check_part_t *)parser->cfg.exec_cookie;
+    cparser_node_type_t type;
+    cparser_node_t *child;
+    union {
+        uint64_t           u64;
+        double             d;
+        cparser_macaddr_t  mac;
+    } val;
+    int k;
+
+    for (k = 0; k < parser->token_tos; k++) {
+        /* 
+         * A string, a file name or a list keyword is valid once it 
+         * matches. Its length is bounded by max_token_size, not by 
+         * CPARSER_MAX_TOKEN_SIZE, and a file may only exist where the
+         * commands run. Only numbers and addresses can be out of range.
+         */
+        type = parser->tokens[k].node->type;
+        if ((CPARSER_NODE_STRING == type) || (CPARSER_NODE_FILE == type) ||
+            (CPARSER_NODE_LIST == type)) {
+            continue;
+        }
+        if (cparser_get_fn_tbl[type] && 
+            (CPARSER_OK != cparser_get_fn_tbl[type](&parser->tokens[k],
+                                                    &val))) {
+            part->column = parser->tokens[k].begin_ptr + 1;
+            return CPARSER_NOT_OK;
+        }
+    }
+
+    /* A command with a sub-mode enters it */
+    child = NODE_CHILDREN(parser->cur_node);
+    if (child && (CPARSER_NODE_ROOT == child->type)) {
+        (void)cparser_submode_enter(parser, NULL, "");
+    }
+    return CPARSER_OK;
+}
+
+/**
+ * \brief    Count an error of the current line of a part.
+ */
+static void
+cparser_check_error (cparser_check_part_t *part, uint32_t column,
+                     cparser_result_t rc)
+{
+    cparser_check_error_t *error;
+
+    if (part->num_errors < part->max_errors) {
+        error = &part->errors[part->num_errors];
+        error->line = part->num_lines + 1;
+        error->column = column;
+        error->rc = rc;
+    }
+    part->num_errors++;
+}
+
+/**
+ * \brief    Check a line after its newline (or the end of the file).
+ *           The error of a line that is too long is already counted.
+ */
+static void
+cparser_check_line (cparser_check_part_t *part, int too_long)
+{
+    cparser_t *parser = &part->parser;
+    uint32_t column = parser->last_good + 2;
+    cparser_result_t rc;
+
+    rc = cparser_input(parser, '\n', CPARSER_CHAR_REGULAR);
+    assert(CPARSER_PENDING != rc);
+    if ((CPARSER_OK != rc) && !too_long) {
+        cparser_check_error(part, ((CPARSER_NOT_OK == rc) ? part->column :
+                                   column), rc);
+    }
+    part->num_lines++;
+}
+
+/**
+ * \brief    Thread of a part. It follows cparser_load_cmd() but the 
+ *           indentation is only fed into the parser after the sub-modes
+ *           it ends are left.
+ */
+static void *
+cparser_check_run (void *arg)
+{
+    cparser_check_part_t *part = (cparser_check_part_t *)arg;
+    cparser_t *parser = &part->parser;
+    const char *p;
+    int indent = 0, last_indent = part->last_indent, new_line = 1;
+    int too_long = 0, m;
+
+    for (p = part->begin; p < part->end; p++) {
+        if ('\n' == *p) {
+            cparser_check_line(part, too_long);
+            indent = 0;
+            new_line = 1;
+            too_long = 0;
+            continue;
+        }
+        if (new_line) {
+            if (' ' == *p) {
+                indent++;
+                continue;
+            }
+            new_line = 0;
+            for (m = indent; m < last_indent; m++) {
+                if (CPARSER_OK != cparser_submode_exit(parser)) {
+                    break;
+                }
+                cparser_fsm_reset(parser);
+            }
+            last_indent = indent;
+            for (m = 0; m < indent; m++) {
+                (void)cparser_input(parser, ' ', CPARSER_CHAR_REGULAR);
+            }
+        }
+        if (too_long) {
+            continue;
+        }
+        if (parser->current_pos >= parser->cfg.max_line_size) {
+            cparser_check_error(part, parser->current_pos + 1, 
+                                CPARSER_ERR_OUT_OF_RES);
+            too_long = 1;
+            continue;
+        }
+        (void)cparser_input(parser, *p, CPARSER_CHAR_REGULAR);
+    }
+    if ((part->begin < part->end) && ('\n' != part->end[-1])) {
+        cparser_check_line(part, too_long);
+    }
+    part->last_indent = last_indent;
+    return NULL;
+}
+
+/**
+ * \brief    Check a part again from the sub-mode and the indentation 
+ *           where the previous part ends.
+ */
+static void
+cparser_check_rerun (cparser_check_part_t *part, 
+                     const cparser_check_part_t *prev)
+{
+    cparser_t *parser = &part->parser;
+    int level;
+
+    while (parser->root_level) {
+        (void)cparser_submode_exit(parser);
+    }
+    for (level = 1; level <= prev->parser.root_level; level++) {
+        parser->root[level] = prev->parser.root[level];
+    }
+    parser->root_level = prev->parser.root_level;
+    cparser_fsm_reset(parser);
+    part->last_indent = prev->last_indent;
+    part->num_lines = 0;
+    part->num_errors = 0;
+    (void)cparser_check_run(part);
+}
+
+/**
+ * \brief    Find the first line at or after 'p' that is not indented.
+ */
+static const char *
+cparser_check_split (const char *begin, const char *p, const char *end)
+{
+    if (p <= begin) {
+        return begin;
+    }
+    for (p--; p < end; p++) {
+        p = memchr(p, '\n', end - p);
+        if (!p) {
+            return end;
+        }
+        if (((p + 1) < end) && (' ' != p[1]) && ('\n' != p[1])) {
+            return p + 1;
+        }
+    }
+    return end;
+}
+
+cparser_result_t
+cparser_check_cmd (cparser_t *parser, const char *filename, int num_threads,
+                   cparser_check_error_t *errors, uint32_t max_errors,
+                   uint32_t *num_errors)
+{
+    cparser_check_part_t *parts;
+    cparser_cfg_t cfg;
+    cparser_result_t rc = CPARSER_OK;
+    const char *map = NULL;
+    struct stat st;
+    uint32_t num_lines = 0, count = 0, k;
+    int fd, n, num_started = 0;
+
+    if (!VALID_PARSER(parser) || !filename || (0 >= num_threads) ||
+        (max_errors && !errors) || !num_errors) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    *num_errors = 0;
+    fd = open(filename, O_RDONLY);
+    if (0 > fd) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+    if (fstat(fd, &st)) {
+        close(fd);
+        return CPARSER_ERR_NOT_EXIST;
+    }
+    if (!st.st_size) {
+        close(fd);
+        return CPARSER_OK;
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == map) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+
+    parts = cparser_mem_alloc(NULL, num_threads * sizeof(*parts));
+    if (!parts) {
+        munmap((void *)map, st.st_size);
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    memset(parts, 0, num_threads * sizeof(*parts));
+
+    /* The parsers of the check run no action and print nothing */
+    cfg = parser->cfg;
+    cfg.printc = cparser_check_printc;
+    cfg.prints = cparser_check_prints;
+    cfg.history = NULL;
+    cfg.record = NULL;
+    cfg.exec = cparser_check_exec;
+    cfg.ch_complete = 0;
+    cfg.ch_help = 0;
+    cfg.flags &= ~(CPARSER_FLAGS_DEBUG | CPARSER_FLAGS_MT_OUTPUT);
+    for (n = 0; n < num_threads; n++) {
+        cparser_check_part_t *part = &parts[n];
+
+        part->begin = cparser_check_split(map, 
+                                          map + ((st.st_size * n) / 
+                                                 num_threads),
+                                          map + st.st_size);
+        part->end = map + st.st_size;
+        if (n) {
+            parts[n - 1].end = part->begin;
+        }
+        part->max_errors = max_errors;
+        part->last_indent = -1;
+        if (max_errors) {
+            part->errors = cparser_mem_alloc(NULL, max_errors * 
+                                             sizeof(*part->errors));
+            if (!part->errors) {
+                rc = CPARSER_ERR_OUT_OF_RES;
+                break;
+            }
+        }
+        cfg.exec_cookie = part;
+        if (CPARSER_OK != cparser_init(&cfg, &part->parser)) {
+            cparser_mem_free(NULL, part->errors, 
+                             max_errors * sizeof(*part->errors));
+            part->errors = NULL;
+            rc = CPARSER_ERR_OUT_OF_RES;
+            break;
+        }
+        part->parser.quiet = 1;
+        part->parser.is_privileged_mode = parser->is_privileged_mode;
+    }
+    for (n = 0; (CPARSER_OK == rc) && (n < num_threads); n++) {
+        if (pthread_create(&parts[n].thread, NULL, cparser_check_run,
+                           &parts[n])) {
+            rc = CPARSER_ERR_OUT_OF_RES;
+            break;
+        }
+        num_started++;
+    }
+    for (n = 0; n < num_started; n++) {
+        pthread_join(parts[n].thread, NULL);
+    }
+
+    /* 
+     * The first line of a part leaves one sub-mode per space of the 
+     * indentation of the previous line. If that does not reach the top
+     * level, the part is checked again in order.
+     */
+    for (n = 1; (CPARSER_OK == rc) && (n < num_threads); n++) {
+        if (parts[n - 1].parser.root_level > parts[n - 1].last_indent) {
+            cparser_check_rerun(&parts[n], &parts[n - 1]);
+        }
+    }
+
+    /* Merge the errors in the order of the lines */
+    for (n = 0; n < num_threads; n++) {
+        cparser_check_part_t *part = &parts[n];
+
+        if (CPARSER_OK == rc) {
+            for (k = 0; (k < part->num_errors) && (k < part->max_errors) &&
+                     (count < max_errors); k++, count++) {
+                errors[count] = part->errors[k];
+                errors[count].line += num_lines;
+            }
+            num_lines += part->num_lines;
+            *num_errors += part->num_errors;
+        }
+        if (part->parser.mem) {
+            cparser_fini(&part->parser);
+        }
+        cparser_mem_free(NULL, part->errors, 
+                         max_errors * sizeof(*part->errors));
+    }
+    cparser_mem_free(NULL, parts, num_threads * sizeof(*parts));
+    munmap((void *)map, st.st_size);
+    if ((CPARSER_OK == rc) && *num_errors) {
+        rc = CPARSER_NOT_OK;
+    }
+    return rc;
+}
+
+void
+cparser_check_print (cparser_t *parser, const cparser_check_error_t *errors,
+                     uint32_t num_errors)
+{
+    char buf[128];
+    const char *msg;
+    uint32_t n;
+
+    assert(parser && (errors || !num_errors));
+    for (n = 0; n < num_errors; n++) {
+        switch (errors[n].rc) {
+            case CPARSER_ERR_PARSE_ERR:
+                msg = "Parse error";
+                break;
+            case CPARSER_ERR_INCOMP_CMD:
+                msg = "Incomplete command";
+                break;
+            case CPARSER_ERR_OUT_OF_RES:
+                msg = "Line too long";
+                break;
+            default:
+                msg = "Invalid parameter";
+                break;
+        }
+        snprintf(buf, sizeof(buf), "Line %u, column %u: %s.\n",
+                 errors[n].line, errors[n].column, msg);
+        parser->cfg.prints(parser, buf);
+    }
+}
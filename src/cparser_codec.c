@@ -0,0 +1,245 @@
+/**
+ * \file     cparser_codec.c
+ * \brief    Binary encoding of the arguments of commands.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_codec.h"
+
+/**
+ * \brief    Number of bytes of a value of a node type.
+ *
+ * \return   0 for strings, file paths and list keywords.
+ */
+static size_t
+cparser_codec_size (cparser_node_type_t type)
+{
+    switch (type) {
+        case CPARSER_NODE_UINT:
+        case CPARSER_NODE_INT:
+        case CPARSER_NODE_HEX:
+        case CPARSER_NODE_IPV4ADDR:
+            return 4;
+        case CPARSER_NODE_UINT64:
+        case CPARSER_NODE_INT64:
+        case CPARSER_NODE_HEX64:
+        case CPARSER_NODE_FLOAT:
+            return 8;
+        case CPARSER_NODE_MACADDR:
+            return 6;
+        default:
+            assert((CPARSER_NODE_STRING == type) || 
+                   (CPARSER_NODE_FILE == type) || 
+                   (CPARSER_NODE_LIST == type));
+            return 0;
+    }
+}
+
+static void
+cparser_encode_bytes (cparser_encoder_t *enc, const void *data, size_t len)
+{
+    if ((enc->size - enc->len) < len) {
+        enc->err = 1;
+        return;
+    }
+    memcpy(enc->buf + enc->len, data, len);
+    enc->len += len;
+}
+
+void
+cparser_encoder_init (cparser_encoder_t *enc, void *buf, size_t size)
+{
+    assert(enc && (buf || !size));
+    enc->buf = (uint8_t *)buf;
+    enc->size = size;
+    enc->len = 0;
+    enc->err = 0;
+}
+
+void
+cparser_encode_arg (cparser_encoder_t *enc, cparser_node_type_t type,
+                    int optional, const void *value)
+{
+    uint8_t data[8];
+    uint64_t val;
+    size_t len, n;
+
+    assert(enc);
+    if (optional) {
+        data[0] = (value ? 1 : 0);
+        cparser_encode_bytes(enc, data, 1);
+    }
+    if (!value) {
+        if (!optional) {
+            enc->err = 1;
+        }
+        return;
+    }
+
+    len = cparser_codec_size(type);
+    switch (len) {
+        case 0:
+            n = strlen((const char *)value);
+            if (n > 0xffff) {
+                enc->err = 1;
+                return;
+            }
+            data[0] = (uint8_t)(n >> 8);
+            data[1] = (uint8_t)n;
+            cparser_encode_bytes(enc, data, 2);
+            cparser_encode_bytes(enc, value, n);
+            return;
+        case 6:
+            cparser_encode_bytes(enc, value, 6);
+            return;
+        case 4:
+            val = *(const uint32_t *)value;
+            break;
+        default:
+            assert(8 == len);
+            memcpy(&val, value, 8);
+            break;
+    }
+    for (n = 0; n < len; n++) {
+        data[n] = (uint8_t)(val >> (8 * (len - n - 1)));
+    }
+    cparser_encode_bytes(enc, data, len);
+}
+
+int
+cparser_encoder_done (const cparser_encoder_t *enc)
+{
+    assert(enc);
+    if (enc->err) {
+        return -1;
+    }
+    return (int)enc->len;
+}
+
+void
+cparser_decoder_init (cparser_decoder_t *dec, const void *buf, size_t len)
+{
+    assert(dec && (buf || !len));
+    dec->buf = (const uint8_t *)buf;
+    dec->len = len;
+    dec->pos = 0;
+    dec->err = 0;
+}
+
+int
+cparser_decode_arg (cparser_decoder_t *dec, cparser_node_type_t type,
+                    int optional, void *value, size_t size, 
+                    const char *list)
+{
+    const uint8_t *p;
+    uint64_t val = 0;
+    uint32_t val32;
+    size_t len, n;
+
+    assert(dec && value);
+    if (dec->err) {
+        return 0;
+    }
+    if (optional) {
+        if ((dec->pos >= dec->len) || (1 < dec->buf[dec->pos])) {
+            dec->err = 1;
+            return 0;
+        }
+        if (!dec->buf[dec->pos++]) {
+            return 0;
+        }
+    }
+
+    len = cparser_codec_size(type);
+    if (!len) {
+        /* A string with its length */
+        if ((dec->len - dec->pos) < 2) {
+            dec->err = 1;
+            return 0;
+        }
+        len = ((size_t)dec->buf[dec->pos] << 8) | dec->buf[dec->pos + 1];
+        dec->pos += 2;
+        p = dec->buf + dec->pos;
+        if (((dec->len - dec->pos) < len) || (len >= size) || 
+            memchr(p, '\0', len)) {
+            dec->err = 1;
+            return 0;
+        }
+        if (list) {
+            while (*list && ((strlen(list) != len) || 
+                             memcmp(list, p, len))) {
+                list += strlen(list) + 1;
+            }
+            if (!*list) {
+                dec->err = 1;
+                return 0;
+            }
+        }
+        memcpy(value, p, len);
+        ((char *)value)[len] = '\0';
+        dec->pos += len;
+        return 1;
+    }
+
+    assert(len <= size);
+    if ((dec->len - dec->pos) < len) {
+        dec->err = 1;
+        return 0;
+    }
+    p = dec->buf + dec->pos;
+    dec->pos += len;
+    if (6 == len) {
+        memcpy(value, p, 6);
+        return 1;
+    }
+    for (n = 0; n < len; n++) {
+        val = (val << 8) | p[n];
+    }
+    if (4 == len) {
+        val32 = (uint32_t)val;
+        memcpy(value, &val32, 4);
+    } else {
+        memcpy(value, &val, 8);
+    }
+    return 1;
+}
+
+cparser_result_t
+cparser_decoder_done (const cparser_decoder_t *dec)
+{
+    assert(dec);
+    if (dec->err || (dec->pos != dec->len)) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    return CPARSER_OK;
+}
@@ -0,0 +1,132 @@
+/**
+ * \file     cparser_codec.h
+ * \brief    Binary encoding of the arguments of commands.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008-2009, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPARSER_CODEC_H__
+#define __CPARSER_CODEC_H__
+
+#include "cparser.h"
+#include "cparser_token.h"
+
+/**
+ * \struct   cparser_encoder_t
+ * \brief    State of the encoding of the arguments of a command.
+ * \details  Parameters are encoded in the order of the command. An 
+ *           optional parameter starts with a byte that is 1 if it is
+ *           given and 0 otherwise. Integers and floating point values
+ *           are in network byte order; a MAC address is 6 bytes; a 
+ *           string has a 16-bit length and no NUL.
+ */
+typedef struct cparser_encoder_ {
+    uint8_t  *buf;
+    size_t   size;   /**< Size of 'buf' */
+    size_t   len;    /**< Number of bytes encoded */
+    int      err;    /**< 1 if 'buf' is too small or a value is missing */
+} cparser_encoder_t;
+
+/**
+ * \struct   cparser_decoder_t
+ * \brief    State of the decoding of the arguments of a command.
+ */
+typedef struct cparser_decoder_ {
+    const uint8_t *buf;
+    size_t        len;  /**< Number of bytes in 'buf' */
+    size_t        pos;  /**< Number of bytes decoded */
+    int           err;  /**< 1 if the arguments are invalid */
+} cparser_decoder_t;
+
+/**
+ * \brief    Start encoding into a buffer.
+ */
+void cparser_encoder_init(cparser_encoder_t *enc, void *buf, size_t size);
+
+/**
+ * \brief    Encode a parameter.
+ * \details  This is used by the encode functions generated by 
+ *           mk_parser.py.
+ *
+ * \param    enc      Pointer to the encoder.
+ * \param    type     Node type of the parameter.
+ * \param    optional 1 if the parameter is optional.
+ * \param    value    Pointer to the value; the string itself for 
+ *                    strings, file paths and list keywords. NULL if an 
+ *                    optional parameter is not given.
+ */
+void cparser_encode_arg(cparser_encoder_t *enc, cparser_node_type_t type,
+                        int optional, const void *value);
+
+/**
+ * \brief    Complete the encoding.
+ *
+ * \return   Number of bytes encoded; -1 if the buffer is too small or a
+ *           required parameter is missing.
+ */
+int cparser_encoder_done(const cparser_encoder_t *enc);
+
+/**
+ * \brief    Start decoding arguments.
+ */
+void cparser_decoder_init(cparser_decoder_t *dec, const void *buf, 
+                          size_t len);
+
+/**
+ * \brief    Decode a parameter.
+ * \details  This is used by the decode functions generated by 
+ *           mk_parser.py. Strings, file paths and list keywords are 
+ *           copied into 'value' with a NUL. A list keyword must be one
+ *           of 'list'.
+ *
+ * \param    dec      Pointer to the decoder.
+ * \param    type     Node type of the parameter.
+ * \param    optional 1 if the parameter is optional.
+ * \param    size     Size of 'value'.
+ * \param    list     Keywords of a LIST parameter, each followed by a 
+ *                    NUL, with an empty one at the end. NULL for other
+ *                    types.
+ *
+ * \retval   value    The value.
+ * \return   1 if the parameter is given; 0 if it is not or the 
+ *           arguments are invalid.
+ */
+int cparser_decode_arg(cparser_decoder_t *dec, cparser_node_type_t type,
+                       int optional, void *value, size_t size, 
+                       const char *list);
+
+/**
+ * \brief    Complete the decoding.
+ *
+ * \return   CPARSER_OK if all arguments are decoded; 
+ *           CPARSER_ERR_INVALID_PARAMS if they are invalid or there are
+ *           bytes left.
+ */
+cparser_result_t cparser_decoder_done(const cparser_decoder_t *dec);
+
+#endif /* __CPARSER_CODEC_H__ */
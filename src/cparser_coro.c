@@ -0,0 +1,332 @@
+/**
+ * \file     cparser_coro.c
+ * \brief    Actions that run as coroutines and block on user input.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_coro.h"
+
+#ifdef CPARSER_CORO_ASM
+/*
+ * cparser_coro_switch(save_sp, sp) saves the callee-saved registers, 
+ * the control bits of MXCSR and the x87 control word on the current 
+ * stack, stores the stack pointer in *save_sp and restores the ones
+ * saved on the stack at sp. A new stack starts at cparser_coro_start, 
+ * which calls r13(r12).
+ */
+void cparser_coro_switch(void **save_sp, void *sp);
+void cparser_coro_start(void);
+
+__asm__(".text\n"
+        ".p2align 4\n"
+        ".globl cparser_coro_switch\n"
+        ".hidden cparser_coro_switch\n"
+        ".type cparser_coro_switch, @function\n"
+        "cparser_coro_switch:\n"
+        "    pushq %rbp\n"
+        "    pushq %rbx\n"
+        "    pushq %r12\n"
+        "    pushq %r13\n"
+        "    pushq %r14\n"
+        "    pushq %r15\n"
+        "    subq $8, %rsp\n"
+        "    stmxcsr (%rsp)\n"
+        "    fnstcw 4(%rsp)\n"
+        "    movq %rsp, (%rdi)\n"
+        "    movq %rsi, %rsp\n"
+        "    ldmxcsr (%rsp)\n"
+        "    fldcw 4(%rsp)\n"
+        "    addq $8, %rsp\n"
+        "    popq %r15\n"
+        "    popq %r14\n"
+        "    popq %r13\n"
+        "    popq %r12\n"
+        "    popq %rbx\n"
+        "    popq %rbp\n"
+        "    ret\n"
+        ".size cparser_coro_switch, .-cparser_coro_switch\n"
+        ".globl cparser_coro_start\n"
+        ".hidden cparser_coro_start\n"
+        ".type cparser_coro_start, @function\n"
+        "cparser_coro_start:\n"
+        "    movq %r12, %rdi\n"
+        "    callq *%r13\n"
+        "    ud2\n"
+        ".size cparser_coro_start, .-cparser_coro_start\n");
+#endif /* CPARSER_CORO_ASM */
+
+/**
+ * \brief    Switch from the caller to the coroutine.
+ *
+ * \param    coro Pointer to the coroutine.
+ */
+static void
+cparser_coro_resume (cparser_coro_t *coro)
+{
+#ifdef CPARSER_CORO_ASM
+    cparser_coro_switch(&coro->caller_sp, coro->sp);
+#else
+    swapcontext(&coro->caller, &coro->ctx);
+#endif
+}
+
+/**
+ * \brief    Switch from the coroutine back to its caller.
+ *
+ * \param    coro Pointer to the coroutine.
+ */
+static void
+cparser_coro_yield (cparser_coro_t *coro)
+{
+#ifdef CPARSER_CORO_ASM
+    cparser_coro_switch(&coro->sp, coro->caller_sp);
+#else
+    swapcontext(&coro->ctx, &coro->caller);
+#endif
+}
+
+/**
+ * \brief    Body of a coroutine. It runs one glue function.
+ *
+ * \param    coro Pointer to the coroutine.
+ */
+static void
+cparser_coro_main (cparser_coro_t *coro)
+{
+    coro->rc = coro->glue(coro->parser);
+    coro->active = 0;
+    cparser_coro_yield(coro);
+    assert(0); /* A finished coroutine is never resumed */
+}
+
+#ifndef CPARSER_CORO_ASM
+/**
+ * \brief    Entry of a ucontext coroutine. makecontext() only passes
+ *           int arguments, so the pointer is split into two halves.
+ */
+static void
+cparser_coro_entry (unsigned int hi, unsigned int lo)
+{
+    cparser_coro_main((cparser_coro_t *)
+                      (((uintptr_t)hi << 16 << 16) | (uintptr_t)lo));
+}
+#endif /* !CPARSER_CORO_ASM */
+
+/**
+ * \brief    Set up the stack of a coroutine to run cparser_coro_main().
+ *
+ * \param    coro Pointer to the coroutine.
+ */
+static void
+cparser_coro_setup (cparser_coro_t *coro)
+{
+#ifdef CPARSER_CORO_ASM
+    void **frame;
+    uint32_t mxcsr;
+    uint16_t fpucw;
+
+    /* 
+     * The frame is popped by cparser_coro_switch(): MXCSR and the x87 
+     * control word, r15, r14, r13, r12, rbx, rbp and the return 
+     * address. The stack is 16-byte aligned when cparser_coro_start 
+     * calls cparser_coro_main(). The command starts with the floating 
+     * point settings of its caller.
+     */
+    __asm__ __volatile__("stmxcsr %0" : "=m" (mxcsr));
+    __asm__ __volatile__("fnstcw %0" : "=m" (fpucw));
+    frame = (void **)(((uintptr_t)(coro->stack + coro->stack_size)) & 
+                      ~(uintptr_t)15);
+    frame -= 8;
+    memset(frame, 0, 8 * sizeof(*frame));
+    memcpy(frame, &mxcsr, sizeof(mxcsr));
+    memcpy((char *)frame + 4, &fpucw, sizeof(fpucw));
+    frame[3] = (void *)cparser_coro_main;
+    frame[4] = coro;
+    frame[7] = (void *)cparser_coro_start;
+    coro->sp = frame;
+#else
+    uintptr_t ptr = (uintptr_t)coro;
+
+    getcontext(&coro->ctx);
+    coro->ctx.uc_stack.ss_sp = coro->stack;
+    coro->ctx.uc_stack.ss_size = coro->stack_size;
+    coro->ctx.uc_link = NULL;
+    makecontext(&coro->ctx, (void (*)(void))cparser_coro_entry, 2,
+                (unsigned int)(ptr >> 16 >> 16), (unsigned int)ptr);
+#endif
+}
+
+/**
+ * \brief    Map a stack with a guard page below it.
+ * \details  The stack size is rounded up to pages. An overflow hits the
+ *           guard page and faults instead of corrupting memory.
+ *
+ * \param    coro Pointer to the coroutine. 'stack_size' is updated.
+ *
+ * \return   The lowest address of the stack; NULL if it cannot be 
+ *           mapped.
+ */
+static char *
+cparser_coro_map_stack (cparser_coro_t *coro)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    char *mem;
+
+    coro->stack_size = (coro->stack_size + page - 1) & ~(page - 1);
+    mem = mmap(NULL, coro->stack_size + page, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == mem) {
+        return NULL;
+    }
+    if (mprotect(mem, page, PROT_NONE)) {
+        munmap(mem, coro->stack_size + page);
+        return NULL;
+    }
+    return mem + page;
+}
+
+cparser_result_t
+cparser_coro_init (cparser_coro_t *coro, size_t stack_size, 
+                   const cparser_alloc_t *alloc)
+{
+    if (!coro) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    memset(coro, 0, sizeof(*coro));
+    coro->alloc = alloc;
+    coro->stack_size = (stack_size ? stack_size : CPARSER_CORO_STACK_SIZE);
+    if (alloc) {
+        coro->stack = cparser_mem_alloc(alloc, coro->stack_size);
+    } else {
+        coro->stack = cparser_coro_map_stack(coro);
+    }
+    if (!coro->stack) {
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_coro_fini (cparser_coro_t *coro)
+{
+    if (!coro || !coro->stack) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    if (coro->active) {
+        return CPARSER_NOT_OK;
+    }
+    if (coro->alloc) {
+        cparser_mem_free(coro->alloc, coro->stack, coro->stack_size);
+    } else {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+        munmap(coro->stack - page, coro->stack_size + page);
+    }
+    coro->stack = NULL;
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_coro_exec (cparser_t *parser, cparser_glue_fn glue)
+{
+    cparser_coro_t *coro;
+
+    assert(VALID_PARSER(parser) && glue);
+    coro = (cparser_coro_t *)parser->cfg.exec_cookie;
+    assert(coro && coro->stack && !coro->active);
+
+    coro->parser = parser;
+    coro->glue = glue;
+    coro->active = 1;
+    (void)cparser_async_handle(&parser->context, &coro->async);
+    cparser_coro_setup(coro);
+    cparser_coro_resume(coro);
+
+    /* The command waits for input if the coroutine is still active */
+    return (coro->active ? CPARSER_PENDING : coro->rc);
+}
+
+/**
+ * \brief    User input callback of cparser_prompt(). It resumes the 
+ *           coroutine and completes the command when its glue function
+ *           returns.
+ */
+static cparser_result_t
+cparser_coro_input (cparser_t *parser, char *buf, int buf_size)
+{
+    cparser_coro_t *coro = (cparser_coro_t *)parser->cfg.exec_cookie;
+    cparser_result_t rc;
+
+    assert(coro && coro->active);
+    cparser_coro_resume(coro);
+    if (coro->active || (CPARSER_PENDING == coro->rc)) {
+        /* Waiting for more input or completed by the action later */
+        return CPARSER_OK;
+    }
+    rc = cparser_complete_async(&coro->async, coro->rc);
+    assert(CPARSER_OK == rc);
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_prompt (cparser_t *parser, const char *prompt, int do_echo,
+                char *buf, int buf_size)
+{
+    cparser_coro_t *coro;
+    cparser_result_t rc;
+
+    if (!VALID_PARSER(parser) || !buf || (0 >= buf_size) ||
+        (cparser_coro_exec != parser->cfg.exec)) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    coro = (cparser_coro_t *)parser->cfg.exec_cookie;
+    if (!coro || !coro->active || (coro->parser != parser) ||
+        ((char *)&coro < coro->stack) || 
+        ((char *)&coro >= (coro->stack + coro->stack_size))) {
+        /* Not called on the stack of the coroutine */
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+
+    rc = cparser_user_input(parser, prompt, do_echo, buf, buf_size, 
+                            cparser_coro_input);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    cparser_coro_yield(coro);
+
+    /* The line is entered */
+    parser->cfg.printc(parser, '\n');
+    return CPARSER_OK;
+}
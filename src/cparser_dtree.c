@@ -0,0 +1,906 @@
+/**
+ * \file     cparser_dtree.c
+ * \brief    Parse trees with commands added and removed at run time.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_image.h"
+
+/** Initial number of hash buckets of a tree. Must be a power of 2. */
+#define DTREE_MIN_BUCKETS    64
+
+/** Reference count of nodes that are never freed */
+#define DNODE_PERMANENT      UINT32_MAX
+
+#define IS_KEYWORD_CHAR(c)   (isalnum((unsigned char)(c)) || ('-' == (c)) || \
+                              ('_' == (c)))
+
+typedef struct cparser_dnode_ cparser_dnode_t;
+
+/**
+ * \struct   cparser_dnode_t
+ * \brief    A node of a run-time tree.
+ * \details  Its strings and list nodes are allocated with it. A node is 
+ *           identified by its parent and its token: the keyword, the 
+ *           type and name of a parameter, the keywords of a LIST or the 
+ *           glue function of an END.
+ */
+struct cparser_dnode_ {
+    cparser_node_t   node;       /**< The node. Must be the first field. */
+    cparser_dnode_t  *parent;    /**< Parent node. NULL for the root. */
+    cparser_dnode_t  *prev;      /**< Previous sibling */
+    cparser_dnode_t  *last;      /**< Last child */
+    cparser_dnode_t  *hash_next; /**< Next node in the same hash bucket */
+    /** Keyword, parameter name or LIST keywords separated by ',' */
+    const char       *name;
+    int              name_len;
+    uint32_t         hash;
+    /** Number of command paths through the node or DNODE_PERMANENT */
+    uint32_t         refcnt;
+    size_t           size;       /**< Number of bytes allocated */
+};
+
+/**
+ * \struct   cparser_dtoken_t
+ * \brief    A token of a command being added or removed.
+ */
+typedef struct {
+    cparser_node_type_t  type;
+    uint32_t             flags;
+    const char           *name;      /**< See cparser_dnode_t */
+    int                  name_len;
+    const char           *desc;      /**< Description of a parameter */
+    int                  desc_len;
+} cparser_dtoken_t;
+
+/**
+ * \brief    Add bytes to a FNV-1a hash.
+ */
+static uint32_t
+cparser_dtree_fnv (uint32_t hash, const void *buf, size_t size)
+{
+    const uint8_t *ptr = (const uint8_t *)buf;
+    size_t n;
+
+    for (n = 0; n < size; n++) {
+        hash = (hash ^ ptr[n]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * \brief    Compute the hash of a node.
+ *
+ * \param    parent   Pointer to the parent node.
+ * \param    type     Node type.
+ * \param    partial  Whether an END node is of a partial command.
+ * \param    name     Name of the node. See cparser_dnode_t.
+ * \param    name_len Length of the name.
+ * \param    fn       Glue function of an END node.
+ *
+ * \return   32-bit hash.
+ */
+static uint32_t
+cparser_dtree_hash (const cparser_dnode_t *parent, cparser_node_type_t type,
+                    int partial, const char *name, int name_len,
+                    cparser_glue_fn fn)
+{
+    uint32_t hash = 2166136261u;
+
+    hash = cparser_dtree_fnv(hash, &parent, sizeof(parent));
+    hash = cparser_dtree_fnv(hash, &type, sizeof(type));
+    if (CPARSER_NODE_END == type) {
+        partial = (0 != partial);
+        hash = cparser_dtree_fnv(hash, &partial, sizeof(partial));
+        return cparser_dtree_fnv(hash, &fn, sizeof(fn));
+    }
+    return cparser_dtree_fnv(hash, name, name_len);
+}
+
+/**
+ * \brief    Find a child node.
+ *
+ * \param    tree     Pointer to the tree.
+ * \param    parent   Pointer to the parent node.
+ * \param    type     Node type.
+ * \param    partial  Whether an END node is of a partial command.
+ * \param    name     Name of the node. See cparser_dnode_t.
+ * \param    name_len Length of the name.
+ * \param    fn       Glue function of an END node.
+ *
+ * \return   Pointer to the child node; NULL if it does not exist.
+ */
+static cparser_dnode_t *
+cparser_dtree_find (const cparser_tree_t *tree, const cparser_dnode_t *parent,
+                    cparser_node_type_t type, int partial, const char *name,
+                    int name_len, cparser_glue_fn fn)
+{
+    cparser_dnode_t *dnode;
+    uint32_t hash;
+
+    hash = cparser_dtree_hash(parent, type, partial, name, name_len, fn);
+    for (dnode = tree->buckets[hash & (tree->num_buckets - 1)]; dnode;
+         dnode = dnode->hash_next) {
+        if ((dnode->hash != hash) || (dnode->parent != parent) ||
+            (dnode->node.type != type)) {
+            continue;
+        }
+        if (CPARSER_NODE_END == type) {
+            if (((cparser_glue_fn)dnode->node.param == fn) &&
+                (!(dnode->node.flags & CPARSER_NODE_FLAGS_OPT_PARTIAL) == 
+                 !partial)) {
+                return dnode;
+            }
+        } else if ((dnode->name_len == name_len) &&
+                   !memcmp(dnode->name, name, name_len)) {
+            return dnode;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * \brief    Double the number of hash buckets of a tree.
+ * \details  The tree keeps working with the current buckets if there is
+ *           not enough memory.
+ *
+ * \param    tree Pointer to the tree.
+ */
+static void
+cparser_dtree_grow (cparser_tree_t *tree)
+{
+    cparser_dnode_t **buckets, *dnode, *next;
+    uint32_t num_buckets = tree->num_buckets * 2, n;
+
+    buckets = cparser_mem_alloc(tree->alloc, num_buckets * sizeof(*buckets));
+    if (!buckets) {
+        return;
+    }
+    for (n = 0; n < tree->num_buckets; n++) {
+        for (dnode = tree->buckets[n]; dnode; dnode = next) {
+            next = dnode->hash_next;
+            dnode->hash_next = buckets[dnode->hash & (num_buckets - 1)];
+            buckets[dnode->hash & (num_buckets - 1)] = dnode;
+        }
+    }
+    cparser_mem_free(tree->alloc, tree->buckets, 
+                     tree->num_buckets * sizeof(*buckets));
+    tree->buckets = buckets;
+    tree->num_buckets = num_buckets;
+}
+
+/**
+ * \brief    Create a node and append it to the children of its parent.
+ *
+ * \param    tree     Pointer to the tree.
+ * \param    parent   Pointer to the parent node. NULL for the root.
+ * \param    type     Node type.
+ * \param    flags    Node flags.
+ * \param    name     Name of the node. See cparser_dnode_t.
+ * \param    name_len Length of the name.
+ * \param    desc     Description. May be NULL.
+ * \param    desc_len Length of the description.
+ * \param    fn       Glue function of an END node.
+ *
+ * \return   Pointer to the node; NULL if there is not enough memory.
+ */
+static cparser_dnode_t *
+cparser_dnode_new (cparser_tree_t *tree, cparser_dnode_t *parent,
+                   cparser_node_type_t type, uint32_t flags, const char *name,
+                   int name_len, const char *desc, int desc_len,
+                   cparser_glue_fn fn)
+{
+    cparser_dnode_t *dnode;
+    cparser_list_node_t *lnode;
+    const char *type_name = cparser_type_name_tbl[type];
+    size_t size, type_len = strlen(type_name);
+    int num_kw = 0, n;
+    char *str;
+
+    /* Count the LIST keywords */
+    if (CPARSER_NODE_LIST == type) {
+        num_kw = 1;
+        for (n = 0; n < name_len; n++) {
+            num_kw += (',' == name[n]);
+        }
+    }
+
+    /* Strings follow the node and its list nodes */
+    size = sizeof(*dnode) + num_kw * sizeof(*lnode) + name_len + 1;
+    if (CPARSER_NODE_LIST == type) {
+        size += name_len + 1; /* separated keywords */
+    } else if (CPARSER_NODE_KEYWORD < type) {
+        size += type_len + 3; /* "<TYPE:" and ">" */
+    }
+    if (desc) {
+        size += desc_len + 1;
+    }
+    dnode = cparser_mem_alloc(tree->alloc, size);
+    if (!dnode) {
+        return NULL;
+    }
+    dnode->size = size;
+    dnode->node.type = type;
+    dnode->node.flags = flags;
+    lnode = (cparser_list_node_t *)(dnode + 1);
+    str = (char *)(lnode + num_kw);
+
+    /* Build the name and the parameter */
+    if (CPARSER_NODE_END == type) {
+        dnode->node.param = fn;
+    } else if (CPARSER_NODE_KEYWORD == type) {
+        dnode->node.param = str;
+    } else if (CPARSER_NODE_LIST == type) {
+        dnode->node.param = lnode;
+    } else if (CPARSER_NODE_ROOT != type) {
+        dnode->node.param = str;
+        str += sprintf(str, "<%s:", type_name);
+    }
+    if (name_len) {
+        memcpy(str, name, name_len);
+    }
+    dnode->name = str;
+    dnode->name_len = name_len;
+    str += name_len;
+    if ((CPARSER_NODE_KEYWORD < type) && (CPARSER_NODE_LIST != type)) {
+        *str++ = '>';
+    }
+    str++; /* NULL-terminated */
+    if (CPARSER_NODE_LIST == type) {
+        /* Each keyword is a separate string */
+        memcpy(str, name, name_len);
+        for (n = 0; n < num_kw; n++) {
+            lnode[n].next = ((n + 1) < num_kw ? &lnode[n+1] : NULL);
+            lnode[n].keyword = str;
+            str += strcspn(str, ",");
+            *str++ = '\0';
+        }
+    }
+    if (desc) {
+        memcpy(str, desc, desc_len);
+        dnode->node.desc = str;
+    }
+
+    /* Append it to the children of its parent */
+    dnode->parent = parent;
+    if (parent) {
+        dnode->prev = parent->last;
+        if (parent->last) {
+            parent->last->node.sibling = &dnode->node;
+        } else {
+            parent->node.children = &dnode->node;
+        }
+        parent->last = dnode;
+    }
+
+    /* Index it */
+    dnode->hash = cparser_dtree_hash(parent, type, 
+                                     flags & CPARSER_NODE_FLAGS_OPT_PARTIAL,
+                                     name, name_len, fn);
+    if (tree->num_nodes >= tree->num_buckets) {
+        cparser_dtree_grow(tree);
+    }
+    dnode->hash_next = tree->buckets[dnode->hash & (tree->num_buckets - 1)];
+    tree->buckets[dnode->hash & (tree->num_buckets - 1)] = dnode;
+    tree->num_nodes++;
+    return dnode;
+}
+
+/**
+ * \brief    Unlink a node without children and free it.
+ *
+ * \param    tree  Pointer to the tree.
+ * \param    dnode Pointer to the node.
+ */
+static void
+cparser_dnode_free (cparser_tree_t *tree, cparser_dnode_t *dnode)
+{
+    cparser_dnode_t **pptr, *next;
+
+    assert(!dnode->node.children && dnode->parent);
+    next = (cparser_dnode_t *)dnode->node.sibling;
+    if (dnode->prev) {
+        dnode->prev->node.sibling = dnode->node.sibling;
+    } else {
+        dnode->parent->node.children = dnode->node.sibling;
+    }
+    if (next) {
+        next->prev = dnode->prev;
+    } else {
+        dnode->parent->last = dnode->prev;
+    }
+
+    pptr = &tree->buckets[dnode->hash & (tree->num_buckets - 1)];
+    while (*pptr != dnode) {
+        pptr = &(*pptr)->hash_next;
+    }
+    *pptr = dnode->hash_next;
+    tree->num_nodes--;
+    cparser_mem_free(tree->alloc, dnode, dnode->size);
+}
+
+/**
+ * \brief    Release a path of a command.
+ * \details  The reference count of a node and all its non-permanent 
+ *           ancestors is decremented. Nodes that are no longer 
+ *           referenced are freed.
+ *
+ * \param    tree  Pointer to the tree.
+ * \param    dnode Pointer to the last node of the path.
+ */
+static void
+cparser_dtree_release (cparser_tree_t *tree, cparser_dnode_t *dnode)
+{
+    cparser_dnode_t *parent;
+
+    while (dnode && (DNODE_PERMANENT != dnode->refcnt)) {
+        parent = dnode->parent;
+        if (!--dnode->refcnt) {
+            cparser_dnode_free(tree, dnode);
+        }
+        dnode = parent;
+    }
+}
+
+/**
+ * \brief    Parse one token of a command.
+ * \details  The syntax is the same as in a .cli file: a keyword,
+ *           "<TYPE:name>", "<TYPE:name:description>" or 
+ *           "<LIST:kw1,kw2,...:name>" (with an optional description).
+ *
+ * \param    str   Pointer to the token.
+ * \param    len   Length of the token.
+ * \param    token Pointer to the parsed token.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_PARSE_ERR otherwise.
+ */
+static cparser_result_t
+cparser_dtree_parse_token (const char *str, int len, cparser_dtoken_t *token)
+{
+    const char *end = str + len, *ptr, *name;
+    int n, type_len;
+
+    for (n = 0; (n < len) && IS_KEYWORD_CHAR(str[n]); n++);
+    if (n == len) {
+        token->type = CPARSER_NODE_KEYWORD;
+        token->name = str;
+        token->name_len = len;
+        return CPARSER_OK;
+    }
+    if ((3 > len) || ('<' != str[0]) || ('>' != str[len-1])) {
+        return CPARSER_ERR_PARSE_ERR;
+    }
+    end--; /* drop '>' */
+
+    /* Type */
+    for (ptr = str + 1; (ptr < end) && (':' != *ptr); ptr++);
+    type_len = ptr - (str + 1);
+    for (n = CPARSER_NODE_KEYWORD + 1; n < CPARSER_MAX_NODES; n++) {
+        if ((strlen(cparser_type_name_tbl[n]) == type_len) &&
+            !memcmp(cparser_type_name_tbl[n], str + 1, type_len)) {
+            break;
+        }
+    }
+    if ((CPARSER_MAX_NODES == n) || (ptr == end)) {
+        return CPARSER_ERR_PARSE_ERR;
+    }
+    token->type = n;
+    ptr++;
+
+    /* Keywords of a LIST */
+    if (CPARSER_NODE_LIST == token->type) {
+        token->name = ptr;
+        for (n = 0; (ptr < end) && (':' != *ptr); ptr++) {
+            if (',' == *ptr) {
+                if (!n) {
+                    return CPARSER_ERR_PARSE_ERR;
+                }
+                n = 0;
+            } else if (!IS_KEYWORD_CHAR(*ptr)) {
+                return CPARSER_ERR_PARSE_ERR;
+            } else {
+                n++;
+            }
+        }
+        if (!n || (ptr == end)) {
+            return CPARSER_ERR_PARSE_ERR;
+        }
+        token->name_len = ptr - token->name;
+        ptr++;
+    }
+
+    /* Parameter name */
+    name = ptr;
+    if ((ptr == end) || !isalpha((unsigned char)*ptr)) {
+        return CPARSER_ERR_PARSE_ERR;
+    }
+    for (; (ptr < end) && (':' != *ptr); ptr++) {
+        if (!isalnum((unsigned char)*ptr) && ('_' != *ptr)) {
+            return CPARSER_ERR_PARSE_ERR;
+        }
+    }
+    if (CPARSER_NODE_LIST != token->type) {
+        token->name = name;
+        token->name_len = ptr - name;
+    }
+
+    /* Description */
+    if (ptr < end) {
+        if ((ptr + 1) == end) {
+            return CPARSER_ERR_PARSE_ERR;
+        }
+        token->desc = ptr + 1;
+        token->desc_len = end - (ptr + 1);
+    }
+    return CPARSER_OK;
+}
+
+/**
+ * \brief    Parse a command into tokens.
+ * \details  '{' and '}' do not produce tokens. They set the optional 
+ *           flags of the tokens in the same way as mk_parser.py.
+ *
+ * \param    tree       Pointer to the tree.
+ * \param    cmd        Command string.
+ * \retval   tokens     Array of tokens. Free it with cparser_mem_free().
+ * \retval   num_tokens Number of tokens.
+ * \retval   num_opt    Number of optional parts.
+ * \retval   size       Number of bytes allocated for 'tokens'.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_PARSE_ERR if the command
+ *           is malformed; CPARSER_ERR_OUT_OF_RES if there is not enough 
+ *           memory.
+ */
+static cparser_result_t
+cparser_dtree_parse (cparser_tree_t *tree, const char *cmd,
+                     cparser_dtoken_t **tokens, int *num_tokens, int *num_opt,
+                     size_t *size)
+{
+    cparser_dtoken_t *token;
+    const char *ptr;
+    uint32_t hidden = 0;
+    int len, n = 0, max = 0, num_start = 0, num_end = 0, start = 0;
+
+    /* Allocate one token per word */
+    for (ptr = cmd; *ptr; ptr++) {
+        max += (!isspace((unsigned char)*ptr) &&
+                ((ptr == cmd) || isspace((unsigned char)ptr[-1])));
+    }
+    if (!max) {
+        return CPARSER_ERR_PARSE_ERR;
+    }
+    *size = max * sizeof(**tokens);
+    *tokens = cparser_mem_alloc(tree->alloc, *size);
+    if (!*tokens) {
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+
+    for (ptr = cmd; isspace((unsigned char)*ptr); ptr++);
+    if ('+' == *ptr) {
+        hidden = CPARSER_NODE_FLAGS_HIDDEN;
+        ptr++;
+    }
+    while (*ptr) {
+        if (isspace((unsigned char)*ptr)) {
+            ptr++;
+            continue;
+        }
+        for (len = 0; ptr[len] && !isspace((unsigned char)ptr[len]); len++);
+        if ((1 == len) && ('{' == *ptr)) {
+            start = 1;
+            num_start++;
+        } else if ((1 == len) && ('}' == *ptr)) {
+            if (!n || start || (num_end == num_start)) {
+                break;
+            }
+            token = &(*tokens)[n-1];
+            token->flags |= CPARSER_NODE_FLAGS_OPT_END;
+            num_end++;
+            if (num_end == num_start) {
+                token->flags &= ~CPARSER_NODE_FLAGS_OPT_PARTIAL;
+            }
+        } else {
+            token = &(*tokens)[n++];
+            if (CPARSER_OK != cparser_dtree_parse_token(ptr, len, token)) {
+                break;
+            }
+            token->flags = hidden;
+            if (num_start > num_end) {
+                token->flags |= CPARSER_NODE_FLAGS_OPT_PARTIAL;
+            }
+            if (start) {
+                token->flags |= CPARSER_NODE_FLAGS_OPT_START;
+            }
+            start = 0;
+        }
+        ptr += len;
+    }
+    if (*ptr || !n || (num_start != num_end)) {
+        cparser_mem_free(tree->alloc, *tokens, *size);
+        return CPARSER_ERR_PARSE_ERR;
+    }
+    *num_tokens = n;
+    *num_opt = num_start;
+    return CPARSER_OK;
+}
+
+/**
+ * \brief    Find the last node of a path of a command.
+ *
+ * \param    tree       Pointer to the tree.
+ * \param    tokens     Tokens of the command.
+ * \param    num_tokens Number of tokens.
+ * \param    k          Number of optional parts in the path.
+ *
+ * \return   Pointer to the node; NULL if the path does not exist.
+ */
+static cparser_dnode_t *
+cparser_dtree_lookup (const cparser_tree_t *tree, 
+                      const cparser_dtoken_t *tokens, int num_tokens, int k)
+{
+    cparser_dnode_t *dnode = (cparser_dnode_t *)tree->root;
+    int n, num_braces = 0;
+
+    for (n = 0; dnode && (n < num_tokens); n++) {
+        if ((tokens[n].flags & CPARSER_NODE_FLAGS_OPT_START) &&
+            (num_braces++ == k)) {
+            break;
+        }
+        dnode = cparser_dtree_find(tree, dnode, tokens[n].type, 0, 
+                                   tokens[n].name, tokens[n].name_len, NULL);
+    }
+    return dnode;
+}
+
+/**
+ * \brief    Find the END node of a complete command under a node.
+ *
+ * \param    dnode Pointer to the node.
+ *
+ * \return   Pointer to the END node; NULL if there is none.
+ */
+static cparser_dnode_t *
+cparser_dtree_find_end (const cparser_dnode_t *dnode)
+{
+    cparser_node_t *node;
+
+    for (node = dnode->node.children; node; node = node->sibling) {
+        if ((CPARSER_NODE_END == node->type) &&
+            !(node->flags & CPARSER_NODE_FLAGS_OPT_PARTIAL)) {
+            return (cparser_dnode_t *)node;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * \brief    Copy the children of a node of another tree.
+ *
+ * \param    tree   Pointer to the tree.
+ * \param    base   Pointer to the other tree.
+ * \param    parent Pointer to the node that receives the copies.
+ * \param    src    Pointer to the node of the other tree.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_OUT_OF_RES if there is
+ *           not enough memory.
+ */
+static cparser_result_t
+cparser_dtree_copy (cparser_tree_t *tree, const cparser_tree_t *base,
+                    cparser_dnode_t *parent, const cparser_node_t *src)
+{
+    const cparser_node_t *child;
+    cparser_list_node_t *lnode;
+    cparser_dnode_t *dnode;
+    cparser_glue_fn fn = NULL;
+    const char *name = NULL, *kw, *desc;
+    char *list = NULL;
+    size_t list_size = 0;
+    int name_len = 0;
+    uint32_t flags;
+    cparser_result_t rc;
+
+    for (child = NODE_CHILDREN(src); child; child = NODE_SIBLING(child)) {
+        switch (child->type) {
+            case CPARSER_NODE_ROOT:
+            case CPARSER_NODE_END:
+                name = NULL;
+                name_len = 0;
+                if (CPARSER_NODE_ROOT == child->type) {
+                    break;
+                }
+                if (NODE_HAS_CMD_ID(child)) {
+                    assert(NODE_CMD_ID(child) < base->num_cmds);
+                    fn = base->glue[NODE_CMD_ID(child)];
+                } else {
+                    fn = (cparser_glue_fn)child->param;
+                }
+                break;
+            case CPARSER_NODE_KEYWORD:
+                name = NODE_PARAM(child);
+                name_len = strlen(name);
+                break;
+            case CPARSER_NODE_LIST:
+                /* Join the keywords */
+                list_size = 0;
+                for (lnode = NODE_PARAM(child); lnode; 
+                     lnode = LIST_NODE_NEXT(child, lnode)) {
+                    list_size += strlen(LIST_NODE_KEYWORD(child, lnode)) + 1;
+                }
+                list = cparser_mem_alloc(tree->alloc, list_size);
+                if (!list) {
+                    return CPARSER_ERR_OUT_OF_RES;
+                }
+                name_len = 0;
+                for (lnode = NODE_PARAM(child); lnode; 
+                     lnode = LIST_NODE_NEXT(child, lnode)) {
+                    kw = LIST_NODE_KEYWORD(child, lnode);
+                    name_len += sprintf(list + name_len, "%s%s", 
+                                        (name_len ? "," : ""), kw);
+                }
+                name = list;
+                break;
+            default:
+                /* Take the name out of "<TYPE:name>" */
+                name = NODE_PARAM(child);
+                name += strlen(cparser_type_name_tbl[child->type]) + 2;
+                name_len = strlen(name) - 1;
+                break;
+        }
+        desc = NODE_DESC(base, child);
+        /* Commands added later may overlap with any node */
+        flags = child->flags & ~(CPARSER_NODE_FLAGS_IMAGE |
+                                 CPARSER_NODE_FLAGS_PACKED |
+                                 CPARSER_NODE_FLAGS_NO_OVERLAP);
+        dnode = cparser_dnode_new(tree, parent, child->type, flags,
+                                  name, name_len, desc, 
+                                  (desc ? strlen(desc) : 0), fn);
+        if (list) {
+            cparser_mem_free(tree->alloc, list, list_size);
+            list = NULL;
+        }
+        if (!dnode) {
+            return CPARSER_ERR_OUT_OF_RES;
+        }
+        /* Nodes of commands added to a run-time base stay removable */
+        dnode->refcnt = (base->buckets ? 
+                         ((const cparser_dnode_t *)child)->refcnt :
+                         DNODE_PERMANENT);
+        rc = cparser_dtree_copy(tree, base, dnode, child);
+        if (CPARSER_OK != rc) {
+            return rc;
+        }
+    }
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_tree_init (cparser_tree_t *tree, const cparser_tree_t *base,
+                   const cparser_alloc_t *alloc)
+{
+    cparser_dnode_t *root;
+
+    if (!tree || (base && !base->root)) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    memset(tree, 0, sizeof(*tree));
+    tree->alloc = alloc;
+    tree->buckets = cparser_mem_alloc(alloc, DTREE_MIN_BUCKETS * 
+                                      sizeof(*tree->buckets));
+    if (!tree->buckets) {
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    tree->num_buckets = DTREE_MIN_BUCKETS;
+
+    root = cparser_dnode_new(tree, NULL, CPARSER_NODE_ROOT, 0, NULL, 0,
+                             (base ? NODE_DESC(base, base->root) : NULL), 
+                             (base && NODE_DESC(base, base->root) ? 
+                              strlen(NODE_DESC(base, base->root)) : 0), NULL);
+    if (root) {
+        root->refcnt = DNODE_PERMANENT;
+        tree->root = &root->node;
+    }
+    if (!root || 
+        (base && (CPARSER_OK != cparser_dtree_copy(tree, base, root, 
+                                                   base->root)))) {
+        cparser_tree_fini(tree);
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_tree_fini (cparser_tree_t *tree)
+{
+    cparser_dnode_t *dnode, *next;
+    uint32_t n;
+
+    if (!tree || !tree->buckets) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    for (n = 0; n < tree->num_buckets; n++) {
+        for (dnode = tree->buckets[n]; dnode; dnode = next) {
+            next = dnode->hash_next;
+            cparser_mem_free(tree->alloc, dnode, dnode->size);
+        }
+    }
+    cparser_mem_free(tree->alloc, tree->buckets, 
+                     tree->num_buckets * sizeof(*tree->buckets));
+    memset(tree, 0, sizeof(*tree));
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_tree_add (cparser_tree_t *tree, const char *cmd, cparser_glue_fn fn,
+                  const char *desc)
+{
+    cparser_dtoken_t *tokens, *token;
+    cparser_dnode_t *dnode, *child, **ends;
+    size_t size;
+    int num_tokens, num_opt, num_braces, partial, k, n;
+    cparser_result_t rc;
+
+    if (!tree || !tree->buckets || !cmd || !fn) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    rc = cparser_dtree_parse(tree, cmd, &tokens, &num_tokens, &num_opt, &size);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+
+    /* The complete command must be new */
+    dnode = cparser_dtree_lookup(tree, tokens, num_tokens, num_opt);
+    if (dnode && cparser_dtree_find_end(dnode)) {
+        cparser_mem_free(tree->alloc, tokens, size);
+        return CPARSER_NOT_OK;
+    }
+    ends = cparser_mem_alloc(tree->alloc, (num_opt + 1) * sizeof(*ends));
+    if (!ends) {
+        cparser_mem_free(tree->alloc, tokens, size);
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+
+    /* 
+     * Insert one path for each number of optional parts. Every node of 
+     * a path is referenced once by the path.
+     */
+    for (k = 0; k <= num_opt; k++) {
+        child = dnode = (cparser_dnode_t *)tree->root;
+        num_braces = 0;
+        for (n = 0; n < num_tokens; n++) {
+            token = &tokens[n];
+            if ((token->flags & CPARSER_NODE_FLAGS_OPT_START) &&
+                (num_braces++ == k)) {
+                break;
+            }
+            child = cparser_dtree_find(tree, dnode, token->type, 0, 
+                                       token->name, token->name_len, NULL);
+            if (!child) {
+                child = cparser_dnode_new(tree, dnode, token->type, 
+                                          token->flags, token->name,
+                                          token->name_len, token->desc,
+                                          token->desc_len, NULL);
+            } else if (!(token->flags & CPARSER_NODE_FLAGS_HIDDEN)) {
+                child->node.flags &= ~CPARSER_NODE_FLAGS_HIDDEN;
+            }
+            if (!child) {
+                break;
+            }
+            if (DNODE_PERMANENT != child->refcnt) {
+                child->refcnt++;
+            }
+            dnode = child;
+        }
+        if (!child) {
+            break; /* out of memory */
+        }
+
+        /* Only the complete command has a description */
+        partial = (k < num_opt ? CPARSER_NODE_FLAGS_OPT_PARTIAL : 0);
+        child = cparser_dtree_find(tree, dnode, CPARSER_NODE_END, partial,
+                                   NULL, 0, fn);
+        if (!child) {
+            child = cparser_dnode_new(tree, dnode, CPARSER_NODE_END, 
+                                      partial | (tokens[0].flags &
+                                                 CPARSER_NODE_FLAGS_HIDDEN),
+                                      NULL, 0, 
+                                      (partial ? NULL : desc), 
+                                      (desc ? strlen(desc) : 0), fn);
+            if (!child) {
+                break;
+            }
+        }
+        if (DNODE_PERMANENT != child->refcnt) {
+            child->refcnt++;
+        }
+        ends[k] = child;
+    }
+
+    if (k <= num_opt) {
+        /* Undo the paths inserted so far */
+        cparser_dtree_release(tree, dnode);
+        while (k--) {
+            cparser_dtree_release(tree, ends[k]);
+        }
+        rc = CPARSER_ERR_OUT_OF_RES;
+    } else {
+        tree->gen++;
+    }
+    cparser_mem_free(tree->alloc, ends, (num_opt + 1) * sizeof(*ends));
+    cparser_mem_free(tree->alloc, tokens, size);
+    return rc;
+}
+
+cparser_result_t
+cparser_tree_remove (cparser_tree_t *tree, const char *cmd)
+{
+    cparser_dtoken_t *tokens;
+    cparser_dnode_t *dnode;
+    cparser_glue_fn fn;
+    size_t size;
+    int num_tokens, num_opt, k;
+    cparser_result_t rc;
+
+    if (!tree || !tree->buckets || !cmd) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    rc = cparser_dtree_parse(tree, cmd, &tokens, &num_tokens, &num_opt, &size);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+
+    /* The END node of the complete command gives the glue function */
+    dnode = cparser_dtree_lookup(tree, tokens, num_tokens, num_opt);
+    if (dnode) {
+        dnode = cparser_dtree_find_end(dnode);
+    }
+    if (!dnode || (DNODE_PERMANENT == dnode->refcnt)) {
+        cparser_mem_free(tree->alloc, tokens, size);
+        return CPARSER_ERR_NOT_EXIST;
+    }
+    fn = (cparser_glue_fn)dnode->node.param;
+
+    for (k = 0; k <= num_opt; k++) {
+        dnode = cparser_dtree_lookup(tree, tokens, num_tokens, k);
+        assert(dnode);
+        dnode = cparser_dtree_find(tree, dnode, CPARSER_NODE_END, 
+                                   (k < num_opt), NULL, 0, fn);
+        assert(dnode && (DNODE_PERMANENT != dnode->refcnt));
+        cparser_dtree_release(tree, dnode);
+    }
+    tree->gen++;
+    cparser_mem_free(tree->alloc, tokens, size);
+    return CPARSER_OK;
+}
@@ -0,0 +1,467 @@
+/**
+ * \file     cparser_exec.c
+ * \brief    Executor that runs actions in a pool of worker threads.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_exec.h"
+
+/** Initial size of the output buffer of a job */
+#define CPARSER_EXEC_OUT_SIZE      (256)
+
+/**
+ * \struct   cparser_exec_job_t
+ * \brief    A command submitted to an executor.
+ * \details  The job, its tokens, cookies and token strings are allocated
+ *           in one block.
+ */
+struct cparser_exec_job_ {
+    /** 
+     * Copy of the parser the glue function runs on. It is the first
+     * field so the output functions can find the job.
+     */
+    cparser_t           parser;
+    cparser_t           *session;  /**< Parser that submitted the job */
+    cparser_exec_t      *exec;     /**< Executor of the job */
+    cparser_glue_fn     glue;      /**< Glue function of the command */
+    cparser_async_t     async;     /**< Handle of the pending command */
+    size_t              size;      /**< Size of the block */
+    pthread_mutex_t     lock;      /**< Lock of the fields below */
+    char                *out;      /**< Output not yet printed */
+    size_t              out_len;   /**< Number of characters in 'out' */
+    size_t              out_size;  /**< Size of 'out' */
+    int                 done;      /**< 1 if the glue function returned */
+    cparser_result_t    rc;        /**< Result of the command */
+};
+
+/**
+ * \brief    Append output to the buffer of a job.
+ *
+ * \param    job Pointer to the job.
+ * \param    s   Output characters.
+ * \param    len Number of characters.
+ */
+static void
+cparser_exec_out (cparser_exec_job_t *job, const char *s, size_t len)
+{
+    cparser_exec_t *exec = job->exec;
+    size_t size;
+    char *out;
+    int was_empty;
+
+    pthread_mutex_lock(&job->lock);
+    if ((job->out_len + len + 1) > job->out_size) {
+        size = (job->out_size ? (2 * job->out_size) : CPARSER_EXEC_OUT_SIZE);
+        if (size < (job->out_len + len + 1)) {
+            size = job->out_len + len + 1;
+        }
+        out = cparser_mem_alloc(exec->alloc, size);
+        if (!out) {
+            /* The output is dropped */
+            pthread_mutex_unlock(&job->lock);
+            return;
+        }
+        if (job->out) {
+            memcpy(out, job->out, job->out_len);
+            cparser_mem_free(exec->alloc, job->out, job->out_size);
+        }
+        job->out = out;
+        job->out_size = size;
+    }
+    was_empty = !job->out_len;
+    memcpy(job->out + job->out_len, s, len);
+    job->out_len += len;
+    job->out[job->out_len] = '\0';
+    pthread_mutex_unlock(&job->lock);
+
+    if (was_empty && exec->notify) {
+        exec->notify(job->session, exec->cookie);
+    }
+}
+
+static void
+cparser_exec_printc (const cparser_t *parser, const char ch)
+{
+    if (!parser->quiet) {
+        cparser_exec_out((cparser_exec_job_t *)parser, &ch, 1);
+    }
+}
+
+static void
+cparser_exec_prints (const cparser_t *parser, const char *s)
+{
+    if (!parser->quiet) {
+        cparser_exec_out((cparser_exec_job_t *)parser, s, strlen(s));
+    }
+}
+
+/**
+ * \brief    Take a job for a worker.
+ * \details  The oldest job of the worker is taken. If it has none, the
+ *           newest job of another worker is stolen.
+ *
+ * \param    worker Pointer to the worker.
+ *
+ * \return   Pointer to the job; NULL if all queues are empty.
+ */
+static cparser_exec_job_t *
+cparser_exec_take (cparser_exec_worker_t *worker)
+{
+    cparser_exec_t *exec = worker->exec;
+    cparser_exec_worker_t *victim;
+    cparser_exec_job_t *job = NULL;
+    int n;
+
+    pthread_mutex_lock(&worker->lock);
+    if (worker->count) {
+        job = worker->jobs[worker->head];
+        worker->head = (worker->head + 1) % exec->max_jobs;
+        worker->count--;
+    }
+    pthread_mutex_unlock(&worker->lock);
+
+    for (n = 1; !job && (n < exec->num_workers); n++) {
+        victim = &exec->workers[(worker - exec->workers + n) % 
+                                exec->num_workers];
+        pthread_mutex_lock(&victim->lock);
+        if (victim->count) {
+            victim->count--;
+            job = victim->jobs[(victim->head + victim->count) % 
+                               exec->max_jobs];
+        }
+        pthread_mutex_unlock(&victim->lock);
+    }
+
+    if (job) {
+        pthread_mutex_lock(&exec->lock);
+        exec->num_queued--;
+        pthread_mutex_unlock(&exec->lock);
+    }
+    return job;
+}
+
+/**
+ * \brief    Run a job.
+ *
+ * \param    job Pointer to the job.
+ */
+static void
+cparser_exec_run (cparser_exec_job_t *job)
+{
+    cparser_exec_t *exec = job->exec;
+    cparser_t *session = job->session;
+    cparser_result_t rc;
+
+    rc = job->glue(&job->parser);
+
+    /* The job may be freed once it is done */
+    pthread_mutex_lock(&job->lock);
+    job->rc = ((CPARSER_PENDING == rc) ? CPARSER_NOT_OK : rc);
+    job->done = 1;
+    pthread_mutex_unlock(&job->lock);
+
+    if (exec->notify) {
+        exec->notify(session, exec->cookie);
+    }
+}
+
+/**
+ * \brief    Entry of a worker thread.
+ *
+ * \param    arg Pointer to the worker.
+ *
+ * \return   NULL.
+ */
+static void *
+cparser_exec_worker (void *arg)
+{
+    cparser_exec_worker_t *worker = (cparser_exec_worker_t *)arg;
+    cparser_exec_t *exec = worker->exec;
+    cparser_exec_job_t *job;
+
+    while (1) {
+        pthread_mutex_lock(&exec->lock);
+        while ((0 >= exec->num_queued) && !exec->stop) {
+            pthread_cond_wait(&exec->cond, &exec->lock);
+        }
+        if (0 >= exec->num_queued) {
+            /* Stopped and all jobs are done */
+            pthread_mutex_unlock(&exec->lock);
+            return NULL;
+        }
+        pthread_mutex_unlock(&exec->lock);
+
+        job = cparser_exec_take(worker);
+        if (job) {
+            cparser_exec_run(job);
+        }
+    }
+}
+
+/**
+ * \brief    Free the storage of an executor.
+ *
+ * \param    exec        Pointer to the executor.
+ * \param    num_started Number of worker threads started.
+ */
+static void
+cparser_exec_stop (cparser_exec_t *exec, int num_started)
+{
+    int n;
+
+    pthread_mutex_lock(&exec->lock);
+    exec->stop = 1;
+    pthread_cond_broadcast(&exec->cond);
+    pthread_mutex_unlock(&exec->lock);
+    for (n = 0; n < num_started; n++) {
+        pthread_join(exec->workers[n].thread, NULL);
+    }
+    for (n = 0; n < exec->num_workers; n++) {
+        pthread_mutex_destroy(&exec->workers[n].lock);
+    }
+    pthread_cond_destroy(&exec->cond);
+    pthread_mutex_destroy(&exec->lock);
+    cparser_mem_free(exec->alloc, exec->workers, 
+                     exec->num_workers * (sizeof(*exec->workers) +
+                                          (exec->max_jobs * 
+                                           sizeof(cparser_exec_job_t *))));
+    exec->workers = NULL;
+}
+
+cparser_result_t
+cparser_exec_init (cparser_exec_t *exec, int num_workers, int max_jobs,
+                   cparser_exec_notify_fn notify, void *cookie,
+                   const cparser_alloc_t *alloc)
+{
+    cparser_exec_job_t **jobs;
+    int n;
+
+    if (!exec || (0 >= num_workers) || (0 >= max_jobs)) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+
+    memset(exec, 0, sizeof(*exec));
+    exec->alloc = alloc;
+    exec->num_workers = num_workers;
+    exec->max_jobs = max_jobs;
+    exec->notify = notify;
+    exec->cookie = cookie;
+
+    /* The workers and their queues are in one block */
+    exec->workers = cparser_mem_alloc(alloc, num_workers * 
+                                      (sizeof(*exec->workers) + 
+                                       (max_jobs * sizeof(*jobs))));
+    if (!exec->workers) {
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    jobs = (cparser_exec_job_t **)(exec->workers + num_workers);
+    pthread_mutex_init(&exec->lock, NULL);
+    pthread_cond_init(&exec->cond, NULL);
+    for (n = 0; n < num_workers; n++) {
+        exec->workers[n].exec = exec;
+        exec->workers[n].jobs = jobs + (n * max_jobs);
+        exec->workers[n].head = 0;
+        exec->workers[n].count = 0;
+        pthread_mutex_init(&exec->workers[n].lock, NULL);
+    }
+    for (n = 0; n < num_workers; n++) {
+        if (pthread_create(&exec->workers[n].thread, NULL, 
+                           cparser_exec_worker, &exec->workers[n])) {
+            cparser_exec_stop(exec, n);
+            return CPARSER_ERR_OUT_OF_RES;
+        }
+    }
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_exec_fini (cparser_exec_t *exec)
+{
+    if (!exec || !exec->workers) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    pthread_mutex_lock(&exec->lock);
+    if (exec->num_jobs) {
+        pthread_mutex_unlock(&exec->lock);
+        return CPARSER_NOT_OK;
+    }
+    pthread_mutex_unlock(&exec->lock);
+
+    cparser_exec_stop(exec, exec->num_workers);
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_exec_submit (cparser_t *parser, cparser_glue_fn glue)
+{
+    cparser_exec_t *exec;
+    cparser_exec_worker_t *worker;
+    cparser_exec_job_t *job;
+    cparser_token_t *tokens;
+    void **cookies;
+    char *buf, *empty;
+    size_t size;
+    int n;
+
+    assert(VALID_PARSER(parser) && glue && !parser->exec_job);
+    exec = (cparser_exec_t *)parser->cfg.exec_cookie;
+    assert(exec);
+
+    pthread_mutex_lock(&exec->lock);
+    if (exec->num_jobs >= exec->max_jobs) {
+        pthread_mutex_unlock(&exec->lock);
+        parser->cfg.prints(parser, "Too many commands are running\n");
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    exec->num_jobs++;
+    worker = &exec->workers[exec->next];
+    exec->next = (exec->next + 1) % exec->num_workers;
+    pthread_mutex_unlock(&exec->lock);
+
+    /* Copy the tokens and the cookies */
+    size = sizeof(*job) + (parser->cfg.max_num_tokens * sizeof(*tokens)) +
+        (parser->cfg.max_nested_levels * sizeof(*cookies)) + 1;
+    for (n = 0; n < parser->token_tos; n++) {
+        size += parser->tokens[n].token_len + 1;
+    }
+    job = cparser_mem_alloc(exec->alloc, size);
+    if (!job) {
+        pthread_mutex_lock(&exec->lock);
+        exec->num_jobs--;
+        pthread_mutex_unlock(&exec->lock);
+        parser->cfg.prints(parser, "Too many commands are running\n");
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    memset(job, 0, sizeof(*job));
+    tokens = (cparser_token_t *)(job + 1);
+    cookies = (void **)(tokens + parser->cfg.max_num_tokens);
+    empty = (char *)(cookies + parser->cfg.max_nested_levels);
+    *empty = '\0'; /* Buffer of the unused tokens */
+    buf = empty + 1;
+    for (n = 0; n < parser->cfg.max_num_tokens; n++) {
+        tokens[n] = parser->tokens[n];
+        if (n < parser->token_tos) {
+            memcpy(buf, parser->tokens[n].buf, tokens[n].token_len);
+            buf[tokens[n].token_len] = '\0';
+            tokens[n].buf = buf;
+            buf += tokens[n].token_len + 1;
+        } else {
+            tokens[n].token_len = 0;
+            tokens[n].buf = empty;
+        }
+    }
+    memcpy(cookies, parser->context.cookie, 
+           parser->cfg.max_nested_levels * sizeof(*cookies));
+
+    job->parser = *parser;
+    job->parser.tokens = tokens;
+    job->parser.context.parser = &job->parser;
+    job->parser.context.cookie = cookies;
+    if (!(parser->cfg.flags & CPARSER_FLAGS_MT_OUTPUT)) {
+        job->parser.cfg.printc = cparser_exec_printc;
+        job->parser.cfg.prints = cparser_exec_prints;
+    }
+    job->parser.cfg.exec = NULL;
+    job->session = parser;
+    job->exec = exec;
+    job->glue = glue;
+    job->size = size;
+    pthread_mutex_init(&job->lock, NULL);
+    (void)cparser_async_handle(&parser->context, &job->async);
+    parser->exec_job = job;
+
+    /* Queue the job. There is always room for all jobs. */
+    pthread_mutex_lock(&worker->lock);
+    assert(worker->count < exec->max_jobs);
+    worker->jobs[(worker->head + worker->count) % exec->max_jobs] = job;
+    worker->count++;
+    pthread_mutex_unlock(&worker->lock);
+
+    pthread_mutex_lock(&exec->lock);
+    exec->num_queued++;
+    pthread_cond_signal(&exec->cond);
+    pthread_mutex_unlock(&exec->lock);
+    return CPARSER_PENDING;
+}
+
+cparser_result_t
+cparser_exec_poll (cparser_t *parser)
+{
+    cparser_exec_job_t *job;
+    cparser_exec_t *exec;
+    cparser_async_t async;
+    cparser_result_t rc;
+    char *out;
+    size_t out_size;
+    int done;
+
+    if (!VALID_PARSER(parser)) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    job = (cparser_exec_job_t *)parser->exec_job;
+    if (!job) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+    exec = job->exec;
+
+    /* Take the output so the worker can go on while it is printed */
+    pthread_mutex_lock(&job->lock);
+    out = job->out;
+    out_size = job->out_size;
+    job->out = NULL;
+    job->out_len = 0;
+    job->out_size = 0;
+    done = job->done;
+    rc = job->rc;
+    pthread_mutex_unlock(&job->lock);
+
+    if (out) {
+        parser->cfg.prints(parser, out);
+        cparser_mem_free(exec->alloc, out, out_size);
+    }
+    if (!done) {
+        return CPARSER_PENDING;
+    }
+
+    async = job->async;
+    parser->exec_job = NULL;
+    pthread_mutex_destroy(&job->lock);
+    cparser_mem_free(exec->alloc, job, job->size);
+    pthread_mutex_lock(&exec->lock);
+    exec->num_jobs--;
+    pthread_mutex_unlock(&exec->lock);
+
+    rc = cparser_complete_async(&async, rc);
+    assert(CPARSER_OK == rc);
+    return CPARSER_OK;
+}
@@ -0,0 +1,368 @@
+/**
+ * \file     cparser_filter.c
+ * \brief    Output filters of commands, e.g. "show log | include error".
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_line.h"
+#include "cparser_filter.h"
+
+/** Names of the filters. A name can be abbreviated. */
+static const char *cparser_filter_names[CPARSER_MAX_FILTER_TYPES] = {
+    "include", "exclude", "begin", "count"
+};
+
+/** A pattern with any of these characters is a regular expression */
+#define CPARSER_FILTER_REGEX_CHARS ".[]()*+?{}|^$\\"
+
+/**
+ * \brief    Check if a line matches the pattern of a stage.
+ *
+ * \param    stage Pointer to the stage.
+ * \param    line  The line. It is NULL terminated.
+ * \param    len   Length of the line.
+ *
+ * \return   1 if it matches; 0 otherwise.
+ */
+static int
+cparser_filter_match (const cparser_filter_stage_t *stage, const char *line,
+                      int len)
+{
+    const char *ch, *last;
+
+    if (stage->is_regex) {
+        return !regexec(&stage->regex, line, 0, NULL, 0);
+    }
+
+    /* memchr() finds the candidates many bytes at a time */
+    if (len < stage->pattern_len) {
+        return 0;
+    }
+    last = line + len - stage->pattern_len;
+    for (ch = line; ch <= last; ch++) {
+        ch = memchr(ch, stage->pattern[0], last - ch + 1);
+        if (!ch) {
+            return 0;
+        }
+        if (!memcmp(ch + 1, stage->pattern + 1, stage->pattern_len - 1)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief    Run the line in the buffer through all stages.
+ *
+ * \param    filter Pointer to the filters.
+ *
+ * \return   1 if the line is printed; 0 if it is dropped.
+ */
+static int
+cparser_filter_line (cparser_filter_t *filter)
+{
+    cparser_filter_stage_t *stage;
+    int n;
+
+    filter->line[filter->line_len] = '\0';
+    for (n = 0; n < filter->num_stages; n++) {
+        stage = &filter->stages[n];
+        switch (stage->type) {
+            case CPARSER_FILTER_INCLUDE:
+                if (!cparser_filter_match(stage, filter->line, 
+                                          filter->line_len)) {
+                    return 0;
+                }
+                break;
+            case CPARSER_FILTER_EXCLUDE:
+                if (cparser_filter_match(stage, filter->line, 
+                                         filter->line_len)) {
+                    return 0;
+                }
+                break;
+            case CPARSER_FILTER_BEGIN:
+                if (!stage->begun) {
+                    if (!cparser_filter_match(stage, filter->line, 
+                                              filter->line_len)) {
+                        return 0;
+                    }
+                    stage->begun = 1;
+                }
+                break;
+            default:
+                assert(CPARSER_FILTER_COUNT == stage->type);
+                stage->count++;
+                return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * \brief    Add characters without LF to the current line.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    filter Pointer to the filters of the parser.
+ * \param    s      The characters.
+ * \param    len    Number of characters.
+ */
+static void
+cparser_filter_put (const cparser_t *parser, cparser_filter_t *filter,
+                    const char *s, int len)
+{
+    int n;
+
+    while (len) {
+        if (0 > filter->rest) {
+            return;
+        }
+        n = CPARSER_FILTER_LINE_SIZE - filter->line_len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(filter->line + filter->line_len, s, n);
+        filter->line_len += n;
+        s += n;
+        len -= n;
+        if (0 < filter->rest) {
+            /* The rest of a long line goes out as it comes */
+            filter->line[filter->line_len] = '\0';
+            filter->prints(parser, filter->line);
+            filter->line_len = 0;
+        } else if (CPARSER_FILTER_LINE_SIZE == filter->line_len) {
+            /* The line is too long. Its beginning decides. */
+            filter->rest = (cparser_filter_line(filter) ? 1 : -1);
+            if (0 < filter->rest) {
+                filter->prints(parser, filter->line);
+            }
+            filter->line_len = 0;
+        }
+    }
+}
+
+/**
+ * \brief    End the current line.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    filter Pointer to the filters of the parser.
+ */
+static void
+cparser_filter_newline (const cparser_t *parser, cparser_filter_t *filter)
+{
+    if (!filter->rest) {
+        if (cparser_filter_line(filter)) {
+            filter->line[filter->line_len] = '\n';
+            filter->line[filter->line_len + 1] = '\0';
+            filter->prints(parser, filter->line);
+        }
+    } else if (0 < filter->rest) {
+        filter->printc(parser, '\n');
+    }
+    filter->rest = 0;
+    filter->line_len = 0;
+}
+
+static void
+cparser_filter_printc (const cparser_t *parser, const char ch)
+{
+    cparser_filter_t *filter = (cparser_filter_t *)parser->filter;
+
+    if ('\n' == ch) {
+        cparser_filter_newline(parser, filter);
+    } else {
+        cparser_filter_put(parser, filter, &ch, 1);
+    }
+}
+
+static void
+cparser_filter_prints (const cparser_t *parser, const char *s)
+{
+    cparser_filter_t *filter = (cparser_filter_t *)parser->filter;
+    const char *lf;
+
+    while (s && *s) {
+        lf = strchr(s, '\n');
+        if (!lf) {
+            cparser_filter_put(parser, filter, s, strlen(s));
+            return;
+        }
+        cparser_filter_put(parser, filter, s, lf - s);
+        cparser_filter_newline(parser, filter);
+        s = lf + 1;
+    }
+}
+
+/**
+ * \brief    Free the compiled patterns of all stages.
+ *
+ * \param    filter Pointer to the filters.
+ */
+static void
+cparser_filter_free (cparser_filter_t *filter)
+{
+    int n;
+
+    for (n = 0; n < filter->num_stages; n++) {
+        if (filter->stages[n].is_regex) {
+            regfree(&filter->stages[n].regex);
+        }
+    }
+    filter->num_stages = 0;
+}
+
+cparser_result_t
+cparser_filter_start (cparser_t *parser, int pos)
+{
+    cparser_filter_t *filter = (cparser_filter_t *)parser->filter;
+    cparser_filter_stage_t *stage;
+    int end = cparser_line_last(parser), len, n, next, type;
+    char word[16];
+    cparser_result_t rc = CPARSER_OK;
+
+    assert(filter && !filter->num_stages);
+    while (pos < end) {
+        assert('|' == cparser_line_char(parser, pos));
+        if ((CPARSER_MAX_FILTERS == filter->num_stages) ||
+            (filter->num_stages && 
+             (CPARSER_FILTER_COUNT == 
+              filter->stages[filter->num_stages-1].type))) {
+            /* Too many filters or nothing left after a count */
+            rc = CPARSER_ERR_PARSE_ERR;
+            break;
+        }
+        for (pos++; (pos < end) && (' ' == cparser_line_char(parser, pos)); 
+             pos++);
+
+        /* Name of the filter */
+        for (len = 0; (pos < end) && (len < (int)sizeof(word) - 1); len++) {
+            word[len] = cparser_line_char(parser, pos);
+            if ((' ' == word[len]) || ('|' == word[len])) {
+                break;
+            }
+            pos++;
+        }
+        word[len] = '\0';
+        for (type = 0; type < CPARSER_MAX_FILTER_TYPES; type++) {
+            if (len && !strncmp(word, cparser_filter_names[type], len)) {
+                break;
+            }
+        }
+        if (!len || (CPARSER_MAX_FILTER_TYPES == type)) {
+            rc = CPARSER_ERR_PARSE_ERR;
+            break;
+        }
+        stage = &filter->stages[filter->num_stages];
+        memset(stage, 0, sizeof(*stage));
+        stage->type = (cparser_filter_type_t)type;
+        for (; (pos < end) && (' ' == cparser_line_char(parser, pos)); pos++);
+        if (CPARSER_FILTER_COUNT == type) {
+            filter->num_stages++;
+            if ((pos < end) && ('|' != cparser_line_char(parser, pos))) {
+                rc = CPARSER_ERR_PARSE_ERR;
+                break;
+            }
+            continue;
+        }
+
+        /* The pattern runs to the next " |" and may have spaces */
+        for (next = pos; next < end; next++) {
+            if (('|' == cparser_line_char(parser, next)) &&
+                (' ' == cparser_line_char(parser, next - 1))) {
+                break;
+            }
+        }
+        for (n = next; (n > pos) && (' ' == cparser_line_char(parser, n - 1));
+             n--);
+        if ((n == pos) || (CPARSER_MAX_TOKEN_SIZE < (n - pos))) {
+            rc = CPARSER_ERR_PARSE_ERR;
+            break;
+        }
+        for (len = 0; pos < n; pos++, len++) {
+            stage->pattern[len] = cparser_line_char(parser, pos);
+        }
+        stage->pattern[len] = '\0';
+        stage->pattern_len = len;
+        if (strpbrk(stage->pattern, CPARSER_FILTER_REGEX_CHARS)) {
+            if (regcomp(&stage->regex, stage->pattern, 
+                        REG_EXTENDED | REG_NOSUB)) {
+                rc = CPARSER_ERR_PARSE_ERR;
+                break;
+            }
+            stage->is_regex = 1;
+        }
+        filter->num_stages++;
+        pos = next;
+    }
+    if (CPARSER_OK != rc) {
+        cparser_filter_free(filter);
+        return rc;
+    }
+
+    /* Send the output of the command through the filters */
+    filter->printc = parser->cfg.printc;
+    filter->prints = parser->cfg.prints;
+    filter->rest = 0;
+    filter->line_len = 0;
+    parser->cfg.printc = cparser_filter_printc;
+    parser->cfg.prints = cparser_filter_prints;
+    return CPARSER_OK;
+}
+
+void
+cparser_filter_stop (cparser_t *parser, int flush)
+{
+    cparser_filter_t *filter = (cparser_filter_t *)parser->filter;
+    char buf[48];
+    int n;
+
+    if (!filter || !filter->num_stages) {
+        return;
+    }
+    parser->cfg.printc = filter->printc;
+    parser->cfg.prints = filter->prints;
+    if (flush) {
+        if (!filter->rest && filter->line_len && 
+            cparser_filter_line(filter)) {
+            parser->cfg.prints(parser, filter->line);
+        }
+        for (n = 0; n < filter->num_stages; n++) {
+            if (CPARSER_FILTER_COUNT == filter->stages[n].type) {
+                snprintf(buf, sizeof(buf), "Count: %llu lines\n",
+                         (unsigned long long)filter->stages[n].count);
+                parser->cfg.prints(parser, buf);
+            }
+        }
+    }
+    cparser_filter_free(filter);
+}
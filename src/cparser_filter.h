@@ -0,0 +1,115 @@
+/**
+ * \file     cparser_filter.h
+ * \brief    Output filters of commands.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008-2009, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPARSER_FILTER_H__
+#define __CPARSER_FILTER_H__
+
+#include <regex.h>
+#include "cparser.h"
+
+/**
+ * \brief    Types of output filters.
+ */
+typedef enum cparser_filter_type_ {
+    CPARSER_FILTER_INCLUDE = 0, /**< Lines that match */
+    CPARSER_FILTER_EXCLUDE,     /**< Lines that do not match */
+    CPARSER_FILTER_BEGIN,       /**< Lines from the first match on */
+    CPARSER_FILTER_COUNT,       /**< Count the lines */
+    CPARSER_MAX_FILTER_TYPES
+} cparser_filter_type_t;
+
+/**
+ * \brief    A stage of the filters of a command.
+ * \details  A pattern without any regular expression special character 
+ *           is searched as a literal string. Otherwise, it is compiled 
+ *           into a regular expression once when the command starts.
+ */
+typedef struct cparser_filter_stage_ {
+    cparser_filter_type_t  type;
+    int                    is_regex; /**< 1 if 'regex' is compiled */
+    regex_t                regex;
+    /** Literal pattern. The first character is searched with memchr(). */
+    char                   pattern[CPARSER_MAX_TOKEN_SIZE + 1];
+    int                    pattern_len;
+    int                    begun;    /**< 1 after the first match of BEGIN */
+    uint64_t               count;    /**< Number of lines of COUNT */
+} cparser_filter_stage_t;
+
+/**
+ * \brief    Output filters of a parser.
+ * \details  While a filtered command runs, the output functions of the 
+ *           parser are replaced. The output is cut into lines and each 
+ *           line runs through the stages. Only the current line is 
+ *           kept. A line longer than the buffer is decided by its first
+ *           CPARSER_FILTER_LINE_SIZE characters.
+ */
+typedef struct cparser_filter_ {
+    int                     num_stages; /**< 0 if no filter is active */
+    cparser_filter_stage_t  stages[CPARSER_MAX_FILTERS];
+    cparser_printc_fn       printc;     /**< Output functions replaced */
+    cparser_prints_fn       prints;
+    /** 
+     * 1 if the rest of a long line is printed; -1 if it is dropped; 0 
+     * if the line is still in 'line'.
+     */
+    int                     rest;
+    int                     line_len;
+    /** The current line with room for LF and NULL */
+    char                    line[CPARSER_FILTER_LINE_SIZE + 2];
+} cparser_filter_t;
+
+/**
+ * \brief    Start the output filters of a command.
+ * \details  The filter text is parsed and compiled and the output 
+ *           functions of the parser are replaced.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    pos    Position of the first '|' in the current line.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_PARSE_ERR if the filter
+ *           text is invalid.
+ */
+cparser_result_t cparser_filter_start(cparser_t *parser, int pos);
+
+/**
+ * \brief    Stop the output filters of a command.
+ * \details  The last line without LF is filtered and COUNT prints the
+ *           number of lines. The output functions are restored. It 
+ *           does nothing if no filter is active.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    flush  1 to filter and print the rest of the output; 0 to 
+ *                  discard it.
+ */
+void cparser_filter_stop(cparser_t *parser, int flush);
+
+#endif /* __CPARSER_FILTER_H__ */
@@ -53,13 +53,33 @@ cparser_match (const cparser_t *parser, const char *token, const int token_len,
     assert(token && parent && match && is_complete);
     *match = NULL;
     *is_complete = 0;
-    for (child = parent->children; NULL != child; child = child->sibling) {
+    for (child = NODE_CHILDREN(parent); NULL != child;
+         child = NODE_SIBLING(child)) {
         if (!NODE_USABLE(parser, child)) {
             continue;
         }
 	local_is_complete = 0;
         rc = cparser_match_fn_tbl[child->type](token, token_len, child, 
                                                &local_is_complete);
+#ifdef SHORTEST_UNIQUE_KEYWORD
+        if ((CPARSER_OK == rc) && child->uniq_len && 
+            (token_len >= child->uniq_len)) {
+            /* 
+             * No sibling can match a token this long. There is no need 
+             * to look at the rest of them.
+             */
+            *match = child;
+            *is_complete = 1;
+            return 1;
+        }
+#endif /* SHORTEST_UNIQUE_KEYWORD */
+        if ((CPARSER_OK == rc) && local_is_complete && 
+            (child->flags & CPARSER_NODE_FLAGS_NO_OVERLAP)) {
+            /* No other sibling can match this token */
+            *match = child;
+            *is_complete = 1;
+            return 1;
+        }
         if (CPARSER_OK == rc) {
             num_matches++;
             /* 
@@ -109,13 +129,13 @@ cparser_token_stack_reset (cparser_t *parser)
     parser->last_good   = -1;
     parser->current_pos = 0;
     parser->token_tos   = 0;
-    for (n = 0; n < CPARSER_MAX_NUM_TOKENS; n++) {
+    for (n = 0; n < parser->cfg.max_num_tokens; n++) {
         token = &parser->tokens[n];
         token->begin_ptr = -1;
         token->token_len = 0;
         token->parent    = NULL;
         token->node      = NULL;
-        memset(token->buf, 0, sizeof(token->buf));
+        memset(token->buf, 0, parser->cfg.max_token_size + 1);
     }
 }
 
@@ -211,6 +231,9 @@ cparser_ws_char (cparser_t *parser, const char ch, int *ch_processed)
     assert(parser && ch_processed);
     *ch_processed = 1;
 
+    if (('|' == ch) && (parser->cfg.flags & CPARSER_FLAGS_FILTER)) {
+        return CPARSER_STATE_FILTER; /* the rest of the line are filters */
+    }
     if (!cparser_match(parser, &ch, 1, parser->cur_node, &match, &is_complete)) {
 	return CPARSER_STATE_ERROR; /* no token match */
     }
@@ -288,7 +311,7 @@ cparser_tok_space (cparser_t *parser, const char ch, int *ch_processed)
 
         /* Push it into the stack */
 	parser->token_tos++;
-	assert(CPARSER_MAX_NUM_TOKENS > parser->token_tos);
+	assert(parser->cfg.max_num_tokens > parser->token_tos);
         token = CUR_TOKEN(parser);
         assert(-1 == token->begin_ptr);
         assert(0 == token->token_len);
@@ -325,7 +348,7 @@ cparser_tok_char (cparser_t *parser, const char ch, int *ch_processed)
     *ch_processed = 1;
 
     token = CUR_TOKEN(parser);
-    if (token->token_len < CPARSER_MAX_TOKEN_SIZE) {
+    if (token->token_len < parser->cfg.max_token_size) {
         INSERT_TOK_STK(token, ch);
     } else {
         return CPARSER_STATE_ERROR;
@@ -410,12 +433,62 @@ cparser_err_char (cparser_t *parser, const char ch, int *ch_processed)
     return CPARSER_STATE_ERROR;
 }
 
+/**
+ * Process a BS in FILTER state.
+ *
+ * \details  There are two possibilities: 1) the '|' starting the filters
+ *           is erased -> delete character/WHITESPACE, 2) otherwise ->
+ *           delete character/FILTER.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    ch     Character to be input which must [BS].
+ *
+ * \retval   ch_processed 1 if the character is used; 0 if the character 
+ *                        is rejected by the parser FSM.
+ * \return   New parser state.
+ */
+static cparser_state_t
+cparser_filter_erase (cparser_t *parser, const char ch, int *ch_processed)
+{
+    assert(parser && ch_processed);
+    *ch_processed = 1;
+    assert(0 < parser->current_pos);
+    parser->current_pos--;
+    if ((parser->last_good + 1) == parser->current_pos) {
+        return CPARSER_STATE_WHITESPACE;
+    }
+    return CPARSER_STATE_FILTER;
+}
+
+/**
+ * Process a SPC or a character in FILTER state.
+ *
+ * \details  There is one possibility: 1) for any characters 
+ *           -> insert character/FILTER. The filters are parsed when the
+ *           command is executed.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    ch     Character to be input.
+ *
+ * \retval   ch_processed 1 if the character is used; 0 if the character 
+ *                        is rejected by the parser FSM.
+ * \return   New parser state.
+ */
+static cparser_state_t
+cparser_filter_char (cparser_t *parser, const char ch, int *ch_processed)
+{
+    assert(parser && ch_processed);
+    *ch_processed = 1;
+    return CPARSER_STATE_FILTER;
+}
+
 /* Define a table of function based on the (state, input type) */
 typedef cparser_state_t (*cparser_state_func)(cparser_t *parser, char ch, int *ch_processed);
-cparser_state_func cparser_state_func_tbl[CPARSER_MAX_STATES][3] = {
+static const cparser_state_func cparser_state_func_tbl[CPARSER_MAX_STATES][3] = {
     { cparser_ws_erase,  cparser_ws_space,  cparser_ws_char }, 
     { cparser_tok_erase, cparser_tok_space, cparser_tok_char }, 
-    { cparser_err_erase, cparser_err_space, cparser_err_char } };
+    { cparser_err_erase, cparser_err_space, cparser_err_char },
+    { cparser_filter_erase, cparser_filter_char, cparser_filter_char } };
 
 cparser_result_t 
 cparser_fsm_input (cparser_t *parser, char ch)
@@ -439,7 +512,7 @@ cparser_fsm_input (cparser_t *parser, char ch)
         assert(0 < parser->current_pos);
 	input_type = 0;
     } else {
-	if (parser->current_pos >= (CPARSER_MAX_LINE_SIZE-1)) {
+	if (parser->current_pos >= parser->cfg.max_line_size) {
 	    parser->cfg.printc(parser, '\a');
 	    return CPARSER_OK;
 	}
@@ -458,7 +531,9 @@ cparser_fsm_input (cparser_t *parser, char ch)
         if (0 != input_type) {
             parser->current_pos++;
         }
-        if (CPARSER_STATE_ERROR != parser->state) {
+        /* In FILTER state, last_good stays before the '|' */
+        if ((CPARSER_STATE_ERROR != parser->state) &&
+            (CPARSER_STATE_FILTER != parser->state)) {
             parser->last_good = parser->current_pos - 1;
         }
     }
@@ -483,6 +558,11 @@ cparser_fsm_input (cparser_t *parser, char ch)
                 parser->cfg.prints(parser, "State: ERROR\n");
                 break;
             }
+            case CPARSER_STATE_FILTER:
+            {
+                parser->cfg.prints(parser, "State: FILTER\n");
+                break;
+            }
             default:
                 parser->cfg.prints(parser, "State: UNKNOWN\n");
         }
@@ -513,8 +593,83 @@ cparser_fsm_reset (cparser_t *parser)
 {
     assert(VALID_PARSER(parser));
 
+    if (parser->cfg.handle && !parser->root_level) {
+        cparser_tree_enter(parser);
+    }
     cparser_token_stack_reset(parser);
     parser->cur_node = parser->root[parser->root_level];
     parser->state = CPARSER_STATE_WHITESPACE;
 }
 
+
+void
+cparser_fsm_save (const cparser_t *parser, cparser_line_fsm_t *snapshot)
+{
+    const cparser_token_t *token;
+    int n;
+
+    assert(VALID_PARSER(parser) && snapshot);
+    snapshot->root = parser->root[parser->root_level];
+    snapshot->tree_gen = TREE_GEN(parser);
+    snapshot->is_privileged_mode = parser->is_privileged_mode;
+    snapshot->state = parser->state;
+    snapshot->current_pos = parser->current_pos;
+    snapshot->last_good = parser->last_good;
+    snapshot->token_tos = parser->token_tos;
+    for (n = 0; n <= parser->token_tos; n++) {
+        token = &parser->tokens[n];
+        snapshot->begin_ptr[n] = token->begin_ptr;
+        snapshot->token_len[n] = token->token_len;
+        snapshot->node[n] = token->node;
+    }
+
+    /* The current node is always the node of the last pushed token */
+    assert(parser->cur_node == (parser->token_tos ? 
+                                snapshot->node[parser->token_tos-1] :
+                                snapshot->root));
+}
+
+cparser_result_t
+cparser_fsm_restore (cparser_t *parser, const cparser_line_fsm_t *snapshot,
+                     int from)
+{
+    cparser_node_t *root;
+    cparser_token_t *token;
+    int n, m;
+
+    assert(VALID_PARSER(parser) && snapshot);
+    root = parser->root[parser->root_level];
+    if ((snapshot->root != root) || (snapshot->tree_gen != TREE_GEN(parser)) ||
+        (snapshot->is_privileged_mode != parser->is_privileged_mode)) {
+        /* Tokens may match different nodes in this mode or tree */
+        return CPARSER_ERR_NOT_EXIST;
+    }
+
+    assert((0 <= from) && (from <= snapshot->token_tos) &&
+           (from <= parser->token_tos));
+    if (!from) {
+        cparser_token_stack_reset(parser);
+    }
+    for (n = from; n <= snapshot->token_tos; n++) {
+        token = &parser->tokens[n];
+        token->begin_ptr = snapshot->begin_ptr[n];
+        token->token_len = snapshot->token_len[n];
+        token->node = snapshot->node[n];
+        token->parent = NULL;
+        if (n < snapshot->token_tos) {
+            token->parent = (n ? snapshot->node[n-1] : root);
+        }
+        for (m = 0; m < token->token_len; m++) {
+            token->buf[m] = cparser_line_char(parser, token->begin_ptr + m);
+        }
+        token->buf[m] = '\0';
+    }
+    parser->token_tos = snapshot->token_tos;
+    parser->state = snapshot->state;
+    parser->current_pos = snapshot->current_pos;
+    parser->last_good = snapshot->last_good;
+    parser->cur_node = (snapshot->token_tos ? 
+                        snapshot->node[snapshot->token_tos-1] : root);
+
+    return CPARSER_OK;
+}
@@ -56,6 +56,33 @@ void cparser_fsm_reset(cparser_t *parser);
  */
 cparser_result_t cparser_fsm_input(cparser_t *parser, char ch);
 
+/**
+ * Take a snapshot of parser FSM states.
+ *
+ * \param    parser   Pointer to the parser structure.
+ *
+ * \retval   snapshot Pointer to the snapshot.
+ * \return   None.
+ */
+void cparser_fsm_save(const cparser_t *parser, cparser_line_fsm_t *snapshot);
+
+/**
+ * Restore parser FSM states from a snapshot. Token strings are copied
+ * from the current line.
+ *
+ * \param    parser   Pointer to the parser structure.
+ * \param    snapshot Pointer to the snapshot.
+ * \param    from     Index of the first token to be restored. Tokens below
+ *                    it are kept and must match the same nodes as in the
+ *                    snapshot.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_NOT_EXIST if the snapshot
+ *           was not taken in the current mode.
+ */
+cparser_result_t cparser_fsm_restore(cparser_t *parser,
+                                     const cparser_line_fsm_t *snapshot,
+                                     int from);
+
 /**
  * Walk through all children of a node. Return a match node if one is found.
  *
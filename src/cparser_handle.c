@@ -0,0 +1,278 @@
+/**
+ * \file     cparser_handle.c
+ * \brief    Versions of a parse tree shared by parsers.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_image.h"
+
+/*
+ * The versions of a handle are shared by parsers in any thread. The 
+ * newest version and the reader counts are read and changed with atomic
+ * operations. A parser that has read 'cur' but has not counted itself as
+ * a reader yet is counted in 'entering'. A replaced version is freed only
+ * when it has no reader and no parser is entering; that is the grace 
+ * period. The list of replaced versions is changed under a spin lock.
+ */
+#define CPARSER_ATOMIC_LOAD(p)     __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define CPARSER_ATOMIC_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define CPARSER_ATOMIC_INC(p)      __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define CPARSER_ATOMIC_DEC(p)      __atomic_sub_fetch((p), 1, __ATOMIC_SEQ_CST)
+
+static void
+cparser_tree_handle_lock (cparser_tree_handle_t *handle)
+{
+    while (__atomic_test_and_set(&handle->lock, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&handle->lock, __ATOMIC_RELAXED));
+    }
+}
+
+static void
+cparser_tree_handle_unlock (cparser_tree_handle_t *handle)
+{
+    __atomic_clear(&handle->lock, __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief    Allocate the next version of a handle.
+ *
+ * \param    handle  Pointer to the handle.
+ * \param    tree    The tree of the version.
+ * \param    free_fn Function to free the tree.
+ *
+ * \return   Pointer to the version; NULL if there is not enough memory.
+ */
+static cparser_tree_ver_t *
+cparser_tree_ver_new (cparser_tree_handle_t *handle, cparser_tree_t *tree,
+                      cparser_tree_free_fn free_fn)
+{
+    cparser_tree_ver_t *ver;
+
+    ver = cparser_mem_alloc(handle->alloc, sizeof(*ver));
+    if (!ver) {
+        return NULL;
+    }
+    ver->tree = tree;
+    ver->free_fn = free_fn;
+    ver->epoch = 0;
+    ver->readers = 0;
+    ver->next = NULL;
+    return ver;
+}
+
+/**
+ * \brief    Free a version and its tree.
+ *
+ * \param    handle Pointer to the handle.
+ * \param    ver    Pointer to the version. No parser may use it.
+ */
+static void
+cparser_tree_ver_free (cparser_tree_handle_t *handle, cparser_tree_ver_t *ver)
+{
+    assert(!ver->readers);
+    if (ver->free_fn) {
+        ver->free_fn(ver->tree);
+    }
+    cparser_mem_free(handle->alloc, ver, sizeof(*ver));
+}
+
+/**
+ * \brief    Free the replaced versions that no parser uses anymore.
+ * \details  Nothing is freed while a parser is entering a version. The 
+ *           last parser to finish entering calls it again.
+ *
+ * \param    handle Pointer to the handle.
+ */
+static void
+cparser_tree_reclaim (cparser_tree_handle_t *handle)
+{
+    cparser_tree_ver_t **prev, *ver, *dead = NULL;
+
+    cparser_tree_handle_lock(handle);
+    /* 'entering' must be read before the reader counts */
+    if (!CPARSER_ATOMIC_LOAD(&handle->entering)) {
+        prev = &handle->old;
+        while (*prev) {
+            ver = *prev;
+            if (CPARSER_ATOMIC_LOAD(&ver->readers)) {
+                prev = &ver->next;
+                continue;
+            }
+            CPARSER_ATOMIC_STORE(prev, ver->next);
+            ver->next = dead;
+            dead = ver;
+        }
+    }
+    cparser_tree_handle_unlock(handle);
+
+    /* Trees are freed outside of the lock */
+    while (dead) {
+        ver = dead;
+        dead = ver->next;
+        cparser_tree_ver_free(handle, ver);
+    }
+}
+
+/**
+ * \brief    Drop a reader of a version.
+ * \details  A replaced version is freed when its last reader is gone.
+ *
+ * \param    handle Pointer to the handle.
+ * \param    ver    Pointer to the version.
+ */
+static void
+cparser_tree_ver_release (cparser_tree_handle_t *handle, 
+                          cparser_tree_ver_t *ver)
+{
+    assert(CPARSER_ATOMIC_LOAD(&ver->readers));
+    if (!CPARSER_ATOMIC_DEC(&ver->readers) && 
+        (ver != CPARSER_ATOMIC_LOAD(&handle->cur))) {
+        cparser_tree_reclaim(handle);
+    }
+}
+
+void
+cparser_tree_enter (cparser_t *parser)
+{
+    cparser_tree_handle_t *handle = parser->cfg.handle;
+    cparser_tree_ver_t *old = parser->tree_ver, *ver;
+
+    assert(handle && !parser->root_level);
+    if (CPARSER_ATOMIC_LOAD(&handle->cur) == old) {
+        return;
+    }
+
+    /* The version read is not freed before it counts this parser */
+    CPARSER_ATOMIC_INC(&handle->entering);
+    ver = CPARSER_ATOMIC_LOAD(&handle->cur);
+    CPARSER_ATOMIC_INC(&ver->readers);
+    if (!CPARSER_ATOMIC_DEC(&handle->entering) && 
+        CPARSER_ATOMIC_LOAD(&handle->old)) {
+        cparser_tree_reclaim(handle);
+    }
+
+    parser->tree_ver = ver;
+    parser->cfg.tree = ver->tree;
+    parser->cfg.root = parser->cfg.tree->root;
+    parser->root[0] = parser->cfg.root;
+    /* It may be freed with the old version */
+    parser->last_end_node = NULL;
+    if (old) {
+        cparser_tree_ver_release(handle, old);
+    }
+}
+
+void
+cparser_tree_leave (cparser_t *parser)
+{
+    if (parser->tree_ver) {
+        cparser_tree_ver_release(parser->cfg.handle, parser->tree_ver);
+        parser->tree_ver = NULL;
+        parser->cfg.tree = NULL;
+        parser->cfg.root = NULL;
+    }
+}
+
+cparser_result_t
+cparser_tree_handle_init (cparser_tree_handle_t *handle, cparser_tree_t *tree,
+                          cparser_tree_free_fn free_fn,
+                          const cparser_alloc_t *alloc)
+{
+    if (!handle || !tree || !tree->root) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    memset(handle, 0, sizeof(*handle));
+    handle->alloc = alloc;
+    handle->cur = cparser_tree_ver_new(handle, tree, free_fn);
+    if (!handle->cur) {
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    handle->cur->epoch = ++handle->epoch;
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_tree_handle_fini (cparser_tree_handle_t *handle)
+{
+    if (!handle || !handle->cur) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    if (CPARSER_ATOMIC_LOAD(&handle->old) || 
+        CPARSER_ATOMIC_LOAD(&handle->cur->readers)) {
+        return CPARSER_NOT_OK;
+    }
+    cparser_tree_ver_free(handle, handle->cur);
+    memset(handle, 0, sizeof(*handle));
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_tree_publish (cparser_tree_handle_t *handle, cparser_tree_t *tree,
+                      cparser_tree_free_fn free_fn)
+{
+    cparser_tree_ver_t *ver, *cur;
+
+    if (!handle || !handle->cur || !tree || !tree->root) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    ver = cparser_tree_ver_new(handle, tree, free_fn);
+    if (!ver) {
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+
+    cparser_tree_handle_lock(handle);
+    cur = handle->cur;
+    if (tree == cur->tree) {
+        cparser_tree_handle_unlock(handle);
+        cparser_mem_free(handle->alloc, ver, sizeof(*ver));
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+
+    /* 
+     * Line snapshots saved with older versions must not match. A new 
+     * tree may be allocated where an old one was.
+     */
+    if (tree->gen <= cur->tree->gen) {
+        tree->gen = cur->tree->gen + 1;
+    }
+    ver->epoch = ++handle->epoch;
+
+    /* The replaced version is freed once its readers are gone */
+    cur->next = handle->old;
+    CPARSER_ATOMIC_STORE(&handle->old, cur);
+    CPARSER_ATOMIC_STORE(&handle->cur, ver);
+    cparser_tree_handle_unlock(handle);
+
+    cparser_tree_reclaim(handle);
+    return CPARSER_OK;
+}
@@ -0,0 +1,769 @@
+/**
+ * \file     cparser_history.c
+ * \brief    Persistent command history implementation.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "cparser.h"
+#include "cparser_history.h"
+
+/*
+ * A history file begins with a magic string. It is followed by one record
+ * per command. Each record is a 16-bit length, the command and a 
+ * terminating NULL. So, commands can be used in the mapping directly.
+ * Records are only appended. Each record is written with a single
+ * write() to a file opened with O_APPEND so records from different 
+ * sessions never interleave.
+ */
+#define HISTORY_MAGIC          "CPHIST1\n"
+#define HISTORY_MAGIC_LEN      (sizeof(HISTORY_MAGIC) - 1)
+#define HISTORY_REC_HDR        (sizeof(uint16_t))
+#define HISTORY_REC_SIZE(len)  (HISTORY_REC_HDR + (len) + 1)
+#define HISTORY_MAX_LEN        (0xffff) /**< Longest command in a record */
+
+#define HISTORY_NUM_GRAMS      (1024) /**< Initial trigram table size */
+
+#define HISTORY_SLOT(h, id)    (&(h)->entries[(id) % (h)->max_entries])
+#define HISTORY_OLDEST(h)      (((h)->next_id > (h)->max_entries) ? \
+                                ((h)->next_id - (h)->max_entries) : 0)
+#define HISTORY_CMD(h, e)      ((h)->map + (e)->offset)
+#define HISTORY_GRAM_KEY(s)    (((((uint32_t)(uint8_t)(s)[0]) << 16) |  \
+                                 (((uint32_t)(uint8_t)(s)[1]) << 8) |   \
+                                 ((uint32_t)(uint8_t)(s)[2])) + 1)
+#define HISTORY_GRAM_HASH(key) ((key) * 2654435761U)
+
+/**
+ * \brief    Compute the hash of a command (FNV-1a).
+ *
+ * \param    cmd Pointer to the command string.
+ *
+ * \return   Hash value.
+ */
+static uint32_t
+cparser_history_hash (const char *cmd)
+{
+    uint32_t hash = 2166136261U;
+
+    for (; *cmd; cmd++) {
+        hash ^= (uint8_t)*cmd;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+/**
+ * \brief    Look up a trigram.
+ *
+ * \param    hist Pointer to the history structure.
+ * \param    key  Trigram key.
+ *
+ * \return   Pointer to the trigram; NULL if no entry contains it.
+ */
+static const cparser_history_gram_t *
+cparser_history_gram_find (const cparser_history_t *hist, uint32_t key)
+{
+    uint32_t n;
+
+    n = HISTORY_GRAM_HASH(key) & hist->gram_mask;
+    while (hist->grams[n].key) {
+        if (key == hist->grams[n].key) {
+            return &hist->grams[n];
+        }
+        n = (n + 1) & hist->gram_mask;
+    }
+    return NULL;
+}
+
+/**
+ * \brief    Double the size of the trigram table.
+ *
+ * \param    hist Pointer to the history structure.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_OUT_OF_RES if there is
+ *           no memory.
+ */
+static cparser_result_t
+cparser_history_gram_grow (cparser_history_t *hist)
+{
+    cparser_history_gram_t *grams;
+    uint32_t n, m, mask;
+
+    mask = (hist->gram_mask << 1) | 1;
+    grams = cparser_mem_alloc(hist->alloc, (mask + 1) * sizeof(*grams));
+    if (!grams) {
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    for (n = 0; n <= hist->gram_mask; n++) {
+        if (!hist->grams[n].key) {
+            continue;
+        }
+        m = HISTORY_GRAM_HASH(hist->grams[n].key) & mask;
+        while (grams[m].key) {
+            m = (m + 1) & mask;
+        }
+        grams[m] = hist->grams[n];
+    }
+    cparser_mem_free(hist->alloc, hist->grams, 
+                     (hist->gram_mask + 1) * sizeof(*grams));
+    hist->grams = grams;
+    hist->gram_mask = mask;
+    return CPARSER_OK;
+}
+
+/**
+ * \brief    Add an entry to the list of a trigram.
+ *
+ * \param    hist Pointer to the history structure.
+ * \param    key  Trigram key.
+ * \param    id   Entry id. It must not be smaller than any id in the list.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_OUT_OF_RES if there is
+ *           no memory.
+ */
+static cparser_result_t
+cparser_history_gram_add (cparser_history_t *hist, uint32_t key, uint32_t id)
+{
+    cparser_history_gram_t *gram;
+    uint32_t n, oldest, *ids;
+    cparser_result_t rc;
+
+    if (4 * (hist->num_grams + 1) > 3 * (hist->gram_mask + 1)) {
+        rc = cparser_history_gram_grow(hist);
+        if (CPARSER_OK != rc) {
+            return rc;
+        }
+    }
+    n = HISTORY_GRAM_HASH(key) & hist->gram_mask;
+    while (hist->grams[n].key && (key != hist->grams[n].key)) {
+        n = (n + 1) & hist->gram_mask;
+    }
+    gram = &hist->grams[n];
+    if (!gram->key) {
+        gram->key = key;
+        hist->num_grams++;
+    }
+    if (gram->count && (id == gram->ids[gram->count - 1])) {
+        /* The trigram appears more than once in the command */
+        return CPARSER_OK;
+    }
+
+    /* Drop evicted entries. Reclaim the space once half of it is unused. */
+    oldest = HISTORY_OLDEST(hist);
+    while ((gram->begin < gram->count) && (gram->ids[gram->begin] < oldest)) {
+        gram->begin++;
+    }
+    if (gram->begin && ((2 * gram->begin) >= gram->count)) {
+        gram->count -= gram->begin;
+        memmove(gram->ids, gram->ids + gram->begin,
+                gram->count * sizeof(*gram->ids));
+        gram->begin = 0;
+    }
+
+    if (gram->count == gram->size) {
+        n = (gram->size ? (2 * gram->size) : 4);
+        ids = cparser_mem_alloc(hist->alloc, n * sizeof(*ids));
+        if (!ids) {
+            return CPARSER_ERR_OUT_OF_RES;
+        }
+        if (gram->count) {
+            memcpy(ids, gram->ids, gram->count * sizeof(*ids));
+        }
+        cparser_mem_free(hist->alloc, gram->ids, gram->size * sizeof(*ids));
+        gram->ids = ids;
+        gram->size = n;
+    }
+    gram->ids[gram->count++] = id;
+    return CPARSER_OK;
+}
+
+/**
+ * \brief    Remove an entry from its hash bucket and mark it as dropped.
+ *
+ * \param    hist Pointer to the history structure.
+ * \param    id   Entry id.
+ */
+static void
+cparser_history_unlink (cparser_history_t *hist, uint32_t id)
+{
+    cparser_history_entry_t *entry;
+    uint32_t *link;
+
+    entry = HISTORY_SLOT(hist, id);
+    link = &hist->buckets[entry->hash & hist->bucket_mask];
+    while (id != *link) {
+        assert(CPARSER_HISTORY_NONE != *link);
+        link = &HISTORY_SLOT(hist, *link)->next;
+    }
+    *link = entry->next;
+    entry->offset = 0;
+}
+
+/**
+ * \brief    Add a record of the history file to the index.
+ *
+ * \param    hist   Pointer to the history structure.
+ * \param    offset File offset of the command string.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_OUT_OF_RES if there is
+ *           no memory.
+ */
+static cparser_result_t
+cparser_history_index (cparser_history_t *hist, uint32_t offset)
+{
+    cparser_history_entry_t *entry;
+    const char *cmd;
+    uint32_t id, hash, n, *bucket;
+    size_t len;
+    cparser_result_t rc;
+
+    id = hist->next_id;
+    entry = HISTORY_SLOT(hist, id);
+    if ((id >= hist->max_entries) && entry->offset) {
+        /* Evict the oldest entry */
+        cparser_history_unlink(hist, id - hist->max_entries);
+    }
+
+    /* Drop the older copy of the same command */
+    cmd = hist->map + offset;
+    hash = cparser_history_hash(cmd);
+    bucket = &hist->buckets[hash & hist->bucket_mask];
+    for (n = *bucket; CPARSER_HISTORY_NONE != n; 
+         n = HISTORY_SLOT(hist, n)->next) {
+        if ((hash == HISTORY_SLOT(hist, n)->hash) &&
+            !strcmp(cmd, HISTORY_CMD(hist, HISTORY_SLOT(hist, n)))) {
+            cparser_history_unlink(hist, n);
+            break;
+        }
+    }
+
+    entry->offset = offset;
+    entry->hash = hash;
+    entry->next = *bucket;
+    *bucket = id;
+    hist->next_id++;
+
+    len = strlen(cmd);
+    for (n = 0; (n + 3) <= len; n++) {
+        rc = cparser_history_gram_add(hist, HISTORY_GRAM_KEY(cmd + n), id);
+        if (CPARSER_OK != rc) {
+            return rc;
+        }
+    }
+    return CPARSER_OK;
+}
+
+/**
+ * \brief    Lock the history file.
+ * \details  Another session may have compacted the file and renamed the 
+ *           new file over the path. The file of the history is then no 
+ *           longer the file at the path.
+ *
+ * \param    hist Pointer to the history structure.
+ * \param    op   LOCK_SH or LOCK_EX.
+ *
+ * \return   CPARSER_OK if the file is locked; CPARSER_ERR_NOT_EXIST if 
+ *           it has been replaced; CPARSER_NOT_OK if it cannot be locked.
+ *           The file is not locked on failure.
+ */
+static cparser_result_t
+cparser_history_lock (cparser_history_t *hist, int op)
+{
+    struct stat st, path_st;
+
+    if (flock(hist->fd, op)) {
+        return CPARSER_NOT_OK;
+    }
+    if (fstat(hist->fd, &st) || stat(hist->path, &path_st) ||
+        (st.st_dev != path_st.st_dev) || (st.st_ino != path_st.st_ino)) {
+        flock(hist->fd, LOCK_UN);
+        return CPARSER_ERR_NOT_EXIST;
+    }
+    return CPARSER_OK;
+}
+
+/**
+ * \brief    Rewrite a history file with only the entries in the history.
+ * \details  The file must be locked exclusively and fully indexed, so no
+ *           command of another session is lost. Sessions that have the
+ *           old file open find it replaced when they lock it to append.
+ *
+ * \param    hist Pointer to the history structure.
+ *
+ * \return   CPARSER_OK if succeeded; CPARSER_NOT_OK if the file cannot be
+ *           written.
+ */
+static cparser_result_t
+cparser_history_compact (cparser_history_t *hist)
+{
+    char tmp_path[CPARSER_HISTORY_PATH_LEN + 4];
+    FILE *fp;
+    const char *cmd;
+    uint32_t id;
+    uint16_t len;
+    int failed;
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", hist->path);
+    fp = fopen(tmp_path, "w");
+    if (!fp) {
+        return CPARSER_NOT_OK;
+    }
+    failed = (1 != fwrite(HISTORY_MAGIC, HISTORY_MAGIC_LEN, 1, fp));
+    id = CPARSER_HISTORY_NONE;
+    while (!failed && (CPARSER_OK == cparser_history_next(hist, id, &id))) {
+        cmd = cparser_history_get(hist, id);
+        len = strlen(cmd);
+        failed = ((1 != fwrite(&len, sizeof(len), 1, fp)) ||
+                  (1 != fwrite(cmd, len + 1, 1, fp)));
+    }
+    failed = fclose(fp) || failed;
+    if (failed || rename(tmp_path, hist->path)) {
+        unlink(tmp_path);
+        return CPARSER_NOT_OK;
+    }
+    return CPARSER_OK;
+}
+
+/**
+ * \brief    Close the history file and free the index.
+ * \details  The path, the capacity and the allocator are kept so that 
+ *           the file can be attached again.
+ *
+ * \param    hist Pointer to the history structure.
+ */
+static void
+cparser_history_detach (cparser_history_t *hist)
+{
+    uint32_t n;
+
+    if (hist->grams) {
+        for (n = 0; n <= hist->gram_mask; n++) {
+            cparser_mem_free(hist->alloc, hist->grams[n].ids,
+                             hist->grams[n].size * sizeof(uint32_t));
+        }
+        cparser_mem_free(hist->alloc, hist->grams,
+                         (hist->gram_mask + 1) * sizeof(*hist->grams));
+    }
+    cparser_mem_free(hist->alloc, hist->buckets,
+                     (hist->bucket_mask + 1) * sizeof(*hist->buckets));
+    cparser_mem_free(hist->alloc, hist->entries,
+                     hist->max_entries * sizeof(*hist->entries));
+    if (hist->map) {
+        munmap(hist->map, hist->map_size);
+    }
+    if (0 <= hist->fd) {
+        close(hist->fd);
+    }
+    hist->fd = -1;
+    hist->map = NULL;
+    hist->map_size = 0;
+    hist->file_size = 0;
+    hist->num_records = 0;
+    hist->next_id = 0;
+    hist->entries = NULL;
+    hist->buckets = NULL;
+    hist->bucket_mask = 0;
+    hist->grams = NULL;
+    hist->gram_mask = 0;
+    hist->num_grams = 0;
+}
+
+/**
+ * \brief    Open the file at the path of a history and index it.
+ * \details  The file is locked exclusively while it is read. A file with
+ *           too many duplicated and evicted commands is compacted before
+ *           the lock is released.
+ *
+ * \param    hist Pointer to the history structure. It is detached on 
+ *                failure.
+ *
+ * \return   Same as cparser_history_open().
+ */
+static cparser_result_t
+cparser_history_attach (cparser_history_t *hist)
+{
+    struct stat st;
+    char magic[HISTORY_MAGIC_LEN];
+    uint32_t n;
+    cparser_result_t rc;
+
+    do {
+        hist->fd = open(hist->path, O_RDWR | O_CREAT | O_APPEND, 0600);
+        if (0 > hist->fd) {
+            return CPARSER_NOT_OK;
+        }
+        rc = cparser_history_lock(hist, LOCK_EX);
+        if (CPARSER_OK != rc) {
+            close(hist->fd);
+            hist->fd = -1;
+        }
+    } while (CPARSER_ERR_NOT_EXIST == rc);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+
+    /* A new file gets the magic string */
+    if (fstat(hist->fd, &st)) {
+        rc = CPARSER_NOT_OK;
+    } else if (!st.st_size) {
+        if (HISTORY_MAGIC_LEN != write(hist->fd, HISTORY_MAGIC, 
+                                       HISTORY_MAGIC_LEN)) {
+            rc = CPARSER_NOT_OK;
+        }
+    } else if ((HISTORY_MAGIC_LEN != pread(hist->fd, magic, sizeof(magic), 0)) ||
+               memcmp(magic, HISTORY_MAGIC, HISTORY_MAGIC_LEN)) {
+        rc = CPARSER_NOT_OK;
+    }
+    hist->file_size = HISTORY_MAGIC_LEN;
+
+    /* Allocate the index */
+    for (n = 1; n < hist->max_entries; n <<= 1);
+    hist->bucket_mask = n - 1;
+    hist->gram_mask = HISTORY_NUM_GRAMS - 1;
+    hist->entries = cparser_mem_alloc(hist->alloc, 
+                                      hist->max_entries * 
+                                      sizeof(*hist->entries));
+    hist->buckets = cparser_mem_alloc(hist->alloc, 
+                                      n * sizeof(*hist->buckets));
+    hist->grams = cparser_mem_alloc(hist->alloc, 
+                                    HISTORY_NUM_GRAMS * sizeof(*hist->grams));
+    if ((CPARSER_OK == rc) &&
+        (!hist->entries || !hist->buckets || !hist->grams)) {
+        rc = CPARSER_ERR_OUT_OF_RES;
+    }
+    if (CPARSER_OK == rc) {
+        memset(hist->buckets, 0xff, n * sizeof(*hist->buckets));
+        rc = cparser_history_sync(hist);
+    }
+    if (CPARSER_OK != rc) {
+        cparser_history_detach(hist);
+        return rc;
+    }
+
+    /* Too many duplicated and evicted commands in the file. Rewrite it. */
+    if (((hist->num_records / 2) > hist->max_entries) &&
+        (CPARSER_OK == cparser_history_compact(hist))) {
+        cparser_history_detach(hist);
+        return cparser_history_attach(hist);
+    }
+    flock(hist->fd, LOCK_UN);
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_history_open (cparser_history_t *hist, const char *path,
+                      uint32_t max_entries, const cparser_alloc_t *alloc)
+{
+    if (!hist || !path || (sizeof(hist->path) <= strlen(path))) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    if (!max_entries) {
+        max_entries = CPARSER_HISTORY_SIZE;
+    }
+    memset(hist, 0, sizeof(*hist));
+    hist->fd = -1;
+    hist->alloc = alloc;
+    hist->max_entries = max_entries;
+    strcpy(hist->path, path);
+    return cparser_history_attach(hist);
+}
+
+cparser_result_t
+cparser_history_close (cparser_history_t *hist)
+{
+    if (!hist || (0 > hist->fd)) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    cparser_history_detach(hist);
+    memset(hist, 0, sizeof(*hist));
+    hist->fd = -1;
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_history_sync (cparser_history_t *hist)
+{
+    struct stat st;
+    size_t size;
+    uint16_t len;
+    cparser_result_t rc;
+
+    if (!hist || (0 > hist->fd)) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    if (fstat(hist->fd, &st)) {
+        return CPARSER_NOT_OK;
+    }
+    size = st.st_size;
+    if (size <= hist->file_size) {
+        return CPARSER_OK;
+    }
+
+    /* 
+     * Map twice the current size so that the mapping does not need
+     * to change for a while as the file grows. 
+     */
+    if (size > hist->map_size) {
+        if (hist->map) {
+            munmap(hist->map, hist->map_size);
+        }
+        hist->map_size = 2 * size;
+        hist->map = mmap(NULL, hist->map_size, PROT_READ, MAP_SHARED,
+                         hist->fd, 0);
+        if (MAP_FAILED == hist->map) {
+            hist->map = NULL;
+            hist->map_size = 0;
+            return CPARSER_NOT_OK;
+        }
+    }
+
+    while ((hist->file_size + HISTORY_REC_HDR) <= size) {
+        memcpy(&len, hist->map + hist->file_size, sizeof(len));
+        if (((hist->file_size + HISTORY_REC_SIZE(len)) > size) ||
+            (UINT32_MAX < (hist->file_size + HISTORY_REC_SIZE(len))) ||
+            hist->map[hist->file_size + HISTORY_REC_HDR + len]) {
+            /* A partial or corrupted record */
+            break;
+        }
+        rc = cparser_history_index(hist, hist->file_size + HISTORY_REC_HDR);
+        if (CPARSER_OK != rc) {
+            return rc;
+        }
+        hist->file_size += HISTORY_REC_SIZE(len);
+        hist->num_records++;
+    }
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_history_add (cparser_history_t *hist, const char *cmd)
+{
+    struct iovec rec[3];
+    const char *newest;
+    uint32_t id;
+    size_t n;
+    uint16_t len;
+    cparser_result_t rc;
+
+    if (!hist || (0 > hist->fd) || !cmd) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    for (n = strlen(cmd); n && isspace((int)cmd[n - 1]); n--);
+    if (!n) {
+        return CPARSER_OK;
+    }
+    if (HISTORY_MAX_LEN < n) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    len = n;
+
+    /* 
+     * Appending holds a shared lock so that the file is not compacted 
+     * in the meantime. A file compacted by another session is attached
+     * again before the command is appended to it.
+     */
+    while (CPARSER_ERR_NOT_EXIST == (rc = cparser_history_lock(hist, 
+                                                              LOCK_SH))) {
+        cparser_history_detach(hist);
+        rc = cparser_history_attach(hist);
+        if (CPARSER_OK != rc) {
+            return rc;
+        }
+    }
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+
+    rc = cparser_history_sync(hist);
+    if ((CPARSER_OK == rc) &&
+        (CPARSER_OK == cparser_history_prev(hist, CPARSER_HISTORY_NONE, &id))) {
+        newest = cparser_history_get(hist, id);
+        if (!strncmp(newest, cmd, len) && !newest[len]) {
+            flock(hist->fd, LOCK_UN);
+            return CPARSER_OK;
+        }
+    }
+    if (CPARSER_OK == rc) {
+        rec[0].iov_base = &len;
+        rec[0].iov_len = HISTORY_REC_HDR;
+        rec[1].iov_base = (void *)cmd;
+        rec[1].iov_len = len;
+        rec[2].iov_base = "";
+        rec[2].iov_len = 1;
+        if (HISTORY_REC_SIZE(len) != writev(hist->fd, rec, 3)) {
+            rc = CPARSER_NOT_OK;
+        }
+    }
+    flock(hist->fd, LOCK_UN);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    return cparser_history_sync(hist);
+}
+
+const char *
+cparser_history_get (const cparser_history_t *hist, uint32_t id)
+{
+    const cparser_history_entry_t *entry;
+
+    if (!hist || !hist->map || (id >= hist->next_id) ||
+        (id < HISTORY_OLDEST(hist))) {
+        return NULL;
+    }
+    entry = HISTORY_SLOT(hist, id);
+    if (!entry->offset) {
+        return NULL;
+    }
+    return HISTORY_CMD(hist, entry);
+}
+
+cparser_result_t
+cparser_history_prev (const cparser_history_t *hist, uint32_t id,
+                      uint32_t *prev)
+{
+    uint32_t oldest;
+
+    if (!hist || !prev) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    oldest = HISTORY_OLDEST(hist);
+    if (id > hist->next_id) {
+        id = hist->next_id;
+    }
+    while (id > oldest) {
+        id--;
+        if (HISTORY_SLOT(hist, id)->offset) {
+            *prev = id;
+            return CPARSER_OK;
+        }
+    }
+    return CPARSER_ERR_NOT_EXIST;
+}
+
+cparser_result_t
+cparser_history_next (const cparser_history_t *hist, uint32_t id,
+                      uint32_t *next)
+{
+    uint32_t oldest;
+
+    if (!hist || !next) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    oldest = HISTORY_OLDEST(hist);
+    if ((CPARSER_HISTORY_NONE == id) || (id < oldest)) {
+        id = oldest;
+    } else {
+        id++;
+    }
+    for (; id < hist->next_id; id++) {
+        if (HISTORY_SLOT(hist, id)->offset) {
+            *next = id;
+            return CPARSER_OK;
+        }
+    }
+    return CPARSER_ERR_NOT_EXIST;
+}
+
+cparser_result_t
+cparser_history_search (const cparser_history_t *hist, const char *str,
+                        uint32_t before, uint32_t *id)
+{
+    const cparser_history_gram_t *gram, *best = NULL;
+    const cparser_history_entry_t *entry;
+    uint32_t oldest, lo, hi, mid, n;
+    size_t len;
+
+    if (!hist || !str || !id) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    len = strlen(str);
+    if (!len) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+    oldest = HISTORY_OLDEST(hist);
+    if (before > hist->next_id) {
+        before = hist->next_id;
+    }
+
+    if (3 > len) {
+        /* 
+         * Too short for the trigram index. Such a short string is found
+         * in most commands anyway. So, just scan backward.
+         */
+        for (n = before; n > oldest; n--) {
+            entry = HISTORY_SLOT(hist, n - 1);
+            if (entry->offset && strstr(HISTORY_CMD(hist, entry), str)) {
+                *id = n - 1;
+                return CPARSER_OK;
+            }
+        }
+        return CPARSER_ERR_NOT_EXIST;
+    }
+
+    /* Only visit entries with the rarest trigram of the string */
+    for (n = 0; (n + 3) <= len; n++) {
+        gram = cparser_history_gram_find(hist, HISTORY_GRAM_KEY(str + n));
+        if (!gram) {
+            return CPARSER_ERR_NOT_EXIST;
+        }
+        if (!best || ((gram->count - gram->begin) < (best->count - best->begin))) {
+            best = gram;
+        }
+    }
+
+    /* Find the first entry id that is not older than 'before' */
+    lo = best->begin;
+    hi = best->count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (best->ids[mid] < before) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (n = lo; (n > best->begin) && (best->ids[n - 1] >= oldest); n--) {
+        entry = HISTORY_SLOT(hist, best->ids[n - 1]);
+        if (entry->offset && strstr(HISTORY_CMD(hist, entry), str)) {
+            *id = best->ids[n - 1];
+            return CPARSER_OK;
+        }
+    }
+    return CPARSER_ERR_NOT_EXIST;
+}
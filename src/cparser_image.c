@@ -0,0 +1,301 @@
+/**
+ * \file     cparser_image.c
+ * \brief    Binary parse tree image loader.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_image.h"
+
+/**
+ * \brief    Compute the FNV-1a hash of a buffer.
+ *
+ * \param    buf  Pointer to the buffer.
+ * \param    size Number of bytes in the buffer.
+ *
+ * \return   32-bit hash.
+ */
+static uint32_t
+cparser_tree_checksum (const uint8_t *buf, size_t size)
+{
+    uint32_t hash = 2166136261u;
+    size_t n;
+
+    for (n = 0; n < size; n++) {
+        hash = (hash ^ buf[n]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * \brief    Follow an offset field of an image and check that the object
+ *           it refers to is inside the image.
+ *
+ * \param    hdr   Pointer to the mapped image.
+ * \param    base  Pointer to the node or list node with the field.
+ * \param    field Value of the field.
+ * \param    size  Size of the object.
+ * \param    align Alignment of the object.
+ * \param    obj   Pointer to the object, NULL for a NULL field.
+ *
+ * \return   1 if the field is valid; 0 otherwise.
+ */
+static int
+cparser_tree_check_field (const cparser_tree_hdr_t *hdr, const void *base,
+                          const void *field, size_t size, size_t align,
+                          const void **obj)
+{
+    intptr_t pos = (const char *)base - (const char *)hdr;
+
+    *obj = NULL;
+    if (!field) {
+        return 1;
+    }
+    /* Compare the offset and not the sum so that nothing overflows */
+    if (((intptr_t)field < (intptr_t)sizeof(*hdr) - pos) ||
+        ((intptr_t)field > (intptr_t)(hdr->size - size) - pos)) {
+        return 0;
+    }
+    pos += (intptr_t)field;
+    if (pos % align) {
+        return 0;
+    }
+    *obj = (const char *)hdr + pos;
+    return 1;
+}
+
+/**
+ * \brief    Check that a string field of an image is NUL-terminated 
+ *           inside the image.
+ */
+static int
+cparser_tree_check_str (const cparser_tree_hdr_t *hdr, const void *base,
+                        const void *field)
+{
+    const void *str;
+
+    if (!cparser_tree_check_field(hdr, base, field, 1, 1, &str)) {
+        return 0;
+    }
+    return (!str || memchr(str, '\0', 
+                           hdr->size - ((const char *)str - 
+                                        (const char *)hdr)));
+}
+
+/**
+ * \brief    Walk all nodes of an image once.
+ * \details  Every offset must stay inside the image and every command 
+ *           ID must index the glue table, so that the parser can follow
+ *           the nodes without checking them. A node is visited once per
+ *           path to it, so a loop exceeds the number of nodes that fit
+ *           in the image.
+ *
+ * \param    hdr  Pointer to the mapped image.
+ * \param    root Pointer to the root node.
+ *
+ * \return   CPARSER_OK if all nodes are valid; CPARSER_ERR_PARSE_ERR if
+ *           not; CPARSER_ERR_OUT_OF_RES if there is no memory to walk.
+ */
+static cparser_result_t
+cparser_tree_check_nodes (const cparser_tree_hdr_t *hdr, 
+                          const cparser_node_t *root)
+{
+    const cparser_node_t **stack, *node;
+    const cparser_list_node_t *lnode;
+    const void *obj, *next[2];
+    int k;
+    size_t max_nodes, max_lnodes, num_nodes = 0, num_lnodes = 0, top = 0;
+    cparser_result_t rc = CPARSER_OK;
+
+    max_nodes = (hdr->size - sizeof(*hdr)) / sizeof(cparser_node_t);
+    max_lnodes = (hdr->size - sizeof(*hdr)) / sizeof(cparser_list_node_t);
+    stack = cparser_mem_alloc(NULL, (max_nodes + 1) * sizeof(*stack));
+    if (!stack) {
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    stack[top++] = root;
+    while (top) {
+        node = stack[--top];
+        if ((++num_nodes > max_nodes) || !NODE_IS_IMAGE(node) ||
+            NODE_IS_PACKED(node) || (CPARSER_MAX_NODE_TYPES <= node->type) ||
+            !cparser_tree_check_str(hdr, node, node->desc)) {
+            rc = CPARSER_ERR_PARSE_ERR;
+            break;
+        }
+        if (CPARSER_NODE_END == node->type) {
+            if ((uintptr_t)node->param >= hdr->num_cmds) {
+                rc = CPARSER_ERR_PARSE_ERR;
+                break;
+            }
+        } else if (CPARSER_NODE_LIST == node->type) {
+            for (obj = node->param, lnode = (const void *)node; obj; 
+                 obj = lnode->next) {
+                if ((++num_lnodes > max_lnodes) ||
+                    !cparser_tree_check_field(hdr, lnode, obj, 
+                                              sizeof(*lnode), 
+                                              sizeof(void *), &obj) ||
+                    !cparser_tree_check_str(hdr, obj, 
+                        ((const cparser_list_node_t *)obj)->keyword)) {
+                    rc = CPARSER_ERR_PARSE_ERR;
+                    break;
+                }
+                lnode = obj;
+            }
+            if ((CPARSER_OK != rc) || !node->param) {
+                rc = CPARSER_ERR_PARSE_ERR;
+                break;
+            }
+        } else if (!cparser_tree_check_str(hdr, node, node->param)) {
+            rc = CPARSER_ERR_PARSE_ERR;
+            break;
+        }
+
+        /* Visit the sibling and the children */
+        if (!cparser_tree_check_field(hdr, node, node->sibling, 
+                                      sizeof(*node), sizeof(void *), 
+                                      &next[0]) ||
+            !cparser_tree_check_field(hdr, node, node->children, 
+                                      sizeof(*node), sizeof(void *), 
+                                      &next[1]) ||
+            (top + 2 > max_nodes + 1)) {
+            rc = CPARSER_ERR_PARSE_ERR;
+            break;
+        }
+        for (k = 0; k < 2; k++) {
+            if (next[k]) {
+                stack[top++] = next[k];
+            }
+        }
+    }
+    cparser_mem_free(NULL, stack, (max_nodes + 1) * sizeof(*stack));
+    return rc;
+}
+
+/**
+ * \brief    Check the header of an image.
+ *
+ * \param    hdr      Pointer to the mapped image.
+ * \param    size     Size of the image file.
+ * \param    num_glue Number of glue functions supplied.
+ *
+ * \return   CPARSER_OK if the image can be used; CPARSER_ERR_PARSE_ERR 
+ *           otherwise.
+ */
+static cparser_result_t
+cparser_tree_check (const cparser_tree_hdr_t *hdr, size_t size,
+                    uint32_t num_glue)
+{
+    const cparser_node_t *root;
+
+    if (memcmp(hdr->magic, CPARSER_TREE_MAGIC, sizeof(hdr->magic)) ||
+        (CPARSER_TREE_VERSION != hdr->version) ||
+        (CPARSER_TREE_BYTE_ORDER != hdr->byte_order) ||
+        (sizeof(void *) != hdr->ptr_size) ||
+        (sizeof(cparser_node_t) != hdr->node_size) ||
+        (size != hdr->size) || (num_glue != hdr->num_cmds)) {
+        return CPARSER_ERR_PARSE_ERR;
+    }
+    if ((sizeof(*hdr) > hdr->root) || (hdr->root % sizeof(void *)) ||
+        ((size - sizeof(cparser_node_t)) < hdr->root)) {
+        return CPARSER_ERR_PARSE_ERR;
+    }
+    if (hdr->checksum != 
+        cparser_tree_checksum((const uint8_t *)(hdr + 1), size - sizeof(*hdr))) {
+        return CPARSER_ERR_PARSE_ERR;
+    }
+    root = (const cparser_node_t *)((const char *)hdr + hdr->root);
+    if ((CPARSER_NODE_ROOT != root->type) || !NODE_IS_IMAGE(root)) {
+        return CPARSER_ERR_PARSE_ERR;
+    }
+    return cparser_tree_check_nodes(hdr, root);
+}
+
+cparser_result_t
+cparser_tree_open (cparser_tree_t *tree, const char *path,
+                   const cparser_glue_fn *glue, uint32_t num_glue)
+{
+    struct stat st;
+    void *map;
+    int fd;
+    cparser_result_t rc;
+
+    if (!tree || !path || (num_glue && !glue)) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    memset(tree, 0, sizeof(*tree));
+
+    fd = open(path, O_RDONLY);
+    if (0 > fd) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+    if (fstat(fd, &st) || (sizeof(cparser_tree_hdr_t) + 
+                           sizeof(cparser_node_t) > st.st_size)) {
+        close(fd);
+        return CPARSER_ERR_PARSE_ERR;
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == map) {
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+
+    rc = cparser_tree_check((const cparser_tree_hdr_t *)map, st.st_size, 
+                            num_glue);
+    if (CPARSER_OK != rc) {
+        munmap(map, st.st_size);
+        return rc;
+    }
+
+    tree->root = (cparser_node_t *)
+        ((char *)map + ((const cparser_tree_hdr_t *)map)->root);
+    tree->glue = glue;
+    tree->num_cmds = num_glue;
+    tree->map = map;
+    tree->map_size = st.st_size;
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_tree_close (cparser_tree_t *tree)
+{
+    if (!tree || !tree->map) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    munmap(tree->map, tree->map_size);
+    memset(tree, 0, sizeof(*tree));
+    return CPARSER_OK;
+}
@@ -44,10 +44,13 @@
 #define CTRL_E (5)
 #define CTRL_N (14)
 #define CTRL_P (16)
+#define CTRL_R (18)
 
 /**
  * \brief    Enable/disable canonical mode.
- * \details  Note that this call must be made first with enable=0.
+ * \details  Note that this call must be made first with enable=0. The
+ *           terminal settings to restore are saved in the 'io_state' of
+ *           the parser.
  *
  * \param    parser Pointer to the parser.
  * \param    enable 1 to enable; 0 to disable.
@@ -55,23 +58,29 @@
 static void
 cparser_term_set_canonical (cparser_t *parser, int enable)
 {
-    static struct termios old_term;
-    static int old_term_set = 0;
-    struct termios new_term;
+    struct termios *old_term, new_term;
 
     if (!VALID_PARSER(parser)) return;
 
+    old_term = (struct termios *)parser->io_state;
     if (enable) {
-        assert(old_term_set);
-        tcsetattr(STDIN_FILENO, TCSANOW, &old_term);
-        old_term_set = 0;
+        if (!old_term) {
+            return; /* the settings could not be saved */
+        }
+        tcsetattr(STDIN_FILENO, TCSANOW, old_term);
+        cparser_mem_free(parser->cfg.alloc, old_term, sizeof(*old_term));
+        parser->io_state = NULL;
     } else {
-        assert(0 == STDIN_FILENO);
-        tcgetattr(STDIN_FILENO, &old_term);
-        new_term = old_term;
+        assert((0 == STDIN_FILENO) && !old_term);
+        old_term = cparser_mem_alloc(parser->cfg.alloc, sizeof(*old_term));
+        if (!old_term) {
+            return;
+        }
+        tcgetattr(STDIN_FILENO, old_term);
+        new_term = *old_term;
         new_term.c_lflag &= ~(ICANON | ECHO);
         tcsetattr(STDIN_FILENO, TCSANOW, &new_term);
-        old_term_set = 1;
+        parser->io_state = old_term;
     }
 }
 
@@ -109,6 +118,8 @@ cparser_unix_getch (cparser_t *parser, int *ch, cparser_char_t *type)
         *type = CPARSER_CHAR_FIRST;
     } else if (CTRL_E == (*ch)) {
         *type = CPARSER_CHAR_LAST;
+    } else if (CTRL_R == (*ch)) {
+        *type = CPARSER_CHAR_SEARCH;
 #endif /* EMACS_BINDING */
     } else if (isalnum(*ch) || ('\n' == *ch) ||
                ispunct(*ch) || (' ' == *ch) ||
@@ -125,6 +136,9 @@ cparser_unix_printc (const cparser_t *parser, const char ch)
 {
     ssize_t wsize;
     assert(parser);
+    if (parser->quiet) {
+        return;
+    }
     wsize = write(parser->cfg.fd, &ch, 1);
     assert((0 <= wsize) || (-1 == parser->cfg.fd));
 }
@@ -134,7 +148,7 @@ cparser_unix_prints (const cparser_t *parser, const char *s)
 {
     ssize_t wsize;
     assert(parser);
-    if (s) {
+    if (s && !parser->quiet) {
         wsize = write(parser->cfg.fd, s, strlen(s));
         assert((0 <= wsize) || (-1 == parser->cfg.fd));
     }
@@ -31,13 +31,90 @@
  */
 
 #include <assert.h>
+#include <stdio.h>
 #include <string.h>
 #include "cparser.h"
 #include "cparser_priv.h"
+#include "cparser_fsm.h"
 
-#define LINE_ALL(line)       &((line)->buf[0])
-#define LINE_CURRENT(line)   &(line)->buf[(line)->current]
+/*
+ * Each line is a gap buffer. Characters before the cursor are stored at
+ * the beginning of 'buf' and characters after the cursor are stored at the
+ * end of it (right before a permanent terminating NULL). The gap between
+ * them is always at least one byte long and its first byte is always NULL.
+ * So, both halves can be printed as strings without copying.
+ */
+#define LINE_BUF_SIZE(line)  ((line)->size+1)
+#define LINE_GAP_SIZE(line)  (LINE_BUF_SIZE(line) - (line)->last)
+#define LINE_GAP_END(line)   ((line)->current + LINE_GAP_SIZE(line))
+#define LINE_HEAD(line)      &((line)->buf[0])
+#define LINE_TAIL(line)      &((line)->buf[LINE_GAP_END(line)])
+
+#ifdef CPARSER_ANSI_TERMINAL
+#define ANSI_INSERT_CHAR     "\033[@"  /**< Insert one blank at the cursor */
+#define ANSI_DELETE_CHAR     "\033[P"  /**< Delete one character at the cursor */
+#define ANSI_ERASE_EOL       "\033[K"  /**< Erase to the end of the line */
+#endif /* CPARSER_ANSI_TERMINAL */
 
+/**
+ * \brief    Return a character of a line given its logical position.
+ *
+ * \param    line Pointer to the line structure.
+ * \param    pos  Logical position of the character.
+ *
+ * \return   The character.
+ */
+static char
+cparser_line_at (const cparser_line_t *line, short pos)
+{
+    assert(line && (0 <= pos) && (pos < line->last));
+    if (pos < line->current) {
+        return line->buf[pos];
+    }
+    return line->buf[pos + LINE_GAP_SIZE(line)];
+}
+
+/**
+ * \brief    Move the terminal cursor back.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    n      Number of columns to move.
+ */
+static void
+cparser_line_cursor_back (const cparser_t *parser, int n)
+{
+#ifdef CPARSER_ANSI_TERMINAL
+    char seq[16];
+
+    if (1 < n) {
+        snprintf(seq, sizeof(seq), "\033[%dD", n);
+        parser->cfg.prints(parser, seq);
+        return;
+    }
+#endif /* CPARSER_ANSI_TERMINAL */
+    for (; n > 0; n--) {
+        parser->cfg.printc(parser, '\b');
+    }
+}
+
+/**
+ * \brief    Print a portion of a line starting from a logical position.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    line   Pointer to the line structure.
+ * \param    pos    Logical position of the first character to be printed.
+ */
+static void
+cparser_line_print_from (const cparser_t *parser, const cparser_line_t *line,
+                         short pos)
+{
+    if (pos < line->current) {
+        parser->cfg.prints(parser, LINE_HEAD(line) + pos);
+        parser->cfg.prints(parser, LINE_TAIL(line));
+    } else {
+        parser->cfg.prints(parser, LINE_TAIL(line) + (pos - line->current));
+    }
+}
 
 cparser_result_t
 cparser_line_reset (cparser_line_t *line)
@@ -48,46 +125,105 @@ cparser_line_reset (cparser_line_t *line)
 
     line->last = 0;
     line->current = 0;
-    memset(line->buf, 0, sizeof(line->buf));
+    line->fsm.root = NULL;
+    line->buf[0] = '\0';
+    line->buf[LINE_BUF_SIZE(line)] = '\0';
+
+    return CPARSER_OK;
+}
 
+cparser_result_t
+cparser_line_compact (cparser_line_t *line)
+{
+    if (!line) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    if (line->current < line->last) {
+        memmove(&line->buf[line->current], LINE_TAIL(line),
+                line->last - line->current);
+        line->current = line->last;
+    }
+    line->buf[line->last] = '\0';
     return CPARSER_OK;
 }
 
+/**
+ * \brief    Update the saved parser FSM state of a line for an insertion
+ *           or a deletion of a character.
+ * \details  Positions at or after the edit move by one. The state is
+ *           dropped if it does not go beyond the edit.
+ *
+ * \param    line  Pointer to the line structure.
+ * \param    pos   Cursor position before the edit.
+ * \param    delta 1 for an insertion; -1 for a deletion.
+ */
+static void
+cparser_line_shift_state (cparser_line_t *line, short pos, short delta)
+{
+    cparser_line_fsm_t *fsm = &line->fsm;
+    short n;
+
+    if (fsm->current_pos <= pos) {
+        fsm->root = NULL;
+    }
+    if (!fsm->root) {
+        return;
+    }
+    for (n = 0; n <= fsm->token_tos; n++) {
+        if (fsm->begin_ptr[n] >= pos) {
+            fsm->begin_ptr[n] += delta;
+        }
+    }
+    fsm->current_pos += delta;
+    if (fsm->last_good >= pos) {
+        fsm->last_good += delta;
+    }
+    if (fsm->edit_end >= pos) {
+        fsm->edit_end += delta;
+    }
+    if (fsm->edit_end < pos + delta) {
+        fsm->edit_end = pos + delta;
+    }
+}
+
 cparser_result_t
 cparser_line_insert (cparser_t *parser, char ch)
 {
-    int n;
     cparser_line_t *line;
 
     if (!VALID_PARSER(parser) || !ch) {
         return CPARSER_ERR_INVALID_PARAMS;
     }
     line = &parser->lines[parser->cur_line];
-    if (CPARSER_MAX_LINE_SIZE <= line->last) {
+    if (line->size <= line->last) {
         return CPARSER_ERR_OUT_OF_RES;
     }
 
-    /* Move all characters from current to last back by 1 */
-    for (n = line->last; n > line->current; n--) {
-        line->buf[n] = line->buf[n-1];
-    }
-    line->buf[++line->last] = '\0';
+    /* Fill the first byte of the gap. The gap is never empty. */
+    cparser_line_shift_state(line, line->current, 1);
+    line->buf[line->current++] = ch;
+    line->last++;
+    line->buf[line->current] = '\0';
 
     /* 
-     * Insert the new character and update the line display. We do not 
-     * have full curse support here. Instead, we simply assume all 
-     * characters are on the same line and use backspace to move the 
-     * cursor.
+     * Update the line display. We do not have full curse support here. 
+     * Instead, we simply assume all characters are on the same line. 
+     * If the terminal understands ANSI sequences, we open a blank 
+     * column for the new character. Otherwise, the rest of the line
+     * is reprinted and backspaces are used to move the cursor back.
      */
-    line->buf[line->current] = ch;
-    parser->cfg.printc(parser, ch);
-    line->current++; /* update current position */
-    parser->cfg.prints(parser, LINE_CURRENT(line));
-
-    /* Move cursor back to the current position */
-    for (n = line->current; n < line->last; n++) {
-        parser->cfg.printc(parser, '\b');
+    if (line->current == line->last) {
+        parser->cfg.printc(parser, ch);
+        return CPARSER_OK;
     }
+#ifdef CPARSER_ANSI_TERMINAL
+    parser->cfg.prints(parser, ANSI_INSERT_CHAR);
+    parser->cfg.printc(parser, ch);
+#else
+    parser->cfg.printc(parser, ch);
+    parser->cfg.prints(parser, LINE_TAIL(line));
+    cparser_line_cursor_back(parser, line->last - line->current);
+#endif /* CPARSER_ANSI_TERMINAL */
     
     return CPARSER_OK;
 }
@@ -96,7 +232,6 @@ cparser_result_t
 cparser_line_delete (cparser_t *parser)
 {
     cparser_line_t *line;
-    int n;
 
     if (!VALID_PARSER(parser)) {
         return CPARSER_ERR_INVALID_PARAMS;
@@ -108,21 +243,26 @@ cparser_line_delete (cparser_t *parser)
         return CPARSER_ERR_NOT_EXIST;
     }
 
-    /* Move all character after current position back by one */
-    for (n = line->current; n < line->last; n++) {
-        line->buf[n-1] = line->buf[n];
-    }
+    /* The character before the cursor simply joins the gap */
+    cparser_line_shift_state(line, line->current, -1);
     line->current--;
     line->last--;
-    line->buf[line->last] = '\0';
+    line->buf[line->current] = '\0';
 
     /* Update the display */
+    if (line->current == line->last) {
+        parser->cfg.prints(parser, "\b \b");
+        return CPARSER_OK;
+    }
+#ifdef CPARSER_ANSI_TERMINAL
+    parser->cfg.printc(parser, '\b');
+    parser->cfg.prints(parser, ANSI_DELETE_CHAR);
+#else
     parser->cfg.printc(parser, '\b');
-    parser->cfg.prints(parser, LINE_CURRENT(line));
+    parser->cfg.prints(parser, LINE_TAIL(line));
     parser->cfg.prints(parser, " \b");
-    for (n = line->current; n < line->last; n++) {
-        parser->cfg.printc(parser, '\b');
-    }
+    cparser_line_cursor_back(parser, line->last - line->current);
+#endif /* CPARSER_ANSI_TERMINAL */
     return CPARSER_OK;
 }
 
@@ -130,7 +270,6 @@ void
 cparser_line_print (const cparser_t *parser, int print_prompt, int new_line)
 {
     const cparser_line_t *line;
-    int n;
 
     assert(VALID_PARSER(parser));
     if (new_line) {
@@ -140,12 +279,10 @@ cparser_line_print (const cparser_t *parser, int print_prompt, int new_line)
         cparser_print_prompt(parser);
     }
     line = &parser->lines[parser->cur_line];
-    parser->cfg.prints(parser, line->buf);
+    cparser_line_print_from(parser, line, 0);
 
     /* Move the cursor back the current position */
-    for (n = line->current; n < line->last; n++) {
-        parser->cfg.printc(parser, '\b');
-    }
+    cparser_line_cursor_back(parser, line->last - line->current);
 }
 
 short
@@ -168,17 +305,17 @@ cparser_line_current_char (const cparser_t *parser)
     const cparser_line_t *line;
     assert(VALID_PARSER(parser));
     line = &parser->lines[parser->cur_line];
-    return line->buf[line->current];
+    if (line->current == line->last) {
+        return '\0';
+    }
+    return *LINE_TAIL(line);
 }
 
 char
 cparser_line_char (const cparser_t *parser, short pos)
 {
-    const cparser_line_t *line;
     assert(VALID_PARSER(parser));
-    line = &parser->lines[parser->cur_line];
-    assert(pos < line->last);
-    return line->buf[pos];
+    return cparser_line_at(&parser->lines[parser->cur_line], pos);
 }
 
 char
@@ -194,9 +331,11 @@ cparser_line_next_char (cparser_t *parser)
         return 0;
     }
 
-    retval = line->buf[line->current];
+    /* Move the first character after the gap to the front of the gap */
+    retval = *LINE_TAIL(line);
+    line->buf[line->current++] = retval;
+    line->buf[line->current] = '\0';
     parser->cfg.printc(parser, retval);
-    line->current++;
 
     return retval;
 }
@@ -213,34 +352,250 @@ cparser_line_prev_char (cparser_t *parser)
         return 0;
     }
 
-    parser->cfg.printc(parser, '\b');
+    /* 
+     * Save the parser FSM state before leaving the furthest position
+     * so that it can be resumed when the cursor moves back.
+     */
+    if (!line->fsm.root || (line->fsm.current_pos <= line->current)) {
+        cparser_line_save_state(parser);
+    }
+
+    /* Move the last character before the gap to the end of the gap */
+    line->buf[LINE_GAP_END(line) - 1] = line->buf[line->current - 1];
     line->current--;
+    line->buf[line->current] = '\0';
+    parser->cfg.printc(parser, '\b');
 
     return '\b';
 }
 
+/**
+ * \brief    Replace the displayed line with another line.
+ * \details  With an ANSI terminal, only the part of the new line that
+ *           differs from the old one is printed and the rest of the
+ *           old line is erased with one sequence.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    old    Pointer to the line being displayed.
+ * \param    new    Pointer to the line to be displayed.
+ */
+static void
+cparser_line_replace (const cparser_t *parser, const cparser_line_t *old,
+                      const cparser_line_t *new)
+{
+    short n;
+#ifdef CPARSER_ANSI_TERMINAL
+    char seq[16];
+
+    /* Skip the common prefix of the two lines */
+    for (n = 0; (n < old->last) && (n < new->last) &&
+             (cparser_line_at(old, n) == cparser_line_at(new, n)); n++);
+
+    /* Move the cursor to the first different character */
+    if (n < old->current) {
+        cparser_line_cursor_back(parser, old->current - n);
+    } else if (n > old->current) {
+        snprintf(seq, sizeof(seq), "\033[%dC", n - old->current);
+        parser->cfg.prints(parser, seq);
+    }
+    if (n < new->last) {
+        cparser_line_print_from(parser, new, n);
+    }
+    if (new->last < old->last) {
+        parser->cfg.prints(parser, ANSI_ERASE_EOL);
+    }
+    cparser_line_cursor_back(parser, new->last - new->current);
+#else
+    /* Erase the current line */
+    for (n = 0; n < old->last; n++) {
+        parser->cfg.prints(parser, "\b \b");
+    }
+
+    /* Print out the new line */
+    cparser_line_print_from(parser, new, 0);
+    cparser_line_cursor_back(parser, new->last - new->current);
+#endif /* CPARSER_ANSI_TERMINAL */
+}
+
+/**
+ * \brief    Erase the rest of the terminal line.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    n      Number of columns to be erased.
+ */
+static void
+cparser_line_erase (const cparser_t *parser, int n)
+{
+#ifndef CPARSER_ANSI_TERMINAL
+    int k;
+#endif /* CPARSER_ANSI_TERMINAL */
+
+    if (0 >= n) {
+        return;
+    }
+#ifdef CPARSER_ANSI_TERMINAL
+    parser->cfg.prints(parser, ANSI_ERASE_EOL);
+#else
+    for (k = 0; k < n; k++) {
+        parser->cfg.printc(parser, ' ');
+    }
+    cparser_line_cursor_back(parser, n);
+#endif /* CPARSER_ANSI_TERMINAL */
+}
+
+/**
+ * \brief    Copy a line and its parser FSM state to another line of the 
+ *           same parser.
+ *
+ * \param    dst Pointer to the destination line.
+ * \param    src Pointer to the source line.
+ */
+static void
+cparser_line_copy (cparser_line_t *dst, const cparser_line_t *src)
+{
+    cparser_line_fsm_t *fsm = &dst->fsm;
+    short n;
+
+    assert(dst->size == src->size);
+    dst->last = src->last;
+    dst->current = src->current;
+    memcpy(dst->buf, src->buf, LINE_BUF_SIZE(src) + 1);
+
+    fsm->root = src->fsm.root;
+    fsm->tree_gen = src->fsm.tree_gen;
+    fsm->edit_end = src->fsm.edit_end;
+    fsm->current_pos = src->fsm.current_pos;
+    fsm->last_good = src->fsm.last_good;
+    fsm->token_tos = src->fsm.token_tos;
+    fsm->state = src->fsm.state;
+    fsm->is_privileged_mode = src->fsm.is_privileged_mode;
+    if (!fsm->root) {
+        return;
+    }
+    for (n = 0; n <= fsm->token_tos; n++) {
+        fsm->begin_ptr[n] = src->fsm.begin_ptr[n];
+        fsm->token_len[n] = src->fsm.token_len[n];
+        fsm->node[n] = src->fsm.node[n];
+    }
+}
+
+/**
+ * \brief    Load a history entry into the current line.
+ * \details  The new line being edited is saved when the first history
+ *           entry is loaded. Changes to a loaded history entry are lost
+ *           when another entry is loaded.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    id     History entry id. CPARSER_HISTORY_NONE to restore
+ *                  the new line.
+ */
+static void
+cparser_line_load (cparser_t *parser, uint32_t id)
+{
+    cparser_line_t *line;
+    const cparser_line_t *entered;
+    const char *cmd;
+    short len, n, m;
+
+    line = &parser->lines[parser->cur_line];
+    if (CPARSER_HISTORY_NONE == parser->hist_id) {
+        cparser_line_copy(&parser->hist_saved, line);
+    }
+    if (CPARSER_HISTORY_NONE == id) {
+        cparser_line_copy(line, &parser->hist_saved);
+    } else {
+        cmd = cparser_history_get(parser->cfg.history, id);
+        assert(cmd);
+        len = strlen(cmd);
+        if (line->size < len) {
+            /* The history may be shared with parsers with longer lines */
+            len = line->size;
+        }
+
+        /* 
+         * A command entered recently is still in a line buffer together
+         * with its parser FSM state. The history drops trailing spaces.
+         */
+        for (n = 0; n <= parser->max_line; n++) {
+            entered = &parser->lines[n];
+            if ((n == parser->cur_line) || 
+                (entered->current != entered->last) ||
+                (entered->last < len) || strncmp(entered->buf, cmd, len)) {
+                continue;
+            }
+            for (m = len; (m < entered->last) && (' ' == entered->buf[m]); m++);
+            if (m == entered->last) {
+                break;
+            }
+        }
+        if (n <= parser->max_line) {
+            cparser_line_copy(line, entered);
+        } else {
+            cparser_line_reset(line);
+            memcpy(line->buf, cmd, len);
+            line->buf[len] = '\0';
+            line->last = line->current = len;
+        }
+    }
+    parser->hist_id = id;
+}
+
+/**
+ * \brief    Display another history entry in the current line.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    id     History entry id. CPARSER_HISTORY_NONE to restore
+ *                  the new line.
+ */
+static void
+cparser_line_recall (cparser_t *parser, uint32_t id)
+{
+    cparser_line_copy(&parser->scratch, &parser->lines[parser->cur_line]);
+    cparser_line_load(parser, id);
+    cparser_line_replace(parser, &parser->scratch,
+                         &parser->lines[parser->cur_line]);
+}
+
 cparser_result_t
 cparser_line_next_line (cparser_t *parser)
 {
-    int n;
+    cparser_history_t *hist;
+    uint32_t id;
+    short new_line;
 
     if (!VALID_PARSER(parser)) {
         return CPARSER_ERR_INVALID_PARAMS;
     }
-
-    /* Erase the current line */
-    for (n = 0; n < cparser_line_last(parser); n++) {
-        parser->cfg.prints(parser, "\b \b");
+    cparser_line_save_state(parser);
+
+    hist = parser->cfg.history;
+    if (hist) {
+        /*
+         * Go to the next history entry. The new line follows the newest
+         * entry and it is followed by the oldest entry.
+         */
+        (void)cparser_history_sync(hist);
+        if (CPARSER_HISTORY_NONE == parser->hist_id) {
+            if (CPARSER_OK != cparser_history_next(hist, parser->hist_id, 
+                                                   &id)) {
+                return CPARSER_OK;
+            }
+        } else if (CPARSER_OK != cparser_history_next(hist, parser->hist_id,
+                                                      &id)) {
+            id = CPARSER_HISTORY_NONE;
+        }
+        cparser_line_recall(parser, id);
+        return CPARSER_OK;
     }
 
     /* Go to the next line */
-    parser->cur_line++;
-    if (parser->max_line < parser->cur_line) {
-        parser->cur_line = 0;
+    new_line = parser->cur_line + 1;
+    if (parser->max_line < new_line) {
+        new_line = 0;
     }
-
-    /* Print out the new line */
-    cparser_line_print(parser, 0, 0);
+    cparser_line_replace(parser, &parser->lines[parser->cur_line],
+                         &parser->lines[new_line]);
+    parser->cur_line = new_line;
 
     return CPARSER_OK;
 }
@@ -248,25 +603,254 @@ cparser_line_next_line (cparser_t *parser)
 cparser_result_t
 cparser_line_prev_line (cparser_t *parser)
 {
-    int n;
+    cparser_history_t *hist;
+    uint32_t id;
+    short new_line;
 
     if (!VALID_PARSER(parser)) {
         return CPARSER_ERR_INVALID_PARAMS;
     }
-
-    /* Erase the current line */
-    for (n = 0; n < cparser_line_last(parser); n++) {
-        parser->cfg.prints(parser, "\b \b");
+    cparser_line_save_state(parser);
+
+    hist = parser->cfg.history;
+    if (hist) {
+        /* Go to the previous history entry, wrapping around like below */
+        (void)cparser_history_sync(hist);
+        if (CPARSER_HISTORY_NONE == parser->hist_id) {
+            if (CPARSER_OK != cparser_history_prev(hist, parser->hist_id,
+                                                   &id)) {
+                return CPARSER_OK;
+            }
+        } else if (CPARSER_OK != cparser_history_prev(hist, parser->hist_id,
+                                                      &id)) {
+            id = CPARSER_HISTORY_NONE;
+        }
+        cparser_line_recall(parser, id);
+        return CPARSER_OK;
     }
 
     /* Go to the previous line */
-    parser->cur_line--;
-    if (0 > parser->cur_line) {
-        parser->cur_line = parser->max_line;
+    new_line = parser->cur_line - 1;
+    if (0 > new_line) {
+        new_line = parser->max_line;
     }
+    cparser_line_replace(parser, &parser->lines[parser->cur_line],
+                         &parser->lines[new_line]);
+    parser->cur_line = new_line;
 
-    /* Print out the new line */
-    cparser_line_print(parser, 0, 0);
+    return CPARSER_OK;
+}
+
+void
+cparser_line_save_state (cparser_t *parser)
+{
+    cparser_line_t *line;
+
+    assert(VALID_PARSER(parser));
+    line = &parser->lines[parser->cur_line];
+    if (parser->quiet || (parser->current_pos != line->current)) {
+        /* The parser FSM is not driven by the line */
+        return;
+    }
+    cparser_fsm_save(parser, &line->fsm);
+    line->fsm.edit_end = -1;
+}
+
+cparser_result_t
+cparser_line_load_state (cparser_t *parser)
+{
+    const cparser_line_t *line;
+
+    if (!VALID_PARSER(parser)) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    line = &parser->lines[parser->cur_line];
+    if (!line->fsm.root || (0 <= line->fsm.edit_end) ||
+        (line->fsm.current_pos != line->current)) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+    return cparser_fsm_restore(parser, &line->fsm, 0);
+}
+
+cparser_result_t
+cparser_line_fast_forward (cparser_t *parser)
+{
+    cparser_line_t *line;
+    const cparser_line_fsm_t *fsm;
+    short pos, k;
+    cparser_result_t rc;
+
+    if (!VALID_PARSER(parser)) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    line = &parser->lines[parser->cur_line];
+    fsm = &line->fsm;
+    pos = line->current;
+    k = parser->token_tos;
+
+    /* 
+     * The parser FSM must be fed by the line and be between two tokens.
+     * The line from the character before the cursor must not be changed
+     * since the snapshot.
+     */
+    if (!fsm->root || (parser->current_pos != pos) ||
+        (CPARSER_STATE_WHITESPACE != parser->state) ||
+        (pos <= fsm->edit_end) || (pos >= fsm->current_pos) ||
+        (k > fsm->token_tos)) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+
+    /* The snapshot must have the same tokens pushed at this position */
+    if (k && ((fsm->node[k-1] != parser->tokens[k-1].node) ||
+              (fsm->begin_ptr[k-1] >= pos))) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+    if ((0 <= fsm->begin_ptr[k]) && (fsm->begin_ptr[k] < pos)) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+    if (((CPARSER_STATE_ERROR == fsm->state) || 
+         (CPARSER_STATE_FILTER == fsm->state)) && 
+        (fsm->last_good < pos - 1)) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+
+    rc = cparser_fsm_restore(parser, fsm, k);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    while (line->current < fsm->current_pos) {
+        (void)cparser_line_next_char(parser);
+    }
+    return CPARSER_OK;
+}
+
+/**
+ * \brief    Display the state of a reverse incremental search.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    failed 1 if the search string is not found; 0 otherwise.
+ */
+static void
+cparser_line_search_print (cparser_t *parser, int failed)
+{
+    const char *cmd;
+    int cols;
+
+    cmd = cparser_history_get(parser->cfg.history, parser->search_id);
+    if (!cmd) {
+        cmd = "";
+    }
+    parser->cfg.printc(parser, '\r');
+    if (failed) {
+        parser->cfg.prints(parser, "failing ");
+    }
+    parser->cfg.prints(parser, "(reverse-i-search)`");
+    parser->cfg.prints(parser, parser->search_buf);
+    parser->cfg.prints(parser, "': ");
+    parser->cfg.prints(parser, cmd);
+
+    cols = (failed ? 8 : 0) + 22 + parser->search_len + strlen(cmd);
+    cparser_line_erase(parser, parser->search_cols - cols);
+    parser->search_cols = cols;
+}
+
+cparser_result_t
+cparser_line_search_start (cparser_t *parser)
+{
+    const cparser_line_t *line;
+
+    if (!VALID_PARSER(parser)) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    if (!parser->cfg.history) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+    (void)cparser_history_sync(parser->cfg.history);
+
+    /* The search display replaces the prompt and the line */
+    line = &parser->lines[parser->cur_line];
+    parser->search_active = 1;
+    parser->search_len = 0;
+    parser->search_buf[0] = '\0';
+    parser->search_id = CPARSER_HISTORY_NONE;
+    parser->search_cols = strlen(parser->prompt[parser->root_level]) +
+        cparser_is_in_privileged_mode(parser) + line->last;
+    cparser_line_search_print(parser, 0);
+
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_line_search_input (cparser_t *parser, char ch)
+{
+    uint32_t before, id;
+    cparser_result_t rc;
+
+    if (!VALID_PARSER(parser) || !parser->search_active) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    (void)cparser_history_sync(parser->cfg.history);
+
+    if (!ch) {
+        /* Look for an older match */
+        before = parser->search_id;
+    } else if ((parser->cfg.ch_erase == ch) || (parser->cfg.ch_del == ch)) {
+        if (parser->search_len) {
+            parser->search_buf[--parser->search_len] = '\0';
+        }
+        before = CPARSER_HISTORY_NONE;
+    } else {
+        if (parser->cfg.max_line_size <= parser->search_len) {
+            parser->cfg.printc(parser, '\a');
+            return CPARSER_ERR_OUT_OF_RES;
+        }
+        parser->search_buf[parser->search_len++] = ch;
+        parser->search_buf[parser->search_len] = '\0';
+        /* The current match may still contain the longer string */
+        before = parser->search_id;
+        if (CPARSER_HISTORY_NONE != before) {
+            before++;
+        }
+    }
+
+    rc = cparser_history_search(parser->cfg.history, parser->search_buf,
+                                before, &id);
+    if (CPARSER_OK == rc) {
+        parser->search_id = id;
+    } else if (!parser->search_len) {
+        parser->search_id = CPARSER_HISTORY_NONE;
+        rc = CPARSER_OK;
+    } else {
+        parser->cfg.printc(parser, '\a');
+    }
+    cparser_line_search_print(parser, (CPARSER_OK != rc));
+
+    return rc;
+}
+
+cparser_result_t
+cparser_line_search_stop (cparser_t *parser, int accept)
+{
+    const cparser_line_t *line;
+    int cols;
+
+    if (!VALID_PARSER(parser) || !parser->search_active) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    if (accept && (CPARSER_HISTORY_NONE != parser->search_id)) {
+        cparser_line_load(parser, parser->search_id);
+    }
+    parser->search_active = 0;
+
+    /* Restore the prompt and the line */
+    line = &parser->lines[parser->cur_line];
+    parser->cfg.printc(parser, '\r');
+    cparser_print_prompt(parser);
+    cparser_line_print_from(parser, line, 0);
+    cols = strlen(parser->prompt[parser->root_level]) +
+        cparser_is_in_privileged_mode(parser) + line->last;
+    cparser_line_erase(parser, parser->search_cols - cols);
+    cparser_line_cursor_back(parser, line->last - line->current);
 
     return CPARSER_OK;
 }
@@ -280,8 +864,20 @@ cparser_line_advance (cparser_t *parser)
         return CPARSER_ERR_INVALID_PARAMS;
     }
 
+    /*
+     * Close the gap of the line just entered so that it is a plain
+     * string in the history (see cparser_last_command()).
+     */
+    rc = cparser_line_compact(&parser->lines[parser->cur_line]);
+    assert(0 == rc);
+    if (parser->cfg.history) {
+        (void)cparser_history_add(parser->cfg.history,
+                                  parser->lines[parser->cur_line].buf);
+        parser->hist_id = CPARSER_HISTORY_NONE;
+    }
+
     parser->cur_line++;
-    if (CPARSER_MAX_LINES <= parser->cur_line) {
+    if (parser->cfg.max_lines <= parser->cur_line) {
         parser->cur_line = 0;
     }
     if (parser->max_line < parser->cur_line) {
@@ -35,14 +35,28 @@
 
 #include "cparser.h"
 #include "cparser_token.h"
+#include "cparser_image.h"
 
 /**
  * A node in the parser tree. It has a node type which determines
  * what type of token is accepted.
+ *
+ * Nodes of a tree image (see cparser_tree_open()) have 
+ * CPARSER_NODE_FLAGS_IMAGE set. Their pointer fields hold byte offsets
+ * relative to the node itself (0 for NULL) and 'param' of an END node
+ * holds the command ID. Nodes of a packed tree are cparser_pnode_t 
+ * with CPARSER_NODE_FLAGS_PACKED set. Use the NODE_* macros below to 
+ * follow them.
  */
 struct cparser_node_ {
-    cparser_node_type_t   type;      /**< Token type */ 
-    uint32_t              flags;     /**< Flags */
+    uint8_t               type;      /**< Token type (cparser_node_type_t) */ 
+    uint8_t               flags;     /**< Flags */
+    /**
+     * Length of the shortest prefix of a keyword that no sibling 
+     * matches. 0 if it is not known or a sibling parameter can match the
+     * same token. Computed by mk_parser.py.
+     */
+    uint16_t              uniq_len;
     void                  *param;    /**< Token-dependent parameter */
     char                  *desc;     /**< A per-node description string */
     /** Pointer to the next sibling in the same level of the tree */
@@ -55,12 +69,151 @@ struct cparser_node_ {
 #define CPARSER_NODE_FLAGS_OPT_END            (1 << 1)
 #define CPARSER_NODE_FLAGS_OPT_PARTIAL        (1 << 2)
 #define CPARSER_NODE_FLAGS_HIDDEN             (1 << 3)
+#define CPARSER_NODE_FLAGS_IMAGE              (1 << 4)
+#define CPARSER_NODE_FLAGS_PACKED             (1 << 5)
+/** No sibling matches a token this node completely matches */
+#define CPARSER_NODE_FLAGS_NO_OVERLAP         (1 << 6)
+
+/**
+ * A node of a packed tree generated by "mk_parser.py -p". It starts 
+ * like cparser_node_t so 'type', 'flags' and 'uniq_len' are read the 
+ * same way. The other fields are byte offsets relative to the node 
+ * itself (0 for NULL), except 'param' of an END node which holds the
+ * command ID. The description is not in the node. See cparser_tree_t.
+ */
+typedef struct cparser_pnode_ {
+    uint8_t               type;      /**< Token type (cparser_node_type_t) */
+    uint8_t               flags;     /**< Flags */
+    uint16_t              uniq_len;  /**< See cparser_node_t */
+    int32_t               param;     /**< Token-dependent parameter */
+    int32_t               sibling;   /**< Next sibling */
+    int32_t               children;  /**< First child */
+} cparser_pnode_t;
+
+/**
+ * A list node of a packed tree. Both fields are offsets relative to the
+ * list node.
+ */
+typedef struct cparser_plist_node_ {
+    int32_t               next;
+    int32_t               keyword;
+} cparser_plist_node_t;
+
+/**
+ * Section of the data of a packed tree that is only read for help. It
+ * is kept apart from the data used to match tokens.
+ */
+#if defined(__GNUC__) && defined(__ELF__)
+#define CPARSER_COLD __attribute__((section("cparser_cold")))
+#else
+#define CPARSER_COLD
+#endif
+
+#define NODE_IS_IMAGE(n)  ((n)->flags & CPARSER_NODE_FLAGS_IMAGE)
+#define NODE_IS_PACKED(n) ((n)->flags & CPARSER_NODE_FLAGS_PACKED)
+
+/**
+ * \brief    Follow a pointer field of a node or a list node.
+ *
+ * \param    base     Pointer to the node or the list node.
+ * \param    field    Value of the field.
+ * \param    is_image Whether the field holds an offset relative to 'base'.
+ *
+ * \return   The pointer the field refers to.
+ */
+static inline void *
+cparser_node_field (const void *base, const void *field, int is_image)
+{
+    if (!is_image || !field) {
+        return (void *)field;
+    }
+    return (char *)base + (intptr_t)field;
+}
+
+/**
+ * \brief    Follow an offset field of a packed node or list node.
+ *
+ * \param    base  Pointer to the node or the list node.
+ * \param    field Value of the field.
+ *
+ * \return   The pointer the field refers to.
+ */
+static inline void *
+cparser_packed_field (const void *base, int32_t field)
+{
+    if (!field) {
+        return NULL;
+    }
+    return (char *)base + field;
+}
+
+#define PNODE(n)         ((const cparser_pnode_t *)(n))
+
+/**
+ * \brief    Get the description of a node of a packed tree.
+ *
+ * \param    tree Pointer to the packed tree.
+ * \param    node Pointer to the node.
+ *
+ * \return   The description; NULL if there is none.
+ */
+static inline char *
+cparser_packed_desc (const cparser_tree_t *tree, const cparser_node_t *node)
+{
+    uint32_t desc = tree->desc_idx[PNODE(node) - PNODE(tree->root)];
+
+    if (!desc) {
+        return NULL;
+    }
+    return (char *)tree->descs + desc;
+}
+
+#define NODE_FIELD(n,f)                                                 \
+    (NODE_IS_PACKED(n) ? cparser_packed_field(n, PNODE(n)->f) :         \
+     cparser_node_field(n, (n)->f, NODE_IS_IMAGE(n)))
+#define NODE_SIBLING(n)  ((cparser_node_t *)NODE_FIELD(n, sibling))
+#define NODE_CHILDREN(n) ((cparser_node_t *)NODE_FIELD(n, children))
+/** Parameter of any node other than END */
+#define NODE_PARAM(n)    NODE_FIELD(n, param)
+
+/**
+ * Description of the node 'n' of the tree 't'. The descriptions of a 
+ * packed tree are kept apart from its nodes and indexed by node.
+ */
+#define NODE_DESC(t,n)                                                  \
+    (NODE_IS_PACKED(n) ? cparser_packed_desc(t, n) :                    \
+     (char *)cparser_node_field(n, (n)->desc, NODE_IS_IMAGE(n)))
+
+/** Whether 'param' of the END node 'n' holds a command ID */
+#define NODE_HAS_CMD_ID(n)                                              \
+    ((n)->flags & (CPARSER_NODE_FLAGS_IMAGE | CPARSER_NODE_FLAGS_PACKED))
+#define NODE_CMD_ID(n)                                                  \
+    (NODE_IS_PACKED(n) ? (uint32_t)PNODE(n)->param :                    \
+     (uint32_t)(intptr_t)(n)->param)
+
+/** Glue function of an END node */
+#define NODE_GLUE(p,n)                                                  \
+    (NODE_HAS_CMD_ID(n) ? (p)->cfg.tree->glue[NODE_CMD_ID(n)] :         \
+     (cparser_glue_fn)(n)->param)
+
+/** Fields of the list node 'l' of the LIST node 'n' */
+#define LIST_NODE_NEXT(n,l)                                             \
+    ((cparser_list_node_t *)(NODE_IS_PACKED(n) ?                        \
+     cparser_packed_field(l, ((const cparser_plist_node_t *)(l))->next) : \
+     cparser_node_field(l, (l)->next, NODE_IS_IMAGE(n))))
+#define LIST_NODE_KEYWORD(n,l)                                          \
+    ((const char *)(NODE_IS_PACKED(n) ?                                 \
+     cparser_packed_field(l, ((const cparser_plist_node_t *)(l))->keyword) : \
+     cparser_node_field(l, (l)->keyword, NODE_IS_IMAGE(n))))
 
 #define VALID_PARSER(p)  (p)
 
 #define NODE_USABLE(p,n) (((p)->is_privileged_mode) ||                  \
                           (!((n)->flags & CPARSER_NODE_FLAGS_HIDDEN)))
 
+/** Generation of the tree of a parser. See cparser_tree_t. */
+#define TREE_GEN(p)      ((p)->cfg.tree ? (p)->cfg.tree->gen : 0)
+
 /** Return the current line index */
 #define CURRENT_LINE(p)  ((p)->cur_line)
 
@@ -71,6 +224,8 @@ typedef struct cparser_list_node_ cparser_list_node_t;
  * \brief    A special list node used for LIST token.
  * \details  Each list node holds one keyword for a LIST token. They
  *           are singlely linked. The last keyword has a NULL next pointer.
+ *           In a tree image, both fields are offsets relative to the list
+ *           node.
  */
 struct cparser_list_node_ {
     cparser_list_node_t   *next;
@@ -85,4 +240,21 @@ struct cparser_list_node_ {
  */
 void cparser_print_prompt(const cparser_t *parser);
 
+/**
+ * \brief    Move a parser at the top level to the newest tree version.
+ * \details  Nothing is done if the parser already uses it. Otherwise,
+ *           the top-level root is replaced and the older version is
+ *           released.
+ *
+ * \param    parser Pointer to the parser structure.
+ */
+void cparser_tree_enter(cparser_t *parser);
+
+/**
+ * \brief    Release the tree version used by a parser.
+ *
+ * \param    parser Pointer to the parser structure.
+ */
+void cparser_tree_leave(cparser_t *parser);
+
 #endif /* __CPARSER_PRIV_H__ */
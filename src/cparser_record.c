@@ -0,0 +1,593 @@
+/**
+ * \file     cparser_record.c
+ * \brief    Recording and replaying of command sessions.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_record.h"
+
+/** Size of the header of a log file */
+#define CPARSER_RECORD_HDR_SIZE    (16)
+
+/** Version of the log format */
+#define CPARSER_RECORD_VERSION     (1)
+
+/** Maximum number of bytes of a varint */
+#define CPARSER_RECORD_MAX_VARINT  (10)
+
+/** Smallest write buffer */
+#define CPARSER_RECORD_MIN_BUF     (64)
+
+/**
+ * \brief    Get the time in microseconds of a clock.
+ */
+static uint64_t
+cparser_record_now (clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static char *
+cparser_record_put_varint (char *p, uint64_t val)
+{
+    while (0x80 <= val) {
+        *p++ = (char)(0x80 | (val & 0x7f));
+        val >>= 7;
+    }
+    *p++ = (char)val;
+    return p;
+}
+
+/**
+ * \brief    Read a varint.
+ *
+ * \return   Number of bytes read; 0 if the varint is truncated or too
+ *           long.
+ */
+static size_t
+cparser_record_get_varint (const char *buf, size_t len, uint64_t *val)
+{
+    const unsigned char *p = (const unsigned char *)buf;
+    size_t n;
+
+    *val = 0;
+    for (n = 0; (n < len) && (n < CPARSER_RECORD_MAX_VARINT); n++) {
+        *val |= (uint64_t)(p[n] & 0x7f) << (7 * n);
+        if (!(p[n] & 0x80)) {
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief    Write all bytes into a file.
+ *
+ * \return   0 if succeeded; -1 otherwise.
+ */
+static int
+cparser_record_write (int fd, const char *buf, size_t len)
+{
+    ssize_t n;
+
+    while (len) {
+        n = write(fd, buf, len);
+        if (0 > n) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+cparser_result_t
+cparser_record_open (cparser_record_t *rec, const char *path, 
+                     size_t buf_size, const cparser_alloc_t *alloc)
+{
+    char hdr[CPARSER_RECORD_HDR_SIZE];
+    uint64_t start;
+    int n;
+
+    if (!rec || !path) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    if (!buf_size) {
+        buf_size = CPARSER_RECORD_BUF_SIZE;
+    }
+    if (CPARSER_RECORD_MIN_BUF > buf_size) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    memset(rec, 0, sizeof(*rec));
+    rec->buf = cparser_mem_alloc(alloc, buf_size);
+    if (!rec->buf) {
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    rec->size = buf_size;
+    rec->alloc = alloc;
+
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, "CPRL", 4);
+    hdr[4] = CPARSER_RECORD_VERSION;
+    start = cparser_record_now(CLOCK_REALTIME);
+    for (n = 0; n < 8; n++) {
+        hdr[8 + n] = (char)(start >> (56 - (8 * n)));
+    }
+    rec->last = cparser_record_now(CLOCK_MONOTONIC);
+    rec->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if ((0 > rec->fd) || cparser_record_write(rec->fd, hdr, sizeof(hdr))) {
+        if (0 <= rec->fd) {
+            close(rec->fd);
+        }
+        cparser_mem_free(alloc, rec->buf, buf_size);
+        rec->buf = NULL;
+        return CPARSER_NOT_OK;
+    }
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_record_flush (cparser_record_t *rec)
+{
+    cparser_result_t rc = CPARSER_OK;
+
+    if (!rec || !rec->buf) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    if (cparser_record_write(rec->fd, rec->buf, rec->len)) {
+        rec->num_dropped += rec->count;
+        rc = CPARSER_NOT_OK;
+    } else {
+        rec->num_records += rec->count;
+    }
+    rec->len = 0;
+    rec->count = 0;
+    return rc;
+}
+
+cparser_result_t
+cparser_record_close (cparser_record_t *rec)
+{
+    cparser_result_t rc;
+
+    if (!rec || !rec->buf) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    rc = cparser_record_flush(rec);
+    if (close(rec->fd)) {
+        rc = CPARSER_NOT_OK;
+    }
+    cparser_mem_free(rec->alloc, rec->buf, rec->size);
+    rec->buf = NULL;
+    rec->fd = -1;
+    return rc;
+}
+
+void
+cparser_record_hook (cparser_t *parser)
+{
+    cparser_record_t *rec;
+    cparser_result_t rc;
+    char *cmd, *p;
+    uint64_t now;
+    size_t len, need;
+
+    assert(parser && parser->cfg.record_cookie);
+    rec = (cparser_record_t *)parser->cfg.record_cookie;
+    assert(rec->buf);
+    now = cparser_record_now(CLOCK_MONOTONIC);
+    (void)cparser_last_command(parser, &cmd, &rc, NULL);
+    if (CPARSER_PENDING == rc) {
+        /* Logged with the time it went pending when it completes */
+        rec->pending = now;
+        return;
+    }
+    if (rec->pending) {
+        now = rec->pending;
+        rec->pending = 0;
+    }
+    if (!cmd) {
+        return;
+    }
+
+    /* Trailing spaces are left by completion */
+    for (len = strlen(cmd); len && (' ' == cmd[len - 1]); len--);
+    if (!len) {
+        return;
+    }
+    need = (2 * CPARSER_RECORD_MAX_VARINT) + 2 + len;
+    if (need > rec->size) {
+        rec->num_dropped++;
+        return;
+    }
+    if ((rec->len + need) > rec->size) {
+        (void)cparser_record_flush(rec);
+    }
+
+    p = rec->buf + rec->len;
+    p = cparser_record_put_varint(p, (now > rec->last ? now - rec->last : 0));
+    *p++ = (char)rc;
+    *p++ = (char)parser->root_level;
+    p = cparser_record_put_varint(p, len);
+    memcpy(p, cmd, len);
+    p += len;
+    rec->len = p - rec->buf;
+    rec->count++;
+    if (now > rec->last) {
+        rec->last = now;
+    }
+}
+
+/**
+ * \brief    Recorder function of a parser being replayed.
+ */
+static void
+cparser_replay_hook (cparser_t *parser)
+{
+    cparser_replay_session_t *session = 
+        (cparser_replay_session_t *)parser->cfg.record_cookie;
+
+    if (CPARSER_PENDING != parser->last_rc) {
+        session->cmd_rc = parser->last_rc;
+        session->done = 1;
+    }
+}
+
+static int
+cparser_replay_bucket (uint64_t usec)
+{
+    int msb;
+
+    if (8 > usec) {
+        return (int)usec;
+    }
+    for (msb = 3; usec >> (msb + 1); msb++);
+    return 8 + ((msb - 3) * 8) + (int)((usec >> (msb - 3)) & 7);
+}
+
+/**
+ * \brief    Get the highest latency of a bucket.
+ */
+static uint64_t
+cparser_replay_bucket_max (int bucket)
+{
+    int shift;
+
+    if (8 > bucket) {
+        return bucket;
+    }
+    shift = (bucket - 8) / 8;
+    return (((uint64_t)(8 + ((bucket - 8) % 8) + 1)) << shift) - 1;
+}
+
+/**
+ * \brief    Read a log file into the session.
+ */
+static cparser_result_t
+cparser_replay_load (cparser_replay_session_t *session)
+{
+    struct stat st;
+    ssize_t n;
+    size_t len = 0;
+    int fd, k;
+
+    fd = open(session->path, O_RDONLY);
+    if (0 > fd) {
+        return CPARSER_NOT_OK;
+    }
+    if (fstat(fd, &st) || (CPARSER_RECORD_HDR_SIZE > st.st_size)) {
+        close(fd);
+        return CPARSER_NOT_OK;
+    }
+    session->log_size = st.st_size;
+    session->log = cparser_mem_alloc(NULL, session->log_size);
+    if (!session->log) {
+        close(fd);
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    while (len < session->log_size) {
+        n = read(fd, session->log + len, session->log_size - len);
+        if ((0 > n) && (EINTR == errno)) {
+            continue;
+        }
+        if (0 >= n) {
+            break;
+        }
+        len += n;
+    }
+    close(fd);
+    session->log_size = len;
+    if ((CPARSER_RECORD_HDR_SIZE > len) || memcmp(session->log, "CPRL", 4) ||
+        (CPARSER_RECORD_VERSION != session->log[4])) {
+        return CPARSER_NOT_OK;
+    }
+    session->start = 0;
+    for (k = 0; k < 8; k++) {
+        session->start = (session->start << 8) | 
+            (unsigned char)session->log[8 + k];
+    }
+    return CPARSER_OK;
+}
+
+/**
+ * \brief    Add the latency of a command to the results.
+ */
+static void
+cparser_replay_count (cparser_replay_stats_t *stats, uint64_t usec)
+{
+    stats->num_cmds++;
+    stats->total_usec += usec;
+    if (usec > stats->max_usec) {
+        stats->max_usec = usec;
+    }
+    stats->buckets[cparser_replay_bucket(usec)]++;
+}
+
+/**
+ * \brief    Thread of a session.
+ */
+static void *
+cparser_replay_run (void *arg)
+{
+    cparser_replay_session_t *session = (cparser_replay_session_t *)arg;
+    cparser_t *parser = session->parser;
+    const char *log = session->log, *cmd;
+    size_t pos = CPARSER_RECORD_HDR_SIZE, n;
+    uint64_t delta, len, when = 0, begin, end = session->base;
+    struct timespec ts;
+    cparser_result_t rc;
+    int level;
+
+    while (pos < session->log_size) {
+        n = cparser_record_get_varint(log + pos, session->log_size - pos,
+                                      &delta);
+        if (!n || ((pos + n + 2) >= session->log_size)) {
+            break; /* Truncated at the end */
+        }
+        pos += n;
+        rc = (cparser_result_t)(unsigned char)log[pos];
+        level = (unsigned char)log[pos + 1];
+        pos += 2;
+        n = cparser_record_get_varint(log + pos, session->log_size - pos, 
+                                      &len);
+        if (!n || (len > (session->log_size - pos - n))) {
+            break;
+        }
+        cmd = log + pos + n;
+        pos += n + len;
+        when += delta;
+
+        if (0.0 < session->speed) {
+            /* Wait for the time of the command */
+            begin = session->base + 
+                (uint64_t)((double)(session->start + when) / session->speed);
+            ts.tv_sec = begin / 1000000;
+            ts.tv_nsec = (begin % 1000000) * 1000;
+            while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+                                            &ts, NULL));
+        }
+
+        begin = cparser_record_now(CLOCK_MONOTONIC);
+        session->done = 0;
+        for (; len; len--, cmd++) {
+            (void)cparser_input(parser, *cmd, CPARSER_CHAR_REGULAR);
+        }
+        (void)cparser_input(parser, '\n', CPARSER_CHAR_REGULAR);
+        while (!session->done && parser->pending) {
+            if (!session->wait || 
+                (CPARSER_OK != session->wait(parser, session->cookie))) {
+                session->rc = CPARSER_NOT_OK;
+                return NULL;
+            }
+        }
+        end = cparser_record_now(CLOCK_MONOTONIC);
+        if (!session->done) {
+            continue; /* Taken as a user input */
+        }
+
+        cparser_replay_count(&session->stats, end - begin);
+        if (session->cmd_rc != rc) {
+            session->stats.num_rc_diverged++;
+        }
+        if (parser->root_level != level) {
+            session->stats.num_level_diverged++;
+        }
+    }
+    session->stats.usec = end - session->base;
+    return NULL;
+}
+
+/**
+ * \brief    Give back a parser the settings a replay took over.
+ * \details  Only what cparser_replay() changed is restored. The tree may
+ *           have moved to a newer version during the replay.
+ *
+ * \param    session Pointer to the replay session.
+ */
+static void
+cparser_replay_restore (cparser_replay_session_t *session)
+{
+    session->parser->cfg.record = session->cfg.record;
+    session->parser->cfg.record_cookie = session->cfg.record_cookie;
+    session->parser->cfg.ch_help = session->cfg.ch_help;
+    session->parser->cfg.ch_complete = session->cfg.ch_complete;
+    session->parser->cfg.flags = session->cfg.flags;
+}
+
+cparser_result_t
+cparser_replay (cparser_replay_session_t *sessions, int num_sessions,
+                double speed, cparser_replay_wait_fn wait, void *cookie,
+                cparser_replay_stats_t *stats)
+{
+    cparser_replay_session_t *session;
+    cparser_result_t rc = CPARSER_OK;
+    uint64_t earliest = 0, base;
+    int n, k, num_started = 0;
+
+    if (!sessions || (0 >= num_sessions) || (0.0 > speed) || !stats) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    for (n = 0; n < num_sessions; n++) {
+        if (!VALID_PARSER(sessions[n].parser) || !sessions[n].path ||
+            sessions[n].parser->pending) {
+            return CPARSER_ERR_INVALID_PARAMS;
+        }
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    for (n = 0; n < num_sessions; n++) {
+        session = &sessions[n];
+        memset(&session->stats, 0, sizeof(session->stats));
+        session->log = NULL;
+        session->rc = cparser_replay_load(session);
+        if (CPARSER_OK != session->rc) {
+            rc = CPARSER_NOT_OK;
+        } else if (!n || (session->start < earliest)) {
+            earliest = session->start;
+        }
+    }
+
+    if (CPARSER_OK == rc) {
+        /* The logs are aligned by the time they were recorded */
+        base = cparser_record_now(CLOCK_MONOTONIC);
+        for (n = 0; n < num_sessions; n++) {
+            session = &sessions[n];
+            session->start -= earliest;
+            session->base = base;
+            session->speed = speed;
+            session->wait = wait;
+            session->cookie = cookie;
+            session->cfg = session->parser->cfg;
+            session->parser->cfg.record = cparser_replay_hook;
+            session->parser->cfg.record_cookie = session;
+            session->parser->cfg.ch_help = 0;
+            session->parser->cfg.ch_complete = 0;
+            session->parser->cfg.flags |= CPARSER_FLAGS_BATCH;
+            if (pthread_create(&session->thread, NULL, cparser_replay_run,
+                               session)) {
+                cparser_replay_restore(session);
+                session->rc = CPARSER_NOT_OK;
+                rc = CPARSER_NOT_OK;
+                break;
+            }
+            num_started++;
+        }
+    }
+
+    for (n = 0; n < num_started; n++) {
+        session = &sessions[n];
+        pthread_join(session->thread, NULL);
+        cparser_replay_restore(session);
+        if (CPARSER_OK != session->rc) {
+            rc = CPARSER_NOT_OK;
+        }
+        stats->num_cmds += session->stats.num_cmds;
+        stats->num_rc_diverged += session->stats.num_rc_diverged;
+        stats->num_level_diverged += session->stats.num_level_diverged;
+        stats->total_usec += session->stats.total_usec;
+        if (session->stats.max_usec > stats->max_usec) {
+            stats->max_usec = session->stats.max_usec;
+        }
+        if (session->stats.usec > stats->usec) {
+            stats->usec = session->stats.usec;
+        }
+        for (k = 0; k < CPARSER_REPLAY_NUM_BUCKETS; k++) {
+            stats->buckets[k] += session->stats.buckets[k];
+        }
+    }
+    for (n = 0; n < num_sessions; n++) {
+        cparser_mem_free(NULL, sessions[n].log, sessions[n].log_size);
+        sessions[n].log = NULL;
+    }
+    return rc;
+}
+
+uint64_t
+cparser_replay_percentile (const cparser_replay_stats_t *stats,
+                           double percent)
+{
+    uint64_t target, count = 0;
+    int k;
+
+    if (!stats || !stats->num_cmds) {
+        return 0;
+    }
+    target = (uint64_t)((percent * stats->num_cmds) / 100.0);
+    if (target < 1) {
+        target = 1;
+    } else if (target > stats->num_cmds) {
+        target = stats->num_cmds;
+    }
+    for (k = 0; k < CPARSER_REPLAY_NUM_BUCKETS; k++) {
+        count += stats->buckets[k];
+        if (count >= target) {
+            break;
+        }
+    }
+    assert(CPARSER_REPLAY_NUM_BUCKETS > k);
+    return cparser_replay_bucket_max(k);
+}
+
+void
+cparser_replay_report (const cparser_replay_stats_t *stats, FILE *fp)
+{
+    double sec;
+
+    assert(stats && fp);
+    sec = (stats->usec ? stats->usec / 1e6 : 1e-6);
+    fprintf(fp, "commands  %llu in %.3f s, %.0f commands/s\n",
+            (unsigned long long)stats->num_cmds, sec, stats->num_cmds / sec);
+    fprintf(fp, "latency   avg %llu, p50 %llu, p90 %llu, p99 %llu, "
+            "p99.9 %llu, max %llu usec\n",
+            (unsigned long long)(stats->num_cmds ? 
+                                 stats->total_usec / stats->num_cmds : 0),
+            (unsigned long long)cparser_replay_percentile(stats, 50.0),
+            (unsigned long long)cparser_replay_percentile(stats, 90.0),
+            (unsigned long long)cparser_replay_percentile(stats, 99.0),
+            (unsigned long long)cparser_replay_percentile(stats, 99.9),
+            (unsigned long long)stats->max_usec);
+    fprintf(fp, "diverged  %llu results, %llu sub-mode levels\n",
+            (unsigned long long)stats->num_rc_diverged,
+            (unsigned long long)stats->num_level_diverged);
+}
@@ -0,0 +1,371 @@
+/**
+ * \file     cparser_ring.c
+ * \brief    Bounded output buffers of sessions.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <time.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_ring.h"
+
+/** Number of bytes of the marker */
+#define CPARSER_RING_MARKER_LEN    (sizeof(CPARSER_RING_MARKER) - 1)
+
+/**
+ * \brief    Get the room for output in a ring. The lock must be held.
+ * \details  With CPARSER_RING_DROP, room for the marker is kept.
+ *
+ * \param    ring Pointer to the ring.
+ *
+ * \return   Number of bytes.
+ */
+static size_t
+cparser_ring_room (const cparser_ring_t *ring)
+{
+    size_t reserved = ((CPARSER_RING_DROP == ring->policy) ? 
+                       CPARSER_RING_MARKER_LEN : 0);
+
+    if ((ring->len + reserved) >= ring->size) {
+        return 0;
+    }
+    return ring->size - reserved - ring->len;
+}
+
+/**
+ * \brief    Copy bytes to the end of a ring. The lock must be held.
+ *
+ * \param    ring Pointer to the ring.
+ * \param    s    Bytes to copy.
+ * \param    len  Number of bytes. They must fit.
+ */
+static void
+cparser_ring_copy (cparser_ring_t *ring, const char *s, size_t len)
+{
+    size_t tail = (ring->head + ring->len) % ring->size, n;
+
+    assert((ring->len + len) <= ring->size);
+    n = ring->size - tail;
+    if (n > len) {
+        n = len;
+    }
+    memcpy(ring->buf + tail, s, n);
+    memcpy(ring->buf, s + n, len - n);
+    ring->len += len;
+}
+
+/**
+ * \brief    Write the oldest bytes of a ring with one writev().
+ *
+ * \param    ring Pointer to the ring.
+ *
+ * \return   Number of bytes written; 0 if the ring is empty; -1 if 
+ *           writev() fails.
+ */
+static ssize_t
+cparser_ring_write (cparser_ring_t *ring)
+{
+    struct iovec iov[2];
+    ssize_t wsize;
+    int num_iov = 0;
+
+    /* Only the owner removes bytes, so they stay while being written */
+    pthread_mutex_lock(&ring->lock);
+    if (ring->len) {
+        iov[0].iov_base = ring->buf + ring->head;
+        iov[0].iov_len = ring->size - ring->head;
+        if (iov[0].iov_len >= ring->len) {
+            iov[0].iov_len = ring->len;
+            num_iov = 1;
+        } else {
+            iov[1].iov_base = ring->buf;
+            iov[1].iov_len = ring->len - iov[0].iov_len;
+            num_iov = 2;
+        }
+    }
+    pthread_mutex_unlock(&ring->lock);
+    if (!num_iov) {
+        return 0;
+    }
+
+    wsize = writev(ring->fd, iov, num_iov);
+    if (0 < wsize) {
+        pthread_mutex_lock(&ring->lock);
+        ring->head = (ring->head + wsize) % ring->size;
+        ring->len -= wsize;
+        pthread_cond_broadcast(&ring->cond);
+        pthread_mutex_unlock(&ring->lock);
+    }
+    return wsize;
+}
+
+/**
+ * \brief    Get the time left until a deadline.
+ *
+ * \param    deadline Deadline on CLOCK_MONOTONIC.
+ *
+ * \return   Number of milliseconds; 0 if the deadline has passed.
+ */
+static int
+cparser_ring_msec_left (const struct timespec *deadline)
+{
+    struct timespec now;
+    int64_t msec;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    msec = ((int64_t)(deadline->tv_sec - now.tv_sec) * 1000 + 
+            (deadline->tv_nsec - now.tv_nsec) / 1000000);
+    return ((0 < msec) ? (int)msec : 0);
+}
+
+/**
+ * \brief    Write a ring until some bytes are written, waiting for the
+ *           file descriptor until a deadline. The session is 
+ *           disconnected if nothing can be written by then.
+ *
+ * \param    ring     Pointer to the ring.
+ * \param    deadline Deadline on CLOCK_MONOTONIC.
+ */
+static void
+cparser_ring_flush (cparser_ring_t *ring, const struct timespec *deadline)
+{
+    struct pollfd pfd;
+    ssize_t wsize;
+    int msec;
+
+    while (1) {
+        wsize = cparser_ring_write(ring);
+        if (0 <= wsize) {
+            return;
+        }
+        if ((EAGAIN != errno) && (EWOULDBLOCK != errno) && 
+            (EINTR != errno)) {
+            break;
+        }
+        msec = cparser_ring_msec_left(deadline);
+        if (!msec) {
+            break;
+        }
+        pfd.fd = ring->fd;
+        pfd.events = POLLOUT;
+        (void)poll(&pfd, 1, msec);
+    }
+
+    pthread_mutex_lock(&ring->lock);
+    ring->disconnected = 1;
+    pthread_cond_broadcast(&ring->cond);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+/**
+ * \brief    Append output to a ring. The policy of the ring decides 
+ *           what happens if it does not fit.
+ *
+ * \param    ring Pointer to the ring.
+ * \param    s    Output bytes.
+ * \param    len  Number of bytes.
+ */
+static void
+cparser_ring_put (cparser_ring_t *ring, const char *s, size_t len)
+{
+    struct timespec deadline;
+    int waiting = 0;
+    size_t n;
+
+    pthread_mutex_lock(&ring->lock);
+    while (len && !ring->disconnected) {
+        n = cparser_ring_room(ring);
+        if (n) {
+            if (n > len) {
+                n = len;
+            }
+            cparser_ring_copy(ring, s, n);
+            ring->dropping = 0;
+            s += n;
+            len -= n;
+            continue;
+        }
+
+        /* The ring is full */
+        switch (ring->policy) {
+            case CPARSER_RING_BLOCK:
+                if (!waiting) {
+                    waiting = 1;
+                    clock_gettime(CLOCK_MONOTONIC, &deadline);
+                    deadline.tv_sec += ring->block_msec / 1000;
+                    deadline.tv_nsec += (ring->block_msec % 1000) * 1000000L;
+                    if (1000000000L <= deadline.tv_nsec) {
+                        deadline.tv_sec++;
+                        deadline.tv_nsec -= 1000000000L;
+                    }
+                }
+                if (pthread_equal(pthread_self(), ring->owner)) {
+                    /* The owner cannot wait for itself */
+                    pthread_mutex_unlock(&ring->lock);
+                    cparser_ring_flush(ring, &deadline);
+                    pthread_mutex_lock(&ring->lock);
+                } else if ((ETIMEDOUT == 
+                            pthread_cond_timedwait(&ring->cond, &ring->lock,
+                                                   &deadline)) &&
+                           !cparser_ring_room(ring)) {
+                    ring->disconnected = 1;
+                    pthread_cond_broadcast(&ring->cond);
+                }
+                break;
+            case CPARSER_RING_DROP:
+                if (!ring->dropping) {
+                    /* The marker uses the reserved room */
+                    cparser_ring_copy(ring, CPARSER_RING_MARKER, 
+                                      CPARSER_RING_MARKER_LEN);
+                    ring->dropping = 1;
+                }
+                ring->num_dropped += len;
+                len = 0;
+                break;
+            default:
+                ring->disconnected = 1;
+                pthread_cond_broadcast(&ring->cond);
+                break;
+        }
+    }
+    ring->num_dropped += len;
+    pthread_mutex_unlock(&ring->lock);
+}
+
+static void
+cparser_ring_printc (const cparser_t *parser, const char ch)
+{
+    if (!parser->quiet) {
+        cparser_ring_put(parser->ring, &ch, 1);
+    }
+}
+
+static void
+cparser_ring_prints (const cparser_t *parser, const char *s)
+{
+    if (s && !parser->quiet) {
+        cparser_ring_put(parser->ring, s, strlen(s));
+    }
+}
+
+cparser_result_t
+cparser_ring_init (cparser_ring_t *ring, int fd, size_t size,
+                   cparser_ring_policy_t policy, 
+                   const cparser_alloc_t *alloc)
+{
+    pthread_condattr_t attr;
+
+    if (!ring || (0 > fd) || (CPARSER_RING_MAX_POLICIES <= policy) ||
+        (size <= CPARSER_RING_MARKER_LEN)) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    memset(ring, 0, sizeof(*ring));
+    ring->buf = cparser_mem_alloc(alloc, size);
+    if (!ring->buf) {
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    ring->alloc = alloc;
+    ring->size = size;
+    ring->fd = fd;
+    ring->policy = policy;
+    ring->owner = pthread_self();
+    ring->block_msec = CPARSER_RING_BLOCK_MSEC;
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&ring->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_ring_fini (cparser_ring_t *ring)
+{
+    if (!ring || !ring->buf) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    pthread_cond_destroy(&ring->cond);
+    pthread_mutex_destroy(&ring->lock);
+    cparser_mem_free(ring->alloc, ring->buf, ring->size);
+    ring->buf = NULL;
+    return CPARSER_OK;
+}
+
+void
+cparser_ring_config (cparser_t *parser, cparser_ring_t *ring)
+{
+    assert(VALID_PARSER(parser) && ring && !parser->ring);
+    parser->ring = ring;
+    parser->cfg.printc = cparser_ring_printc;
+    parser->cfg.prints = cparser_ring_prints;
+    parser->cfg.flags |= CPARSER_FLAGS_MT_OUTPUT;
+}
+
+cparser_result_t
+cparser_ring_drain (cparser_ring_t *ring)
+{
+    ssize_t wsize;
+
+    if (!ring || !ring->buf) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    do {
+        wsize = cparser_ring_write(ring);
+    } while (0 < wsize);
+    if ((0 > wsize) && (EAGAIN != errno) && (EWOULDBLOCK != errno) &&
+        (EINTR != errno)) {
+        pthread_mutex_lock(&ring->lock);
+        ring->disconnected = 1;
+        pthread_cond_broadcast(&ring->cond);
+        pthread_mutex_unlock(&ring->lock);
+    }
+
+    if (ring->disconnected) {
+        return CPARSER_NOT_OK;
+    }
+    return (cparser_ring_pending(ring) ? CPARSER_PENDING : CPARSER_OK);
+}
+
+size_t
+cparser_ring_pending (cparser_ring_t *ring)
+{
+    size_t len;
+
+    assert(ring);
+    pthread_mutex_lock(&ring->lock);
+    len = ring->len;
+    pthread_mutex_unlock(&ring->lock);
+    return len;
+}
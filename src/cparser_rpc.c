@@ -0,0 +1,631 @@
+/**
+ * \file     cparser_rpc.c
+ * \brief    Batch mode for automation clients.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_rpc.h"
+
+/** Initial size of the response buffer */
+#define CPARSER_RPC_OUT_SIZE       (256)
+
+/** Size of the header of a framed response */
+#define CPARSER_RPC_HDR_SIZE       (16)
+
+/**
+ * \brief    Get the time in microseconds.
+ */
+static uint64_t
+cparser_rpc_now (void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static uint32_t
+cparser_rpc_get32 (const char *buf)
+{
+    const unsigned char *p = (const unsigned char *)buf;
+
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | 
+        ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void
+cparser_rpc_put32 (char *buf, uint32_t val)
+{
+    buf[0] = (char)(val >> 24);
+    buf[1] = (char)(val >> 16);
+    buf[2] = (char)(val >> 8);
+    buf[3] = (char)val;
+}
+
+/**
+ * \brief    Append bytes to the response.
+ * \details  If the buffer cannot grow, the bytes are dropped.
+ *
+ * \param    rpc Pointer to the session.
+ * \param    s   The bytes.
+ * \param    len Number of bytes.
+ */
+static void
+cparser_rpc_out (cparser_rpc_t *rpc, const char *s, size_t len)
+{
+    size_t size;
+    char *out;
+
+    if ((rpc->out_len + len) > rpc->out_size) {
+        size = 2 * rpc->out_size;
+        if (size < (rpc->out_len + len)) {
+            size = rpc->out_len + len;
+        }
+        out = cparser_mem_alloc(rpc->alloc, size);
+        if (!out) {
+            return;
+        }
+        memcpy(out, rpc->out, rpc->out_len);
+        cparser_mem_free(rpc->alloc, rpc->out, rpc->out_size);
+        rpc->out = out;
+        rpc->out_size = size;
+    }
+    memcpy(rpc->out + rpc->out_len, s, len);
+    rpc->out_len += len;
+}
+
+/**
+ * \brief    Append output of an action to the response.
+ * \details  In a JSON response, the output is escaped as a string.
+ *
+ * \param    rpc Pointer to the session.
+ * \param    s   The output.
+ * \param    len Number of bytes.
+ */
+static void
+cparser_rpc_capture (cparser_rpc_t *rpc, const char *s, size_t len)
+{
+    char esc[8];
+    size_t n, k;
+
+    if (CPARSER_RPC_JSON != rpc->format) {
+        cparser_rpc_out(rpc, s, len);
+        return;
+    }
+    for (n = 0, k = 0; n < len; n++) {
+        if (('"' != s[n]) && ('\\' != s[n]) && 
+            ((unsigned char)s[n] >= ' ')) {
+            continue;
+        }
+        cparser_rpc_out(rpc, s + k, n - k);
+        k = n + 1;
+        switch (s[n]) {
+            case '\n':
+                cparser_rpc_out(rpc, "\\n", 2);
+                break;
+            case '\t':
+                cparser_rpc_out(rpc, "\\t", 2);
+                break;
+            case '"':
+            case '\\':
+                esc[0] = '\\';
+                esc[1] = s[n];
+                cparser_rpc_out(rpc, esc, 2);
+                break;
+            default:
+                snprintf(esc, sizeof(esc), "\\u%04x", (unsigned char)s[n]);
+                cparser_rpc_out(rpc, esc, 6);
+                break;
+        }
+    }
+    cparser_rpc_out(rpc, s + k, n - k);
+}
+
+static void
+cparser_rpc_printc (const cparser_t *parser, const char ch)
+{
+    if (!parser->quiet) {
+        cparser_rpc_capture(parser->rpc, &ch, 1);
+    }
+}
+
+static void
+cparser_rpc_prints (const cparser_t *parser, const char *s)
+{
+    if (s && !parser->quiet) {
+        cparser_rpc_capture(parser->rpc, s, strlen(s));
+    }
+}
+
+/**
+ * \brief    Executor of a session. 
+ * \details  The output is captured only while the action runs.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    glue   Glue function of the command.
+ *
+ * \return   Return code of the glue function or of the executor of the
+ *           parser.
+ */
+static cparser_result_t
+cparser_rpc_exec (cparser_t *parser, cparser_glue_fn glue)
+{
+    cparser_rpc_t *rpc = parser->rpc;
+    cparser_result_t rc;
+
+    parser->quiet = 0;
+    if (rpc->cfg.exec) {
+        rc = rpc->cfg.exec(parser, glue);
+    } else {
+        rc = glue(parser);
+    }
+    if (CPARSER_PENDING != rc) {
+        parser->quiet = 1;
+    }
+    return rc;
+}
+
+/**
+ * \brief    Start the response of a request.
+ *
+ * \param    rpc Pointer to the session.
+ */
+static void
+cparser_rpc_begin (cparser_rpc_t *rpc)
+{
+    rpc->start = cparser_rpc_now();
+    rpc->out_len = 0;
+    if (CPARSER_RPC_JSON == rpc->format) {
+        cparser_rpc_out(rpc, "{\"id\":", 6);
+        cparser_rpc_out(rpc, rpc->id, strlen(rpc->id));
+        cparser_rpc_out(rpc, ",\"output\":\"", 11);
+    } else {
+        rpc->out_len = CPARSER_RPC_HDR_SIZE;
+    }
+}
+
+/**
+ * \brief    Complete the response of a request and send it.
+ *
+ * \param    rpc Pointer to the session.
+ * \param    rc  Result of the request.
+ */
+static void
+cparser_rpc_end (cparser_rpc_t *rpc, cparser_result_t rc)
+{
+    uint64_t usec = cparser_rpc_now() - rpc->start;
+    char buf[64];
+    int n;
+
+    if (CPARSER_RPC_JSON == rpc->format) {
+        n = snprintf(buf, sizeof(buf), "\",\"rc\":%d,\"usec\":%llu}\n", rc,
+                     (unsigned long long)usec);
+        cparser_rpc_out(rpc, buf, n);
+    } else {
+        assert(CPARSER_RPC_HDR_SIZE <= rpc->out_size);
+        cparser_rpc_put32(rpc->out, rpc->out_len - 4);
+        cparser_rpc_put32(rpc->out + 4, rpc->frame_id);
+        cparser_rpc_put32(rpc->out + 8, (uint32_t)rc);
+        cparser_rpc_put32(rpc->out + 12, (uint32_t)usec);
+    }
+    rpc->num_requests++;
+    rpc->send(rpc->out, rpc->out_len, rpc->cookie);
+    rpc->out_len = 0;
+}
+
+/**
+ * \brief    Run the command line of a request.
+ *
+ * \param    rpc Pointer to the session.
+ * \param    len Length of the command line in 'cmd'.
+ */
+static void
+cparser_rpc_run (cparser_rpc_t *rpc, int len)
+{
+    cparser_t *parser = rpc->parser;
+    cparser_result_t rc;
+    int n;
+
+    if (len >= parser->cfg.max_line_size) {
+        cparser_rpc_end(rpc, CPARSER_ERR_OUT_OF_RES);
+        return;
+    }
+    for (n = 0; n < len; n++) {
+        if ((('\t' != rpc->cmd[n]) && ((unsigned char)rpc->cmd[n] < ' ')) ||
+            (127 == rpc->cmd[n])) {
+            cparser_rpc_end(rpc, CPARSER_ERR_INVALID_PARAMS);
+            return;
+        }
+    }
+    for (n = 0; n < len; n++) {
+        (void)cparser_input(parser, ('\t' == rpc->cmd[n]) ? ' ' : 
+                            rpc->cmd[n], CPARSER_CHAR_REGULAR);
+    }
+    rc = cparser_input(parser, '\n', CPARSER_CHAR_REGULAR);
+    if (CPARSER_PENDING == rc) {
+        rpc->pending = 1;
+        return;
+    }
+    cparser_rpc_end(rpc, rc);
+}
+
+/**
+ * \brief    Skip JSON whitespaces.
+ */
+static const char *
+cparser_rpc_json_ws (const char *s, const char *end)
+{
+    while ((s < end) && ((' ' == *s) || ('\t' == *s) || ('\r' == *s))) {
+        s++;
+    }
+    return s;
+}
+
+/**
+ * \brief    Parse a JSON string.
+ *
+ * \param    s    Pointer to the opening quote.
+ * \param    end  End of the line.
+ * \param    buf  Buffer of the decoded string. NULL to skip the string.
+ * \param    size Size of 'buf'.
+ *
+ * \retval   len  Length of the decoded string. -1 if it does not fit.
+ * \return   Pointer after the closing quote; NULL if the string is 
+ *           invalid.
+ */
+static const char *
+cparser_rpc_json_string (const char *s, const char *end, char *buf,
+                         int size, int *len)
+{
+    unsigned int code;
+    char ch;
+    int n = 0;
+
+    assert((s < end) && ('"' == *s));
+    for (s++; (s < end) && ('"' != *s); s++) {
+        ch = *s;
+        if ('\\' == ch) {
+            if (++s >= end) {
+                return NULL;
+            }
+            switch (*s) {
+                case 'n': ch = '\n'; break;
+                case 't': ch = '\t'; break;
+                case 'r': ch = '\r'; break;
+                case 'b': ch = '\b'; break;
+                case 'f': ch = '\f'; break;
+                case '"': case '\\': case '/': ch = *s; break;
+                case 'u':
+                    /* Only ASCII characters are supported */
+                    if (((end - s) < 5) || 
+                        (1 != sscanf(s + 1, "%4x", &code)) || 
+                        (0x80 <= code)) {
+                        return NULL;
+                    }
+                    ch = (char)code;
+                    s += 4;
+                    break;
+                default:
+                    return NULL;
+            }
+        }
+        if (buf && (0 <= n)) {
+            if ((n + 1) < size) {
+                buf[n++] = ch;
+            } else {
+                n = -1;
+            }
+        }
+    }
+    if (s >= end) {
+        return NULL;
+    }
+    if (buf && (0 <= n)) {
+        buf[n] = '\0';
+    }
+    *len = n;
+    return s + 1;
+}
+
+/**
+ * \brief    Run a JSON request.
+ *
+ * \param    rpc Pointer to the session.
+ * \param    s   The line of the request.
+ * \param    end End of the line.
+ */
+static void
+cparser_rpc_json (cparser_rpc_t *rpc, const char *s, const char *end)
+{
+    const char *value;
+    char key[8];
+    int len, cmd_len = -2;
+
+    strcpy(rpc->id, "null");
+    s = cparser_rpc_json_ws(s, end);
+    if ((s >= end) || ('{' != *s)) {
+        goto invalid;
+    }
+    s = cparser_rpc_json_ws(s + 1, end);
+    while ((s < end) && ('"' == *s)) {
+        s = cparser_rpc_json_string(s, end, key, sizeof(key), &len);
+        if (s) {
+            s = cparser_rpc_json_ws(s, end);
+        }
+        if (!s || (s >= end) || (':' != *s)) {
+            goto invalid;
+        }
+        value = s = cparser_rpc_json_ws(s + 1, end);
+        if ((s < end) && ('"' == *s)) {
+            s = cparser_rpc_json_string(s, end, 
+                                        ((0 <= len) && !strcmp(key, "cmd") ? 
+                                         rpc->cmd : NULL),
+                                        rpc->parser->cfg.max_line_size + 1,
+                                        &len);
+            if (!s) {
+                goto invalid;
+            }
+        } else {
+            /* A number, true, false or null */
+            while ((s < end) && strchr("-+.0123456789eEtruefalsn", *s)) {
+                s++;
+            }
+            if (s == value) {
+                goto invalid;
+            }
+        }
+        if (!strcmp(key, "cmd")) {
+            if ('"' != *value) {
+                goto invalid;
+            }
+            cmd_len = len;
+        } else if (!strcmp(key, "id")) {
+            if ((s - value) > CPARSER_RPC_MAX_ID) {
+                goto invalid;
+            }
+            memcpy(rpc->id, value, s - value);
+            rpc->id[s - value] = '\0';
+        }
+        s = cparser_rpc_json_ws(s, end);
+        if ((s < end) && (',' == *s)) {
+            s = cparser_rpc_json_ws(s + 1, end);
+        } else {
+            break;
+        }
+    }
+    if ((s >= end) || ('}' != *s) || 
+        (cparser_rpc_json_ws(s + 1, end) != end) || (-2 == cmd_len)) {
+        goto invalid;
+    }
+
+    cparser_rpc_begin(rpc);
+    if (-1 == cmd_len) {
+        cparser_rpc_end(rpc, CPARSER_ERR_OUT_OF_RES);
+        return;
+    }
+    cparser_rpc_run(rpc, cmd_len);
+    return;
+
+invalid:
+    cparser_rpc_begin(rpc);
+    cparser_rpc_end(rpc, CPARSER_ERR_INVALID_PARAMS);
+}
+
+/**
+ * \brief    Run all complete requests in the buffer until one is 
+ *           pending.
+ *
+ * \param    rpc Pointer to the session.
+ *
+ * \return   See cparser_rpc_input().
+ */
+static cparser_result_t
+cparser_rpc_process (cparser_rpc_t *rpc)
+{
+    size_t pos = 0, len;
+    const char *lf;
+    cparser_result_t rc = CPARSER_OK;
+
+    while (!rpc->pending && (pos < rpc->in_len)) {
+        if (CPARSER_RPC_JSON == rpc->format) {
+            lf = memchr(rpc->in + pos, '\n', rpc->in_len - pos);
+            if (!lf) {
+                break;
+            }
+            if (cparser_rpc_json_ws(rpc->in + pos, lf) != lf) {
+                cparser_rpc_json(rpc, rpc->in + pos, lf);
+            }
+            pos = lf + 1 - rpc->in;
+            continue;
+        }
+
+        if ((rpc->in_len - pos) < 4) {
+            break;
+        }
+        len = cparser_rpc_get32(rpc->in + pos);
+        if ((4 > len) || ((rpc->in_size - 4) < len)) {
+            rc = CPARSER_NOT_OK;
+            break;
+        }
+        if ((rpc->in_len - pos - 4) < len) {
+            break;
+        }
+        rpc->frame_id = cparser_rpc_get32(rpc->in + pos + 4);
+        len -= 4;
+        cparser_rpc_begin(rpc);
+        if (len >= (size_t)rpc->parser->cfg.max_line_size) {
+            cparser_rpc_end(rpc, CPARSER_ERR_OUT_OF_RES);
+        } else {
+            memcpy(rpc->cmd, rpc->in + pos + 8, len);
+            rpc->cmd[len] = '\0';
+            cparser_rpc_run(rpc, (int)len);
+        }
+        pos += 8 + len;
+    }
+
+    memmove(rpc->in, rpc->in + pos, rpc->in_len - pos);
+    rpc->in_len -= pos;
+    if ((CPARSER_OK == rc) && !rpc->pending && 
+        (rpc->in_len == rpc->in_size)) {
+        /* A request is longer than the buffer */
+        rc = CPARSER_NOT_OK;
+    }
+    if (CPARSER_OK != rc) {
+        rpc->in_len = 0;
+        return rc;
+    }
+    return (rpc->pending ? CPARSER_PENDING : CPARSER_OK);
+}
+
+cparser_result_t
+cparser_rpc_init (cparser_rpc_t *rpc, cparser_t *parser, 
+                  cparser_rpc_format_t format, size_t in_size,
+                  cparser_rpc_send_fn send, void *cookie,
+                  const cparser_alloc_t *alloc)
+{
+    if (!rpc || !VALID_PARSER(parser) || parser->rpc || 
+        (CPARSER_RPC_MAX_FORMATS <= format) || (8 > in_size) || !send) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    memset(rpc, 0, sizeof(*rpc));
+    rpc->in = cparser_mem_alloc(alloc, in_size);
+    rpc->cmd = cparser_mem_alloc(alloc, parser->cfg.max_line_size + 1);
+    rpc->out = cparser_mem_alloc(alloc, CPARSER_RPC_OUT_SIZE);
+    if (!rpc->in || !rpc->cmd || !rpc->out) {
+        cparser_mem_free(alloc, rpc->in, in_size);
+        cparser_mem_free(alloc, rpc->cmd, parser->cfg.max_line_size + 1);
+        cparser_mem_free(alloc, rpc->out, CPARSER_RPC_OUT_SIZE);
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    rpc->parser = parser;
+    rpc->format = format;
+    rpc->send = send;
+    rpc->cookie = cookie;
+    rpc->alloc = alloc;
+    rpc->cfg = parser->cfg;
+    rpc->in_size = in_size;
+    rpc->out_size = CPARSER_RPC_OUT_SIZE;
+
+    /* The output is captured only while an action runs */
+    parser->rpc = rpc;
+    parser->quiet = 1;
+    parser->cfg.printc = cparser_rpc_printc;
+    parser->cfg.prints = cparser_rpc_prints;
+    parser->cfg.exec = cparser_rpc_exec;
+    parser->cfg.ch_help = 0;
+    parser->cfg.ch_complete = 0;
+    parser->cfg.flags |= CPARSER_FLAGS_BATCH;
+    parser->cfg.flags &= ~CPARSER_FLAGS_MT_OUTPUT;
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_rpc_fini (cparser_rpc_t *rpc)
+{
+    if (!rpc || !rpc->parser) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    if (rpc->pending) {
+        return CPARSER_NOT_OK;
+    }
+    /* 
+     * Only restore what cparser_rpc_init() changed. The tree may have 
+     * moved to a newer version since.
+     */
+    rpc->parser->cfg.printc = rpc->cfg.printc;
+    rpc->parser->cfg.prints = rpc->cfg.prints;
+    rpc->parser->cfg.exec = rpc->cfg.exec;
+    rpc->parser->cfg.ch_help = rpc->cfg.ch_help;
+    rpc->parser->cfg.ch_complete = rpc->cfg.ch_complete;
+    rpc->parser->cfg.flags = rpc->cfg.flags;
+    rpc->parser->rpc = NULL;
+    rpc->parser->quiet = 0;
+    cparser_mem_free(rpc->alloc, rpc->in, rpc->in_size);
+    cparser_mem_free(rpc->alloc, rpc->cmd, rpc->cfg.max_line_size + 1);
+    cparser_mem_free(rpc->alloc, rpc->out, rpc->out_size);
+    rpc->parser = NULL;
+    return CPARSER_OK;
+}
+
+cparser_result_t
+cparser_rpc_input (cparser_rpc_t *rpc, const char *data, size_t len,
+                   size_t *used)
+{
+    cparser_result_t rc = CPARSER_OK;
+    size_t n;
+
+    if (!rpc || !rpc->parser || (!data && len) || !used) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    *used = 0;
+    while (*used < len) {
+        n = rpc->in_size - rpc->in_len;
+        if (n > (len - *used)) {
+            n = len - *used;
+        }
+        if (!n) {
+            break;
+        }
+        memcpy(rpc->in + rpc->in_len, data + *used, n);
+        rpc->in_len += n;
+        *used += n;
+        if (rpc->pending) {
+            continue;
+        }
+        rc = cparser_rpc_process(rpc);
+        if (CPARSER_NOT_OK == rc) {
+            return rc;
+        }
+    }
+    return (rpc->pending ? CPARSER_PENDING : CPARSER_OK);
+}
+
+cparser_result_t
+cparser_rpc_poll (cparser_rpc_t *rpc)
+{
+    if (!rpc || !rpc->parser) {
+        return CPARSER_ERR_INVALID_PARAMS;
+    }
+    if (!rpc->pending) {
+        return CPARSER_OK;
+    }
+    if (rpc->parser->pending) {
+        return CPARSER_PENDING;
+    }
+    rpc->pending = 0;
+    rpc->parser->quiet = 1;
+    cparser_rpc_end(rpc, rpc->parser->last_rc);
+    return cparser_rpc_process(rpc);
+}
@@ -84,15 +84,15 @@ cparser_match_keyword (const char *token, const int token_len,
 
     assert(token && node && (CPARSER_NODE_KEYWORD == node->type) && is_complete);
 
-    //kw_len = strnlen(node->param, CPARSER_MAX_TOKEN_SIZE);
-    kw_len = strlen(node->param);
+    //kw_len = strnlen(NODE_PARAM(node), CPARSER_MAX_TOKEN_SIZE);
+    kw_len = strlen(NODE_PARAM(node));
     if (token_len > kw_len) {
 	*is_complete = 0;
 	return CPARSER_NOT_OK;
     }
     match_len = (kw_len < token_len ? kw_len : token_len);
     
-    if (!strncmp(token, node->param, match_len)) {
+    if (!strncmp(token, NODE_PARAM(node), match_len)) {
 	*is_complete = (match_len == kw_len);
 	return CPARSER_OK;
     }
@@ -376,13 +376,13 @@ cparser_match_list (const char *token, const int token_len,
     unsigned int num_matches = 0;
     assert(token && node && (CPARSER_NODE_LIST == node->type) && is_complete);
     
-    lnode = (cparser_list_node_t *)node->param;
+    lnode = NODE_PARAM(node);
     assert(lnode);
     while (lnode) {
-        if (!strncmp(token, lnode->keyword, token_len)) {
+        if (!strncmp(token, LIST_NODE_KEYWORD(node, lnode), token_len)) {
             num_matches++;
         }
-        lnode = lnode->next;
+        lnode = LIST_NODE_NEXT(node, lnode);
     }
     *is_complete = (1 == num_matches ? 1 : 0);
 
@@ -402,7 +402,7 @@ cparser_complete_keyword (cparser_t *parser, const cparser_node_t *node,
     char *ch_ptr;
 
     assert(parser && node && token && (CPARSER_NODE_KEYWORD == node->type));
-    ch_ptr = node->param + token_len;
+    ch_ptr = (char *)NODE_PARAM(node) + token_len;
     while (*ch_ptr) {
         rc = cparser_input(parser, *ch_ptr, CPARSER_CHAR_REGULAR);
         assert(CPARSER_OK == rc);
@@ -449,24 +449,27 @@ cparser_result_t
 cparser_complete_list (cparser_t *parser, const cparser_node_t *node,
                        const char *token, const int token_len)
 {
-    cparser_list_node_t *lnode, *match_lnode = NULL;
+    cparser_list_node_t *lnode;
+    const char *keyword, *match_keyword = NULL;
     int match_len = -1, n;
     cparser_result_t rc = CPARSER_NOT_OK;
 
     assert(parser && node && token && (CPARSER_NODE_LIST == node->type) && token_len);
     /* Find the longest common suffix if it exists */
-    for (lnode = node->param; NULL != lnode; lnode = lnode->next) {
-        if (!strncmp(lnode->keyword, token, token_len)) {
+    for (lnode = NODE_PARAM(node); NULL != lnode;
+         lnode = LIST_NODE_NEXT(node, lnode)) {
+        keyword = LIST_NODE_KEYWORD(node, lnode);
+        if (!strncmp(keyword, token, token_len)) {
             /* Prefix matches. See what is the longest suffix */
             if (-1 == match_len) {
                 /* First match. Cover the whole thing */
-                match_len = strlen(lnode->keyword);
-                assert(!match_lnode);
-                match_lnode = lnode;
+                match_len = strlen(keyword);
+                assert(!match_keyword);
+                match_keyword = keyword;
             } else {
                 /* Second and after matches. Intersect with previous match */
                 for (n = token_len; n < match_len; n++) {
-                    if (lnode->keyword[n] != match_lnode->keyword[n]) {
+                    if (keyword[n] != match_keyword[n]) {
                         break;
                     }
                 }
@@ -477,9 +480,9 @@ cparser_complete_list (cparser_t *parser, const cparser_node_t *node,
 
     /* If a common prefix is found, input it */
     if (0 < match_len) {
-        assert(match_lnode);
+        assert(match_keyword);
         for (n = token_len; n < match_len; n++) {
-            rc = cparser_input(parser, match_lnode->keyword[n], CPARSER_CHAR_REGULAR);
+            rc = cparser_input(parser, match_keyword[n], CPARSER_CHAR_REGULAR);
             assert(CPARSER_OK == rc);
         }
         rc = CPARSER_OK;
@@ -861,14 +864,15 @@ cparser_get_list (const cparser_token_t *token, void *value)
      * simplify the logic, we return the string in the list node even
      * when the token contains the full keyword.
      */
-    for (lnode = (cparser_list_node_t *)token->node->param;
-         NULL != lnode; lnode = lnode->next) {
-        int clen = strlen(lnode->keyword);
+    for (lnode = NODE_PARAM(token->node); NULL != lnode;
+         lnode = LIST_NODE_NEXT(token->node, lnode)) {
+        const char *keyword = LIST_NODE_KEYWORD(token->node, lnode);
+        int clen = strlen(keyword);
         if (clen > token->token_len) {
             clen = token->token_len; /* min. of token and keyword length */
         }
-        if (!strncmp(token->buf, lnode->keyword, clen)) {
-            *ptr = (char *)lnode->keyword;
+        if (!strncmp(token->buf, keyword, clen)) {
+            *ptr = (char *)keyword;
             return CPARSER_OK;
         }
     }
@@ -876,3 +880,34 @@ cparser_get_list (const cparser_token_t *token, void *value)
     *ptr = NULL;
     return CPARSER_NOT_OK;
 }
+
+/*
+ * cparser_get_arg - Get a parameter into a field of an argument structure
+ *     generated by "mk_parser.py -a". Strings, file paths and list 
+ *     keywords are copied into the field.
+ */
+cparser_result_t
+cparser_get_arg (const cparser_token_t *token, const cparser_node_type_t type,
+                 void *value, const size_t size)
+{
+    char *str;
+    size_t len;
+    cparser_result_t rc;
+
+    assert(token && value && (CPARSER_NODE_KEYWORD < type) && 
+           (CPARSER_MAX_NODES > type));
+    if ((CPARSER_NODE_STRING != type) && (CPARSER_NODE_FILE != type) &&
+        (CPARSER_NODE_LIST != type)) {
+        return cparser_get_fn_tbl[type](token, value);
+    }
+    rc = cparser_get_fn_tbl[type](token, &str);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    len = strlen(str);
+    if (len >= size) {
+        return CPARSER_ERR_OUT_OF_RES;
+    }
+    memcpy(value, str, len + 1);
+    return CPARSER_OK;
+}
@@ -33,6 +33,10 @@
 #ifndef __CPARSER_TOKEN_H__
 #define __CPARSER_TOKEN_H__
 
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
 #define CPARSER_MAX_NODE_TYPES (16)
 
 /**
@@ -112,9 +116,10 @@ typedef cparser_result_t (*cparser_complete_fn)(cparser_t *parser,
 typedef cparser_result_t (*cparser_get_fn)(const cparser_token_t *token,
                                            void *val);
 
-extern cparser_match_fn    cparser_match_fn_tbl[CPARSER_MAX_NODE_TYPES];
-extern cparser_complete_fn cparser_complete_fn_tbl[CPARSER_MAX_NODE_TYPES];
-extern cparser_get_fn      cparser_get_fn_tbl[CPARSER_MAX_NODE_TYPES];
+extern const cparser_match_fn    cparser_match_fn_tbl[CPARSER_MAX_NODE_TYPES];
+extern const cparser_complete_fn cparser_complete_fn_tbl[CPARSER_MAX_NODE_TYPES];
+extern const cparser_get_fn      cparser_get_fn_tbl[CPARSER_MAX_NODE_TYPES];
+extern const char * const        cparser_type_name_tbl[CPARSER_MAX_NODE_TYPES];
 
 /********** Token match functions **********/
 cparser_result_t cparser_match_root(const char *token, const int token_len,
@@ -170,4 +175,25 @@ cparser_result_t cparser_get_ipv4addr(const cparser_token_t *token, void *value)
 cparser_result_t cparser_get_file(const cparser_token_t *token, void *value);
 cparser_result_t cparser_get_list(const cparser_token_t *token, void *value);
 
+/**
+ * \brief    Get a parameter into a field of an argument structure.
+ * \details  This is used by glue functions generated by "mk_parser.py -a".
+ *
+ * \param    token Pointer to the token.
+ * \param    type  Node type of the parameter.
+ * \param    size  Size of the field. Strings, file paths and list 
+ *                 keywords are copied into the field.
+ *
+ * \retval   value The field.
+ * \return   CPARSER_OK if succeeded; CPARSER_ERR_OUT_OF_RES if a string 
+ *           does not fit; CPARSER_NOT_OK otherwise.
+ */
+cparser_result_t cparser_get_arg(const cparser_token_t *token, 
+                                 const cparser_node_type_t type,
+                                 void *value, const size_t size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
 #endif /* __CPARSER_MATCH_H__ */
@@ -42,7 +42,7 @@
  *           contains a function pointer of a match function that checks
  *           if a token conforms to a certain node type.
  */
-cparser_match_fn cparser_match_fn_tbl[CPARSER_MAX_NODE_TYPES] = {
+const cparser_match_fn cparser_match_fn_tbl[CPARSER_MAX_NODE_TYPES] = {
     cparser_match_root,
     cparser_match_end,
     cparser_match_keyword, 
@@ -66,7 +66,7 @@ cparser_match_fn cparser_match_fn_tbl[CPARSER_MAX_NODE_TYPES] = {
  *           contains a function pointer of a completion function that
  *           attempts to complete a token given its node type.
  */
-cparser_complete_fn cparser_complete_fn_tbl[CPARSER_MAX_NODE_TYPES] = {
+const cparser_complete_fn cparser_complete_fn_tbl[CPARSER_MAX_NODE_TYPES] = {
     NULL,
     NULL,
     cparser_complete_keyword,
@@ -84,7 +84,7 @@ cparser_complete_fn cparser_complete_fn_tbl[CPARSER_MAX_NODE_TYPES] = {
     cparser_complete_list
 };
 
-cparser_get_fn cparser_get_fn_tbl[CPARSER_MAX_NODE_TYPES] = {
+const cparser_get_fn cparser_get_fn_tbl[CPARSER_MAX_NODE_TYPES] = {
     NULL,
     NULL,
     NULL, 
@@ -101,3 +101,27 @@ cparser_get_fn cparser_get_fn_tbl[CPARSER_MAX_NODE_TYPES] = {
     cparser_get_file,
     cparser_get_list
 };
+
+/**
+ * \brief    A table of token type names.
+ * \details  This array is indexed by CLI Parser node type. Each element
+ *           is the name used for the type in .cli files (e.g. "UINT" in 
+ *           "<UINT:id>").
+ */
+const char * const cparser_type_name_tbl[CPARSER_MAX_NODE_TYPES] = {
+    "ROOT",
+    "END",
+    "KEYWORD",
+    "STRING",
+    "UINT",
+    "UINT64",
+    "INT",
+    "INT64",
+    "HEX",
+    "HEX64",
+    "FLOAT",
+    "MACADDR",
+    "IPV4ADDR",
+    "FILE",
+    "LIST"
+};
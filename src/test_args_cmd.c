@@ -0,0 +1,70 @@
+/**
+ * \file     test_args_cmd.c
+ * \brief    Action functions of the test tree built with argument 
+ *           structures (mk_parser.py -a).
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "cparser.h"
+#include "args/cparser_tree.h"
+
+extern char *output_ptr;
+
+/**
+ * Handle "args name <STRING:name> { <UINT:reports> }".
+ */
+cparser_result_t
+cparser_cmd_args_name_name_reports (cparser_context_t *context,
+    const cparser_args_args_name_name_reports_t *args)
+{
+    assert(context && args);
+    if (args->has.reports) {
+        output_ptr += sprintf(output_ptr, "name %s reports %u\n", args->name,
+                              args->reports);
+    } else {
+        output_ptr += sprintf(output_ptr, "name %s\n", args->name);
+    }
+    return CPARSER_OK;
+}
+
+/**
+ * Handle "args pc <IPV4ADDR:ipv4> <LIST:on,off:state>".
+ */
+cparser_result_t
+cparser_cmd_args_pc_ipv4_state (cparser_context_t *context,
+    const cparser_args_args_pc_ipv4_state_t *args)
+{
+    assert(context && args);
+    output_ptr += sprintf(output_ptr, "pc %08x %s\n", args->ipv4, 
+                          args->state);
+    return CPARSER_OK;
+}
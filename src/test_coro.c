@@ -0,0 +1,274 @@
+/**
+ * \file     test_coro.c
+ * \brief    Test program for coroutine actions.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_image.h"
+#include "cparser_coro.h"
+#include "test_util.h"
+#ifdef CPARSER_CORO_ASM
+#include <xmmintrin.h>
+#endif
+
+/**
+ * \brief    A session with its own coroutine and output buffer.
+ */
+typedef struct test_session_ {
+    cparser_t       parser;
+    cparser_coro_t  coro;
+    char            output[1000];
+    char            *output_ptr;
+} test_session_t;
+
+static test_session_t *
+test_session (const cparser_t *parser)
+{
+    return (test_session_t *)parser->context.cookie[0];
+}
+
+/**
+ * Output functions of the sessions. Each one has its own buffer.
+ */
+static void
+session_printc (const cparser_t *parser, const char ch)
+{
+    test_session_t *session = test_session(parser);
+
+    session->output_ptr += sprintf(session->output_ptr, "%c", ch);
+}
+
+static void
+session_prints (const cparser_t *parser, const char *s)
+{
+    test_session_t *session = test_session(parser);
+
+    session->output_ptr += sprintf(session->output_ptr, "%s", s);
+}
+
+/**
+ * Glue function of "login <STRING:user>". It asks for a password and a
+ * confirmation as blocking code would.
+ */
+static cparser_result_t
+test_login_glue (cparser_t *parser)
+{
+    char *user = NULL, passwd[16], answer[8];
+    int tries;
+
+    (void)cparser_get_string(&parser->tokens[1], &user);
+    for (tries = 0; tries < 2; tries++) {
+        if (CPARSER_OK != cparser_prompt(parser, "Password: ", 0, passwd,
+                                         sizeof(passwd))) {
+            return CPARSER_NOT_OK;
+        }
+        if (!strcmp(passwd, "secret")) {
+            break;
+        }
+        parser->cfg.prints(parser, "Wrong password\n");
+    }
+    if (2 == tries) {
+        return CPARSER_OK;
+    }
+    if (CPARSER_OK != cparser_prompt(parser, "Sure? ", 1, answer,
+                                     sizeof(answer))) {
+        return CPARSER_NOT_OK;
+    }
+    parser->cfg.prints(parser, user);
+    parser->cfg.prints(parser, ('y' == answer[0]) ? " logged in\n" : 
+                       " cancelled\n");
+    return CPARSER_OK;
+}
+
+/**
+ * Glue function of "loop <UINT:n>". It reads n lines.
+ */
+static cparser_result_t
+test_loop_glue (cparser_t *parser)
+{
+    uint32_t n = 0;
+    char buf[4];
+
+    (void)cparser_get_uint(&parser->tokens[1], &n);
+    while (n--) {
+        (void)cparser_prompt(parser, NULL, 0, buf, sizeof(buf));
+    }
+    return CPARSER_OK;
+}
+
+#ifdef CPARSER_CORO_ASM
+/**
+ * Glue function of "round". It changes the rounding mode of SSE and 
+ * checks that the mode survives a prompt.
+ */
+static cparser_result_t
+test_round_glue (cparser_t *parser)
+{
+    unsigned int csr = _mm_getcsr();
+    char buf[4];
+
+    _mm_setcsr((csr & ~_MM_ROUND_MASK) | _MM_ROUND_UP);
+    (void)cparser_prompt(parser, NULL, 0, buf, sizeof(buf));
+    parser->cfg.prints(parser, (_MM_ROUND_UP == _MM_GET_ROUNDING_MODE()) ?
+                       "up\n" : "lost\n");
+    _mm_setcsr(csr);
+    return CPARSER_OK;
+}
+#endif /* CPARSER_CORO_ASM */
+
+/**
+ * Start a session
+ */
+static cparser_result_t
+start_session (test_session_t *session, cparser_cfg_t *cfg)
+{
+    cparser_result_t rc;
+
+    memset(session, 0, sizeof(*session));
+    session->output_ptr = session->output;
+    rc = cparser_coro_init(&session->coro, 0, NULL);
+    if (CPARSER_OK == rc) {
+        cfg->exec_cookie = &session->coro;
+        rc = cparser_init(cfg, &session->parser);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_set_root_context(&session->parser, session);
+    }
+    return rc;
+}
+
+int
+main (int argc, char *argv[])
+{
+    static test_session_t sessions[2];
+    test_session_t *a = &sessions[0], *b = &sessions[1];
+    cparser_tree_t tree;
+    cparser_cfg_t cfg;
+    char buf[8];
+    int n, num_loops = 1000000;
+    cparser_result_t rc;
+
+    test_cfg_init(&cfg, &tree, "S> ");
+    cfg.printc = session_printc;
+    cfg.prints = session_prints;
+    cfg.exec = cparser_coro_exec;
+
+    rc = cparser_tree_init(&tree, NULL, NULL);
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&tree, "login <STRING:user>", test_login_glue, 
+                              NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&tree, "loop <UINT:n>", test_loop_glue, NULL);
+    }
+#ifdef CPARSER_CORO_ASM
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&tree, "round", test_round_glue, NULL);
+    }
+#endif
+    for (n = 0; (CPARSER_OK == rc) && (n < 2); n++) {
+        rc = start_session(&sessions[n], &cfg);
+    }
+    if (CPARSER_OK != rc) {
+        printf("Fail to initialize the test (%d).\n", rc);
+        return -1;
+    }
+
+    /* Test two sessions waiting for input in one thread */
+    feed_parser(&a->parser, "login alice\n");
+    feed_parser(&b->parser, "login bob\n");
+    feed_parser(&a->parser, "guess\n");
+    feed_parser(&b->parser, "secret\n");
+    feed_parser(&a->parser, "secret\n");
+    feed_parser(&b->parser, "n\n");
+    feed_parser(&a->parser, "yes\n");
+    update_result(a->output, "login alice \n"
+                  "Password: \n"
+                  "Wrong password\n"
+                  "Password: \n"
+                  "Sure? yes\n"
+                  "alice logged in\n"
+                  "S> ", "session a");
+    update_result(b->output, "login bob \n"
+                  "Password: \n"
+                  "Sure? n\n"
+                  "bob cancelled\n"
+                  "S> ", "session b");
+
+    /* 
+     * Test an aborted prompt and a prompt outside of a coroutine. The
+     * command is completed by the input after the abort.
+     */
+    a->output_ptr = a->output;
+    feed_parser(&a->parser, "login carol\nsec");
+    n = cparser_abort_user_input(&a->parser);
+    feed_parser(&a->parser, "x\n");
+    a->output_ptr += sprintf(a->output_ptr, "|%d|%d|%d|", n,
+                             cparser_prompt(&a->parser, NULL, 1, buf,
+                                            sizeof(buf)),
+                             cparser_coro_fini(&a->coro));
+    update_result(a->output, "login carol \n"
+                  "Password: \n"
+                  "Wrong password\n"
+                  "Password: \n"
+                  "Wrong password\n"
+                  "S> |0|2|0|", "aborted prompt");
+
+    /* Test many round trips from the parser to the action and back */
+    b->output_ptr = b->output;
+    feed_parser(&b->parser, "loop 1000000\n");
+    for (n = 0; n < num_loops; n++) {
+        cparser_input(&b->parser, '\n', CPARSER_CHAR_REGULAR);
+        b->output_ptr = b->output;
+    }
+    update_result(b->output, "\nS> ", "loop");
+
+#ifdef CPARSER_CORO_ASM
+    /* Test that the SSE control state is switched with the stack */
+    b->output_ptr = b->output;
+    feed_parser(&b->parser, "round\n");
+    b->output_ptr += sprintf(b->output_ptr, "|%d|",
+                             _MM_ROUND_NEAREST == _MM_GET_ROUNDING_MODE());
+    feed_parser(&b->parser, "\n");
+    update_result(b->output, "round \n|1|\nup\nS> ", "fp control");
+#endif
+
+    for (n = 0; n < 2; n++) {
+        cparser_fini(&sessions[n].parser);
+    }
+    (void)cparser_coro_fini(&b->coro);
+    cparser_tree_fini(&tree);
+    return test_report();
+}
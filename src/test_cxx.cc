@@ -0,0 +1,195 @@
+/**
+ * \file     test_cxx.cc
+ * \brief    Test program for the C++ front end.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "cparser.hpp"
+#include "test_util.h"
+
+/* Commands are checked at compile time */
+static_assert(3 == cparser::detail::scan("a <UINT:x> { <STRING:s> "
+                                         "{ <LIST:on,off:st> } }", 0).num_params,
+              "parameters");
+static_assert(cparser::detail::scan("a <UINT:x> { b <HEX:y> }", 1).param.optional &&
+              (3 == cparser::detail::scan("a <UINT:x> { b <HEX:y> }", 1).param.token),
+              "optional parameter");
+static_assert(-1 == cparser::detail::scan("a <UINTX:x>", 0).num_params,
+              "unknown type");
+static_assert(-1 == cparser::detail::scan("a { <UINT:x>", 0).num_params,
+              "unbalanced braces");
+
+static constexpr char show_port[] =
+    "show port <UINT:id> { <STRING:name> { <IPV4ADDR:addr> } }";
+static constexpr char set_port[] =
+    "set port <INT64:id> <LIST:up,down:state> <FLOAT:weight> <MACADDR:mac>";
+static constexpr char clear_port[] = "+clear port { <HEX64:mask> }";
+static constexpr char count_ports[] = "count ports";
+static constexpr char add_neighbor[] = "add neighbor <UINT64:as>";
+
+static cparser_result_t
+show_port_fn (cparser_context_t *context, uint32_t id,
+              std::optional<const char *> name,
+              const std::optional<uint32_t> &addr)
+{
+    output_ptr += sprintf(output_ptr, "port %u", id);
+    if (name) {
+        output_ptr += sprintf(output_ptr, " %s", *name);
+    }
+    if (addr) {
+        output_ptr += sprintf(output_ptr, " %08x", *addr);
+    }
+    output_ptr += sprintf(output_ptr, "\n");
+    return CPARSER_OK;
+}
+
+static cparser_result_t
+set_port_fn (cparser_context_t *context, int64_t id, const char *state,
+             double weight, const cparser_macaddr_t &mac) noexcept
+{
+    output_ptr += sprintf(output_ptr, "set %lld %s %.2f %02x:%02x\n",
+                          (long long)id, state, weight, mac.octet[0],
+                          mac.octet[5]);
+    return CPARSER_OK;
+}
+
+static constexpr auto clear_port_fn =
+    [](cparser_context_t *context, std::optional<uint64_t> mask) {
+        output_ptr += sprintf(output_ptr, "clear %llx\n",
+                              (unsigned long long)mask.value_or(0));
+        return CPARSER_OK;
+    };
+
+/**
+ * Port table. Its commands are bound to the object.
+ */
+class port_table {
+public:
+    int num_ports = 4;
+
+    cparser_result_t
+    count (cparser_context_t *context) const
+    {
+        output_ptr += sprintf(output_ptr, "%d ports\n", num_ports);
+        return CPARSER_OK;
+    }
+};
+
+static port_table ports;
+
+static cparser_result_t
+add_neighbor_fn (cparser_context_t *context, uint64_t as)
+{
+    output_ptr += sprintf(output_ptr, "neighbor %llu\n",
+                          (unsigned long long)as);
+    return CPARSER_OK;
+}
+
+static cparser::command<show_port, show_port_fn> show_port_cmd("Show a port");
+static cparser::command<set_port, set_port_fn> set_port_cmd;
+static cparser::command<clear_port, +clear_port_fn> clear_port_cmd;
+static cparser::command<count_ports, &port_table::count>
+    count_ports_cmd(&ports, "Count the ports");
+
+int
+main (int argc, char *argv[])
+{
+    cparser_t parser;
+    cparser_cfg_t cfg;
+    cparser_tree_t tree;
+    cparser_result_t rc;
+
+    test_cfg_init(&cfg, &tree, "TEST>> ");
+    rc = cparser_tree_init(&tree, NULL, NULL);
+    if (CPARSER_OK == rc) {
+        rc = cparser::add_commands(&tree);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_init(&cfg, &parser);
+    }
+    if (CPARSER_OK != rc) {
+        printf("Fail to initialize parser (%d).\n", rc);
+        return -1;
+    }
+    /* Test required and optional parameters */
+    BZERO_OUTPUT;
+    feed_parser(&parser, "show port 3\n");
+    feed_parser(&parser, "show port 3 eth0\n");
+    feed_parser(&parser, "show port 3 eth0 10.1.2.3\n");
+    update_result(output, "show port 3 \nport 3\n"
+                  "TEST>> show port 3 eth0 \nport 3 eth0\n"
+                  "TEST>> show port 3 eth0 10.1.2.3 \nport 3 eth0 0a010203\n"
+                  "TEST>> ", "optional parameters");
+
+    /* Test all other parameter types */
+    BZERO_OUTPUT;
+    feed_parser(&parser, "set port -5 down 0.25 00:11:22:33:44:55\n");
+    cparser_set_privileged_mode(&parser, 1);
+    feed_parser(&parser, "clear port\n");
+    feed_parser(&parser, "clear port 0xfedcba9876543210\n");
+    cparser_set_privileged_mode(&parser, 0);
+    update_result(output, "set port -5 down 0.25 00:11:22:33:44:55 \n"
+                  "set -5 down 0.25 00:55\n"
+                  "TEST>> clear port \nclear 0\n"
+                  "+TEST>> clear port 0xfedcba9876543210 \n"
+                  "clear fedcba9876543210\n"
+                  "+TEST>> ", "parameter types");
+
+    /* Test a member function bound to an object */
+    BZERO_OUTPUT;
+    ports.num_ports = 7;
+    feed_parser(&parser, "count ports\n");
+    cparser_help_cmd(&parser, (char *)"count");
+    update_result(output, "count ports \n7 ports\n"
+                  "TEST>> Count the ports\r\n"
+                  "  count ports \r\n"
+                  "\n", "member function");
+
+    /* Test a glue function given to cparser_tree_add() */
+    BZERO_OUTPUT;
+    output_ptr += sprintf(output_ptr, "%d|",
+        cparser_tree_add(&tree, add_neighbor,
+                         cparser::glue<add_neighbor, add_neighbor_fn>::fn,
+                         NULL));
+    feed_parser(&parser, "add neighbor 4200000000\n");
+    output_ptr += sprintf(output_ptr, "|%d|",
+                          cparser_tree_remove(&tree, add_neighbor));
+    feed_parser(&parser, "add neighbor 1\n");
+    update_result(output, "0|add neighbor 4200000000 \n"
+                  "neighbor 4200000000\n"
+                  "TEST>> |0|add neighbor 1\n"
+                  "       ^Parse error\n"
+                  "TEST>> ", "glue function");
+
+    cparser_fini(&parser);
+    cparser_tree_fini(&tree);
+    return test_report();
+}
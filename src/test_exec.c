@@ -0,0 +1,269 @@
+/**
+ * \file     test_exec.c
+ * \brief    Test program for the executor.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_image.h"
+#include "cparser_exec.h"
+#include "test_util.h"
+
+#define TEST_NUM_SESSIONS  (8)
+
+/**
+ * \brief    A session with its own output buffer.
+ */
+typedef struct test_session_ {
+    cparser_t  parser;
+    int        id;
+    char       output[1000];
+    char       *output_ptr;
+} test_session_t;
+
+static pthread_mutex_t num_notified_lock = PTHREAD_MUTEX_INITIALIZER;
+static int num_notified = 0;
+
+static test_session_t *
+test_session (const cparser_t *parser)
+{
+    return (test_session_t *)parser->context.cookie[0];
+}
+
+/**
+ * A CPU-heavy computation
+ */
+static uint64_t
+test_sum (uint32_t n)
+{
+    uint64_t sum = 0;
+    uint32_t k;
+
+    for (k = 0; k < n; k++) {
+        sum = (sum + ((uint64_t)k * k)) % 1000003;
+    }
+    return sum;
+}
+
+/**
+ * Glue function of "sum <UINT:n>". The output comes in two parts.
+ */
+static cparser_result_t
+test_sum_glue (cparser_t *parser)
+{
+    uint32_t n = 0;
+    char buf[64];
+
+    (void)cparser_get_uint(&parser->tokens[1], &n);
+    snprintf(buf, sizeof(buf), "sum %u", n);
+    parser->cfg.prints(parser, buf);
+    snprintf(buf, sizeof(buf), " = %llu", (unsigned long long)test_sum(n));
+    parser->cfg.prints(parser, buf);
+    parser->cfg.printc(parser, '\n');
+    return CPARSER_OK;
+}
+
+/**
+ * Glue function of "who". It prints the session of the root context.
+ */
+static cparser_result_t
+test_who_glue (cparser_t *parser)
+{
+    char buf[32];
+
+    snprintf(buf, sizeof(buf), "session %d\n", 
+             test_session(parser)->id);
+    parser->cfg.prints(parser, buf);
+    return CPARSER_OK;
+}
+
+/**
+ * Output functions of the sessions. Each one has its own buffer.
+ */
+static void
+session_printc (const cparser_t *parser, const char ch)
+{
+    test_session_t *session = test_session(parser);
+
+    session->output_ptr += sprintf(session->output_ptr, "%c", ch);
+}
+
+static void
+session_prints (const cparser_t *parser, const char *s)
+{
+    test_session_t *session = test_session(parser);
+
+    session->output_ptr += sprintf(session->output_ptr, "%s", s);
+}
+
+static void
+test_notify (cparser_t *parser, void *cookie)
+{
+    pthread_mutex_lock(&num_notified_lock);
+    num_notified++;
+    pthread_mutex_unlock(&num_notified_lock);
+}
+
+/**
+ * Poll all sessions until no command is pending
+ */
+static void
+poll_sessions (test_session_t *sessions, int num_sessions)
+{
+    int n, num_pending;
+
+    do {
+        num_pending = 0;
+        for (n = 0; n < num_sessions; n++) {
+            (void)cparser_exec_poll(&sessions[n].parser);
+            if (sessions[n].parser.pending) {
+                /* The job is running or a queued command is submitted */
+                num_pending++;
+            }
+        }
+        if (num_pending) {
+            usleep(100);
+        }
+    } while (num_pending);
+}
+
+/**
+ * Start a session
+ */
+static cparser_result_t
+start_session (test_session_t *session, int id, cparser_cfg_t *cfg)
+{
+    cparser_result_t rc;
+
+    memset(session, 0, sizeof(*session));
+    session->id = id;
+    session->output_ptr = session->output;
+    rc = cparser_init(cfg, &session->parser);
+    if (CPARSER_OK == rc) {
+        rc = cparser_set_root_context(&session->parser, session);
+    }
+    return rc;
+}
+
+int
+main (int argc, char *argv[])
+{
+    static test_session_t sessions[TEST_NUM_SESSIONS];
+    cparser_tree_t tree;
+    cparser_exec_t exec, small;
+    cparser_cfg_t cfg;
+    char expected[1000], got[64];
+    int n, m;
+    cparser_result_t rc;
+
+    test_cfg_init(&cfg, &tree, "S> ");
+    cfg.printc = session_printc;
+    cfg.prints = session_prints;
+    cfg.exec = cparser_exec_submit;
+    cfg.exec_cookie = &exec;
+
+    rc = cparser_tree_init(&tree, NULL, NULL);
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&tree, "sum <UINT:n>", test_sum_glue, NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&tree, "who", test_who_glue, NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_exec_init(&exec, 4, TEST_NUM_SESSIONS, test_notify, 
+                               NULL, NULL);
+    }
+    for (n = 0; (CPARSER_OK == rc) && (n < TEST_NUM_SESSIONS); n++) {
+        rc = start_session(&sessions[n], n, &cfg);
+    }
+    if (CPARSER_OK != rc) {
+        printf("Fail to initialize the test (%d).\n", rc);
+        return -1;
+    }
+
+    /* 
+     * Test sessions running in parallel. The commands of each session 
+     * run in order and the input after them is queued.
+     */
+    for (n = 0; n < TEST_NUM_SESSIONS; n++) {
+        feed_parser(&sessions[n].parser, "sum 2000000\nwho\nsum 3\n");
+    }
+    poll_sessions(sessions, TEST_NUM_SESSIONS);
+    for (n = 0; n < TEST_NUM_SESSIONS; n++) {
+        snprintf(expected, sizeof(expected), 
+                 "sum 2000000 \nsum 2000000 = %llu\n"
+                 "S> who \nsession %d\n"
+                 "S> sum 3 \nsum 3 = 5\n"
+                 "S> ", (unsigned long long)test_sum(2000000), n);
+        snprintf(got, sizeof(got), "session %d", n);
+        update_result(sessions[n].output, expected, got);
+    }
+    n = (0 < num_notified);
+    update_result(n ? "notified" : "-", "notified", "notification");
+
+    /* 
+     * Test a full executor. A command that does not fit fails. The 
+     * executor cannot stop before the job is polled.
+     */
+    rc = cparser_exec_init(&small, 1, 1, NULL, NULL, NULL);
+    for (n = 0; (CPARSER_OK == rc) && (n < 2); n++) {
+        cparser_fini(&sessions[n].parser);
+        cfg.exec_cookie = &small;
+        rc = start_session(&sessions[n], n, &cfg);
+    }
+    if (CPARSER_OK == rc) {
+        feed_parser(&sessions[0].parser, "sum 100\n");
+        feed_parser(&sessions[1].parser, "who\n");
+        m = cparser_exec_fini(&small);
+        poll_sessions(sessions, 2);
+        n = snprintf(expected, sizeof(expected), "%d|%d|", m, 
+                     cparser_exec_poll(&sessions[0].parser));
+        snprintf(expected + n, sizeof(expected) - n, "%d", 
+                 cparser_exec_fini(&small));
+        update_result(expected, "1|3|0", "fini");
+        update_result(sessions[0].output, "sum 100 \nsum 100 = 328350\nS> ",
+                      "full executor 0");
+        update_result(sessions[1].output, "who \n"
+                      "Too many commands are running\n"
+                      "S> ", "full executor 1");
+    }
+
+    for (n = 0; n < TEST_NUM_SESSIONS; n++) {
+        cparser_fini(&sessions[n].parser);
+    }
+    cparser_exec_fini(&exec);
+    cparser_tree_fini(&tree);
+    return test_report();
+}
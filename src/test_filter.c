@@ -0,0 +1,250 @@
+/**
+ * \file     test_filter.c
+ * \brief    Test program of the output filters.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "test_util.h"
+
+static cparser_async_t test_async;
+
+/** Levels of the log lines */
+static const char *test_levels[] = { "error", "info", "debug" };
+
+/**
+ * Glue function of "show log <UINT:n>". It prints n log lines.
+ */
+static cparser_result_t
+test_log_glue (cparser_t *parser)
+{
+    uint32_t n = 0, k;
+    char buf[64];
+
+    (void)cparser_get_uint(&parser->tokens[2], &n);
+    for (k = 0; k < n; k++) {
+        snprintf(buf, sizeof(buf), "%u %s: event %u\n", k, 
+                 test_levels[k % 3], k * 7);
+        parser->cfg.prints(parser, buf);
+    }
+    return CPARSER_OK;
+}
+
+/**
+ * Glue function of "show wide". A long line is printed in pieces.
+ */
+static cparser_result_t
+test_wide_glue (cparser_t *parser)
+{
+    int n;
+
+    parser->cfg.prints(parser, "short one\n");
+    for (n = 0; n < 700; n++) {
+        parser->cfg.printc(parser, (0 == n) ? 'w' : 'x');
+    }
+    parser->cfg.prints(parser, "\nshort two\nno newline");
+    return CPARSER_OK;
+}
+
+/**
+ * Glue function of "show later". It completes asynchronously.
+ */
+static cparser_result_t
+test_later_glue (cparser_t *parser)
+{
+    parser->cfg.prints(parser, "first line\n");
+    if (CPARSER_OK != cparser_async_handle(&parser->context, &test_async)) {
+        return CPARSER_NOT_OK;
+    }
+    return CPARSER_PENDING;
+}
+
+int
+main (int argc, char *argv[])
+{
+    cparser_t parser, plain;
+    cparser_tree_t tree;
+    cparser_cfg_t cfg;
+    int n;
+    cparser_result_t rc;
+
+    test_cfg_init(&cfg, &tree, "T> ");
+    cfg.flags = CPARSER_FLAGS_FILTER;
+
+    rc = cparser_tree_init(&tree, NULL, NULL);
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&tree, "show log <UINT:n>", test_log_glue, 
+                              NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&tree, "show wide", test_wide_glue, NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&tree, "show later", test_later_glue, NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_init(&cfg, &parser);
+    }
+    if (CPARSER_OK != rc) {
+        printf("Fail to initialize the test (%d).\n", rc);
+        return -1;
+    }
+
+    /* Test plain string patterns */
+    BZERO_OUTPUT;
+    feed_parser(&parser, "show log 7 | include error\n");
+    feed_parser(&parser, "sh log 7 | ex debug\n");
+    update_result(output, "show log 7 | include error\n"
+                  "0 error: event 0\n"
+                  "3 error: event 21\n"
+                  "6 error: event 42\n"
+                  "T> sh log 7 | ex debug\n"
+                  "0 error: event 0\n"
+                  "1 info: event 7\n"
+                  "3 error: event 21\n"
+                  "4 info: event 28\n"
+                  "6 error: event 42\n"
+                  "T> ", "plain patterns");
+
+    /* Test regular expressions and a chain of filters */
+    BZERO_OUTPUT;
+    feed_parser(&parser, "show log 9 | i (error|info): event [0-9]$\n");
+    feed_parser(&parser, "show log 9 | begin ^4 | exclude info | count\n");
+    feed_parser(&parser, "show log 4 | b 7\n");
+    update_result(output, "show log 9 | i (error|info): event [0-9]$\n"
+                  "0 error: event 0\n"
+                  "1 info: event 7\n"
+                  "T> show log 9 | begin ^4 | exclude info | count\n"
+                  "Count: 3 lines\n"
+                  "T> show log 4 | b 7\n"
+                  "1 info: event 7\n"
+                  "2 debug: event 14\n"
+                  "3 error: event 21\n"
+                  "T> ", "regular expressions");
+
+    /* Test invalid filters */
+    BZERO_OUTPUT;
+    feed_parser(&parser, "show log 3 | grep x\n");
+    feed_parser(&parser, "show log 3 | count | include x\n");
+    feed_parser(&parser, "show log 3 | include \n");
+    feed_parser(&parser, "show log 3 | include a[\n");
+    feed_parser(&parser, "show log 3 | count x\n");
+    feed_parser(&parser, "show | count\n");
+    update_result(output, "show log 3 | grep x\n"
+                  "Invalid output filter\n"
+                  "T> show log 3 | count | include x\n"
+                  "Invalid output filter\n"
+                  "T> show log 3 | include \n"
+                  "Invalid output filter\n"
+                  "T> show log 3 | include a[\n"
+                  "Invalid output filter\n"
+                  "T> show log 3 | count x\n"
+                  "Invalid output filter\n"
+                  "T> show | count\n"
+                  "        ^Incomplete command\n"
+                  "T> ", "invalid filters");
+
+    /* Test long lines and output without LF at the end */
+    BZERO_OUTPUT;
+    feed_parser(&parser, "show wide | include w\n");
+    feed_parser(&parser, "show wide | exclude w\n");
+    feed_parser(&parser, "show wide | count\n");
+    n = strlen("show wide | include w\nw");
+    output_ptr += sprintf(output_ptr, "|%d|", 
+                          (int)strspn(output + n, "x"));
+    update_result(output + n + 699, "\n"
+                  "short two\n"
+                  "no newlineT> show wide | exclude w\n"
+                  "short one\n"
+                  "T> show wide | count\n"
+                  "Count: 4 lines\n"
+                  "T> |699|", "long lines");
+
+    /* 
+     * Test erasing the '|', help, recalling a filtered command and
+     * a filter that is not a token
+     */
+    BZERO_OUTPUT;
+    feed_parser(&parser, "show log 2 |\b\n");
+    feed_parser(&parser, "show log 2 | i ?");
+    feed_parser(&parser, "nfo\n");
+    cparser_input(&parser, 0, CPARSER_CHAR_UP_ARROW);
+    feed_parser(&parser, "\n");
+    feed_parser(&parser, "show log 2|x\n");
+    update_result(output, "show log 2 |\b \b\n"
+                  "0 error: event 0\n"
+                  "1 info: event 7\n"
+                  "T> show log 2 | i \n"
+                  "include <pattern> - Lines that match\n"
+                  "exclude <pattern> - Lines that do not match\n"
+                  "begin <pattern> - Lines from the first match\n"
+                  "count - Count the lines\n"
+                  "T> show log 2 | i nfo\n"
+                  "1 info: event 7\n"
+                  "T> show log 2 | i nfo\n"
+                  "1 info: event 7\n"
+                  "T> show log 2|x\n"
+                  "             ^Parse error\n"
+                  "T> ", "editing");
+
+    /* 
+     * Test a pending command. Its output is filtered until it 
+     * completes. The input in the meantime is not filtered.
+     */
+    BZERO_OUTPUT;
+    feed_parser(&parser, "show later | exclude first\nshow log 1\n");
+    parser.cfg.prints(&parser, "second line\nlast line\n");
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_complete_async(&test_async, CPARSER_OK));
+    update_result(output, "show later | exclude first\n"
+                  "second line\n"
+                  "last line\n"
+                  "T> show log 1 \n"
+                  "0 error: event 0\n"
+                  "T> 0|", "pending command");
+
+    /* Test a parser without filters */
+    BZERO_OUTPUT;
+    cfg.flags = 0;
+    if (CPARSER_OK == cparser_init(&cfg, &plain)) {
+        feed_parser(&plain, "show log 2 | count\n");
+        cparser_fini(&plain);
+    }
+    update_result(output, "show log 2 | count\n"
+                  "              ^Parse error\n"
+                  "T> ", "no filters");
+
+    cparser_fini(&parser);
+    cparser_tree_fini(&tree);
+    return test_report();
+}
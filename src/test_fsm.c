@@ -116,65 +116,84 @@ test_input (cparser_t *parser, const char *input)
     return 1;
 }
 
-int
-test_state_transition (const char *input, const cparser_state_t final_state,
+/**
+ * Feed a test string into an initialized parser and check the resulting
+ * parser FSM state. See test_state_transition() for the parameters.
+ *
+ * \return   1 if succeeded; 0 if failed.
+ */
+static int
+test_check_transition (cparser_t *parser, const char *input,
+                       const cparser_state_t final_state,
                        const short token_tos, const cparser_token_t *tokens,
                        const short current_pos, const short last_good)
 {
-    cparser_t parser;
     int n;
 
-    test_init_parser(&parser);
-
-    if (CPARSER_STATE_WHITESPACE != parser.state) {
+    if (CPARSER_STATE_WHITESPACE != parser->state) {
         return 0;
     }
-    if (!test_input(&parser, input)) {
+    if (!test_input(parser, input)) {
         return 0;
     }
-    if (final_state != parser.state) {
+    if (final_state != parser->state) {
         printf("ERROR: Unexpected state. (expected:%d  got:%d)\n",
-               final_state, parser.state);
+               final_state, parser->state);
         return 0;
     }
     /* Check against expected token stack */
-    if (token_tos != parser.token_tos) {
+    if (token_tos != parser->token_tos) {
         printf("ERROR: Unexpected token stack size. (expected:%d  got:%d)\n",
-               token_tos, parser.token_tos);
+               token_tos, parser->token_tos);
         return 0;
     }
     for (n = 0; n <= token_tos; n++) {
-        if (tokens[n].token_len != parser.tokens[n].token_len) {
+        if (tokens[n].token_len != parser->tokens[n].token_len) {
             printf("ERROR: Token %d length mismatch.\n", n);
             return 0;
         }
-        if (tokens[n].begin_ptr != parser.tokens[n].begin_ptr) {
+        if (tokens[n].begin_ptr != parser->tokens[n].begin_ptr) {
             printf("ERROR: Token %d begin pointer mismatch.\n", n);
             return 0;
         }
-        if (tokens[n].parent != parser.tokens[n].parent) {
+        if (tokens[n].parent != parser->tokens[n].parent) {
             printf("ERROR: Token %d parent pointer mismatch.\n", n);
             return 0;
         }
         if (tokens[n].token_len &&
-            strcmp(tokens[n].buf, parser.tokens[n].buf)) {
+            strcmp(tokens[n].buf, parser->tokens[n].buf)) {
             printf("ERROR: Token %d buffer mismatch.\n", n);
             return 0;
         }
     }
-    if (current_pos != parser.current_pos) {
+    if (current_pos != parser->current_pos) {
         printf("ERROR: Current position is incorrect (expect:%d  got:%d).\n",
-               current_pos, parser.current_pos);
+               current_pos, parser->current_pos);
         return 0;
     }
-    if (last_good != parser.last_good) {
+    if (last_good != parser->last_good) {
         printf("ERROR: Last good position is incorrect (expect:%d  got:%d).\n",
-               last_good, parser.last_good);
+               last_good, parser->last_good);
         return 0;
     }
     return 1;
 }
 
+int
+test_state_transition (const char *input, const cparser_state_t final_state,
+                       const short token_tos, const cparser_token_t *tokens,
+                       const short current_pos, const short last_good)
+{
+    cparser_t parser;
+    int passed;
+
+    test_init_parser(&parser);
+    passed = test_check_transition(&parser, input, final_state, token_tos,
+                                   tokens, current_pos, last_good);
+    cparser_fini(&parser);
+    return passed;
+}
+
 /**
  * Get a SPACE in WHITESPACE state. We should end in WHITESPACE and
  * the token stack should be completely empty.
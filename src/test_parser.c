@@ -33,6 +33,8 @@
  */
 
 #include <assert.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
@@ -40,7 +42,9 @@
 #include "cparser.h"
 #include "cparser_priv.h"
 #include "cparser_token.h"
+#include "cparser_image.h"
 #include "cparser_tree.h"
+#include "cparser_check.h"
 
 /** Zeroize a data structure */
 #define BZERO_OUTPUT memset(output, 0, sizeof(output)); output_ptr = output
@@ -48,6 +52,24 @@
 extern char output[2000], *output_ptr;
 extern int interactive;
 int num_passed = 0, num_failed =0;
+int num_trees_freed = 0;
+
+/** The parse tree of test.cli generated by "mk_parser.py -p" */
+extern cparser_tree_t test_packed_tree;
+/** The parse tree of test_args.cli generated by "mk_parser.py -a" */
+extern cparser_node_t test_args_root;
+
+/** Commands that are run with both the C tree and the binary image */
+static const char *image_cmds[] = {
+    "sh\temp\ts a\t\n",
+    "show employee 0x1 w\t\n",
+    "show employee 0x1 ?\n",
+    "show employees-by-id 0x0 0x1\n",
+    "help roster\n",
+    "employee 0x1\nh?\t70\nexit\n",
+    "show xyz\n",
+    NULL
+};
 
 /**
  * Feed a string into the parser (skipping line buffering)
@@ -101,6 +123,280 @@ test_prints (const cparser_t *parser, const char *s)
     output_ptr += sprintf(output_ptr, "%s", s);
 }
 
+/**
+ * Print all history entries from the newest to the oldest separated by '|'
+ */
+static void
+print_history (const cparser_history_t *hist)
+{
+    uint32_t id = CPARSER_HISTORY_NONE;
+
+    while (CPARSER_OK == cparser_history_prev(hist, id, &id)) {
+        output_ptr += sprintf(output_ptr, "%s|", cparser_history_get(hist, id));
+    }
+}
+
+/**
+ * Print the history entry that matches a search string
+ */
+static void
+print_search (const cparser_history_t *hist, const char *str)
+{
+    uint32_t id;
+
+    if (CPARSER_OK == cparser_history_search(hist, str, CPARSER_HISTORY_NONE,
+                                             &id)) {
+        output_ptr += sprintf(output_ptr, "%s|", cparser_history_get(hist, id));
+    } else {
+        output_ptr += sprintf(output_ptr, "-|");
+    }
+}
+
+/**
+ * Glue function of the commands added at run time
+ */
+static cparser_result_t
+test_neighbor_glue (cparser_t *parser)
+{
+    uint32_t peer = 0;
+
+    (void)cparser_get_ipv4addr(&parser->tokens[3], &peer);
+    output_ptr += sprintf(output_ptr, "neighbor %08x\n", peer);
+    return CPARSER_OK;
+}
+
+/** Handle of the pending table dump */
+static cparser_async_t test_async;
+
+/**
+ * Glue function of a table dump that completes asynchronously
+ */
+static cparser_result_t
+test_dump_glue (cparser_t *parser)
+{
+    uint32_t id = 0;
+
+    (void)cparser_get_uint(&parser->tokens[2], &id);
+    output_ptr += sprintf(output_ptr, "dump %u\n", id);
+    if (CPARSER_OK != cparser_async_handle(&parser->context, &test_async)) {
+        return CPARSER_NOT_OK;
+    }
+    return CPARSER_PENDING;
+}
+
+/**
+ * Free a tree published in a tree handle
+ */
+static void
+test_tree_free (cparser_tree_t *tree)
+{
+    cparser_tree_fini(tree);
+    num_trees_freed++;
+}
+
+/** Number of threads parsing while trees are published */
+#define TEST_SWAP_THREADS (4)
+/** Number of trees published while the threads parse */
+#define TEST_SWAP_TREES   (200)
+/** Number of commands entered by each thread */
+#define TEST_SWAP_CMDS    (2000)
+
+/**
+ * A tree published while parsers in other threads use the handle
+ */
+typedef struct test_swap_tree_ {
+    cparser_tree_t tree;
+    int            freed;
+} test_swap_tree_t;
+
+static test_swap_tree_t swap_trees[TEST_SWAP_TREES];
+static cparser_t swap_parsers[TEST_SWAP_THREADS];
+static int num_swap_freed, num_swap_stale;
+
+/**
+ * Free a tree published while threads parse. It may run in any thread.
+ */
+static void
+test_swap_free (cparser_tree_t *tree)
+{
+    cparser_tree_fini(tree);
+    __atomic_store_n(&((test_swap_tree_t *)tree)->freed, 1, 
+                     __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&num_swap_freed, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Glue function of the command run by the threads. It counts commands
+ * run on a tree that has been freed.
+ */
+static cparser_result_t
+test_swap_glue (cparser_t *parser)
+{
+    const test_swap_tree_t *tree = (const test_swap_tree_t *)parser->cfg.tree;
+
+    if (__atomic_load_n(&tree->freed, __ATOMIC_SEQ_CST)) {
+        __atomic_add_fetch(&num_swap_stale, 1, __ATOMIC_SEQ_CST);
+    }
+    (*(int *)parser->context.cookie[0])++;
+    return CPARSER_OK;
+}
+
+static void
+test_swap_printc (const cparser_t *parser, const char ch)
+{
+}
+
+static void
+test_swap_prints (const cparser_t *parser, const char *s)
+{
+}
+
+static void *
+test_swap_thread (void *arg)
+{
+    cparser_t *parser = (cparser_t *)arg;
+    const char *ch;
+    int n;
+
+    for (n = 0; n < TEST_SWAP_CMDS; n++) {
+        for (ch = "show bgp neighbor 10.1.2.3\n"; *ch; ch++) {
+            (void)cparser_input(parser, *ch, CPARSER_CHAR_REGULAR);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * \brief    Publish trees in a handle while threads parse with it.
+ *
+ * \param    cfg  Configuration of the parsers. It is not changed.
+ * \param    base The tree every published tree is built on.
+ *
+ * \return   CPARSER_OK if the test ran; the first error otherwise.
+ */
+static cparser_result_t
+test_tree_swap (const cparser_cfg_t *cfg, cparser_tree_t *base)
+{
+    cparser_tree_handle_t handle;
+    pthread_t threads[TEST_SWAP_THREADS];
+    int counts[TEST_SWAP_THREADS], n, num_cmds = 0;
+    cparser_result_t rc = CPARSER_OK;
+
+    for (n = 0; (CPARSER_OK == rc) && (n < TEST_SWAP_TREES); n++) {
+        rc = cparser_tree_init(&swap_trees[n].tree, base, NULL);
+        if (CPARSER_OK == rc) {
+            rc = cparser_tree_add(&swap_trees[n].tree, 
+                                  "show bgp neighbor <IPV4ADDR:peer>",
+                                  test_swap_glue, NULL);
+        }
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_handle_init(&handle, &swap_trees[0].tree, 
+                                      test_swap_free, NULL);
+    }
+    for (n = 0; (CPARSER_OK == rc) && (n < TEST_SWAP_THREADS); n++) {
+        memset(&swap_parsers[n], 0, sizeof(swap_parsers[n]));
+        swap_parsers[n].cfg = *cfg;
+        swap_parsers[n].cfg.handle = &handle;
+        swap_parsers[n].cfg.printc = test_swap_printc;
+        swap_parsers[n].cfg.prints = test_swap_prints;
+        rc = cparser_init(&swap_parsers[n].cfg, &swap_parsers[n]);
+        if (CPARSER_OK == rc) {
+            counts[n] = 0;
+            rc = cparser_set_root_context(&swap_parsers[n], &counts[n]);
+        }
+    }
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+
+    for (n = 0; n < TEST_SWAP_THREADS; n++) {
+        pthread_create(&threads[n], NULL, test_swap_thread, &swap_parsers[n]);
+    }
+    for (n = 1; n < TEST_SWAP_TREES; n++) {
+        (void)cparser_tree_publish(&handle, &swap_trees[n].tree, 
+                                   test_swap_free);
+        sched_yield();
+    }
+    for (n = 0; n < TEST_SWAP_THREADS; n++) {
+        pthread_join(threads[n], NULL);
+        num_cmds += counts[n];
+        cparser_fini(&swap_parsers[n]);
+    }
+    output_ptr += sprintf(output_ptr, "%d|%d|%d|", 
+                          (TEST_SWAP_THREADS * TEST_SWAP_CMDS == num_cmds),
+                          num_swap_stale, num_swap_freed);
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_tree_handle_fini(&handle));
+    output_ptr += sprintf(output_ptr, "%d", num_swap_freed);
+    return CPARSER_OK;
+}
+
+/**
+ * Open a copy of a tree image with one node broken and its checksum
+ * updated, so only the walk of the nodes can reject it.
+ *
+ * \param    path    Path of the image.
+ * \param    end_id  1 to give the first END node an out-of-range 
+ *                   command ID; 0 to point the children of the root 
+ *                   outside the image.
+ *
+ * \return   Result of cparser_tree_open().
+ */
+static cparser_result_t
+test_broken_image (const char *path, int end_id)
+{
+    static char buf[16384];
+    char bad_path[64];
+    cparser_tree_hdr_t *hdr = (cparser_tree_hdr_t *)buf;
+    cparser_node_t *node;
+    cparser_tree_t tree;
+    cparser_result_t rc;
+    uint32_t hash = 2166136261u, n;
+    FILE *fp;
+
+    fp = fopen(path, "rb");
+    if (!fp) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+    n = fread(buf, 1, sizeof(buf), fp);
+    fclose(fp);
+    if ((sizeof(*hdr) > n) || (hdr->size != n)) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+
+    /* The nodes follow the header in pre-order, from the root */
+    node = (cparser_node_t *)(buf + hdr->root);
+    if (end_id) {
+        while (CPARSER_NODE_END != node->type) {
+            node++;
+        }
+        node->param = (void *)(intptr_t)hdr->num_cmds;
+    } else {
+        node->children = (cparser_node_t *)(intptr_t)hdr->size;
+    }
+    for (n = sizeof(*hdr); n < hdr->size; n++) {
+        hash = (hash ^ (uint8_t)buf[n]) * 16777619u;
+    }
+    hdr->checksum = hash;
+
+    snprintf(bad_path, sizeof(bad_path), "/tmp/test_parser.%d.bin", 
+             (int)getpid());
+    fp = fopen(bad_path, "wb");
+    if (!fp) {
+        return CPARSER_ERR_NOT_EXIST;
+    }
+    fwrite(buf, 1, hdr->size, fp);
+    fclose(fp);
+    rc = cparser_tree_open(&tree, bad_path, cparser_glue_tbl, 
+                           CPARSER_NUM_GLUE);
+    if (CPARSER_OK == rc) {
+        cparser_tree_close(&tree);
+    }
+    unlink(bad_path);
+    return rc;
+}
+
 /**
  * \brief    Entry point of the program.
  *
@@ -112,14 +408,22 @@ test_prints (const cparser_t *parser, const char *s)
 int
 main (int argc, char *argv[])
 {
-    cparser_t parser;
-    char *config_file = NULL;
+    cparser_t parser, small, image;
+    cparser_history_t history, shared;
+    cparser_arena_t arena;
+    cparser_tree_t tree, base, dyn;
+    cparser_tree_handle_t handle;
+    static char arena_buf[8192], expected[sizeof(output)];
+    char *config_file = NULL, *history_file = NULL, *cmd, hist_path[64];
+    char tree_path[256], dyn_cmd[32];
+    uint32_t num_nodes;
     int ch, debug = 0, n;
+    FILE *fp;
     cparser_result_t rc;
 
     memset(&parser, 0, sizeof(parser));
 
-    while (-1 != (ch = getopt(argc, argv, "pic:d"))) {
+    while (-1 != (ch = getopt(argc, argv, "pic:h:d"))) {
         switch (ch) {
             case 'p':
                 printf("pid = %d\n", getpid());
@@ -130,6 +434,9 @@ main (int argc, char *argv[])
             case 'c':
                 config_file = optarg;
                 break;
+            case 'h':
+                history_file = optarg;
+                break;
             case 'd':
                 debug = 1;
                 break;
@@ -156,10 +463,20 @@ main (int argc, char *argv[])
         return -1;
     }
     if (interactive) {
+        if (history_file) {
+            if (CPARSER_OK != cparser_history_open(&history, history_file, 0, NULL)) {
+                printf("Fail to open history file %s.\n", history_file);
+                return -1;
+            }
+            parser.cfg.history = &history;
+        }
         if (config_file) {
             (void)cparser_load_cmd(&parser, config_file);
         }
         cparser_run(&parser);
+        if (parser.cfg.history) {
+            cparser_history_close(parser.cfg.history);
+        }
     } else {
         /* Run the scripted tests */
         /* Test command execution without trailing space */
@@ -329,6 +646,12 @@ main (int argc, char *argv[])
         update_result(output, "s\nshow\nsave\nTEST>> s",
                       "context-sensitive help #2");
 
+        /* Complete up to the longest common prefix */
+        feed_parser(&parser, "\n");
+        BZERO_OUTPUT;
+        feed_parser(&parser, "show emp\t");
+        update_result(output, "show employee", "context-sensitive help #3");
+
         /* Test incomplete commands */
         feed_parser(&parser, "\n"); /* flush out the last incomplete command */
         BZERO_OUTPUT;
@@ -389,9 +712,729 @@ main (int argc, char *argv[])
                       "TEST>> ",
                       "help summary #2");
 
+        /*
+         * Test line editing in the middle of a line. Each inserted
+         * character should only cost a constant number of output bytes.
+         */
+        BZERO_OUTPUT;
+        feed_parser(&parser, "sh employees");
+        for (n = 0; n < 10; n++) {
+            cparser_input(&parser, 0, CPARSER_CHAR_LEFT_ARROW);
+        }
+        feed_parser(&parser, "ow\n");
+        update_result(output, "sh employees\b\b\b\b\b\b\b\b\b\b"
+                      "\033[@o\033[@w employees \n"
+                      "0x00000001 bob\n0x00000003 john\nTEST>> ",
+                      "mid-line insert");
+        BZERO_OUTPUT;
+        rc = cparser_last_command(&parser, &cmd, NULL, NULL);
+        update_result(cmd, "show employees ", "mid-line insert history");
+
+        /*
+         * Test command recall. The parser state of a partial line is
+         * restored when the line is displayed again.
+         */
+        BZERO_OUTPUT;
+        feed_parser(&parser, "show emp");
+        cparser_input(&parser, 0, CPARSER_CHAR_UP_ARROW);
+        cparser_input(&parser, 0, CPARSER_CHAR_DOWN_ARROW);
+        feed_parser(&parser, "loyees\n");
+        update_result(output, "show employees \033[7D\033[Kloyees \n"
+                      "0x00000001 bob\n0x00000003 john\nTEST>> ",
+                      "partial line recall");
+
+        /*
+         * Test jumping to both ends of a line. After the first token is 
+         * edited, the rest of the line is resumed from the saved state.
+         */
+        BZERO_OUTPUT;
+        feed_parser(&parser, "shaw employees-by-id 0x2");
+        cparser_input(&parser, 0, CPARSER_CHAR_FIRST);
+        for (n = 0; n < 3; n++) {
+            cparser_input(&parser, 0, CPARSER_CHAR_RIGHT_ARROW);
+        }
+        feed_parser(&parser, "\bo");
+        cparser_input(&parser, 0, CPARSER_CHAR_LAST);
+        feed_parser(&parser, " 0x3\n");
+        update_result(output, "shaw employees-by-id 0x2"
+                      "\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b"
+                      "sha\b\033[P\033[@ow employees-by-id 0x2 0x3 \n"
+                      "john\n   ID: 0x00000003\n   Height:  80\"   Weight: 220 lbs.\n"
+                      "TEST>> ",
+                      "line end jump");
+
+        /*
+         * Test the persistent history. Duplicated commands are dropped and
+         * only the last 4 commands are kept after the file is reopened.
+         */
+        snprintf(hist_path, sizeof(hist_path), "/tmp/test_parser.%d.hist",
+                 (int)getpid());
+        unlink(hist_path);
+        BZERO_OUTPUT;
+        rc = cparser_history_open(&history, hist_path, 4, NULL);
+        if (CPARSER_OK == rc) {
+            cparser_history_add(&history, "show employees");
+            cparser_history_add(&history, "show employees all");
+            cparser_history_add(&history, "show employees ");
+            cparser_history_add(&history, "help");
+            cparser_history_close(&history);
+            rc = cparser_history_open(&history, hist_path, 4, NULL);
+        }
+        if (CPARSER_OK == rc) {
+            print_history(&history);
+            cparser_history_add(&history, "quit");
+            cparser_history_add(&history, "save roster x");
+            print_history(&history);
+        }
+        update_result(output, "help|show employees|show employees all|"
+                      "save roster x|quit|help|show employees|",
+                      "history file");
+
+        BZERO_OUTPUT;
+        if (CPARSER_OK == rc) {
+            print_search(&history, "emp");
+            print_search(&history, "ro");
+            print_search(&history, "all");
+            print_search(&history, "");
+        }
+        update_result(output, "show employees|save roster x|-|-|",
+                      "history search");
+
+        /* Test reverse incremental search in the parser */
+        BZERO_OUTPUT;
+        if (CPARSER_OK == rc) {
+            parser.cfg.history = &history;
+            cparser_input(&parser, 0, CPARSER_CHAR_SEARCH);
+            feed_parser(&parser, "em\n");
+        }
+        update_result(output, "\r(reverse-i-search)`': "
+                      "\r(reverse-i-search)`e': save roster x"
+                      "\r(reverse-i-search)`em': show employees"
+                      "\rTEST>> show employees \033[K\n"
+                      "0x00000001 bob\n0x00000003 john\nTEST>> ",
+                      "reverse search");
+
+        BZERO_OUTPUT;
+        if (CPARSER_OK == rc) {
+            cparser_input(&parser, 0, CPARSER_CHAR_UP_ARROW);
+            cparser_input(&parser, 0, CPARSER_CHAR_UP_ARROW);
+            cparser_input(&parser, 0, CPARSER_CHAR_DOWN_ARROW);
+            feed_parser(&parser, "\n");
+            parser.cfg.history = NULL;
+            cparser_history_close(&history);
+        }
+        unlink(hist_path);
+        update_result(output, "show employees "
+                      "\033[14Dave roster x\033[K"
+                      "\033[12Dhow employees \n"
+                      "0x00000001 bob\n0x00000003 john\nTEST>> ",
+                      "history recall");
+
+        /*
+         * Test a history file compacted by another session. The session
+         * that has the old file open appends to the new file.
+         */
+        BZERO_OUTPUT;
+        rc = cparser_history_open(&history, hist_path, 2, NULL);
+        for (n = 0; (CPARSER_OK == rc) && (n < 6); n++) {
+            sprintf(dyn_cmd, "cmd %d", n);
+            rc = cparser_history_add(&history, dyn_cmd);
+        }
+        if (CPARSER_OK == rc) {
+            rc = cparser_history_open(&shared, hist_path, 2, NULL);
+        }
+        if (CPARSER_OK == rc) {
+            cparser_history_add(&history, "quit");
+            cparser_history_sync(&shared);
+            print_history(&shared);
+            cparser_history_close(&shared);
+            rc = cparser_history_open(&shared, hist_path, 10, NULL);
+        }
+        if (CPARSER_OK == rc) {
+            print_history(&shared);
+            output_ptr += sprintf(output_ptr, "%u", shared.num_records);
+            cparser_history_close(&shared);
+            cparser_history_close(&history);
+        }
+        unlink(hist_path);
+        update_result(output, "quit|cmd 5|quit|cmd 5|cmd 4|3", 
+                      "history compaction");
+
+        /* 
+         * Test a command file. Its commands are not entered into the line
+         * buffers, so no parser FSM state is saved with them.
+         */
+        snprintf(hist_path, sizeof(hist_path), "/tmp/test_parser.%d.cmd",
+                 (int)getpid());
+        BZERO_OUTPUT;
+        fp = fopen(hist_path, "w");
+        if (fp) {
+            fprintf(fp, "show employees\nshow employees-by-id 0x3\n");
+            fclose(fp);
+            output_ptr += sprintf(output_ptr, "%d|", 
+                                  cparser_load_cmd(&parser, hist_path));
+        }
+        unlink(hist_path);
+        update_result(output, "\n0x00000001 bob\n0x00000003 john\n"
+                      "TEST>> \njohn\n   ID: 0x00000003\n"
+                      "   Height:  80\"   Weight: 220 lbs.\nTEST>> 0|",
+                      "command file");
+
+        /* Test the result of a failed action */
+        BZERO_OUTPUT;
+        feed_parser(&parser, "no employee 0x99");
+        rc = cparser_input(&parser, '\n', CPARSER_CHAR_REGULAR);
+        output_ptr += sprintf(output_ptr, "|%d", rc);
+        update_result(output, "no employee 0x99 \n"
+                      "Employee 0x00000099 does not exist in the database.\n"
+                      "TEST>> |3", 
+                      "failed action");
+
+        /*
+         * Test the tree with argument structures. A string that the 
+         * parser accepts but that does not fit in its field fails the
+         * command instead of being cut.
+         */
+        memset(&image, 0, sizeof(image));
+        image.cfg = parser.cfg;
+        image.cfg.root = &test_args_root;
+        image.cfg.max_line_size = 512;
+        image.cfg.max_token_size = 400;
+        BZERO_OUTPUT;
+        rc = cparser_init(&image.cfg, &image);
+        if (CPARSER_OK == rc) {
+            feed_parser(&image, "args name bob\n");
+            feed_parser(&image, "args name bob 3\n");
+            feed_parser(&image, "args pc 10.0.0.1 off\n");
+        }
+        update_result(output, "args name bob \nname bob\n"
+                      "TEST>> args name bob 3 \nname bob reports 3\n"
+                      "TEST>> args pc 10.0.0.1 off \npc 0a000001 off\n"
+                      "TEST>> ", "argument structures");
+        if (CPARSER_OK == rc) {
+            feed_parser(&image, "args name ");
+            for (n = 0; n < 300; n++) {
+                cparser_input(&image, 'x', CPARSER_CHAR_REGULAR);
+            }
+            BZERO_OUTPUT;
+            rc = cparser_input(&image, '\n', CPARSER_CHAR_REGULAR);
+            output_ptr += sprintf(output_ptr, "|%d", rc);
+            cparser_fini(&image);
+        }
+        update_result(output, " \nTEST>> |4", "argument too long");
+
+        /*
+         * Test a parser with its own limits and its storage in an arena.
+         * Characters beyond the line size are refused.
+         */
+        memset(&small, 0, sizeof(small));
+        small.cfg = parser.cfg;
+        small.cfg.max_line_size = 16;
+        small.cfg.max_lines = 2;
+        small.cfg.max_num_tokens = 4;
+        cparser_arena_init(&arena, arena_buf, sizeof(arena_buf));
+        small.cfg.alloc = &arena.alloc;
+        BZERO_OUTPUT;
+        rc = cparser_init(&small.cfg, &small);
+        if (CPARSER_OK == rc) {
+            feed_parser(&small, "show employees all\n");
+            cparser_fini(&small);
+        }
+        update_result(output, "show employees a\a\a\a\a\a\n"
+                      "                       ^Line too long\nTEST>> ",
+                      "runtime limits");
+
+        /*
+         * Test the binary image of the parse tree. It must behave the
+         * same as the C tree.
+         */
+        cmd = strrchr(argv[0], '/');
+        snprintf(tree_path, sizeof(tree_path), "%.*stest_tree.bin",
+                 (cmd ? (int)(cmd - argv[0] + 1) : 0), argv[0]);
+        BZERO_OUTPUT;
+        expected[0] = '\0';
+        rc = cparser_tree_open(&tree, tree_path, cparser_glue_tbl,
+                               CPARSER_NUM_GLUE);
+        if (CPARSER_OK == rc) {
+            memset(&image, 0, sizeof(image));
+            image.cfg = parser.cfg;
+            image.cfg.root = NULL;
+            image.cfg.tree = &tree;
+            rc = cparser_init(&image.cfg, &image);
+        }
+        if (CPARSER_OK != rc) {
+            sprintf(output, "Fail to open %s (%d).", tree_path, rc);
+        }
+        for (n = 0; (CPARSER_OK == rc) && image_cmds[n]; n++) {
+            BZERO_OUTPUT;
+            feed_parser(&parser, image_cmds[n]);
+            strcpy(expected, output);
+            BZERO_OUTPUT;
+            feed_parser(&image, image_cmds[n]);
+            if (strcmp(output, expected)) {
+                break;
+            }
+        }
+        update_result(output, expected, "tree image");
+        if (CPARSER_OK == rc) {
+            cparser_fini(&image);
+            cparser_tree_close(&tree);
+        }
+
+        /* Test images with nodes that cannot be followed */
+        BZERO_OUTPUT;
+        sprintf(output, "%d %d", test_broken_image(tree_path, 0),
+                test_broken_image(tree_path, 1));
+        update_result(output, "5 5", "broken tree image");
+
+        /*
+         * Test the packed parse tree. It must behave the same as the C 
+         * tree, including the descriptions in help.
+         */
+        memset(&image, 0, sizeof(image));
+        image.cfg = parser.cfg;
+        image.cfg.root = NULL;
+        image.cfg.tree = &test_packed_tree;
+        rc = cparser_init(&image.cfg, &image);
+        for (n = 0; (CPARSER_OK == rc) && image_cmds[n]; n++) {
+            BZERO_OUTPUT;
+            feed_parser(&parser, image_cmds[n]);
+            strcpy(expected, output);
+            BZERO_OUTPUT;
+            feed_parser(&image, image_cmds[n]);
+            if (strcmp(output, expected)) {
+                break;
+            }
+        }
+        if (CPARSER_OK != rc) {
+            sprintf(output, "Fail to use the packed tree (%d).", rc);
+        }
+        update_result(output, expected, "packed tree");
+        if (CPARSER_OK == rc) {
+            cparser_fini(&image);
+        }
+
+        /*
+         * Test commands added and removed at run time. Removing all of 
+         * them frees every node they added.
+         */
+        memset(&base, 0, sizeof(base));
+        base.root = &cparser_root;
+        BZERO_OUTPUT;
+        rc = cparser_tree_init(&dyn, &base, NULL);
+        if (CPARSER_OK == rc) {
+            memset(&image, 0, sizeof(image));
+            image.cfg = parser.cfg;
+            image.cfg.tree = &dyn;
+            num_nodes = dyn.num_nodes;
+            output_ptr += sprintf(output_ptr, "%d ",
+                cparser_tree_add(&dyn, "show bgp neighbor <IPV4ADDR:peer>",
+                                 test_neighbor_glue, "Show a BGP neighbor"));
+            output_ptr += sprintf(output_ptr, "%d ",
+                cparser_tree_add(&dyn, "show bgp neighbor <IPV4ADDR:peer>",
+                                 test_neighbor_glue, NULL));
+            output_ptr += sprintf(output_ptr, "%d ",
+                cparser_tree_add(&dyn, "show bgp {", test_neighbor_glue, NULL));
+            output_ptr += sprintf(output_ptr, "%d|",
+                cparser_tree_remove(&dyn, "show employees"));
+            rc = cparser_init(&image.cfg, &image);
+        }
+        if (CPARSER_OK == rc) {
+            feed_parser(&image, "sh bgp n 10.1.2.3\n");
+            feed_parser(&image, "help bgp\n");
+            feed_parser(&image, "sh employees\n");
+            for (n = 0; n < 10000; n++) {
+                snprintf(dyn_cmd, sizeof(dyn_cmd), "bgp neighbor%d { <UINT:as> }", n);
+                if (CPARSER_OK != cparser_tree_add(&dyn, dyn_cmd, 
+                                                   test_neighbor_glue, NULL)) {
+                    break;
+                }
+            }
+            feed_parser(&image, "bgp neighbor9999 7\n");
+            for (n = 0; n < 10000; n++) {
+                snprintf(dyn_cmd, sizeof(dyn_cmd), "bgp neighbor%d { <UINT:as> }", n);
+                if (CPARSER_OK != cparser_tree_remove(&dyn, dyn_cmd)) {
+                    break;
+                }
+            }
+            cparser_tree_remove(&dyn, "show bgp neighbor <IPV4ADDR:peer>");
+            output_ptr += sprintf(output_ptr, "|%d|", 
+                                  (int)(dyn.num_nodes - num_nodes));
+            feed_parser(&image, "sh bgp n 10.1.2.3\n");
+            cparser_fini(&image);
+            cparser_tree_fini(&dyn);
+        }
+        update_result(output, "0 1 5 3|"
+                      "sh bgp n 10.1.2.3 \n"
+                      "neighbor 0a010203\n"
+                      "TEST>> help bgp \n"
+                      "Show a BGP neighbor\r\n"
+                      "  show bgp neighbor <IPV4ADDR:peer> \r\n"
+                      "\n"
+                      "TEST>> sh employees \n"
+                      "0x00000001 bob\n"
+                      "0x00000003 john\n"
+                      "TEST>> bgp neighbor9999 7 \n"
+                      "neighbor 00000000\n"
+                      "TEST>> |0|sh bgp n 10.1.2.3\n"
+                      "          ^Parse error\n"
+                      "TEST>> ", "run-time commands");
+
+        /*
+         * Test a command that does not fit in the allocator. The tree
+         * is unchanged so its generation must not move either.
+         */
+        BZERO_OUTPUT;
+        cparser_arena_init(&arena, arena_buf, sizeof(arena_buf));
+        rc = cparser_tree_init(&dyn, NULL, &arena.alloc);
+        if (CPARSER_OK == rc) {
+            for (n = 0; (CPARSER_OK == rc) && (n < 10000); n++) {
+                num_nodes = dyn.gen;
+                snprintf(dyn_cmd, sizeof(dyn_cmd), 
+                         "bgp neighbor%d { <UINT:as> }", n);
+                rc = cparser_tree_add(&dyn, dyn_cmd, test_neighbor_glue, NULL);
+            }
+            sprintf(output, "%d %d", rc, (int)(dyn.gen - num_nodes));
+            cparser_tree_fini(&dyn);
+        }
+        update_result(output, "4 0", "run-time command out of memory");
+
+        /*
+         * Test a tree published while a parser is in the middle of a 
+         * line. The line finishes with the old tree. Each parser moves
+         * to the new tree at its next line and the old tree is freed
+         * after the last one.
+         */
+        BZERO_OUTPUT;
+        rc = cparser_tree_init(&tree, &base, NULL);
+        if (CPARSER_OK == rc) {
+            rc = cparser_tree_add(&tree, "show bgp neighbor <IPV4ADDR:peer>",
+                                  test_neighbor_glue, NULL);
+        }
+        if (CPARSER_OK == rc) {
+            rc = cparser_tree_handle_init(&handle, &tree, test_tree_free, 
+                                          NULL);
+        }
+        if (CPARSER_OK == rc) {
+            memset(&image, 0, sizeof(image));
+            image.cfg = parser.cfg;
+            image.cfg.handle = &handle;
+            rc = cparser_init(&image.cfg, &image);
+        }
+        if (CPARSER_OK == rc) {
+            memset(&small, 0, sizeof(small));
+            small.cfg = image.cfg;
+            rc = cparser_init(&small.cfg, &small);
+        }
+        if (CPARSER_OK == rc) {
+            feed_parser(&image, "sh bgp n 10.1");
+            rc = cparser_tree_init(&dyn, &tree, NULL);
+        }
+        if (CPARSER_OK == rc) {
+            output_ptr += sprintf(output_ptr, "%d|", 
+                cparser_tree_remove(&dyn, "show bgp neighbor <IPV4ADDR:peer>"));
+            output_ptr += sprintf(output_ptr, "%d|",
+                cparser_tree_publish(&handle, &dyn, test_tree_free));
+            feed_parser(&image, ".2.3\n");
+            output_ptr += sprintf(output_ptr, "%d|", num_trees_freed);
+            feed_parser(&small, "sh bgp n 10.1.2.3\n");
+            output_ptr += sprintf(output_ptr, "%d|", num_trees_freed);
+            feed_parser(&image, "sh bgp n 10.1.2.3\n");
+            output_ptr += sprintf(output_ptr, "%d|", 
+                                  cparser_tree_handle_fini(&handle));
+            cparser_fini(&small);
+            cparser_fini(&image);
+            output_ptr += sprintf(output_ptr, "%d|", 
+                                  cparser_tree_handle_fini(&handle));
+            output_ptr += sprintf(output_ptr, "%d", num_trees_freed);
+        }
+        update_result(output, "sh bgp n 10.10|0|.2.3 \n"
+                      "neighbor 0a010203\n"
+                      "TEST>> 0|sh bgp n 10.1.2.3\n"
+                      "          ^Parse error\n"
+                      "TEST>> 1|sh bgp n 10.1.2.3\n"
+                      "          ^Parse error\n"
+                      "TEST>> 1|0|2", "tree versions");
+
+        /*
+         * Test trees published while parsers in other threads use them.
+         * No command runs on a freed tree and every replaced tree is 
+         * freed.
+         */
+        BZERO_OUTPUT;
+        rc = test_tree_swap(&parser.cfg, &base);
+        output_ptr += sprintf(output_ptr, "|%d", rc);
+        update_result(output, "1|0|199|0|200|0", "tree swap in threads");
+
+        /*
+         * Test asynchronous commands. The input after a pending command 
+         * is queued and runs in order when the command completes.
+         */
+        BZERO_OUTPUT;
+        rc = cparser_tree_init(&dyn, &base, NULL);
+        if (CPARSER_OK == rc) {
+            rc = cparser_tree_add(&dyn, "dump table <UINT:id>", 
+                                  test_dump_glue, NULL);
+        }
+        if (CPARSER_OK == rc) {
+            memset(&image, 0, sizeof(image));
+            image.cfg = parser.cfg;
+            image.cfg.tree = &dyn;
+            image.cfg.max_queue_size = 30;
+            rc = cparser_init(&image.cfg, &image);
+        }
+        if (CPARSER_OK == rc) {
+            cparser_async_t first;
+
+            output_ptr += sprintf(output_ptr, "%d|", 
+                                  cparser_input(&image, '\n', 
+                                                CPARSER_CHAR_REGULAR));
+            feed_parser(&image, "dump table 1");
+            output_ptr += sprintf(output_ptr, "%d|", 
+                                  cparser_input(&image, '\n', 
+                                                CPARSER_CHAR_REGULAR));
+            feed_parser(&image, "sh employees\ndump tab 2\nsh emp");
+            cparser_last_command(&image, NULL, &rc, NULL);
+            output_ptr += sprintf(output_ptr, "%d|%d|", rc,
+                                  cparser_input(&image, 'x', 
+                                                CPARSER_CHAR_REGULAR));
+            first = test_async;
+            output_ptr += sprintf(output_ptr, "%d|", 
+                                  cparser_complete_async(&first, CPARSER_OK));
+            output_ptr += sprintf(output_ptr, "|%d|", 
+                                  cparser_complete_async(&first, CPARSER_OK));
+            output_ptr += sprintf(output_ptr, "%d|", 
+                                  cparser_complete_async(&test_async, 
+                                                         CPARSER_NOT_OK));
+            cparser_last_command(&image, &cmd, &rc, NULL);
+            output_ptr += sprintf(output_ptr, "%s|%d|", cmd, rc);
+            feed_parser(&image, "loyees\n");
+            cparser_fini(&image);
+            cparser_tree_fini(&dyn);
+        }
+        update_result(output, "\nTEST>> 0|dump table 1 \n"
+                      "dump 1\n"
+                      "7|7|4|TEST>> sh employees \n"
+                      "0x00000001 bob\n"
+                      "0x00000003 john\n"
+                      "TEST>> dump tab 2 \n"
+                      "dump 2\n"
+                      "0||3|TEST>> sh emp0|dump tab 2 |1|loyees \n"
+                      "0x00000001 bob\n"
+                      "0x00000003 john\n"
+                      "TEST>> ", "asynchronous commands");
+
+        /*
+         * Test commands run from encoded arguments. Only the output of
+         * the actions is printed.
+         */
+        {
+            uint8_t args[64];
+            uint32_t min = 3, id = 1;
+            char *field = "height", *name = "robert";
+            int len;
+
+            parser.cfg.codecs = cparser_codec_tbl;
+            parser.cfg.num_codecs = CPARSER_NUM_CODECS;
+            BZERO_OUTPUT;
+            len = cparser_enc_show_employees_by_id_min_max(args, sizeof(args),
+                                                          &min, NULL);
+            output_ptr += sprintf(output_ptr, "%d:%02x%02x%02x%02x%02x%02x|",
+                                  len, args[0], args[1], args[2], args[3], 
+                                  args[4], args[5]);
+            output_ptr += sprintf(output_ptr, "%d|", 
+                cparser_execute_encoded(&parser, 
+                    CPARSER_ID_SHOW_EMPLOYEES_BY_ID_MIN_MAX, args, len));
+            output_ptr += sprintf(output_ptr, "%d|", 
+                cparser_execute_encoded(&parser, 
+                    CPARSER_ID_SHOW_EMPLOYEES_BY_ID_MIN_MAX, args, len - 1));
+            output_ptr += sprintf(output_ptr, "%d|", 
+                cparser_execute_encoded(&parser, 
+                    CPARSER_ID_SHOW_EMPLOYEES_BY_ID_MIN_MAX, args, len + 1));
+            output_ptr += sprintf(output_ptr, "%d|", 
+                cparser_enc_show_employees_by_id_min_max(args, 4, &min, 
+                                                         NULL));
+            output_ptr += sprintf(output_ptr, "%d|", 
+                cparser_execute_encoded(&parser, 0x12345678, NULL, 0));
+            output_ptr += sprintf(output_ptr, "%d|", 
+                cparser_execute_encoded(&parser, 
+                    CPARSER_ID_SHOW_EMPLOYEES_BY_ID_MIN_MAX, NULL, 1));
+
+            /* A list keyword must be one of the list */
+            len = cparser_enc_show_employee_id_field(args, sizeof(args),
+                                                     &id, &field);
+            output_ptr += sprintf(output_ptr, "%d|", 
+                cparser_execute_encoded(&parser, 
+                    CPARSER_ID_SHOW_EMPLOYEE_ID_FIELD, args, len));
+            field = "heigh";
+            len = cparser_enc_show_employee_id_field(args, sizeof(args),
+                                                     &id, &field);
+            output_ptr += sprintf(output_ptr, "%d|", 
+                cparser_execute_encoded(&parser, 
+                    CPARSER_ID_SHOW_EMPLOYEE_ID_FIELD, args, len));
+
+            /* Hidden commands and submodes */
+            len = cparser_enc_show_employee_id_bonus_factor(args, 
+                                                            sizeof(args), 
+                                                            &id);
+            output_ptr += sprintf(output_ptr, "%d|", 
+                cparser_execute_encoded(&parser, 
+                    CPARSER_ID_SHOW_EMPLOYEE_ID_BONUS_FACTOR, args, len));
+            len = cparser_enc_employee_id(args, sizeof(args), &id);
+            output_ptr += sprintf(output_ptr, "%d|", 
+                cparser_execute_encoded(&parser, CPARSER_ID_EMPLOYEE_ID,
+                                        args, len));
+            output_ptr += sprintf(output_ptr, "%d|", 
+                cparser_execute_encoded(&parser, CPARSER_ID_SHOW_EMPLOYEES,
+                                        NULL, 0));
+            len = cparser_enc_emp_name_name(args, sizeof(args), &name);
+            output_ptr += sprintf(output_ptr, "%d|", 
+                cparser_execute_encoded(&parser, CPARSER_ID_EMP_NAME_NAME,
+                                        args, len));
+            output_ptr += sprintf(output_ptr, "%d|", 
+                cparser_execute_encoded(&parser, CPARSER_ID_EMP_EXIT,
+                                        NULL, 0));
+            feed_parser(&parser, "show employees\n");
+            update_result(output, "6:010000000300|john\n"
+                          "   ID: 0x00000003\n"
+                          "   Height:  80\"   Weight: 220 lbs.\n"
+                          "0|2|2|-1|3|2|Height: 70 in.\n"
+                          "0|2|3|0|3|0|0|show employees \n"
+                          "0x00000001 robert\n"
+                          "0x00000003 john\n"
+                          "TEST>> ", "encoded commands");
+        }
+
+        /*
+         * Test checking a command file. The errors are the same with 
+         * any number of threads. In the second file, the sub-mode is not
+         * indented so the parts after the first one are checked again.
+         */
+        {
+            static const char *check_files[] = {
+                "employee 0x1\n"
+                "  name Bob\n"
+                "  height 72\n"
+                "  height abc\n"
+                "  weight 99999999999\n"
+                "\n"
+                "show employees\n"
+                "employee 0x2\n"
+                "  titl\n"
+                "employee 0x3\n"
+                "  pc-mac-address 00:11:22:33:44:55\n"
+                "show employee 0x1 bonus-factor\n"
+                "frobnicate\n"
+                "show employees-by-id 0x0 0x1\n"
+                "name Bob\n"
+                "help %0400d\n"
+                "employee 0x4",
+                "employee 0x5\nname Al\nheight 70\n"
+                "employee 0x6\nname Ed\nheight 71\n"
+                "employee 0x7\nname Jo\nheight 72\n",
+                NULL
+            };
+            cparser_check_error_t errors[8];
+            char check_path[64];
+            uint32_t num_errors;
+            FILE *fp;
+            int threads[] = { 1, 3, 16 }, k;
+            uint32_t max[] = { 5, 8, 8 };
+
+            snprintf(check_path, sizeof(check_path), 
+                     "/tmp/test_parser.%d.cmd", (int)getpid());
+            BZERO_OUTPUT;
+            for (n = 0; check_files[n]; n++) {
+                fp = fopen(check_path, "w");
+                if (fp) {
+                    fprintf(fp, check_files[n], 0);
+                    fclose(fp);
+                }
+                for (k = 0; k < 3; k++) {
+                    num_errors = 0;
+                    output_ptr += sprintf(output_ptr, "%d|",
+                        cparser_check_cmd(&parser, check_path, threads[k],
+                                          errors, max[k], &num_errors));
+                    output_ptr += sprintf(output_ptr, "%u\n", num_errors);
+                    cparser_check_print(&parser, errors, 
+                                        (max[k] < num_errors ? max[k] :
+                                         num_errors));
+                }
+            }
+            unlink(check_path);
+            output_ptr += sprintf(output_ptr, "%d", 
+                cparser_check_cmd(&parser, check_path, 1, errors, 5,
+                                  &num_errors));
+            update_result(output, 
+                          "1|7\n"
+                          "Line 4, column 10: Parse error.\n"
+                          "Line 5, column 10: Invalid parameter.\n"
+                          "Line 9, column 7: Incomplete command.\n"
+                          "Line 12, column 19: Parse error.\n"
+                          "Line 13, column 1: Parse error.\n"
+                          "1|7\n"
+                          "Line 4, column 10: Parse error.\n"
+                          "Line 5, column 10: Invalid parameter.\n"
+                          "Line 9, column 7: Incomplete command.\n"
+                          "Line 12, column 19: Parse error.\n"
+                          "Line 13, column 1: Parse error.\n"
+                          "Line 15, column 2: Parse error.\n"
+                          "Line 16, column 384: Line too long.\n"
+                          "1|7\n"
+                          "Line 4, column 10: Parse error.\n"
+                          "Line 5, column 10: Invalid parameter.\n"
+                          "Line 9, column 7: Incomplete command.\n"
+                          "Line 12, column 19: Parse error.\n"
+                          "Line 13, column 1: Parse error.\n"
+                          "Line 15, column 2: Parse error.\n"
+                          "Line 16, column 384: Line too long.\n"
+                          "1|2\n"
+                          "Line 4, column 2: Parse error.\n"
+                          "Line 7, column 2: Parse error.\n"
+                          "1|2\n"
+                          "Line 4, column 2: Parse error.\n"
+                          "Line 7, column 2: Parse error.\n"
+                          "1|2\n"
+                          "Line 4, column 2: Parse error.\n"
+                          "Line 7, column 2: Parse error.\n"
+                          "3", "check command file");
+
+            /*
+             * Strings as long as the parser accepts and files that do 
+             * not exist here are valid.
+             */
+            memset(&image, 0, sizeof(image));
+            image.cfg = parser.cfg;
+            image.cfg.max_line_size = 512;
+            image.cfg.max_token_size = 400;
+            BZERO_OUTPUT;
+            rc = cparser_init(&image.cfg, &image);
+            fp = fopen(check_path, "w");
+            if ((CPARSER_OK == rc) && fp) {
+                fprintf(fp, "save roster %0300d\n"
+                        "load roster /nonexistent/roster.cmd\n"
+                        "employee 0x8\n"
+                        "  name %0300d\n"
+                        "  height 99999999999\n", 0, 0);
+                fclose(fp);
+                num_errors = 0;
+                output_ptr += sprintf(output_ptr, "%d|",
+                    cparser_check_cmd(&image, check_path, 1, errors, 5,
+                                      &num_errors));
+                output_ptr += sprintf(output_ptr, "%u\n", num_errors);
+                cparser_check_print(&image, errors, num_errors);
+                cparser_fini(&image);
+            }
+            unlink(check_path);
+            update_result(output, "1|1\n"
+                          "Line 5, column 10: Invalid parameter.\n",
+                          "check long strings");
+        }
+
         printf("Total=%d  Passed=%d  Failed=%d\n", num_passed + num_failed,
                num_passed, num_failed);
     }
 
+    cparser_fini(&parser);
     return num_failed;
 }
@@ -0,0 +1,436 @@
+/**
+ * \file     test_record.c
+ * \brief    Test program of recording and replaying sessions.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_record.h"
+#include "cparser_image.h"
+#include "test_util.h"
+
+/** Number of sessions and commands of the load test */
+#define TEST_NUM_SESSIONS   (16)
+#define TEST_NUM_CMDS       (20000)
+
+static cparser_async_t test_async;
+/** Result of "show port 0" */
+static cparser_result_t port0_rc = CPARSER_NOT_OK;
+/** Tree handle of the parser replaying into published trees */
+static cparser_tree_handle_t test_handle;
+/** Tree published by test_publish_glue() */
+static cparser_tree_t *test_next_tree;
+/** Number of trees freed by test_tree_free() */
+static int num_trees_freed;
+
+/**
+ * Glue function of "show port <UINT:n>".
+ */
+static cparser_result_t
+test_port_glue (cparser_t *parser)
+{
+    uint32_t n = 0;
+
+    (void)cparser_get_uint(&parser->tokens[2], &n);
+    return (n ? CPARSER_OK : port0_rc);
+}
+
+/**
+ * Free a tree published in a tree handle
+ */
+static void
+test_tree_free (cparser_tree_t *tree)
+{
+    cparser_tree_fini(tree);
+    num_trees_freed++;
+}
+
+/**
+ * Glue function of "show port <UINT:n>" of a published tree. The first
+ * command publishes the next version of the tree.
+ */
+static cparser_result_t
+test_publish_glue (cparser_t *parser)
+{
+    if (test_next_tree) {
+        (void)cparser_tree_publish(&test_handle, test_next_tree, 
+                                   test_tree_free);
+        test_next_tree = NULL;
+    }
+    return test_port_glue(parser);
+}
+
+/**
+ * Glue function of "show later". It completes asynchronously.
+ */
+static cparser_result_t
+test_later_glue (cparser_t *parser)
+{
+    if (CPARSER_OK != cparser_async_handle(&parser->context, &test_async)) {
+        return CPARSER_NOT_OK;
+    }
+    return CPARSER_PENDING;
+}
+
+/**
+ * Wait function of the replays. It completes "show later".
+ */
+static cparser_result_t
+test_wait (cparser_t *parser, void *cookie)
+{
+    (*(int *)cookie)++;
+    return cparser_complete_async(&test_async, CPARSER_NOT_OK);
+}
+
+/**
+ * Output functions of the parsers. The output is discarded as sessions
+ * replay in parallel.
+ */
+static void
+discard_printc (const cparser_t *parser, const char ch)
+{
+}
+
+static void
+discard_prints (const cparser_t *parser, const char *s)
+{
+}
+
+/**
+ * Print the records of a log file into the output buffer as 
+ * "<rc> <level> <command>|". 'T' is printed instead if the times of 
+ * the records go backwards.
+ */
+static void
+print_log (const char *path)
+{
+    unsigned char buf[1000];
+    size_t len, pos = 16, n;
+    uint64_t delta;
+    FILE *fp;
+
+    fp = fopen(path, "r");
+    if (!fp) {
+        output_ptr += sprintf(output_ptr, "no log");
+        return;
+    }
+    len = fread(buf, 1, sizeof(buf), fp);
+    fclose(fp);
+    if ((16 > len) || memcmp(buf, "CPRL\x01\0\0\0", 8)) {
+        output_ptr += sprintf(output_ptr, "bad header");
+        return;
+    }
+    while (pos < len) {
+        for (delta = 0, n = 0; buf[pos] & 0x80; pos++, n += 7) {
+            delta |= (uint64_t)(buf[pos] & 0x7f) << n;
+        }
+        delta |= (uint64_t)buf[pos++] << n;
+        if (delta > 10000000) {
+            output_ptr += sprintf(output_ptr, "T");
+        }
+        output_ptr += sprintf(output_ptr, "%d %d %.*s|", buf[pos], 
+                              buf[pos + 1], buf[pos + 2], 
+                              (char *)&buf[pos + 3]);
+        pos += 3 + buf[pos + 2];
+    }
+}
+
+/**
+ * Write a log file with a command every 'gap' usec.
+ */
+static void
+write_log (const char *path, int gap, const char *tail)
+{
+    static const char cmds[][16] = { "show port 1", "sh po 0", "show port 2" };
+    FILE *fp;
+    int n;
+
+    fp = fopen(path, "w");
+    if (!fp) {
+        return;
+    }
+    fwrite("CPRL\x01\0\0\0\0\0\0\0\0\0\0\0", 1, 16, fp);
+    for (n = 0; n < 3; n++) {
+        /* The level of the second command is 1 */
+        fprintf(fp, "%c%c%c%c%c%s", 0x80 | (gap & 0x7f), (gap >> 7) & 0x7f,
+                (1 == n ? 1 : 0), (1 == n ? 1 : 0), (int)strlen(cmds[n]),
+                cmds[n]);
+    }
+    fwrite(tail, 1, strlen(tail), fp);
+    fclose(fp);
+}
+
+static int
+init_parser (cparser_t *parser, cparser_tree_t *tree, 
+             cparser_tree_handle_t *handle)
+{
+    cparser_cfg_t cfg;
+
+    test_cfg_init(&cfg, tree, "T> ");
+    cfg.handle = handle;
+    cfg.printc = discard_printc;
+    cfg.prints = discard_prints;
+    return cparser_init(&cfg, parser);
+}
+
+int
+main (int argc, char *argv[])
+{
+    static cparser_t parsers[TEST_NUM_SESSIONS];
+    static cparser_replay_session_t sessions[TEST_NUM_SESSIONS];
+    cparser_replay_stats_t stats;
+    cparser_record_t rec;
+    cparser_tree_t tree, v1, v2;
+    cparser_t session;
+    char path[64], path2[64], report[256];
+    int n, num_waits = 0;
+    FILE *fp;
+    cparser_result_t rc;
+
+    snprintf(path, sizeof(path), "/tmp/test_record.%d.log", (int)getpid());
+    snprintf(path2, sizeof(path2), "/tmp/test_record.%d.2.log", 
+             (int)getpid());
+    rc = cparser_tree_init(&tree, NULL, NULL);
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&tree, "show port <UINT:n>", test_port_glue, 
+                              NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&tree, "show later", test_later_glue, NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&tree, "clear port <UINT:n>", test_port_glue,
+                              NULL);
+    }
+    for (n = 0; (CPARSER_OK == rc) && (n < TEST_NUM_SESSIONS); n++) {
+        rc = init_parser(&parsers[n], &tree, NULL);
+        sessions[n].parser = &parsers[n];
+        sessions[n].path = path;
+    }
+    if (CPARSER_OK != rc) {
+        printf("Fail to initialize the test (%d).\n", rc);
+        return -1;
+    }
+
+    /* Test invalid parameters */
+    BZERO_OUTPUT;
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_record_open(NULL, path, 0, NULL));
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_record_open(&rec, path, 8, NULL));
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_record_open(&rec, "/nonexistent/x", 0,
+                                              NULL));
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_replay(sessions, 0, 0.0, NULL, NULL, 
+                                         &stats));
+    output_ptr += sprintf(output_ptr, "%d", 
+                          cparser_replay(sessions, 1, -1.0, NULL, NULL, 
+                                         &stats));
+    update_result(output, "2|2|1|2|2", "invalid parameters");
+
+    /* Test recording a session */
+    BZERO_OUTPUT;
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_record_open(&rec, path, 0, NULL));
+    parsers[0].cfg.record = cparser_record_hook;
+    parsers[0].cfg.record_cookie = &rec;
+    feed_parser(&parsers[0], "show port 3\n");
+    feed_parser(&parsers[0], "sh po 0\n");
+    feed_parser(&parsers[0], "\n   \n");
+    feed_parser(&parsers[0], "show xyz\n");
+    feed_parser(&parsers[0], "show\n");
+    feed_parser(&parsers[0], "show later\n");
+    feed_parser(&parsers[0], "show port 4\n");
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_complete_async(&test_async, CPARSER_OK));
+    parsers[0].cfg.record = NULL;
+    output_ptr += sprintf(output_ptr, "%u|", rec.count);
+    output_ptr += sprintf(output_ptr, "%d|", cparser_record_close(&rec));
+    output_ptr += sprintf(output_ptr, "%llu|", 
+                          (unsigned long long)rec.num_records);
+    print_log(path);
+    update_result(output, "0|0|6|0|6|"
+                  "0 0 show port 3|1 0 sh po 0|5 0 show xyz|"
+                  "6 0 show|0 0 show later|0 0 show port 4|", 
+                  "record");
+
+    /* Test replaying it. "show later" is completed by the wait function */
+    BZERO_OUTPUT;
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_replay(sessions, 1, 0.0, test_wait, 
+                                         &num_waits, &stats));
+    output_ptr += sprintf(output_ptr, "%llu %llu %llu %d|", 
+                          (unsigned long long)stats.num_cmds,
+                          (unsigned long long)stats.num_rc_diverged,
+                          (unsigned long long)stats.num_level_diverged,
+                          num_waits);
+    port0_rc = CPARSER_OK;
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_replay(sessions, 1, 0.0, test_wait, 
+                                         &num_waits, &stats));
+    port0_rc = CPARSER_NOT_OK;
+    output_ptr += sprintf(output_ptr, "%llu %llu|", 
+                          (unsigned long long)stats.num_rc_diverged,
+                          (unsigned long long)sessions[0].stats.num_cmds);
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_replay(sessions, 1, 0.0, NULL, NULL, 
+                                         &stats));
+    output_ptr += sprintf(output_ptr, "%d %d %c", sessions[0].rc,
+                          parsers[0].pending, parsers[0].cfg.ch_help);
+    (void)cparser_complete_async(&test_async, CPARSER_OK);
+    update_result(output, "0|6 1 0 1|0|2 6|1|1 1 ?", "replay");
+
+    /* 
+     * Test the pace of a replay. The commands of the log are 15 msec
+     * apart and the second one has level 1.
+     */
+    BZERO_OUTPUT;
+    write_log(path2, 15000, "\x81");
+    sessions[0].path = path2;
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_replay(sessions, 1, 1.0, NULL, NULL, 
+                                         &stats));
+    output_ptr += sprintf(output_ptr, "%llu %llu %llu %d|", 
+                          (unsigned long long)stats.num_cmds,
+                          (unsigned long long)stats.num_rc_diverged,
+                          (unsigned long long)stats.num_level_diverged,
+                          (45000 <= stats.usec));
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_replay(sessions, 1, 4.0, NULL, NULL, 
+                                         &stats));
+    output_ptr += sprintf(output_ptr, "%llu %d|", 
+                          (unsigned long long)stats.num_cmds,
+                          (11250 <= stats.usec) && (45000 > stats.usec));
+    write_log(path2, 1, "XXXX");
+    rc = cparser_replay(sessions, 1, 0.0, NULL, NULL, &stats);
+    output_ptr += sprintf(output_ptr, "%d %d|", rc, sessions[0].rc);
+    unlink(path2);
+    rc = cparser_replay(sessions, 1, 0.0, NULL, NULL, &stats);
+    output_ptr += sprintf(output_ptr, "%d %d", rc, sessions[0].rc);
+    sessions[0].path = path;
+    update_result(output, "0|3 0 1 1|0|3 1|0 0|1 1", "pace");
+
+    /* Test many sessions replaying a long log */
+    BZERO_OUTPUT;
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_record_open(&rec, path, 0, NULL));
+    parsers[0].cfg.record = cparser_record_hook;
+    parsers[0].cfg.record_cookie = &rec;
+    for (n = 0; n < TEST_NUM_CMDS; n++) {
+        feed_parser(&parsers[0], (n % 10) ? "show port 7\n" : "sh po 0\n");
+    }
+    parsers[0].cfg.record = NULL;
+    output_ptr += sprintf(output_ptr, "%d|", cparser_record_close(&rec));
+    output_ptr += sprintf(output_ptr, "%llu %llu|", 
+                          (unsigned long long)rec.num_records,
+                          (unsigned long long)rec.num_dropped);
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_replay(sessions, TEST_NUM_SESSIONS, 0.0,
+                                         NULL, NULL, &stats));
+    output_ptr += sprintf(output_ptr, "%llu %llu %d", 
+                          (unsigned long long)stats.num_cmds,
+                          (unsigned long long)stats.num_rc_diverged,
+                          (cparser_replay_percentile(&stats, 50.0) <=
+                           cparser_replay_percentile(&stats, 99.0)) &&
+                          (cparser_replay_percentile(&stats, 100.0) >=
+                           stats.max_usec));
+    /* The report has times. Only its last line is checked. */
+    report[0] = '\0';
+    fp = tmpfile();
+    if (fp) {
+        cparser_replay_report(&stats, fp);
+        rewind(fp);
+        while (fgets(report, sizeof(report), fp)) {
+        }
+        fclose(fp);
+        output_ptr += sprintf(output_ptr, "|%s", report);
+    }
+    unlink(path);
+    update_result(output, "0|0|20000 0|0|320000 0 1|"
+                  "diverged  0 results, 0 sub-mode levels\n", 
+                  "many sessions");
+
+    /*
+     * Test a tree published during a replay. The parser moves to it and 
+     * keeps it after the replay.
+     */
+    BZERO_OUTPUT;
+    write_log(path2, 1, "");
+    rc = cparser_tree_init(&v1, NULL, NULL);
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&v1, "show port <UINT:n>", test_publish_glue,
+                              NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_init(&v2, NULL, NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&v2, "show port <UINT:n>", test_port_glue,
+                              NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_handle_init(&test_handle, &v1, test_tree_free, 
+                                      NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = init_parser(&session, NULL, &test_handle);
+    }
+    if (CPARSER_OK == rc) {
+        test_next_tree = &v2;
+        sessions[0].parser = &session;
+        sessions[0].path = path2;
+        output_ptr += sprintf(output_ptr, "%d|", 
+                              cparser_replay(sessions, 1, 0.0, NULL, NULL,
+                                             &stats));
+        output_ptr += sprintf(output_ptr, "%llu %d %d %c|", 
+                              (unsigned long long)stats.num_cmds,
+                              num_trees_freed, 
+                              (int)(session.cfg.tree == &v2),
+                              session.cfg.ch_help);
+        sessions[0].parser = &parsers[0];
+        sessions[0].path = path;
+        cparser_fini(&session);
+        output_ptr += sprintf(output_ptr, "%d", 
+                              cparser_tree_handle_fini(&test_handle));
+    }
+    unlink(path2);
+    update_result(output, "0|3 1 1 ?|0", "tree published");
+
+    for (n = 0; n < TEST_NUM_SESSIONS; n++) {
+        cparser_fini(&parsers[n]);
+    }
+    cparser_tree_fini(&tree);
+    return test_report();
+}
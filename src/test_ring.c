@@ -0,0 +1,307 @@
+/**
+ * \file     test_ring.c
+ * \brief    Test program for the output rings.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_exec.h"
+#include "cparser_ring.h"
+#include "test_util.h"
+
+#define TEST_RING_SIZE  (64)
+
+/**
+ * Glue function of "dump <UINT:n>". It prints n numbered lines.
+ */
+static cparser_result_t
+test_dump_glue (cparser_t *parser)
+{
+    uint32_t n = 0, k;
+    char buf[32];
+
+    (void)cparser_get_uint(&parser->tokens[1], &n);
+    for (k = 0; k < n; k++) {
+        snprintf(buf, sizeof(buf), "line %u\n", k);
+        parser->cfg.prints(parser, buf);
+    }
+    return CPARSER_OK;
+}
+
+/**
+ * The expected output of "dump <n>"
+ */
+static void
+test_dump_output (char *buf, uint32_t n)
+{
+    uint32_t k;
+
+    for (k = 0; k < n; k++) {
+        buf += sprintf(buf, "line %u\n", k);
+    }
+}
+
+/**
+ * Read all output in a pipe and append it to the output buffer
+ */
+static void
+read_pipe (int fd)
+{
+    size_t len = strlen(output);
+    ssize_t rsize;
+
+    while (0 < (rsize = read(fd, output + len, sizeof(output) - len - 1))) {
+        len += rsize;
+    }
+    output[len] = '\0';
+}
+
+/**
+ * Start a session whose output goes to a ring and a pipe
+ */
+static cparser_result_t
+start_session (cparser_t *parser, cparser_ring_t *ring, int *fds,
+               cparser_ring_policy_t policy, cparser_cfg_t *cfg)
+{
+    cparser_result_t rc;
+
+    if (pipe(fds) || (0 > fcntl(fds[0], F_SETFL, O_NONBLOCK)) ||
+        (0 > fcntl(fds[1], F_SETFL, O_NONBLOCK))) {
+        return CPARSER_NOT_OK;
+    }
+    memset(parser, 0, sizeof(*parser));
+    rc = cparser_ring_init(ring, fds[1], TEST_RING_SIZE, policy, NULL);
+    if (CPARSER_OK == rc) {
+        rc = cparser_init(cfg, parser);
+    }
+    if (CPARSER_OK == rc) {
+        cparser_ring_config(parser, ring);
+    }
+    return rc;
+}
+
+/**
+ * Stop a session started by start_session()
+ */
+static void
+stop_session (cparser_t *parser, cparser_ring_t *ring, int *fds)
+{
+    cparser_fini(parser);
+    cparser_ring_fini(ring);
+    close(fds[0]);
+    if (0 <= fds[1]) {
+        close(fds[1]);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+    cparser_tree_t tree;
+    cparser_exec_t exec;
+    cparser_cfg_t cfg;
+    cparser_t parser, term;
+    cparser_ring_t ring;
+    char expected[20000], got[64];
+    int fds[2], n, m;
+    cparser_result_t rc;
+
+    /* A closed pipe must fail the write, not kill the test */
+    signal(SIGPIPE, SIG_IGN);
+
+    test_cfg_init(&cfg, &tree, "S> ");
+
+    rc = cparser_tree_init(&tree, NULL, NULL);
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&tree, "dump <UINT:n>", test_dump_glue, NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_exec_init(&exec, 1, 1, NULL, NULL, NULL);
+    }
+    if (CPARSER_OK != rc) {
+        printf("Fail to initialize the test (%d).\n", rc);
+        return -1;
+    }
+
+    /* Test invalid parameters */
+    n = sprintf(got, "%d|", cparser_ring_init(&ring, 1, 24, 
+                                              CPARSER_RING_BLOCK, NULL));
+    n += sprintf(got + n, "%d|", cparser_ring_init(&ring, -1, 100, 
+                                                   CPARSER_RING_BLOCK, NULL));
+    sprintf(got + n, "%d", cparser_ring_init(&ring, 1, 100, 
+                                             CPARSER_RING_MAX_POLICIES, NULL));
+    update_result(got, "2|2|2", "invalid parameters");
+
+    /* 
+     * Test a ring that drops the output. The output that fits is kept 
+     * and the marker replaces the rest, once.
+     */
+    output[0] = '\0';
+    if (CPARSER_OK == start_session(&parser, &ring, fds, CPARSER_RING_DROP,
+                                    &cfg)) {
+        feed_parser(&parser, "dump 10\n");
+        n = (int)cparser_ring_pending(&ring);
+        m = (int)ring.num_dropped;
+        rc = cparser_ring_drain(&ring);
+        read_pipe(fds[0]);
+        sprintf(got, "%d|%d|%d|%d", n, m, rc, 
+                (int)cparser_ring_pending(&ring));
+        update_result(got, "64|42|0|0", "drop counters");
+        update_result(output, "dump 10 \nline 0\nline 1\nline 2\nline 3\n"
+                      "lin" CPARSER_RING_MARKER, "drop output");
+
+        /* 
+         * The output is kept again once there is room. The prompt 
+         * of the command was dropped.
+         */
+        output[0] = '\0';
+        feed_parser(&parser, "dump 2\n");
+        (void)cparser_ring_drain(&ring);
+        read_pipe(fds[0]);
+        update_result(output, "dump 2 \nline 0\nline 1\nS> ", 
+                      "drop recovery");
+
+        /* Saving the terminal settings keeps the ring */
+        output[0] = '\0';
+        memset(&term, 0, sizeof(term));
+        cparser_io_config(&term);
+        term.cfg.io_init(&parser);
+        term.cfg.io_cleanup(&parser);
+        feed_parser(&parser, "dump 1\n");
+        (void)cparser_ring_drain(&ring);
+        read_pipe(fds[0]);
+        update_result(output, "dump 1 \nline 0\nS> ", "terminal settings");
+        stop_session(&parser, &ring, fds);
+    }
+
+    /* Test a ring that disconnects a slow session */
+    output[0] = '\0';
+    if (CPARSER_OK == start_session(&parser, &ring, fds, 
+                                    CPARSER_RING_DISCONNECT, &cfg)) {
+        feed_parser(&parser, "dump 10\n");
+        rc = cparser_ring_drain(&ring);
+        read_pipe(fds[0]);
+        sprintf(got, "%d|%d", rc, (int)strlen(output));
+        update_result(got, "1|64", "disconnect");
+        stop_session(&parser, &ring, fds);
+    }
+
+    /* Test a write error */
+    output[0] = '\0';
+    if (CPARSER_OK == start_session(&parser, &ring, fds, CPARSER_RING_BLOCK,
+                                    &cfg)) {
+        close(fds[0]);
+        fds[0] = open("/dev/null", O_RDONLY);
+        feed_parser(&parser, "dump 1\n");
+        n = sprintf(got, "%d|", cparser_ring_drain(&ring));
+        sprintf(got + n, "%d", cparser_ring_drain(&ring));
+        update_result(got, "1|1", "write error");
+        stop_session(&parser, &ring, fds);
+    }
+
+    /* 
+     * Test a blocking ring in the thread that drains it. The ring is 
+     * written to the pipe while the command runs.
+     */
+    output[0] = '\0';
+    if (CPARSER_OK == start_session(&parser, &ring, fds, CPARSER_RING_BLOCK,
+                                    &cfg)) {
+        feed_parser(&parser, "dump 500\n");
+        rc = cparser_ring_drain(&ring);
+        read_pipe(fds[0]);
+        n = sprintf(expected, "dump 500 \n");
+        test_dump_output(expected + n, 500);
+        strcat(expected, "S> ");
+        update_result(output, expected, "block in owner");
+        sprintf(got, "%d", rc);
+        update_result(got, "0", "block in owner drained");
+        stop_session(&parser, &ring, fds);
+    }
+
+    /* 
+     * Test a blocking ring with an executor. The job waits for the ring 
+     * to be drained and no output is lost.
+     */
+    output[0] = '\0';
+    cfg.exec = cparser_exec_submit;
+    cfg.exec_cookie = &exec;
+    if (CPARSER_OK == start_session(&parser, &ring, fds, CPARSER_RING_BLOCK,
+                                    &cfg)) {
+        feed_parser(&parser, "dump 2000\ndump 3\n");
+        do {
+            (void)cparser_exec_poll(&parser);
+            rc = cparser_ring_drain(&ring);
+            read_pipe(fds[0]);
+        } while (parser.pending || (CPARSER_OK != rc));
+        n = sprintf(expected, "dump 2000 \n");
+        test_dump_output(expected + n, 2000);
+        strcat(expected, "S> dump 3 \nline 0\nline 1\nline 2\nS> ");
+        update_result(output, expected, "block in executor");
+        stop_session(&parser, &ring, fds);
+    }
+
+    /* 
+     * Test blocking rings whose client never reads. A job and then the
+     * thread that drains the ring give up and disconnect the session.
+     */
+    if (CPARSER_OK == start_session(&parser, &ring, fds, CPARSER_RING_BLOCK,
+                                    &cfg)) {
+        ring.block_msec = 50;
+        feed_parser(&parser, "dump 20000\n");
+        do {
+            (void)cparser_exec_poll(&parser);
+            rc = cparser_ring_drain(&ring);
+        } while (parser.pending);
+        sprintf(got, "%d|%d", rc, ring.disconnected);
+        update_result(got, "1|1", "block in executor without reader");
+        stop_session(&parser, &ring, fds);
+    }
+    cfg.exec = NULL;
+    cfg.exec_cookie = NULL;
+    if (CPARSER_OK == start_session(&parser, &ring, fds, CPARSER_RING_BLOCK,
+                                    &cfg)) {
+        ring.block_msec = 50;
+        feed_parser(&parser, "dump 20000\n");
+        rc = cparser_ring_drain(&ring);
+        sprintf(got, "%d|%d", rc, ring.disconnected);
+        update_result(got, "1|1", "block in owner without reader");
+        stop_session(&parser, &ring, fds);
+    }
+
+    cparser_exec_fini(&exec);
+    cparser_tree_fini(&tree);
+    return test_report();
+}
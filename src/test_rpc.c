@@ -0,0 +1,385 @@
+/**
+ * \file     test_rpc.c
+ * \brief    Test program of the batch mode for automation clients.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_image.h"
+#include "cparser_rpc.h"
+#include "test_util.h"
+
+/** Number of requests of the pipelining test */
+#define TEST_NUM_PIPELINED  (20000)
+
+static cparser_async_t test_async;
+/** Number of responses and sum of the ids during the pipelining test */
+static uint32_t num_responses, sum_ids;
+static int counting;
+/** Number of trees freed by test_tree_free() */
+static int num_trees_freed;
+
+/**
+ * Glue function of "show port <UINT:n>".
+ */
+static cparser_result_t
+test_port_glue (cparser_t *parser)
+{
+    uint32_t n = 0;
+    char buf[32];
+
+    (void)cparser_get_uint(&parser->tokens[2], &n);
+    snprintf(buf, sizeof(buf), "port %u\n", n);
+    parser->cfg.prints(parser, buf);
+    return (n ? CPARSER_OK : CPARSER_NOT_OK);
+}
+
+/**
+ * Glue function of "show quote". The output must be escaped in JSON.
+ */
+static cparser_result_t
+test_quote_glue (cparser_t *parser)
+{
+    parser->cfg.prints(parser, "a \"b\"\tc\\d");
+    parser->cfg.printc(parser, '\x01');
+    parser->cfg.printc(parser, '\n');
+    return CPARSER_OK;
+}
+
+/**
+ * Glue function of "show later". It completes asynchronously.
+ */
+static cparser_result_t
+test_later_glue (cparser_t *parser)
+{
+    parser->cfg.prints(parser, "started\n");
+    if (CPARSER_OK != cparser_async_handle(&parser->context, &test_async)) {
+        return CPARSER_NOT_OK;
+    }
+    return CPARSER_PENDING;
+}
+
+/**
+ * Free a tree published in a tree handle
+ */
+static void
+test_tree_free (cparser_tree_t *tree)
+{
+    cparser_tree_fini(tree);
+    num_trees_freed++;
+}
+
+static uint32_t
+test_get32 (const char *buf)
+{
+    const unsigned char *p = (const unsigned char *)buf;
+
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | 
+        ((uint32_t)p[2] << 8) | p[3];
+}
+
+/**
+ * Append a frame with 'id' and 'cmd' to 'buf'.
+ *
+ * \return   Length of the frame.
+ */
+static int
+test_frame (char *buf, uint32_t id, const char *cmd)
+{
+    uint32_t len = 4 + strlen(cmd);
+    int n;
+
+    for (n = 0; n < 4; n++) {
+        buf[n] = (char)(len >> (24 - (8 * n)));
+        buf[4 + n] = (char)(id >> (24 - (8 * n)));
+    }
+    memcpy(buf + 8, cmd, strlen(cmd));
+    return 4 + len;
+}
+
+/**
+ * Sender of JSON responses. The time is replaced by 'T'.
+ */
+static void
+test_send_json (const char *buf, size_t len, void *cookie)
+{
+    const char *usec = strstr(buf, ",\"usec\":");
+
+    if (!usec || (usec >= (buf + len)) || ('\n' != buf[len - 1])) {
+        output_ptr += sprintf(output_ptr, "BAD RESPONSE\n");
+        return;
+    }
+    output_ptr += sprintf(output_ptr, "%.*s,\"usec\":T}\n", 
+                          (int)(usec - buf), buf);
+}
+
+/**
+ * Sender of framed responses. A response is printed as 
+ * "[<id> <rc> <output>]".
+ */
+static void
+test_send_frame (const char *buf, size_t len, void *cookie)
+{
+    if ((16 > len) || ((test_get32(buf) + 4) != len)) {
+        output_ptr += sprintf(output_ptr, "BAD RESPONSE\n");
+        return;
+    }
+    if (counting) {
+        num_responses++;
+        sum_ids += test_get32(buf + 4);
+        return;
+    }
+    output_ptr += sprintf(output_ptr, "[%u %d %.*s]", test_get32(buf + 4),
+                          (int)test_get32(buf + 8), (int)(len - 16), 
+                          buf + 16);
+}
+
+/**
+ * Feed a string to a session
+ */
+static cparser_result_t
+feed_rpc (cparser_rpc_t *rpc, const char *str)
+{
+    size_t used;
+
+    return cparser_rpc_input(rpc, str, strlen(str), &used);
+}
+
+int
+main (int argc, char *argv[])
+{
+    static char frames[TEST_NUM_PIPELINED * 32];
+    cparser_t parser;
+    cparser_t session;
+    cparser_tree_t tree, v1, v2;
+    cparser_tree_handle_t handle;
+    cparser_cfg_t cfg, session_cfg;
+    cparser_rpc_t rpc;
+    char buf[600];
+    size_t used, pos, len;
+    uint32_t sum;
+    int n;
+    cparser_result_t rc;
+
+    test_cfg_init(&cfg, &tree, "T> ");
+
+    rc = cparser_tree_init(&tree, NULL, NULL);
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&tree, "show port <UINT:n>", test_port_glue, 
+                              NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&tree, "show quote", test_quote_glue, NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&tree, "show later", test_later_glue, NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_init(&cfg, &parser);
+    }
+    if (CPARSER_OK != rc) {
+        printf("Fail to initialize the test (%d).\n", rc);
+        return -1;
+    }
+
+    /* Test invalid parameters */
+    BZERO_OUTPUT;
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_rpc_init(&rpc, &parser, 
+                                           CPARSER_RPC_MAX_FORMATS, 256, 
+                                           test_send_json, NULL, NULL));
+    output_ptr += sprintf(output_ptr, "%d|", 
+                          cparser_rpc_init(&rpc, &parser, CPARSER_RPC_JSON,
+                                           256, NULL, NULL, NULL));
+    output_ptr += sprintf(output_ptr, "%d", 
+                          cparser_rpc_init(&rpc, &parser, CPARSER_RPC_JSON,
+                                           1024, test_send_json, NULL, 
+                                           NULL));
+    update_result(output, "2|2|0", "invalid parameters");
+
+    /* Test pipelined JSON requests. Nothing is echoed. */
+    BZERO_OUTPUT;
+    rc = feed_rpc(&rpc, "{\"id\": 1, \"cmd\": \"show port 3\"}\n"
+                  "{\"cmd\":\"sh po 0\",\"id\":2}\n"
+                  "\n"
+                  " { \"id\" : \"a\\\"b\" , \"cmd\" : \"show quote\" }\r\n"
+                  "{\"id\":4,\"cmd\":\"\\u0073how\\tport 5\"}\n"
+                  "{\"id\":5,\"cmd\":\"show xyz\"}\n"
+                  "{\"id\":6,\"cmd\":\"show\"}\n"
+                  "{\"id\":7,\"cmd\":\"show port\",\"x\":[1]}\n"
+                  "{\"id\":8}\n"
+                  "{\"id\":9,\"cmd\":\"show port 1\\n\"}\n"
+                  "{\"id\":10,\"cmd\":\"show port 1\"");
+    output_ptr += sprintf(output_ptr, "%d|", rc);
+    rc = feed_rpc(&rpc, "}\n");
+    output_ptr += sprintf(output_ptr, "%d", rc);
+    update_result(output, "{\"id\":1,\"output\":\"port 3\\n\",\"rc\":0,\"usec\":T}\n"
+                  "{\"id\":2,\"output\":\"port 0\\n\",\"rc\":1,\"usec\":T}\n"
+                  "{\"id\":\"a\\\"b\",\"output\":\"a \\\"b\\\"\\tc\\\\d\\u0001\\n\",\"rc\":0,\"usec\":T}\n"
+                  "{\"id\":4,\"output\":\"port 5\\n\",\"rc\":0,\"usec\":T}\n"
+                  "{\"id\":5,\"output\":\"\",\"rc\":5,\"usec\":T}\n"
+                  "{\"id\":6,\"output\":\"\",\"rc\":6,\"usec\":T}\n"
+                  "{\"id\":7,\"output\":\"\",\"rc\":2,\"usec\":T}\n"
+                  "{\"id\":8,\"output\":\"\",\"rc\":2,\"usec\":T}\n"
+                  "{\"id\":9,\"output\":\"\",\"rc\":2,\"usec\":T}\n"
+                  "0|{\"id\":10,\"output\":\"port 1\\n\",\"rc\":0,\"usec\":T}\n"
+                  "0", "JSON requests");
+
+    /* Test requests split into single bytes and a long command line */
+    BZERO_OUTPUT;
+    strcpy(buf, "{\"id\":1,\"cmd\":\"show port 42\"}\n{\"id\":2,\"cmd\":\"");
+    for (n = 0; n < CPARSER_MAX_LINE_SIZE; n++) {
+        strcat(buf, "x");
+    }
+    strcat(buf, "\"}\n");
+    for (n = 0; buf[n]; n++) {
+        (void)cparser_rpc_input(&rpc, buf + n, 1, &used);
+    }
+    update_result(output, "{\"id\":1,\"output\":\"port 42\\n\",\"rc\":0,\"usec\":T}\n"
+                  "{\"id\":2,\"output\":\"\",\"rc\":4,\"usec\":T}\n",
+                  "split requests");
+
+    /* 
+     * Test a pending command. The requests after it wait until it 
+     * completes. 
+     */
+    BZERO_OUTPUT;
+    rc = feed_rpc(&rpc, "{\"id\":1,\"cmd\":\"show later\"}\n"
+                  "{\"id\":2,\"cmd\":\"show port 2\"}\n");
+    output_ptr += sprintf(output_ptr, "%d|%d|", rc, cparser_rpc_poll(&rpc));
+    output_ptr += sprintf(output_ptr, "%d|", cparser_rpc_fini(&rpc));
+    test_printc(&parser, '|');
+    (void)cparser_complete_async(&test_async, CPARSER_NOT_OK);
+    output_ptr += sprintf(output_ptr, "%d|", cparser_rpc_poll(&rpc));
+    output_ptr += sprintf(output_ptr, "%d", cparser_rpc_fini(&rpc));
+    update_result(output, "7|7|1||"
+                  "{\"id\":1,\"output\":\"started\\n\",\"rc\":1,\"usec\":T}\n"
+                  "{\"id\":2,\"output\":\"port 2\\n\",\"rc\":0,\"usec\":T}\n"
+                  "0|0", "pending command");
+
+    /* The parser is interactive again after cparser_rpc_fini() */
+    BZERO_OUTPUT;
+    feed_parser(&parser, "show port 7\n");
+    update_result(output, "show port 7 \nport 7\nT> ", "restored parser");
+
+    /* Test framed requests */
+    BZERO_OUTPUT;
+    rc = cparser_rpc_init(&rpc, &parser, CPARSER_RPC_FRAMED, 64, 
+                          test_send_frame, NULL, NULL);
+    pos = test_frame(buf, 7, "show port 9");
+    pos += test_frame(buf + pos, 0xfffffffe, "show port");
+    pos += test_frame(buf + pos, 3, "");
+    pos += test_frame(buf + pos, 4, "show po\x02 1");
+    rc = cparser_rpc_input(&rpc, buf, pos, &used);
+    output_ptr += sprintf(output_ptr, "|%d|%d|", rc, (int)(used == pos));
+    memcpy(buf, "\0\0\0\3", 4);
+    rc = cparser_rpc_input(&rpc, buf, 4, &used);
+    output_ptr += sprintf(output_ptr, "%d|", rc);
+    memcpy(buf, "\0\0\0\x80xxxx", 8);
+    rc = cparser_rpc_input(&rpc, buf, 8, &used);
+    output_ptr += sprintf(output_ptr, "%d|%d", rc, cparser_rpc_fini(&rpc));
+    update_result(output, "[7 0 port 9\n][4294967294 6 ][3 6 ][4 2 ]"
+                  "|0|1|1|1|0", "framed requests");
+
+    /* 
+     * Test many pipelined requests with a small buffer. The buffer is
+     * refilled as requests run.
+     */
+    BZERO_OUTPUT;
+    for (pos = 0, sum = 0, n = 0; n < TEST_NUM_PIPELINED; n++) {
+        pos += test_frame(frames + pos, n, "show port 1");
+        sum += n;
+    }
+    rc = cparser_rpc_init(&rpc, &parser, CPARSER_RPC_FRAMED, 256, 
+                          test_send_frame, NULL, NULL);
+    counting = 1;
+    num_responses = 0;
+    sum_ids = 0;
+    for (len = 0; (CPARSER_OK == rc) && (len < pos); len += used) {
+        rc = cparser_rpc_input(&rpc, frames + len, pos - len, &used);
+    }
+    counting = 0;
+    output_ptr += sprintf(output_ptr, "%d|%d|%d|%d", rc, 
+                          (int)(TEST_NUM_PIPELINED == num_responses),
+                          (int)(sum == sum_ids), cparser_rpc_fini(&rpc));
+    update_result(output, "0|1|1|0", "pipelined requests");
+
+    /*
+     * Test a tree published while a session is open. The parser moves
+     * to it at the next request and keeps it after cparser_rpc_fini().
+     */
+    BZERO_OUTPUT;
+    rc = cparser_tree_init(&v1, NULL, NULL);
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_add(&v1, "show port <UINT:n>", test_port_glue, 
+                              NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_handle_init(&handle, &v1, test_tree_free, NULL);
+    }
+    if (CPARSER_OK == rc) {
+        session_cfg = cfg;
+        session_cfg.tree = NULL;
+        session_cfg.handle = &handle;
+        rc = cparser_init(&session_cfg, &session);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_rpc_init(&rpc, &session, CPARSER_RPC_JSON, 1024, 
+                              test_send_json, NULL, NULL);
+    }
+    if (CPARSER_OK == rc) {
+        rc = cparser_tree_init(&v2, NULL, NULL);
+        if (CPARSER_OK == rc) {
+            rc = cparser_tree_add(&v2, "show vlan <UINT:n>", test_port_glue,
+                                  NULL);
+        }
+        if (CPARSER_OK == rc) {
+            rc = cparser_tree_publish(&handle, &v2, test_tree_free);
+        }
+        (void)feed_rpc(&rpc, "{\"id\":1,\"cmd\":\"show vlan 4\"}\n");
+        output_ptr += sprintf(output_ptr, "%d|", cparser_rpc_fini(&rpc));
+        output_ptr += sprintf(output_ptr, "%d|%d|", num_trees_freed,
+                              (int)(session.cfg.tree == &v2));
+        feed_parser(&session, "show vlan 5\n");
+        cparser_fini(&session);
+        output_ptr += sprintf(output_ptr, "|%d", 
+                              cparser_tree_handle_fini(&handle));
+    }
+    update_result(output, "{\"id\":1,\"output\":\"port 4\\n\",\"rc\":0,"
+                  "\"usec\":T}\n"
+                  "0|1|1|show vlan 5 \nport 5\nT> |0", "tree published");
+
+    cparser_fini(&parser);
+    cparser_tree_fini(&tree);
+    return test_report();
+}
@@ -187,7 +187,10 @@ int main (int argc, char *argv[])
     cparser_result_t result;
     cparser_node_t node;
     cparser_token_t token;
+    char token_buf[CPARSER_MAX_TOKEN_SIZE+1];
 
+    token.buf = token_buf;
+    memset(&node, 0, sizeof(node));
     for (n = 0; n < NELEM(match_testcases); n++) {
         node.type = match_testcases[n].type;
         node.param = match_testcases[n].param;
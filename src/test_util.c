@@ -0,0 +1,96 @@
+/**
+ * \file     test_util.c
+ * \brief    Helpers shared by the test programs.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "test_util.h"
+
+char output[TEST_OUTPUT_SIZE], *output_ptr = output;
+int num_passed = 0, num_failed = 0;
+
+void
+feed_parser (cparser_t *parser, const char *str)
+{
+    for (; *str; str++) {
+        cparser_input(parser, *str, CPARSER_CHAR_REGULAR);
+    }
+}
+
+void
+update_result (const char *got, const char *expected, const char *test)
+{
+    if (!strcmp(got, expected)) {
+        printf("\nPASS: %s\n", test);
+        num_passed++;
+    } else {
+        printf("\nFAIL: %s\nexpected=%s\ngot=%s\n", test, expected, got);
+        num_failed++;
+    }
+    fflush(stdout);
+}
+
+int
+test_report (void)
+{
+    printf("Total=%d  Passed=%d  Failed=%d\n", num_passed + num_failed,
+           num_passed, num_failed);
+    return num_failed;
+}
+
+void
+test_printc (const cparser_t *parser, const char ch)
+{
+    output_ptr += sprintf(output_ptr, "%c", ch);
+}
+
+void
+test_prints (const cparser_t *parser, const char *s)
+{
+    output_ptr += sprintf(output_ptr, "%s", s);
+}
+
+void
+test_cfg_init (cparser_cfg_t *cfg, cparser_tree_t *tree, const char *prompt)
+{
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->tree = tree;
+    cfg->ch_complete = '\t';
+    cfg->ch_erase = '\b';
+    cfg->ch_del = 127;
+    cfg->ch_help = '?';
+    strncpy(cfg->prompt, prompt, sizeof(cfg->prompt) - 1);
+    cfg->fd = -1;
+    cfg->printc = test_printc;
+    cfg->prints = test_prints;
+}
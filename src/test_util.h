@@ -0,0 +1,106 @@
+/**
+ * \file     test_util.h
+ * \brief    Helpers shared by the test programs.
+ * \version  \verbatim $Id$ \endverbatim
+ */
+/*
+ * Copyright (c) 2008, Henry Kwok
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the project nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY HENRY KWOK ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL HENRY KWOK BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __TEST_UTIL_H__
+#define __TEST_UTIL_H__
+
+#include <string.h>
+#include "cparser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Size of the output buffer */
+#define TEST_OUTPUT_SIZE  (20000)
+
+/** Zeroize the output buffer */
+#define BZERO_OUTPUT memset(output, 0, sizeof(output)); output_ptr = output
+
+/** Output of the parser. test_printc() and test_prints() append to it. */
+extern char output[TEST_OUTPUT_SIZE], *output_ptr;
+/** Number of the tests passed and failed */
+extern int num_passed, num_failed;
+
+/**
+ * \brief    Feed a string into a parser.
+ *
+ * \param    parser Pointer to the parser structure.
+ * \param    str    Characters to input.
+ */
+void feed_parser(cparser_t *parser, const char *str);
+
+/**
+ * \brief    Update the pass/fail counters and display a status string.
+ *
+ * \param    got      Output of the test.
+ * \param    expected Expected output.
+ * \param    test     Name of the test.
+ */
+void update_result(const char *got, const char *expected, const char *test);
+
+/**
+ * \brief    Print the number of the tests passed and failed.
+ *
+ * \return   Number of the tests failed.
+ */
+int test_report(void);
+
+/**
+ * \brief    Output function of a character that appends to 'output'.
+ */
+void test_printc(const cparser_t *parser, const char ch);
+
+/**
+ * \brief    Output function of a string that appends to 'output'.
+ */
+void test_prints(const cparser_t *parser, const char *s);
+
+/**
+ * \brief    Set up the configuration of a test parser.
+ * \details  The editing characters are the usual ones, there is no 
+ *           terminal and the output goes to test_printc() and 
+ *           test_prints().
+ *
+ * \param    cfg    Pointer to the configuration to set up.
+ * \param    tree   Parse tree of the parser. It can be NULL.
+ * \param    prompt Prompt of the parser.
+ */
+void test_cfg_init(cparser_cfg_t *cfg, cparser_tree_t *tree, 
+                   const char *prompt);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __TEST_UTIL_H__ */
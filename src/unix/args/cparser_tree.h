@@ -0,0 +1,48 @@
+/*----------------------------------------------------------------------
+ * This file is generated by mk_parser.py.
+ *----------------------------------------------------------------------*/
+#ifndef __CPARSER_TREE_H__
+#define __CPARSER_TREE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define CPARSER_NUM_GLUE 2
+#define CPARSER_NUM_CODECS 2
+
+extern const cparser_glue_fn cparser_glue_tbl[];
+extern const cparser_codec_t cparser_codec_tbl[];
+extern cparser_node_t cparser_root;
+
+
+/** Arguments of cparser_cmd_args_name_name_reports() */
+typedef struct cparser_args_args_name_name_reports_ {
+    struct {
+        unsigned reports : 1;
+    } has;
+    uint32_t reports;
+    char name[CPARSER_MAX_TOKEN_SIZE + 1];
+} cparser_args_args_name_name_reports_t;
+cparser_result_t cparser_cmd_args_name_name_reports(cparser_context_t *context,
+    const cparser_args_args_name_name_reports_t *args);
+#define CPARSER_ID_ARGS_NAME_NAME_REPORTS (0x7b485c74U)
+int cparser_enc_args_name_name_reports(void *buf, size_t size,
+    const cparser_args_args_name_name_reports_t *args);
+
+/** Arguments of cparser_cmd_args_pc_ipv4_state() */
+typedef struct cparser_args_args_pc_ipv4_state_ {
+    uint32_t ipv4;
+    char state[CPARSER_MAX_TOKEN_SIZE + 1];
+} cparser_args_args_pc_ipv4_state_t;
+cparser_result_t cparser_cmd_args_pc_ipv4_state(cparser_context_t *context,
+    const cparser_args_args_pc_ipv4_state_t *args);
+#define CPARSER_ID_ARGS_PC_IPV4_STATE (0xf24b4d08U)
+int cparser_enc_args_pc_ipv4_state(void *buf, size_t size,
+    const cparser_args_args_pc_ipv4_state_t *args);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __CPARSER_TREE_H__ */
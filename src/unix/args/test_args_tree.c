@@ -0,0 +1,45 @@
+/*----------------------------------------------------------------------
+ * This file is generated by mk_parser.py.
+ *----------------------------------------------------------------------*/
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_codec.h"
+#include "cparser_tree.h"
+
+cparser_result_t cparser_glue_args_name_name_reports(cparser_t *parser);
+cparser_result_t cparser_glue_args_pc_ipv4_state(cparser_t *parser);
+
+const cparser_glue_fn cparser_glue_tbl[] = {
+    cparser_glue_args_name_name_reports,
+    cparser_glue_args_pc_ipv4_state,
+};
+
+cparser_result_t cparser_dec_args_name_name_reports(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_args_pc_ipv4_state(cparser_t *parser, const void *data,
+    size_t len);
+
+const cparser_codec_t cparser_codec_tbl[] = {
+    { 0x7b485c74U, 5, "\000\000\000\001\000",
+      cparser_glue_args_name_name_reports, cparser_dec_args_name_name_reports },
+    { 0xf24b4d08U, 5, "\000\001\000\000\000",
+      cparser_glue_args_pc_ipv4_state, cparser_dec_args_pc_ipv4_state },
+};
+
+extern cparser_node_t cparser_node_args;
+
+cparser_node_t cparser_root = {
+    CPARSER_NODE_ROOT,
+    0,
+    0,
+    NULL,
+    "Root node of the parser tree",
+    NULL,
+    &cparser_node_args
+};
+
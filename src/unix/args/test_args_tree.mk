@@ -0,0 +1,3 @@
+# This file is generated by mk_parser.py.
+TEST_ARGS_TREE_SRC = test_args_tree.c \
+	test_args_tree_kw_args.c
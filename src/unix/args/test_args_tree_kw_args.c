@@ -0,0 +1,256 @@
+/*----------------------------------------------------------------------
+ * This file is generated by mk_parser.py.
+ *----------------------------------------------------------------------*/
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_codec.h"
+
+
+/** Arguments of cparser_cmd_args_name_name_reports() */
+typedef struct cparser_args_args_name_name_reports_ {
+    struct {
+        unsigned reports : 1;
+    } has;
+    uint32_t reports;
+    char name[CPARSER_MAX_TOKEN_SIZE + 1];
+} cparser_args_args_name_name_reports_t;
+cparser_result_t cparser_cmd_args_name_name_reports(cparser_context_t *context,
+    const cparser_args_args_name_name_reports_t *args);
+
+/** Arguments of cparser_cmd_args_pc_ipv4_state() */
+typedef struct cparser_args_args_pc_ipv4_state_ {
+    uint32_t ipv4;
+    char state[CPARSER_MAX_TOKEN_SIZE + 1];
+} cparser_args_args_pc_ipv4_state_t;
+cparser_result_t cparser_cmd_args_pc_ipv4_state(cparser_context_t *context,
+    const cparser_args_args_pc_ipv4_state_t *args);
+
+cparser_result_t
+cparser_glue_args_name_name_reports (cparser_t *parser)
+{
+    cparser_args_args_name_name_reports_t args;
+    cparser_result_t rc;
+
+    memset(&args, 0, sizeof(args));
+    rc = cparser_get_arg(&parser->tokens[2], CPARSER_NODE_STRING,
+                         &args.name, sizeof(args.name));
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    if (3 < parser->token_tos) {
+        rc = cparser_get_arg(&parser->tokens[3], CPARSER_NODE_UINT,
+                             &args.reports, sizeof(args.reports));
+        if (CPARSER_OK != rc) {
+            return rc;
+        }
+        args.has.reports = 1;
+    }
+    rc = cparser_cmd_args_name_name_reports(&parser->context, &args);
+    return rc;
+}
+
+int
+cparser_enc_args_name_name_reports (void *buf, size_t size,
+    const cparser_args_args_name_name_reports_t *args)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_STRING, 0, args->name);
+    cparser_encode_arg(&enc, CPARSER_NODE_UINT, 1,
+                       args->has.reports ? &args->reports : NULL);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_args_name_name_reports (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    cparser_args_args_name_name_reports_t args;
+    cparser_result_t rc;
+
+    memset(&args, 0, sizeof(args));
+    cparser_decoder_init(&dec, data, len);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_STRING, 0, args.name,
+                           sizeof(args.name), NULL);
+    args.has.reports = cparser_decode_arg(&dec, CPARSER_NODE_UINT, 1, &args.reports,
+                           sizeof(args.reports), NULL);
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_args_name_name_reports(&parser->context, &args);
+    return rc;
+}
+
+cparser_result_t
+cparser_glue_args_pc_ipv4_state (cparser_t *parser)
+{
+    cparser_args_args_pc_ipv4_state_t args;
+    cparser_result_t rc;
+
+    memset(&args, 0, sizeof(args));
+    rc = cparser_get_arg(&parser->tokens[2], CPARSER_NODE_IPV4ADDR,
+                         &args.ipv4, sizeof(args.ipv4));
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_get_arg(&parser->tokens[3], CPARSER_NODE_LIST,
+                         &args.state, sizeof(args.state));
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_args_pc_ipv4_state(&parser->context, &args);
+    return rc;
+}
+
+int
+cparser_enc_args_pc_ipv4_state (void *buf, size_t size,
+    const cparser_args_args_pc_ipv4_state_t *args)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_IPV4ADDR, 0, &args->ipv4);
+    cparser_encode_arg(&enc, CPARSER_NODE_LIST, 0, args->state);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_args_pc_ipv4_state (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    cparser_args_args_pc_ipv4_state_t args;
+    cparser_result_t rc;
+
+    memset(&args, 0, sizeof(args));
+    cparser_decoder_init(&dec, data, len);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_IPV4ADDR, 0, &args.ipv4,
+                           sizeof(args.ipv4), NULL);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_LIST, 0, args.state,
+                           sizeof(args.state), "on\0off\0");
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_args_pc_ipv4_state(&parser->context, &args);
+    return rc;
+}
+
+cparser_node_t cparser_node_args_pc_ipv4_state_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_args_pc_ipv4_state,
+    "Set the state of the PC of an employee",
+    NULL,
+    NULL
+};
+
+cparser_list_node_t cparser_list_node_args_pc_ipv4_state_off = {
+    NULL,
+    "off"
+ };
+
+cparser_list_node_t cparser_list_node_args_pc_ipv4_state_on = {
+    &cparser_list_node_args_pc_ipv4_state_off,
+    "on"
+ };
+
+cparser_node_t cparser_node_args_pc_ipv4_state = {
+    CPARSER_NODE_LIST,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    &cparser_list_node_args_pc_ipv4_state_on,
+    NULL,
+    NULL,
+    &cparser_node_args_pc_ipv4_state_eol
+};
+
+cparser_node_t cparser_node_args_pc_ipv4 = {
+    CPARSER_NODE_IPV4ADDR,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<IPV4ADDR:ipv4>",
+    NULL,
+    NULL,
+    &cparser_node_args_pc_ipv4_state
+};
+
+cparser_node_t cparser_node_args_pc = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    1,
+    "pc",
+    NULL,
+    NULL,
+    &cparser_node_args_pc_ipv4
+};
+
+cparser_node_t cparser_node_args_name_name_reports_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_args_name_name_reports,
+    "Set the name of an employee and optionally the number of reports",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_args_name_name_reports = {
+    CPARSER_NODE_UINT,
+    CPARSER_NODE_FLAGS_OPT_START | CPARSER_NODE_FLAGS_OPT_END | CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<UINT:reports>",
+    NULL,
+    NULL,
+    &cparser_node_args_name_name_reports_eol
+};
+
+cparser_node_t cparser_node_args_name_name_eol = {
+    CPARSER_NODE_END,
+    CPARSER_NODE_FLAGS_OPT_PARTIAL,
+    0,
+    cparser_glue_args_name_name_reports,
+    NULL,
+    &cparser_node_args_name_name_reports,
+    NULL
+};
+
+cparser_node_t cparser_node_args_name_name = {
+    CPARSER_NODE_STRING,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<STRING:name>",
+    NULL,
+    NULL,
+    &cparser_node_args_name_name_eol
+};
+
+cparser_node_t cparser_node_args_name = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    1,
+    "name",
+    NULL,
+    &cparser_node_args_pc,
+    &cparser_node_args_name_name
+};
+
+cparser_node_t cparser_node_args = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    1,
+    "args",
+    NULL,
+    NULL,
+    &cparser_node_args_name
+};
+
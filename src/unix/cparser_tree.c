@@ -0,0 +1,177 @@
+/*----------------------------------------------------------------------
+ * This file is generated by mk_parser.py.
+ *----------------------------------------------------------------------*/
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_codec.h"
+#include "cparser_tree.h"
+
+cparser_result_t cparser_glue_show_employees(cparser_t *parser);
+cparser_result_t cparser_glue_show_employees_all(cparser_t *parser);
+cparser_result_t cparser_glue_show_employees_by_id_min_max(cparser_t *parser);
+cparser_result_t cparser_glue_show_employee_id_field(cparser_t *parser);
+cparser_result_t cparser_glue_show_employee_id_bonus_factor(cparser_t *parser);
+cparser_result_t cparser_glue_employee_id(cparser_t *parser);
+cparser_result_t cparser_glue_emp_exit(cparser_t *parser);
+cparser_result_t cparser_glue_emp_name_name(cparser_t *parser);
+cparser_result_t cparser_glue_emp_date_of_birth_month_day_year(cparser_t *parser);
+cparser_result_t cparser_glue_emp_height_inches(cparser_t *parser);
+cparser_result_t cparser_glue_emp_weight_lbs(cparser_t *parser);
+cparser_result_t cparser_glue_emp_bonus_factor_scale(cparser_t *parser);
+cparser_result_t cparser_glue_emp_pc_ip_address_ipv4(cparser_t *parser);
+cparser_result_t cparser_glue_emp_pc_mac_address_addr(cparser_t *parser);
+cparser_result_t cparser_glue_emp_title_title(cparser_t *parser);
+cparser_result_t cparser_glue_emp_passcode_passcode(cparser_t *parser);
+cparser_result_t cparser_glue_emp_help_filter(cparser_t *parser);
+cparser_result_t cparser_glue_no_employee_id(cparser_t *parser);
+cparser_result_t cparser_glue_save_roster_filename(cparser_t *parser);
+cparser_result_t cparser_glue_load_roster_filename(cparser_t *parser);
+cparser_result_t cparser_glue_help_filter(cparser_t *parser);
+cparser_result_t cparser_glue_enable_privileged_mode(cparser_t *parser);
+cparser_result_t cparser_glue_disable_privileged_mode(cparser_t *parser);
+cparser_result_t cparser_glue_quit(cparser_t *parser);
+
+const cparser_glue_fn cparser_glue_tbl[] = {
+    cparser_glue_show_employees,
+    cparser_glue_show_employees_all,
+    cparser_glue_show_employees_by_id_min_max,
+    cparser_glue_show_employee_id_field,
+    cparser_glue_show_employee_id_bonus_factor,
+    cparser_glue_employee_id,
+    cparser_glue_emp_exit,
+    cparser_glue_emp_name_name,
+    cparser_glue_emp_date_of_birth_month_day_year,
+    cparser_glue_emp_height_inches,
+    cparser_glue_emp_weight_lbs,
+    cparser_glue_emp_bonus_factor_scale,
+    cparser_glue_emp_pc_ip_address_ipv4,
+    cparser_glue_emp_pc_mac_address_addr,
+    cparser_glue_emp_title_title,
+    cparser_glue_emp_passcode_passcode,
+    cparser_glue_emp_help_filter,
+    cparser_glue_no_employee_id,
+    cparser_glue_save_roster_filename,
+    cparser_glue_load_roster_filename,
+    cparser_glue_help_filter,
+    cparser_glue_enable_privileged_mode,
+    cparser_glue_disable_privileged_mode,
+    cparser_glue_quit,
+};
+
+cparser_result_t cparser_dec_show_employees(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_show_employees_all(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_show_employees_by_id_min_max(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_show_employee_id_field(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_show_employee_id_bonus_factor(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_employee_id(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_exit(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_name_name(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_date_of_birth_month_day_year(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_height_inches(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_weight_lbs(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_bonus_factor_scale(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_pc_ip_address_ipv4(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_pc_mac_address_addr(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_title_title(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_passcode_passcode(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_help_filter(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_no_employee_id(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_save_roster_filename(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_load_roster_filename(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_help_filter(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_enable_privileged_mode(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_disable_privileged_mode(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_quit(cparser_t *parser, const void *data,
+    size_t len);
+
+const cparser_codec_t cparser_codec_tbl[] = {
+    { 0x07ed66efU, 4, "\003\000\000\000",
+      cparser_glue_save_roster_filename, cparser_dec_save_roster_filename },
+    { 0x104cddfaU, 3, "\003\000\000",
+      cparser_glue_emp_height_inches, cparser_dec_emp_height_inches },
+    { 0x136149dfU, 3, "\007\000\000",
+      cparser_glue_emp_pc_mac_address_addr, cparser_dec_emp_pc_mac_address_addr },
+    { 0x232b0cd9U, 3, "\007\000\000",
+      cparser_glue_disable_privileged_mode, cparser_dec_disable_privileged_mode },
+    { 0x2855eb6eU, 2, "\010\000",
+      cparser_glue_quit, cparser_dec_quit },
+    { 0x3b225a21U, 3, "\010\000\000",
+      cparser_glue_emp_title_title, cparser_dec_emp_title_title },
+    { 0x4229e93fU, 5, "\000\001\001\001\000",
+      cparser_glue_show_employees_by_id_min_max, cparser_dec_show_employees_by_id_min_max },
+    { 0x46f0dd61U, 3, "\006\000\000",
+      cparser_glue_emp_pc_ip_address_ipv4, cparser_dec_emp_pc_ip_address_ipv4 },
+    { 0x4938e6f6U, 3, "\004\000\000",
+      cparser_glue_emp_weight_lbs, cparser_dec_emp_weight_lbs },
+    { 0x4c25784bU, 4, "\000\000\001\000",
+      cparser_glue_show_employees_all, cparser_dec_show_employees_all },
+    { 0x5373a0feU, 3, "\012\001\000",
+      cparser_glue_emp_help_filter, cparser_dec_emp_help_filter },
+    { 0x55f6f182U, 3, "\000\000\000",
+      cparser_glue_show_employees, cparser_dec_show_employees },
+    { 0x570caabeU, 5, "\002\000\000\000\000",
+      cparser_glue_emp_date_of_birth_month_day_year, cparser_dec_emp_date_of_birth_month_day_year },
+    { 0x586e1dfeU, 3, "\001\000\000",
+      cparser_glue_employee_id, cparser_dec_employee_id },
+    { 0x6a080d60U, 3, "\006\000\000",
+      cparser_glue_enable_privileged_mode, cparser_dec_enable_privileged_mode },
+    { 0x7c5f9ed9U, 3, "\011\000\000",
+      cparser_glue_emp_passcode_passcode, cparser_dec_emp_passcode_passcode },
+    { 0x83cf1c5cU, 5, "\000\002\000\000\000",
+      cparser_glue_show_employee_id_field, cparser_dec_show_employee_id_field },
+    { 0x9c2060eeU, 4, "\002\000\000\000",
+      cparser_glue_no_employee_id, cparser_dec_no_employee_id },
+    { 0xa5cccd88U, 3, "\001\000\000",
+      cparser_glue_emp_name_name, cparser_dec_emp_name_name },
+    { 0xac718e36U, 4, "\004\000\000\000",
+      cparser_glue_load_roster_filename, cparser_dec_load_roster_filename },
+    { 0xbbaf1f57U, 3, "\005\000\000",
+      cparser_glue_emp_bonus_factor_scale, cparser_dec_emp_bonus_factor_scale },
+    { 0xc29bf365U, 3, "\005\001\000",
+      cparser_glue_help_filter, cparser_dec_help_filter },
+    { 0xc3d086d8U, 5, "\000\002\000\001\000",
+      cparser_glue_show_employee_id_bonus_factor, cparser_dec_show_employee_id_bonus_factor },
+    { 0xd7787cb6U, 2, "\000\000",
+      cparser_glue_emp_exit, cparser_dec_emp_exit },
+};
+
+extern cparser_node_t cparser_node_show;
+
+cparser_node_t cparser_root = {
+    CPARSER_NODE_ROOT,
+    0,
+    0,
+    NULL,
+    "Root node of the parser tree",
+    NULL,
+    &cparser_node_show
+};
+
@@ -0,0 +1,12 @@
+# This file is generated by mk_parser.py.
+CPARSER_TREE_SRC = cparser_tree.c \
+	cparser_tree_kw_disable.c \
+	cparser_tree_kw_employee.c \
+	cparser_tree_kw_enable.c \
+	cparser_tree_kw_help.c \
+	cparser_tree_kw_load.c \
+	cparser_tree_kw_no.c \
+	cparser_tree_kw_quit.c \
+	cparser_tree_kw_save.c \
+	cparser_tree_kw_show.c \
+	cparser_tree_sm_employee_id_root.c
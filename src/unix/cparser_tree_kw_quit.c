@@ -0,0 +1,68 @@
+/*----------------------------------------------------------------------
+ * This file is generated by mk_parser.py.
+ *----------------------------------------------------------------------*/
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_codec.h"
+
+cparser_result_t cparser_cmd_quit(cparser_context_t *context);
+
+cparser_result_t
+cparser_glue_quit (cparser_t *parser)
+{
+    cparser_result_t rc;
+
+    rc = cparser_cmd_quit(&parser->context);
+    return rc;
+}
+
+int
+cparser_enc_quit (void *buf, size_t size)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_quit (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_quit(&parser->context);
+    return rc;
+}
+
+cparser_node_t cparser_node_quit_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_quit,
+    "Leave the database",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_quit = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    1,
+    "quit",
+    NULL,
+    NULL,
+    &cparser_node_quit_eol
+};
+
@@ -0,0 +1,465 @@
+/*----------------------------------------------------------------------
+ * This file is generated by mk_parser.py.
+ *----------------------------------------------------------------------*/
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_codec.h"
+
+cparser_result_t cparser_cmd_show_employees(cparser_context_t *context);
+cparser_result_t cparser_cmd_show_employees_all(cparser_context_t *context);
+cparser_result_t cparser_cmd_show_employees_by_id_min_max(cparser_context_t *context,
+    uint32_t *min_ptr,
+    uint32_t *max_ptr);
+cparser_result_t cparser_cmd_show_employee_id_field(cparser_context_t *context,
+    uint32_t *id_ptr,
+    char **field_ptr);
+cparser_result_t cparser_cmd_show_employee_id_bonus_factor(cparser_context_t *context,
+    uint32_t *id_ptr);
+
+extern cparser_node_t cparser_node_employee;
+
+cparser_result_t
+cparser_glue_show_employees (cparser_t *parser)
+{
+    cparser_result_t rc;
+
+    rc = cparser_cmd_show_employees(&parser->context);
+    return rc;
+}
+
+int
+cparser_enc_show_employees (void *buf, size_t size)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_show_employees (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_show_employees(&parser->context);
+    return rc;
+}
+
+cparser_result_t
+cparser_glue_show_employees_all (cparser_t *parser)
+{
+    cparser_result_t rc;
+
+    rc = cparser_cmd_show_employees_all(&parser->context);
+    return rc;
+}
+
+int
+cparser_enc_show_employees_all (void *buf, size_t size)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_show_employees_all (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_show_employees_all(&parser->context);
+    return rc;
+}
+
+cparser_result_t
+cparser_glue_show_employees_by_id_min_max (cparser_t *parser)
+{
+    uint32_t min_val;
+    uint32_t *min_ptr = NULL;
+    uint32_t max_val;
+    uint32_t *max_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_uint(&parser->tokens[2], &min_val);
+    if (CPARSER_OK == rc) {
+        min_ptr = &min_val;
+    } else {
+        assert(3 > parser->token_tos);
+    }
+    rc = cparser_get_uint(&parser->tokens[3], &max_val);
+    if (CPARSER_OK == rc) {
+        max_ptr = &max_val;
+    } else {
+        assert(4 > parser->token_tos);
+    }
+    rc = cparser_cmd_show_employees_by_id_min_max(&parser->context,
+        min_ptr,
+        max_ptr);
+    return rc;
+}
+
+int
+cparser_enc_show_employees_by_id_min_max (void *buf, size_t size,
+    uint32_t *min_ptr,
+    uint32_t *max_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_UINT, 1, min_ptr);
+    cparser_encode_arg(&enc, CPARSER_NODE_UINT, 1, max_ptr);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_show_employees_by_id_min_max (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    uint32_t min_val;
+    uint32_t *min_ptr = NULL;
+    uint32_t max_val;
+    uint32_t *max_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    if (cparser_decode_arg(&dec, CPARSER_NODE_UINT, 1, &min_val,
+                           sizeof(min_val), NULL)) {
+        min_ptr = &min_val;
+    }
+    if (cparser_decode_arg(&dec, CPARSER_NODE_UINT, 1, &max_val,
+                           sizeof(max_val), NULL)) {
+        max_ptr = &max_val;
+    }
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_show_employees_by_id_min_max(&parser->context,
+        min_ptr,
+        max_ptr);
+    return rc;
+}
+
+cparser_result_t
+cparser_glue_show_employee_id_field (cparser_t *parser)
+{
+    uint32_t id_val;
+    uint32_t *id_ptr = NULL;
+    char *field_val;
+    char **field_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_hex(&parser->tokens[2], &id_val);
+    assert(CPARSER_OK == rc);
+    id_ptr = &id_val;
+    rc = cparser_get_list(&parser->tokens[3], &field_val);
+    assert(CPARSER_OK == rc);
+    field_ptr = &field_val;
+    rc = cparser_cmd_show_employee_id_field(&parser->context,
+        id_ptr,
+        field_ptr);
+    return rc;
+}
+
+int
+cparser_enc_show_employee_id_field (void *buf, size_t size,
+    uint32_t *id_ptr,
+    char **field_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_HEX, 0, id_ptr);
+    cparser_encode_arg(&enc, CPARSER_NODE_LIST, 0,
+                       field_ptr ? *field_ptr : NULL);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_show_employee_id_field (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    uint32_t id_val;
+    uint32_t *id_ptr = NULL;
+    char field_buf[CPARSER_MAX_TOKEN_SIZE + 1];
+    char *field_val = field_buf;
+    char **field_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_HEX, 0, &id_val,
+                           sizeof(id_val), NULL);
+    id_ptr = &id_val;
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_LIST, 0, field_buf,
+                           sizeof(field_buf), "height\0weight\0date-of-birth\0title\0");
+    field_ptr = &field_val;
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_show_employee_id_field(&parser->context,
+        id_ptr,
+        field_ptr);
+    return rc;
+}
+
+cparser_result_t
+cparser_glue_show_employee_id_bonus_factor (cparser_t *parser)
+{
+    uint32_t id_val;
+    uint32_t *id_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_hex(&parser->tokens[2], &id_val);
+    assert(CPARSER_OK == rc);
+    id_ptr = &id_val;
+    rc = cparser_cmd_show_employee_id_bonus_factor(&parser->context,
+        id_ptr);
+    return rc;
+}
+
+int
+cparser_enc_show_employee_id_bonus_factor (void *buf, size_t size,
+    uint32_t *id_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_HEX, 0, id_ptr);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_show_employee_id_bonus_factor (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    uint32_t id_val;
+    uint32_t *id_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_HEX, 0, &id_val,
+                           sizeof(id_val), NULL);
+    id_ptr = &id_val;
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_show_employee_id_bonus_factor(&parser->context,
+        id_ptr);
+    return rc;
+}
+
+cparser_node_t cparser_node_show_employee_id_bonus_factor_eol = {
+    CPARSER_NODE_END,
+    CPARSER_NODE_FLAGS_HIDDEN,
+    0,
+    cparser_glue_show_employee_id_bonus_factor,
+    "Show the bonus factor of an employee.",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_show_employee_id_bonus_factor = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_HIDDEN | CPARSER_NODE_FLAGS_NO_OVERLAP,
+    1,
+    "bonus-factor",
+    NULL,
+    NULL,
+    &cparser_node_show_employee_id_bonus_factor_eol
+};
+
+cparser_node_t cparser_node_show_employee_id_field_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_show_employee_id_field,
+    "Show specific field of an employee.",
+    NULL,
+    NULL
+};
+
+cparser_list_node_t cparser_list_node_show_employee_id_field_title = {
+    NULL,
+    "title"
+ };
+
+cparser_list_node_t cparser_list_node_show_employee_id_field_date_of_birth = {
+    &cparser_list_node_show_employee_id_field_title,
+    "date-of-birth"
+ };
+
+cparser_list_node_t cparser_list_node_show_employee_id_field_weight = {
+    &cparser_list_node_show_employee_id_field_date_of_birth,
+    "weight"
+ };
+
+cparser_list_node_t cparser_list_node_show_employee_id_field_height = {
+    &cparser_list_node_show_employee_id_field_weight,
+    "height"
+ };
+
+cparser_node_t cparser_node_show_employee_id_field = {
+    CPARSER_NODE_LIST,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    &cparser_list_node_show_employee_id_field_height,
+    NULL,
+    &cparser_node_show_employee_id_bonus_factor,
+    &cparser_node_show_employee_id_field_eol
+};
+
+cparser_node_t cparser_node_show_employee_id = {
+    CPARSER_NODE_HEX,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<HEX:id>",
+    NULL,
+    NULL,
+    &cparser_node_show_employee_id_field
+};
+
+cparser_node_t cparser_node_show_employee = {
+    CPARSER_NODE_KEYWORD,
+    0,
+    9,
+    "employee",
+    NULL,
+    NULL,
+    &cparser_node_show_employee_id
+};
+
+cparser_node_t cparser_node_show_employees_by_id_min_max_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_show_employees_by_id_min_max,
+    "List all employees within a certain range of employee ids",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_show_employees_by_id_min_max = {
+    CPARSER_NODE_UINT,
+    CPARSER_NODE_FLAGS_OPT_START | CPARSER_NODE_FLAGS_OPT_END | CPARSER_NODE_FLAGS_OPT_END | CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<UINT:max>",
+    NULL,
+    NULL,
+    &cparser_node_show_employees_by_id_min_max_eol
+};
+
+cparser_node_t cparser_node_show_employees_by_id_min_eol = {
+    CPARSER_NODE_END,
+    CPARSER_NODE_FLAGS_OPT_PARTIAL,
+    0,
+    cparser_glue_show_employees_by_id_min_max,
+    NULL,
+    &cparser_node_show_employees_by_id_min_max,
+    NULL
+};
+
+cparser_node_t cparser_node_show_employees_by_id_min = {
+    CPARSER_NODE_UINT,
+    CPARSER_NODE_FLAGS_OPT_PARTIAL | CPARSER_NODE_FLAGS_OPT_START | CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<UINT:min>",
+    NULL,
+    NULL,
+    &cparser_node_show_employees_by_id_min_eol
+};
+
+cparser_node_t cparser_node_show_employees_by_id_eol = {
+    CPARSER_NODE_END,
+    CPARSER_NODE_FLAGS_OPT_PARTIAL,
+    0,
+    cparser_glue_show_employees_by_id_min_max,
+    NULL,
+    &cparser_node_show_employees_by_id_min,
+    NULL
+};
+
+cparser_node_t cparser_node_show_employees_by_id = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    10,
+    "employees-by-id",
+    NULL,
+    &cparser_node_show_employee,
+    &cparser_node_show_employees_by_id_eol
+};
+
+cparser_node_t cparser_node_show_employees_all_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_show_employees_all,
+    "List detail records of all employees.",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_show_employees_all = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    1,
+    "all",
+    NULL,
+    NULL,
+    &cparser_node_show_employees_all_eol
+};
+
+cparser_node_t cparser_node_show_employees_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_show_employees,
+    "List a summary of employees.",
+    &cparser_node_show_employees_all,
+    NULL
+};
+
+cparser_node_t cparser_node_show_employees = {
+    CPARSER_NODE_KEYWORD,
+    0,
+    10,
+    "employees",
+    NULL,
+    &cparser_node_show_employees_by_id,
+    &cparser_node_show_employees_eol
+};
+
+cparser_node_t cparser_node_show = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    2,
+    "show",
+    NULL,
+    &cparser_node_employee,
+    &cparser_node_show_employees
+};
+
@@ -0,0 +1,948 @@
+/*----------------------------------------------------------------------
+ * This file is generated by mk_parser.py.
+ *----------------------------------------------------------------------*/
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_codec.h"
+
+cparser_result_t cparser_cmd_emp_exit(cparser_context_t *context);
+cparser_result_t cparser_cmd_emp_name_name(cparser_context_t *context,
+    char **name_ptr);
+cparser_result_t cparser_cmd_emp_date_of_birth_month_day_year(cparser_context_t *context,
+    int32_t *month_ptr,
+    int32_t *day_ptr,
+    int32_t *year_ptr);
+cparser_result_t cparser_cmd_emp_height_inches(cparser_context_t *context,
+    uint32_t *inches_ptr);
+cparser_result_t cparser_cmd_emp_weight_lbs(cparser_context_t *context,
+    uint32_t *lbs_ptr);
+cparser_result_t cparser_cmd_emp_bonus_factor_scale(cparser_context_t *context,
+    double *scale_ptr);
+cparser_result_t cparser_cmd_emp_pc_ip_address_ipv4(cparser_context_t *context,
+    uint32_t *ipv4_ptr);
+cparser_result_t cparser_cmd_emp_pc_mac_address_addr(cparser_context_t *context,
+    cparser_macaddr_t *addr_ptr);
+cparser_result_t cparser_cmd_emp_title_title(cparser_context_t *context,
+    char **title_ptr);
+cparser_result_t cparser_cmd_emp_passcode_passcode(cparser_context_t *context,
+    uint64_t *passcode_ptr);
+cparser_result_t cparser_cmd_emp_help_filter(cparser_context_t *context,
+    char **filter_ptr);
+
+cparser_result_t
+cparser_glue_emp_exit (cparser_t *parser)
+{
+    cparser_result_t rc;
+
+    rc = cparser_cmd_emp_exit(&parser->context);
+    return rc;
+}
+
+int
+cparser_enc_emp_exit (void *buf, size_t size)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_emp_exit (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_emp_exit(&parser->context);
+    return rc;
+}
+
+cparser_result_t
+cparser_glue_emp_name_name (cparser_t *parser)
+{
+    char *name_val;
+    char **name_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_string(&parser->tokens[1], &name_val);
+    assert(CPARSER_OK == rc);
+    name_ptr = &name_val;
+    rc = cparser_cmd_emp_name_name(&parser->context,
+        name_ptr);
+    return rc;
+}
+
+int
+cparser_enc_emp_name_name (void *buf, size_t size,
+    char **name_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_STRING, 0,
+                       name_ptr ? *name_ptr : NULL);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_emp_name_name (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    char name_buf[CPARSER_MAX_TOKEN_SIZE + 1];
+    char *name_val = name_buf;
+    char **name_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_STRING, 0, name_buf,
+                           sizeof(name_buf), NULL);
+    name_ptr = &name_val;
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_emp_name_name(&parser->context,
+        name_ptr);
+    return rc;
+}
+
+cparser_result_t
+cparser_glue_emp_date_of_birth_month_day_year (cparser_t *parser)
+{
+    int32_t month_val;
+    int32_t *month_ptr = NULL;
+    int32_t day_val;
+    int32_t *day_ptr = NULL;
+    int32_t year_val;
+    int32_t *year_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_int(&parser->tokens[1], &month_val);
+    assert(CPARSER_OK == rc);
+    month_ptr = &month_val;
+    rc = cparser_get_int(&parser->tokens[2], &day_val);
+    assert(CPARSER_OK == rc);
+    day_ptr = &day_val;
+    rc = cparser_get_int(&parser->tokens[3], &year_val);
+    assert(CPARSER_OK == rc);
+    year_ptr = &year_val;
+    rc = cparser_cmd_emp_date_of_birth_month_day_year(&parser->context,
+        month_ptr,
+        day_ptr,
+        year_ptr);
+    return rc;
+}
+
+int
+cparser_enc_emp_date_of_birth_month_day_year (void *buf, size_t size,
+    int32_t *month_ptr,
+    int32_t *day_ptr,
+    int32_t *year_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_INT, 0, month_ptr);
+    cparser_encode_arg(&enc, CPARSER_NODE_INT, 0, day_ptr);
+    cparser_encode_arg(&enc, CPARSER_NODE_INT, 0, year_ptr);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_emp_date_of_birth_month_day_year (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    int32_t month_val;
+    int32_t *month_ptr = NULL;
+    int32_t day_val;
+    int32_t *day_ptr = NULL;
+    int32_t year_val;
+    int32_t *year_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_INT, 0, &month_val,
+                           sizeof(month_val), NULL);
+    month_ptr = &month_val;
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_INT, 0, &day_val,
+                           sizeof(day_val), NULL);
+    day_ptr = &day_val;
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_INT, 0, &year_val,
+                           sizeof(year_val), NULL);
+    year_ptr = &year_val;
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_emp_date_of_birth_month_day_year(&parser->context,
+        month_ptr,
+        day_ptr,
+        year_ptr);
+    return rc;
+}
+
+cparser_result_t
+cparser_glue_emp_height_inches (cparser_t *parser)
+{
+    uint32_t inches_val;
+    uint32_t *inches_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_uint(&parser->tokens[1], &inches_val);
+    assert(CPARSER_OK == rc);
+    inches_ptr = &inches_val;
+    rc = cparser_cmd_emp_height_inches(&parser->context,
+        inches_ptr);
+    return rc;
+}
+
+int
+cparser_enc_emp_height_inches (void *buf, size_t size,
+    uint32_t *inches_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_UINT, 0, inches_ptr);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_emp_height_inches (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    uint32_t inches_val;
+    uint32_t *inches_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_UINT, 0, &inches_val,
+                           sizeof(inches_val), NULL);
+    inches_ptr = &inches_val;
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_emp_height_inches(&parser->context,
+        inches_ptr);
+    return rc;
+}
+
+cparser_result_t
+cparser_glue_emp_weight_lbs (cparser_t *parser)
+{
+    uint32_t lbs_val;
+    uint32_t *lbs_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_uint(&parser->tokens[1], &lbs_val);
+    assert(CPARSER_OK == rc);
+    lbs_ptr = &lbs_val;
+    rc = cparser_cmd_emp_weight_lbs(&parser->context,
+        lbs_ptr);
+    return rc;
+}
+
+int
+cparser_enc_emp_weight_lbs (void *buf, size_t size,
+    uint32_t *lbs_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_UINT, 0, lbs_ptr);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_emp_weight_lbs (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    uint32_t lbs_val;
+    uint32_t *lbs_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_UINT, 0, &lbs_val,
+                           sizeof(lbs_val), NULL);
+    lbs_ptr = &lbs_val;
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_emp_weight_lbs(&parser->context,
+        lbs_ptr);
+    return rc;
+}
+
+cparser_result_t
+cparser_glue_emp_bonus_factor_scale (cparser_t *parser)
+{
+    double scale_val;
+    double *scale_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_float(&parser->tokens[1], &scale_val);
+    assert(CPARSER_OK == rc);
+    scale_ptr = &scale_val;
+    rc = cparser_cmd_emp_bonus_factor_scale(&parser->context,
+        scale_ptr);
+    return rc;
+}
+
+int
+cparser_enc_emp_bonus_factor_scale (void *buf, size_t size,
+    double *scale_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_FLOAT, 0, scale_ptr);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_emp_bonus_factor_scale (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    double scale_val;
+    double *scale_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_FLOAT, 0, &scale_val,
+                           sizeof(scale_val), NULL);
+    scale_ptr = &scale_val;
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_emp_bonus_factor_scale(&parser->context,
+        scale_ptr);
+    return rc;
+}
+
+cparser_result_t
+cparser_glue_emp_pc_ip_address_ipv4 (cparser_t *parser)
+{
+    uint32_t ipv4_val;
+    uint32_t *ipv4_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_ipv4addr(&parser->tokens[1], &ipv4_val);
+    assert(CPARSER_OK == rc);
+    ipv4_ptr = &ipv4_val;
+    rc = cparser_cmd_emp_pc_ip_address_ipv4(&parser->context,
+        ipv4_ptr);
+    return rc;
+}
+
+int
+cparser_enc_emp_pc_ip_address_ipv4 (void *buf, size_t size,
+    uint32_t *ipv4_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_IPV4ADDR, 0, ipv4_ptr);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_emp_pc_ip_address_ipv4 (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    uint32_t ipv4_val;
+    uint32_t *ipv4_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_IPV4ADDR, 0, &ipv4_val,
+                           sizeof(ipv4_val), NULL);
+    ipv4_ptr = &ipv4_val;
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_emp_pc_ip_address_ipv4(&parser->context,
+        ipv4_ptr);
+    return rc;
+}
+
+cparser_result_t
+cparser_glue_emp_pc_mac_address_addr (cparser_t *parser)
+{
+    cparser_macaddr_t addr_val;
+    cparser_macaddr_t *addr_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_macaddr(&parser->tokens[1], &addr_val);
+    assert(CPARSER_OK == rc);
+    addr_ptr = &addr_val;
+    rc = cparser_cmd_emp_pc_mac_address_addr(&parser->context,
+        addr_ptr);
+    return rc;
+}
+
+int
+cparser_enc_emp_pc_mac_address_addr (void *buf, size_t size,
+    cparser_macaddr_t *addr_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_MACADDR, 0, addr_ptr);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_emp_pc_mac_address_addr (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    cparser_macaddr_t addr_val;
+    cparser_macaddr_t *addr_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_MACADDR, 0, &addr_val,
+                           sizeof(addr_val), NULL);
+    addr_ptr = &addr_val;
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_emp_pc_mac_address_addr(&parser->context,
+        addr_ptr);
+    return rc;
+}
+
+cparser_result_t
+cparser_glue_emp_title_title (cparser_t *parser)
+{
+    char *title_val;
+    char **title_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_string(&parser->tokens[1], &title_val);
+    assert(CPARSER_OK == rc);
+    title_ptr = &title_val;
+    rc = cparser_cmd_emp_title_title(&parser->context,
+        title_ptr);
+    return rc;
+}
+
+int
+cparser_enc_emp_title_title (void *buf, size_t size,
+    char **title_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_STRING, 0,
+                       title_ptr ? *title_ptr : NULL);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_emp_title_title (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    char title_buf[CPARSER_MAX_TOKEN_SIZE + 1];
+    char *title_val = title_buf;
+    char **title_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_STRING, 0, title_buf,
+                           sizeof(title_buf), NULL);
+    title_ptr = &title_val;
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_emp_title_title(&parser->context,
+        title_ptr);
+    return rc;
+}
+
+cparser_result_t
+cparser_glue_emp_passcode_passcode (cparser_t *parser)
+{
+    uint64_t passcode_val;
+    uint64_t *passcode_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_hex64(&parser->tokens[1], &passcode_val);
+    assert(CPARSER_OK == rc);
+    passcode_ptr = &passcode_val;
+    rc = cparser_cmd_emp_passcode_passcode(&parser->context,
+        passcode_ptr);
+    return rc;
+}
+
+int
+cparser_enc_emp_passcode_passcode (void *buf, size_t size,
+    uint64_t *passcode_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_HEX64, 0, passcode_ptr);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_emp_passcode_passcode (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    uint64_t passcode_val;
+    uint64_t *passcode_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_HEX64, 0, &passcode_val,
+                           sizeof(passcode_val), NULL);
+    passcode_ptr = &passcode_val;
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_emp_passcode_passcode(&parser->context,
+        passcode_ptr);
+    return rc;
+}
+
+cparser_result_t
+cparser_glue_emp_help_filter (cparser_t *parser)
+{
+    char *filter_val;
+    char **filter_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_string(&parser->tokens[1], &filter_val);
+    if (CPARSER_OK == rc) {
+        filter_ptr = &filter_val;
+    } else {
+        assert(2 > parser->token_tos);
+    }
+    rc = cparser_cmd_emp_help_filter(&parser->context,
+        filter_ptr);
+    return rc;
+}
+
+int
+cparser_enc_emp_help_filter (void *buf, size_t size,
+    char **filter_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_STRING, 1,
+                       filter_ptr ? *filter_ptr : NULL);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_emp_help_filter (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    char filter_buf[CPARSER_MAX_TOKEN_SIZE + 1];
+    char *filter_val = filter_buf;
+    char **filter_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    if (cparser_decode_arg(&dec, CPARSER_NODE_STRING, 1, filter_buf,
+                           sizeof(filter_buf), NULL)) {
+        filter_ptr = &filter_val;
+    }
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_emp_help_filter(&parser->context,
+        filter_ptr);
+    return rc;
+}
+
+cparser_node_t cparser_node_employee_id_root_help_filter_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_emp_help_filter,
+    "List all available commands with a substring 'filter' in it.",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_employee_id_root_help_filter = {
+    CPARSER_NODE_STRING,
+    CPARSER_NODE_FLAGS_OPT_START | CPARSER_NODE_FLAGS_OPT_END | CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<STRING:filter>",
+    NULL,
+    NULL,
+    &cparser_node_employee_id_root_help_filter_eol
+};
+
+cparser_node_t cparser_node_employee_id_root_help_eol = {
+    CPARSER_NODE_END,
+    CPARSER_NODE_FLAGS_OPT_PARTIAL,
+    0,
+    cparser_glue_emp_help_filter,
+    NULL,
+    &cparser_node_employee_id_root_help_filter,
+    NULL
+};
+
+cparser_node_t cparser_node_employee_id_root_help = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    3,
+    "help",
+    NULL,
+    NULL,
+    &cparser_node_employee_id_root_help_eol
+};
+
+cparser_node_t cparser_node_employee_id_root_passcode_passcode_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_emp_passcode_passcode,
+    "Security passcode",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_employee_id_root_passcode_passcode = {
+    CPARSER_NODE_HEX64,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<HEX64:passcode>",
+    NULL,
+    NULL,
+    &cparser_node_employee_id_root_passcode_passcode_eol
+};
+
+cparser_node_t cparser_node_employee_id_root_passcode = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    2,
+    "passcode",
+    NULL,
+    &cparser_node_employee_id_root_help,
+    &cparser_node_employee_id_root_passcode_passcode
+};
+
+cparser_node_t cparser_node_employee_id_root_title_title_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_emp_title_title,
+    "Title",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_employee_id_root_title_title = {
+    CPARSER_NODE_STRING,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<STRING:title>",
+    NULL,
+    NULL,
+    &cparser_node_employee_id_root_title_title_eol
+};
+
+cparser_node_t cparser_node_employee_id_root_title = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    1,
+    "title",
+    NULL,
+    &cparser_node_employee_id_root_passcode,
+    &cparser_node_employee_id_root_title_title
+};
+
+cparser_node_t cparser_node_employee_id_root_pc_mac_address_addr_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_emp_pc_mac_address_addr,
+    "Employee's PC MAC address",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_employee_id_root_pc_mac_address_addr = {
+    CPARSER_NODE_MACADDR,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<MACADDR:addr>",
+    NULL,
+    NULL,
+    &cparser_node_employee_id_root_pc_mac_address_addr_eol
+};
+
+cparser_node_t cparser_node_employee_id_root_pc_mac_address = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    4,
+    "pc-mac-address",
+    NULL,
+    &cparser_node_employee_id_root_title,
+    &cparser_node_employee_id_root_pc_mac_address_addr
+};
+
+cparser_node_t cparser_node_employee_id_root_pc_ip_address_ipv4_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_emp_pc_ip_address_ipv4,
+    "Employee's PC IP address",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_employee_id_root_pc_ip_address_ipv4 = {
+    CPARSER_NODE_IPV4ADDR,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<IPV4ADDR:ipv4>",
+    NULL,
+    NULL,
+    &cparser_node_employee_id_root_pc_ip_address_ipv4_eol
+};
+
+cparser_node_t cparser_node_employee_id_root_pc_ip_address = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    4,
+    "pc-ip-address",
+    NULL,
+    &cparser_node_employee_id_root_pc_mac_address,
+    &cparser_node_employee_id_root_pc_ip_address_ipv4
+};
+
+cparser_node_t cparser_node_employee_id_root_bonus_factor_scale_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_emp_bonus_factor_scale,
+    "Scaling factor for bonus",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_employee_id_root_bonus_factor_scale = {
+    CPARSER_NODE_FLOAT,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<FLOAT:scale>",
+    NULL,
+    NULL,
+    &cparser_node_employee_id_root_bonus_factor_scale_eol
+};
+
+cparser_node_t cparser_node_employee_id_root_bonus_factor = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    1,
+    "bonus-factor",
+    NULL,
+    &cparser_node_employee_id_root_pc_ip_address,
+    &cparser_node_employee_id_root_bonus_factor_scale
+};
+
+cparser_node_t cparser_node_employee_id_root_weight_lbs_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_emp_weight_lbs,
+    "Weight in lbs",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_employee_id_root_weight_lbs = {
+    CPARSER_NODE_UINT,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<UINT:lbs>",
+    NULL,
+    NULL,
+    &cparser_node_employee_id_root_weight_lbs_eol
+};
+
+cparser_node_t cparser_node_employee_id_root_weight = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    1,
+    "weight",
+    NULL,
+    &cparser_node_employee_id_root_bonus_factor,
+    &cparser_node_employee_id_root_weight_lbs
+};
+
+cparser_node_t cparser_node_employee_id_root_height_inches_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_emp_height_inches,
+    "Height in inches",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_employee_id_root_height_inches = {
+    CPARSER_NODE_UINT,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<UINT:inches>",
+    NULL,
+    NULL,
+    &cparser_node_employee_id_root_height_inches_eol
+};
+
+cparser_node_t cparser_node_employee_id_root_height = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    3,
+    "height",
+    NULL,
+    &cparser_node_employee_id_root_weight,
+    &cparser_node_employee_id_root_height_inches
+};
+
+cparser_node_t cparser_node_employee_id_root_date_of_birth_month_day_year_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_emp_date_of_birth_month_day_year,
+    "Date of birth",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_employee_id_root_date_of_birth_month_day_year = {
+    CPARSER_NODE_INT,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<INT:year>",
+    NULL,
+    NULL,
+    &cparser_node_employee_id_root_date_of_birth_month_day_year_eol
+};
+
+cparser_node_t cparser_node_employee_id_root_date_of_birth_month_day = {
+    CPARSER_NODE_INT,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<INT:day>",
+    NULL,
+    NULL,
+    &cparser_node_employee_id_root_date_of_birth_month_day_year
+};
+
+cparser_node_t cparser_node_employee_id_root_date_of_birth_month = {
+    CPARSER_NODE_INT,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<INT:month>",
+    NULL,
+    NULL,
+    &cparser_node_employee_id_root_date_of_birth_month_day
+};
+
+cparser_node_t cparser_node_employee_id_root_date_of_birth = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    1,
+    "date-of-birth",
+    NULL,
+    &cparser_node_employee_id_root_height,
+    &cparser_node_employee_id_root_date_of_birth_month
+};
+
+cparser_node_t cparser_node_employee_id_root_name_name_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_emp_name_name,
+    "Name",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_employee_id_root_name_name = {
+    CPARSER_NODE_STRING,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    0,
+    "<STRING:name>",
+    NULL,
+    NULL,
+    &cparser_node_employee_id_root_name_name_eol
+};
+
+cparser_node_t cparser_node_employee_id_root_name = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    1,
+    "name",
+    NULL,
+    &cparser_node_employee_id_root_date_of_birth,
+    &cparser_node_employee_id_root_name_name
+};
+
+cparser_node_t cparser_node_employee_id_root_exit_eol = {
+    CPARSER_NODE_END,
+    0,
+    0,
+    cparser_glue_emp_exit,
+    "Exit employee submode",
+    NULL,
+    NULL
+};
+
+cparser_node_t cparser_node_employee_id_root_exit = {
+    CPARSER_NODE_KEYWORD,
+    CPARSER_NODE_FLAGS_NO_OVERLAP,
+    1,
+    "exit",
+    NULL,
+    &cparser_node_employee_id_root_name,
+    &cparser_node_employee_id_root_exit_eol
+};
+
+cparser_node_t cparser_node_employee_id_root = {
+    CPARSER_NODE_ROOT,
+    0,
+    0,
+    NULL,
+    "Root of submode emp",
+    NULL,
+    &cparser_node_employee_id_root_exit
+};
+
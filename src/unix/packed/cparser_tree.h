@@ -0,0 +1,139 @@
+/*----------------------------------------------------------------------
+ * This file is generated by mk_parser.py.
+ *----------------------------------------------------------------------*/
+#ifndef __CPARSER_TREE_H__
+#define __CPARSER_TREE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define CPARSER_NUM_GLUE 24
+#define CPARSER_NUM_CODECS 24
+
+extern const cparser_glue_fn cparser_glue_tbl[];
+extern const cparser_codec_t cparser_codec_tbl[];
+extern cparser_tree_t cparser_tree;
+
+cparser_result_t cparser_cmd_show_employees(cparser_context_t *context);
+#define CPARSER_ID_SHOW_EMPLOYEES (0x55f6f182U)
+int cparser_enc_show_employees(void *buf, size_t size);
+cparser_result_t cparser_cmd_show_employees_all(cparser_context_t *context);
+#define CPARSER_ID_SHOW_EMPLOYEES_ALL (0x4c25784bU)
+int cparser_enc_show_employees_all(void *buf, size_t size);
+cparser_result_t cparser_cmd_show_employees_by_id_min_max(cparser_context_t *context,
+    uint32_t *min_ptr,
+    uint32_t *max_ptr);
+#define CPARSER_ID_SHOW_EMPLOYEES_BY_ID_MIN_MAX (0x4229e93fU)
+int cparser_enc_show_employees_by_id_min_max(void *buf, size_t size,
+    uint32_t *min_ptr,
+    uint32_t *max_ptr);
+cparser_result_t cparser_cmd_show_employee_id_field(cparser_context_t *context,
+    uint32_t *id_ptr,
+    char **field_ptr);
+#define CPARSER_ID_SHOW_EMPLOYEE_ID_FIELD (0x83cf1c5cU)
+int cparser_enc_show_employee_id_field(void *buf, size_t size,
+    uint32_t *id_ptr,
+    char **field_ptr);
+cparser_result_t cparser_cmd_show_employee_id_bonus_factor(cparser_context_t *context,
+    uint32_t *id_ptr);
+#define CPARSER_ID_SHOW_EMPLOYEE_ID_BONUS_FACTOR (0xc3d086d8U)
+int cparser_enc_show_employee_id_bonus_factor(void *buf, size_t size,
+    uint32_t *id_ptr);
+cparser_result_t cparser_cmd_employee_id(cparser_context_t *context,
+    uint32_t *id_ptr);
+#define CPARSER_ID_EMPLOYEE_ID (0x586e1dfeU)
+int cparser_enc_employee_id(void *buf, size_t size,
+    uint32_t *id_ptr);
+cparser_result_t cparser_cmd_emp_exit(cparser_context_t *context);
+#define CPARSER_ID_EMP_EXIT (0xd7787cb6U)
+int cparser_enc_emp_exit(void *buf, size_t size);
+cparser_result_t cparser_cmd_emp_name_name(cparser_context_t *context,
+    char **name_ptr);
+#define CPARSER_ID_EMP_NAME_NAME (0xa5cccd88U)
+int cparser_enc_emp_name_name(void *buf, size_t size,
+    char **name_ptr);
+cparser_result_t cparser_cmd_emp_date_of_birth_month_day_year(cparser_context_t *context,
+    int32_t *month_ptr,
+    int32_t *day_ptr,
+    int32_t *year_ptr);
+#define CPARSER_ID_EMP_DATE_OF_BIRTH_MONTH_DAY_YEAR (0x570caabeU)
+int cparser_enc_emp_date_of_birth_month_day_year(void *buf, size_t size,
+    int32_t *month_ptr,
+    int32_t *day_ptr,
+    int32_t *year_ptr);
+cparser_result_t cparser_cmd_emp_height_inches(cparser_context_t *context,
+    uint32_t *inches_ptr);
+#define CPARSER_ID_EMP_HEIGHT_INCHES (0x104cddfaU)
+int cparser_enc_emp_height_inches(void *buf, size_t size,
+    uint32_t *inches_ptr);
+cparser_result_t cparser_cmd_emp_weight_lbs(cparser_context_t *context,
+    uint32_t *lbs_ptr);
+#define CPARSER_ID_EMP_WEIGHT_LBS (0x4938e6f6U)
+int cparser_enc_emp_weight_lbs(void *buf, size_t size,
+    uint32_t *lbs_ptr);
+cparser_result_t cparser_cmd_emp_bonus_factor_scale(cparser_context_t *context,
+    double *scale_ptr);
+#define CPARSER_ID_EMP_BONUS_FACTOR_SCALE (0xbbaf1f57U)
+int cparser_enc_emp_bonus_factor_scale(void *buf, size_t size,
+    double *scale_ptr);
+cparser_result_t cparser_cmd_emp_pc_ip_address_ipv4(cparser_context_t *context,
+    uint32_t *ipv4_ptr);
+#define CPARSER_ID_EMP_PC_IP_ADDRESS_IPV4 (0x46f0dd61U)
+int cparser_enc_emp_pc_ip_address_ipv4(void *buf, size_t size,
+    uint32_t *ipv4_ptr);
+cparser_result_t cparser_cmd_emp_pc_mac_address_addr(cparser_context_t *context,
+    cparser_macaddr_t *addr_ptr);
+#define CPARSER_ID_EMP_PC_MAC_ADDRESS_ADDR (0x136149dfU)
+int cparser_enc_emp_pc_mac_address_addr(void *buf, size_t size,
+    cparser_macaddr_t *addr_ptr);
+cparser_result_t cparser_cmd_emp_title_title(cparser_context_t *context,
+    char **title_ptr);
+#define CPARSER_ID_EMP_TITLE_TITLE (0x3b225a21U)
+int cparser_enc_emp_title_title(void *buf, size_t size,
+    char **title_ptr);
+cparser_result_t cparser_cmd_emp_passcode_passcode(cparser_context_t *context,
+    uint64_t *passcode_ptr);
+#define CPARSER_ID_EMP_PASSCODE_PASSCODE (0x7c5f9ed9U)
+int cparser_enc_emp_passcode_passcode(void *buf, size_t size,
+    uint64_t *passcode_ptr);
+cparser_result_t cparser_cmd_emp_help_filter(cparser_context_t *context,
+    char **filter_ptr);
+#define CPARSER_ID_EMP_HELP_FILTER (0x5373a0feU)
+int cparser_enc_emp_help_filter(void *buf, size_t size,
+    char **filter_ptr);
+cparser_result_t cparser_cmd_no_employee_id(cparser_context_t *context,
+    uint32_t *id_ptr);
+#define CPARSER_ID_NO_EMPLOYEE_ID (0x9c2060eeU)
+int cparser_enc_no_employee_id(void *buf, size_t size,
+    uint32_t *id_ptr);
+cparser_result_t cparser_cmd_save_roster_filename(cparser_context_t *context,
+    char **filename_ptr);
+#define CPARSER_ID_SAVE_ROSTER_FILENAME (0x07ed66efU)
+int cparser_enc_save_roster_filename(void *buf, size_t size,
+    char **filename_ptr);
+cparser_result_t cparser_cmd_load_roster_filename(cparser_context_t *context,
+    char **filename_ptr);
+#define CPARSER_ID_LOAD_ROSTER_FILENAME (0xac718e36U)
+int cparser_enc_load_roster_filename(void *buf, size_t size,
+    char **filename_ptr);
+cparser_result_t cparser_cmd_help_filter(cparser_context_t *context,
+    char **filter_ptr);
+#define CPARSER_ID_HELP_FILTER (0xc29bf365U)
+int cparser_enc_help_filter(void *buf, size_t size,
+    char **filter_ptr);
+cparser_result_t cparser_cmd_enable_privileged_mode(cparser_context_t *context);
+#define CPARSER_ID_ENABLE_PRIVILEGED_MODE (0x6a080d60U)
+int cparser_enc_enable_privileged_mode(void *buf, size_t size);
+cparser_result_t cparser_cmd_disable_privileged_mode(cparser_context_t *context);
+#define CPARSER_ID_DISABLE_PRIVILEGED_MODE (0x232b0cd9U)
+int cparser_enc_disable_privileged_mode(void *buf, size_t size);
+cparser_result_t cparser_cmd_quit(cparser_context_t *context);
+#define CPARSER_ID_QUIT (0x2855eb6eU)
+int cparser_enc_quit(void *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __CPARSER_TREE_H__ */
@@ -0,0 +1,422 @@
+/*----------------------------------------------------------------------
+ * This file is generated by mk_parser.py.
+ *----------------------------------------------------------------------*/
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_codec.h"
+#include "cparser_tree.h"
+
+cparser_result_t cparser_glue_show_employees(cparser_t *parser);
+cparser_result_t cparser_glue_show_employees_all(cparser_t *parser);
+cparser_result_t cparser_glue_show_employees_by_id_min_max(cparser_t *parser);
+cparser_result_t cparser_glue_show_employee_id_field(cparser_t *parser);
+cparser_result_t cparser_glue_show_employee_id_bonus_factor(cparser_t *parser);
+cparser_result_t cparser_glue_employee_id(cparser_t *parser);
+cparser_result_t cparser_glue_emp_exit(cparser_t *parser);
+cparser_result_t cparser_glue_emp_name_name(cparser_t *parser);
+cparser_result_t cparser_glue_emp_date_of_birth_month_day_year(cparser_t *parser);
+cparser_result_t cparser_glue_emp_height_inches(cparser_t *parser);
+cparser_result_t cparser_glue_emp_weight_lbs(cparser_t *parser);
+cparser_result_t cparser_glue_emp_bonus_factor_scale(cparser_t *parser);
+cparser_result_t cparser_glue_emp_pc_ip_address_ipv4(cparser_t *parser);
+cparser_result_t cparser_glue_emp_pc_mac_address_addr(cparser_t *parser);
+cparser_result_t cparser_glue_emp_title_title(cparser_t *parser);
+cparser_result_t cparser_glue_emp_passcode_passcode(cparser_t *parser);
+cparser_result_t cparser_glue_emp_help_filter(cparser_t *parser);
+cparser_result_t cparser_glue_no_employee_id(cparser_t *parser);
+cparser_result_t cparser_glue_save_roster_filename(cparser_t *parser);
+cparser_result_t cparser_glue_load_roster_filename(cparser_t *parser);
+cparser_result_t cparser_glue_help_filter(cparser_t *parser);
+cparser_result_t cparser_glue_enable_privileged_mode(cparser_t *parser);
+cparser_result_t cparser_glue_disable_privileged_mode(cparser_t *parser);
+cparser_result_t cparser_glue_quit(cparser_t *parser);
+
+const cparser_glue_fn cparser_glue_tbl[] = {
+    cparser_glue_show_employees,
+    cparser_glue_show_employees_all,
+    cparser_glue_show_employees_by_id_min_max,
+    cparser_glue_show_employee_id_field,
+    cparser_glue_show_employee_id_bonus_factor,
+    cparser_glue_employee_id,
+    cparser_glue_emp_exit,
+    cparser_glue_emp_name_name,
+    cparser_glue_emp_date_of_birth_month_day_year,
+    cparser_glue_emp_height_inches,
+    cparser_glue_emp_weight_lbs,
+    cparser_glue_emp_bonus_factor_scale,
+    cparser_glue_emp_pc_ip_address_ipv4,
+    cparser_glue_emp_pc_mac_address_addr,
+    cparser_glue_emp_title_title,
+    cparser_glue_emp_passcode_passcode,
+    cparser_glue_emp_help_filter,
+    cparser_glue_no_employee_id,
+    cparser_glue_save_roster_filename,
+    cparser_glue_load_roster_filename,
+    cparser_glue_help_filter,
+    cparser_glue_enable_privileged_mode,
+    cparser_glue_disable_privileged_mode,
+    cparser_glue_quit,
+};
+
+cparser_result_t cparser_dec_show_employees(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_show_employees_all(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_show_employees_by_id_min_max(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_show_employee_id_field(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_show_employee_id_bonus_factor(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_employee_id(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_exit(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_name_name(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_date_of_birth_month_day_year(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_height_inches(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_weight_lbs(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_bonus_factor_scale(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_pc_ip_address_ipv4(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_pc_mac_address_addr(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_title_title(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_passcode_passcode(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_emp_help_filter(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_no_employee_id(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_save_roster_filename(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_load_roster_filename(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_help_filter(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_enable_privileged_mode(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_disable_privileged_mode(cparser_t *parser, const void *data,
+    size_t len);
+cparser_result_t cparser_dec_quit(cparser_t *parser, const void *data,
+    size_t len);
+
+const cparser_codec_t cparser_codec_tbl[] = {
+    { 0x07ed66efU, 4, "\003\000\000\000",
+      cparser_glue_save_roster_filename, cparser_dec_save_roster_filename },
+    { 0x104cddfaU, 3, "\003\000\000",
+      cparser_glue_emp_height_inches, cparser_dec_emp_height_inches },
+    { 0x136149dfU, 3, "\007\000\000",
+      cparser_glue_emp_pc_mac_address_addr, cparser_dec_emp_pc_mac_address_addr },
+    { 0x232b0cd9U, 3, "\007\000\000",
+      cparser_glue_disable_privileged_mode, cparser_dec_disable_privileged_mode },
+    { 0x2855eb6eU, 2, "\010\000",
+      cparser_glue_quit, cparser_dec_quit },
+    { 0x3b225a21U, 3, "\010\000\000",
+      cparser_glue_emp_title_title, cparser_dec_emp_title_title },
+    { 0x4229e93fU, 5, "\000\001\001\001\000",
+      cparser_glue_show_employees_by_id_min_max, cparser_dec_show_employees_by_id_min_max },
+    { 0x46f0dd61U, 3, "\006\000\000",
+      cparser_glue_emp_pc_ip_address_ipv4, cparser_dec_emp_pc_ip_address_ipv4 },
+    { 0x4938e6f6U, 3, "\004\000\000",
+      cparser_glue_emp_weight_lbs, cparser_dec_emp_weight_lbs },
+    { 0x4c25784bU, 4, "\000\000\001\000",
+      cparser_glue_show_employees_all, cparser_dec_show_employees_all },
+    { 0x5373a0feU, 3, "\012\001\000",
+      cparser_glue_emp_help_filter, cparser_dec_emp_help_filter },
+    { 0x55f6f182U, 3, "\000\000\000",
+      cparser_glue_show_employees, cparser_dec_show_employees },
+    { 0x570caabeU, 5, "\002\000\000\000\000",
+      cparser_glue_emp_date_of_birth_month_day_year, cparser_dec_emp_date_of_birth_month_day_year },
+    { 0x586e1dfeU, 3, "\001\000\000",
+      cparser_glue_employee_id, cparser_dec_employee_id },
+    { 0x6a080d60U, 3, "\006\000\000",
+      cparser_glue_enable_privileged_mode, cparser_dec_enable_privileged_mode },
+    { 0x7c5f9ed9U, 3, "\011\000\000",
+      cparser_glue_emp_passcode_passcode, cparser_dec_emp_passcode_passcode },
+    { 0x83cf1c5cU, 5, "\000\002\000\000\000",
+      cparser_glue_show_employee_id_field, cparser_dec_show_employee_id_field },
+    { 0x9c2060eeU, 4, "\002\000\000\000",
+      cparser_glue_no_employee_id, cparser_dec_no_employee_id },
+    { 0xa5cccd88U, 3, "\001\000\000",
+      cparser_glue_emp_name_name, cparser_dec_emp_name_name },
+    { 0xac718e36U, 4, "\004\000\000\000",
+      cparser_glue_load_roster_filename, cparser_dec_load_roster_filename },
+    { 0xbbaf1f57U, 3, "\005\000\000",
+      cparser_glue_emp_bonus_factor_scale, cparser_dec_emp_bonus_factor_scale },
+    { 0xc29bf365U, 3, "\005\001\000",
+      cparser_glue_help_filter, cparser_dec_help_filter },
+    { 0xc3d086d8U, 5, "\000\002\000\001\000",
+      cparser_glue_show_employee_id_bonus_factor, cparser_dec_show_employee_id_bonus_factor },
+    { 0xd7787cb6U, 2, "\000\000",
+      cparser_glue_emp_exit, cparser_dec_emp_exit },
+};
+
+static const struct {
+    cparser_pnode_t nodes[81];
+    cparser_plist_node_t lists[4];
+    char strings[430];
+} cparser_packed = {
+    {
+        { CPARSER_NODE_ROOT, CPARSER_NODE_FLAGS_PACKED, 0, 0, 0, 16 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 2, 1312, 272, 16 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED, 10, 1354, 64, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 0, 16, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 1360, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 1, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 10, 1411, 96, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_OPT_PARTIAL, 0, 2, 16, 0 },
+        { CPARSER_NODE_UINT, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_OPT_PARTIAL | CPARSER_NODE_FLAGS_OPT_START | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 1488, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_OPT_PARTIAL, 0, 2, 16, 0 },
+        { CPARSER_NODE_UINT, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_OPT_START | CPARSER_NODE_FLAGS_OPT_END | CPARSER_NODE_FLAGS_OPT_END | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 1378, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 2, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED, 9, 1281, 0, 16 },
+        { CPARSER_NODE_HEX, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 1525, 0, 16 },
+        { CPARSER_NODE_LIST, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 1072, 32, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 3, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_HIDDEN | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 1140, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_HIDDEN, 0, 4, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 2, 1185, 624, 16 },
+        { CPARSER_NODE_HEX, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 1429, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 5, 0, 16 },
+        { CPARSER_NODE_ROOT, CPARSER_NODE_FLAGS_PACKED, 0, 0, 0, 16 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 981, 32, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 6, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 1063, 48, 16 },
+        { CPARSER_NODE_STRING, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 1273, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 7, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 996, 80, 16 },
+        { CPARSER_NODE_INT, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 1179, 0, 16 },
+        { CPARSER_NODE_INT, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 1064, 0, 16 },
+        { CPARSER_NODE_INT, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 1125, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 8, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 3, 838, 48, 16 },
+        { CPARSER_NODE_UINT, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 1021, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 9, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 783, 48, 16 },
+        { CPARSER_NODE_UINT, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 987, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 10, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 788, 48, 16 },
+        { CPARSER_NODE_FLOAT, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 1078, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 11, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 4, 701, 48, 16 },
+        { CPARSER_NODE_IPV4ADDR, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 1070, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 12, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 4, 667, 48, 16 },
+        { CPARSER_NODE_MACADDR, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 870, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 13, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 700, 48, 16 },
+        { CPARSER_NODE_STRING, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 919, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 14, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 2, 698, 48, 16 },
+        { CPARSER_NODE_HEX64, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 900, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 15, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 3, 568, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_OPT_PARTIAL, 0, 16, 16, 0 },
+        { CPARSER_NODE_STRING, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_OPT_START | CPARSER_NODE_FLAGS_OPT_END | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 694, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 16, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 509, 64, 16 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 545, 0, 16 },
+        { CPARSER_NODE_HEX, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 789, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 17, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 2, 466, 64, 16 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 417, 0, 16 },
+        { CPARSER_NODE_STRING, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 631, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 18, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 483, 64, 16 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 353, 0, 16 },
+        { CPARSER_NODE_FILE, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 585, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 19, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 312, 64, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_OPT_PARTIAL, 0, 20, 16, 0 },
+        { CPARSER_NODE_STRING, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_OPT_START | CPARSER_NODE_FLAGS_OPT_END | CPARSER_NODE_FLAGS_NO_OVERLAP, 0, 438, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 20, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 2, 298, 48, 16 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 298, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 21, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_HIDDEN | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 242, 48, 16 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_HIDDEN | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 250, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_HIDDEN, 0, 22, 0, 0 },
+        { CPARSER_NODE_KEYWORD, CPARSER_NODE_FLAGS_PACKED | CPARSER_NODE_FLAGS_NO_OVERLAP, 1, 74, 0, 16 },
+        { CPARSER_NODE_END, CPARSER_NODE_FLAGS_PACKED, 0, 23, 0, 0 },
+    },
+    {
+        { 8, 54 },
+        { 8, 39 },
+        { 8, 116 },
+        { 0, 132 },
+    },
+    "show\000"
+    "exit\000"
+    "quit\000"
+    "weight\000"
+    "height\000"
+    "pc-ip-address\000"
+    "pc-mac-address\000"
+    "employees\000"
+    "bonus-factor\000"
+    "roster\000"
+    "help\000"
+    "no\000"
+    "all\000"
+    "date-of-birth\000"
+    "save\000"
+    "name\000"
+    "title\000"
+    "disable\000"
+    "enable\000"
+    "employee\000"
+    "privileged-mode\000"
+    "passcode\000"
+    "employees-by-id\000"
+    "load\000"
+    "<INT:day>\000"
+    "<UINT:max>\000"
+    "<UINT:inches>\000"
+    "<UINT:lbs>\000"
+    "<STRING:filter>\000"
+    "<MACADDR:addr>\000"
+    "<INT:year>\000"
+    "<UINT:min>\000"
+    "<INT:month>\000"
+    "<STRING:filename>\000"
+    "<FILE:filename>\000"
+    "<STRING:name>\000"
+    "<STRING:title>\000"
+    "<FLOAT:scale>\000"
+    "<HEX64:passcode>\000"
+    "<HEX:id>\000"
+    "<IPV4ADDR:ipv4>"
+};
+
+static const uint32_t cparser_desc_idx[81] CPARSER_COLD = {
+    372,
+    0,
+    0,
+    587,
+    0,
+    549,
+    0,
+    0,
+    0,
+    0,
+    0,
+    94,
+    0,
+    0,
+    0,
+    654,
+    0,
+    616,
+    0,
+    0,
+    281,
+    166,
+    0,
+    401,
+    0,
+    0,
+    219,
+    0,
+    0,
+    0,
+    0,
+    186,
+    0,
+    0,
+    77,
+    0,
+    0,
+    152,
+    0,
+    0,
+    1,
+    0,
+    0,
+    26,
+    0,
+    0,
+    51,
+    0,
+    0,
+    224,
+    0,
+    0,
+    470,
+    0,
+    0,
+    0,
+    488,
+    0,
+    0,
+    0,
+    344,
+    0,
+    0,
+    0,
+    247,
+    0,
+    0,
+    0,
+    230,
+    0,
+    0,
+    0,
+    488,
+    0,
+    0,
+    447,
+    0,
+    0,
+    423,
+    0,
+    200,
+};
+
+static const char cparser_descs[690] CPARSER_COLD =
+    "\000"
+    "Scaling factor for bonus\000"
+    "Employee's PC IP address\000"
+    "Employee's PC MAC address\000"
+    "Height in inches\000"
+    "List all employees within a certain range of employee ids\000"
+    "Weight in lbs\000"
+    "Root of submode emp\000"
+    "Date of birth\000"
+    "Leave the database\000"
+    "Name\000"
+    "Title\000"
+    "Load roster file\000"
+    "Save the current roster to a file\000"
+    "Add a new employee or enter the record of an existing employee\000"
+    "Delete an existing employee\000"
+    "Root node of the parser tree\000"
+    "Exit employee submode\000"
+    "Disable privileged mode\000"
+    "Enable privileged mode\000"
+    "Security passcode\000"
+    "List all available commands with a substring 'filter' in it.\000"
+    "List detail records of all employees.\000"
+    "List a summary of employees.\000"
+    "Show the bonus factor of an employee.\000"
+    "Show specific field of an employee."
+;
+
+cparser_tree_t cparser_tree = {
+    (cparser_node_t *)&cparser_packed.nodes[0],
+    cparser_glue_tbl,
+    CPARSER_NUM_GLUE,
+    cparser_desc_idx,
+    cparser_descs
+};
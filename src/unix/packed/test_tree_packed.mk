@@ -0,0 +1,12 @@
+# This file is generated by mk_parser.py.
+TEST_TREE_PACKED_SRC = test_tree_packed.c \
+	test_tree_packed_kw_disable.c \
+	test_tree_packed_kw_employee.c \
+	test_tree_packed_kw_enable.c \
+	test_tree_packed_kw_help.c \
+	test_tree_packed_kw_load.c \
+	test_tree_packed_kw_no.c \
+	test_tree_packed_kw_quit.c \
+	test_tree_packed_kw_save.c \
+	test_tree_packed_kw_show.c \
+	test_tree_packed_sm_employee_id_root.c
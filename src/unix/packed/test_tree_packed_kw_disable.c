@@ -0,0 +1,48 @@
+/*----------------------------------------------------------------------
+ * This file is generated by mk_parser.py.
+ *----------------------------------------------------------------------*/
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_codec.h"
+
+cparser_result_t cparser_cmd_disable_privileged_mode(cparser_context_t *context);
+
+cparser_result_t
+cparser_glue_disable_privileged_mode (cparser_t *parser)
+{
+    cparser_result_t rc;
+
+    rc = cparser_cmd_disable_privileged_mode(&parser->context);
+    return rc;
+}
+
+int
+cparser_enc_disable_privileged_mode (void *buf, size_t size)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_disable_privileged_mode (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_disable_privileged_mode(&parser->context);
+    return rc;
+}
+
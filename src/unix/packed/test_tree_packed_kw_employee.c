@@ -0,0 +1,63 @@
+/*----------------------------------------------------------------------
+ * This file is generated by mk_parser.py.
+ *----------------------------------------------------------------------*/
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_codec.h"
+
+cparser_result_t cparser_cmd_employee_id(cparser_context_t *context,
+    uint32_t *id_ptr);
+
+cparser_result_t
+cparser_glue_employee_id (cparser_t *parser)
+{
+    uint32_t id_val;
+    uint32_t *id_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_hex(&parser->tokens[1], &id_val);
+    assert(CPARSER_OK == rc);
+    id_ptr = &id_val;
+    rc = cparser_cmd_employee_id(&parser->context,
+        id_ptr);
+    return rc;
+}
+
+int
+cparser_enc_employee_id (void *buf, size_t size,
+    uint32_t *id_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_HEX, 0, id_ptr);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_employee_id (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    uint32_t id_val;
+    uint32_t *id_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_HEX, 0, &id_val,
+                           sizeof(id_val), NULL);
+    id_ptr = &id_val;
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_employee_id(&parser->context,
+        id_ptr);
+    return rc;
+}
+
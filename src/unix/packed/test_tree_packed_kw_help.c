@@ -0,0 +1,69 @@
+/*----------------------------------------------------------------------
+ * This file is generated by mk_parser.py.
+ *----------------------------------------------------------------------*/
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_codec.h"
+
+cparser_result_t cparser_cmd_help_filter(cparser_context_t *context,
+    char **filter_ptr);
+
+cparser_result_t
+cparser_glue_help_filter (cparser_t *parser)
+{
+    char *filter_val;
+    char **filter_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_string(&parser->tokens[1], &filter_val);
+    if (CPARSER_OK == rc) {
+        filter_ptr = &filter_val;
+    } else {
+        assert(2 > parser->token_tos);
+    }
+    rc = cparser_cmd_help_filter(&parser->context,
+        filter_ptr);
+    return rc;
+}
+
+int
+cparser_enc_help_filter (void *buf, size_t size,
+    char **filter_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_STRING, 1,
+                       filter_ptr ? *filter_ptr : NULL);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_help_filter (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    char filter_buf[CPARSER_MAX_TOKEN_SIZE + 1];
+    char *filter_val = filter_buf;
+    char **filter_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    if (cparser_decode_arg(&dec, CPARSER_NODE_STRING, 1, filter_buf,
+                           sizeof(filter_buf), NULL)) {
+        filter_ptr = &filter_val;
+    }
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_help_filter(&parser->context,
+        filter_ptr);
+    return rc;
+}
+
@@ -0,0 +1,65 @@
+/*----------------------------------------------------------------------
+ * This file is generated by mk_parser.py.
+ *----------------------------------------------------------------------*/
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "cparser.h"
+#include "cparser_priv.h"
+#include "cparser_token.h"
+#include "cparser_codec.h"
+
+cparser_result_t cparser_cmd_load_roster_filename(cparser_context_t *context,
+    char **filename_ptr);
+
+cparser_result_t
+cparser_glue_load_roster_filename (cparser_t *parser)
+{
+    char *filename_val;
+    char **filename_ptr = NULL;
+    cparser_result_t rc;
+
+    rc = cparser_get_file(&parser->tokens[2], &filename_val);
+    assert(CPARSER_OK == rc);
+    filename_ptr = &filename_val;
+    rc = cparser_cmd_load_roster_filename(&parser->context,
+        filename_ptr);
+    return rc;
+}
+
+int
+cparser_enc_load_roster_filename (void *buf, size_t size,
+    char **filename_ptr)
+{
+    cparser_encoder_t enc;
+
+    cparser_encoder_init(&enc, buf, size);
+    cparser_encode_arg(&enc, CPARSER_NODE_FILE, 0,
+                       filename_ptr ? *filename_ptr : NULL);
+    return cparser_encoder_done(&enc);
+}
+
+cparser_result_t
+cparser_dec_load_roster_filename (cparser_t *parser, const void *data,
+    size_t len)
+{
+    cparser_decoder_t dec;
+    char filename_buf[CPARSER_MAX_TOKEN_SIZE + 1];
+    char *filename_val = filename_buf;
+    char **filename_ptr = NULL;
+    cparser_result_t rc;
+
+    cparser_decoder_init(&dec, data, len);
+    (void)cparser_decode_arg(&dec, CPARSER_NODE_FILE, 0, filename_buf,
+                           sizeof(filename_buf), NULL);
+    filename_ptr = &filename_val;
+    rc = cparser_decoder_done(&dec);
+    if (CPARSER_OK != rc) {
+        return rc;
+    }
+    rc = cparser_cmd_load_roster_filename(&parser->context,
+        filename_ptr);
+    return rc;
+}
+
@@ -70,7 +70,7 @@ $(DIR_LIST):
 	@echo "MAKE $(basename $@)"
 	$(MAKE) PLATFORM=$(PLATFORM) MODULE=$(basename $@) DEBUG="$(DEBUG)" LIBRARY=$(LIBRARY) -C $(basename $@)/src all
 
-$(TEST_LIST):
+$(TEST_LIST) $(BENCH_LIST):
 	@echo "MAKE TEST $(dir $@):$(notdir $@)..."
 	$(MAKE) PLATFORM=$(PLATFORM) MODULE=$(dir $@) DEBUG="$(DEBUG)" -C $(dir $@)src -f Makefile.$(notdir $@) all
 
@@ -80,7 +80,7 @@ $(CLEAN_LIST):
 
 bin: $(BUILDDIR) $(DIR_LIST)
 
-all: bin $(TEST_LIST)
+all: bin $(TEST_LIST) $(BENCH_LIST)
 
 tests: all
 	@for testcase in ${TEST_LIST}; do \